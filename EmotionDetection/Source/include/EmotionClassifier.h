@@ -0,0 +1,157 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				EmotionClassifier.h
+* \@brief Desc:				Multi-class emotion classifier over small face crops
+* \@brief prerequisite::	C++17 (AVX2/AVX-512 used when present)
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+#include "opencv2/opencv.hpp"
+
+#ifndef FACERECOGNITION_API
+#define FACERECOGNITION_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Fully connected network:: crop -> [dense + ReLU] x n -> dense -> softmax over EEmotion
+	* \@desc no hidden layer makes it a softmax linear classifier, one or two small ones a tiny MLP
+	* \@desc every face of a frame is one row of the input, each layer is a single SGEMM over the batch
+	* \@desc classify is const and takes the scratch from the caller, one instance serves any number of threads
+	* \@desc an aligned model takes crops rotated and scaled so that the eye centers land on fixed points, a box model the widened face box
+	*/
+	class FACERECOGNITION_API EmotionClassifier final
+	{
+	public:
+		static constexpr int s_classNum = static_cast<int>(EEmotion::Max);
+
+		/**
+		* \@brief One dense layer
+		*/
+		struct SLayer
+		{
+			cv::Mat weights;							//CV_32F, outputs x inputs
+			cv::Mat bias;								//CV_32F, 1 x outputs
+		};
+
+		/**
+		* \@brief Settings of train
+		*/
+		struct STrainParam
+		{
+			int inputSize;								//side of the square crop
+			std::vector<int> hidden;					//outputs of the hidden layers, empty for a softmax linear classifier
+			int epochs;
+			int batch;									//faces per SGD step
+			float learningRate;
+			float momentum;
+			float weightDecay;							//L2 on the weights, not on the bias
+			uint64_t seed;
+
+			STrainParam() : inputSize(48), hidden{ 128 }, epochs(30), batch(64), learningRate(0.01f), momentum(0.9f), weightDecay(1e-4f), seed(7) {}
+		};
+
+		/**
+		* \@brief Scratch of one thread, sized on first use
+		*/
+		struct SWorkspace
+		{
+			cv::Mat crop;								//resized face, 8 bit
+			cv::Mat shrunk;								//face shrunk before the alignment warp
+			simd::AlignedVector<float> input;			//faces x inputSize^2
+			simd::AlignedVector<float> hidden[2];		//activations, ping-pong
+		};
+
+	public:
+		EmotionClassifier();
+
+		/**
+		* \@brief Build from trained layers
+		* \@param inputSize:: side of the square gray crop, e.g. 48 or 64
+		* \@param layers:: the first takes inputSize^2 inputs, the last gives s_classNum outputs in EEmotion order
+		* \@param align:: true if the layers were trained on eye aligned crops
+		*/
+		EResult create(const int inputSize, const std::vector<SLayer>& layers, const bool align = false);
+
+		/**
+		* \@brief Model file:: "GEMO", int32 version, int32 inputSize, int32 layers, int32 align (version 2, box crops in version 1)
+		* then per layer int32 outputs, int32 inputs, float weights[outputs][inputs], float bias[outputs]
+		*/
+		EResult load(const std::string& modelPath);
+		EResult save(const std::string& modelPath) const;
+
+		/**
+		* \@brief Train by minibatch SGD with momentum on the softmax cross entropy and replace the model, save writes the "GEMO" file
+		* \@param grays:: CV_8UC1 images
+		* \@param faces:: face box in each image, e.g. the whole image for datasets of face crops such as FER2013
+		* \@param eyes:: eye centers of each face as in classify, empty trains a box model
+		* \@param labels:: EEmotion of each face
+		* \@desc every crop is prepared once, memory is about faces x inputSize^2 floats
+		*/
+		EResult train(const std::vector<cv::Mat>& grays, const std::vector<cv::Rect>& faces, const std::vector<cv::Vec4f>& eyes,
+			const std::vector<int>& labels, const STrainParam& param);
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setIsa(const simd::EIsa isa) noexcept(true) { m_isa = simd::resolveIsa(isa); }
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+		bool isLoaded() const noexcept(true) { return !m_layers.empty(); }
+		int inputSize() const noexcept(true) { return m_inputSize; }
+		bool isAligned() const noexcept(true) { return m_align; }
+
+		/**
+		* \@brief Probabilities of every face
+		* \@desc box model:: the face box is widened by 10% and resized to the input
+		* \@desc aligned model:: the eyes go to (1/3, 0.4) and (2/3, 0.4) of the input, faces without eyes use the eyes expected in a frontal box
+		* \@desc each crop is normalized to zero mean and unit variance
+		* \@param gray:: CV_8UC1 frame
+		* \@param faces:: face boxes in gray pixels
+		* \@param eyes:: empty, or per face the eye centers x, y of the eye on the image left then on the image right, all 0 when unknown
+		* \@param probabilities:: faces.size() x s_classNum, one face after the other
+		*/
+		void classify(const cv::Mat& gray, const std::vector<cv::Rect>& faces, const std::vector<cv::Vec4f>& eyes, float* probabilities, SWorkspace& workspace) const;
+		void classify(const cv::Mat& gray, const std::vector<cv::Rect>& faces, float* probabilities, SWorkspace& workspace) const
+		{
+			classify(gray, faces, std::vector<cv::Vec4f>(), probabilities, workspace);
+		}
+
+	private:
+		/**
+		* \@brief Dense layer with the weights transposed to inputs x stride, stride the outputs rounded up to 16
+		*/
+		struct SPackedLayer
+		{
+			int inputs, outputs, stride;
+			simd::AlignedVector<float> weights;
+			simd::AlignedVector<float> bias;
+
+			SPackedLayer() : inputs(0), outputs(0), stride(0) {}
+		};
+
+		/**
+		* \@brief Normalized crop of one face, eyes nullptr for a box crop
+		*/
+		static void prepare(const cv::Mat& gray, const cv::Rect& face, const cv::Vec4f* eyes, const int inputSize, float* input, SWorkspace& workspace);
+
+		/**
+		* \@brief Eyes of the face, the ones expected in a frontal box when they are not known
+		*/
+		static cv::Vec4f faceEyes(const cv::Rect& face, const std::vector<cv::Vec4f>& eyes, const size_t index);
+
+	private:
+		int m_inputSize;
+		bool m_align;
+		std::vector<SLayer> m_layers;					//!< fp32 source, kept for saving
+		std::vector<SPackedLayer> m_packed;
+		simd::EIsa m_isa;
+	};
+}///namespace Ghost
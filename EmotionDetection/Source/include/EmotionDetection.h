@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "GIVisionDetect.h"
 
 #ifndef FACERECOGNITION_API
@@ -16,6 +18,27 @@ using namespace cv;
 
 namespace Ghost
 {
+	/**
+	* \@brief Emotion of one tracked face
+	*/
+	struct SFaceEmotion
+	{
+		int id;									//stays the same while the face is tracked
+		cv::Rect box;							//last face box in frameIn pixels
+		EEmotion emotion;						//debounced state
+		float score;							//smoothed probability of emotion, 0..1
+		std::array<float, static_cast<size_t>(EEmotion::Max)> probabilities;	//smoothed probability of every class in EEmotion order
+		float smile;							//0..1, from the landmarks only
+		float mouthOpen;						//0..1, from the landmarks only
+		float eyeClosure;						//0..1 both eyes, from the landmarks only
+
+		SFaceEmotion() : id(-1), emotion(EEmotion::Neutral), score(1.f), smile(0.f), mouthOpen(0.f), eyeClosure(0.f)
+		{
+			probabilities.fill(0.f);
+			probabilities[0] = 1.f;
+		}
+	};
+
 	/**
 	* \@brief Emotion Detector for complex task
 	*/
@@ -28,12 +51,21 @@ namespace Ghost
 	public:
 		/**
 		* \@brief Setting the path of the data file required by the module #####Chinese cannot be included in the path#####
-		* \@param faceModelPath:: face detection cascade Path
+		* \@param faceModelPath:: face detection model Path #seeta .bin model (needs USE_SEETA), or a Haar/LBP cascade .xml run by the built-in SIMD engine#
 		* \@param emotionXmlPath:: emotion detection cascadePath
+		* \@param flagPath:: folder of the legacy "SmileFlag" mirror, see TYPE_Emotion_FlagInterval #empty disables the mirror#
 		* \@return Returns the result of execution
 		*/
 		static EResult setPath(const string& faceModelPath, const string& emotionXmlPath, const string& flagPath) noexcept(true);
 
+		/**
+		* \@brief Setting the model of the multi-class classifier, see EmotionClassifier::load
+		* \@desc EmotionClassifier::train builds one, TestLib EMOTION_TRAIN exports it from a folder per emotion
+		* \@param classifierPath:: "GEMO" model file
+		* \@return Returns the result of execution
+		*/
+		static EResult setClassifierPath(const string& classifierPath) noexcept(true);
+
 		/**
 		* \@brief Get the version number of the current library
 		* \@return Returns the result of execution
@@ -67,6 +99,12 @@ namespace Ghost
 
 		/**
 		* \@brief Setting Module Parameters
+		* \@desc TYPE_Emotion_FlagInterval shortest seconds between two writes of the SmileFlag mirror, 0 turns the mirror off
+		* \@desc TYPE_Emotion_Classifier 0::Haar smile cascade #Neutral/Smile only# 1::multi-class classifier, all faces of a frame in one batch
+		* \@desc 2::geometry of the 68 landmarks given by setLandmarks #no face detection nor image work, Neutral/Smile/Surprise#
+		* \@desc TYPE_Emotion_Interval frames between two classifications of a face, the label is carried forward in between, 0/1::every frame
+		* \@desc TYPE_Emotion_ChangeThreshold a face whose 8x8 normalized thumbnail moved more than this mean absolute difference
+		* \@desc since its last classification is classified again at once, default 0.25, 0::off
 		* \@param type Setting the type of parameter
 		* \@param value 0.0::close---1.0::open
 		* \@return Results of implementation
@@ -82,6 +120,16 @@ namespace Ghost
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Landmarks for the next detect with TYPE_Emotion_Classifier 2, bind it to FaceLandmark::bindSlotLandmarkBuffer
+		* \@desc with TYPE_Emotion_Classifier 1 the eye centers of a face whose eyes fall in a detected box align the crop of an aligned model
+		* \@desc smile from the mouth width and the lift of its corners, mouth open from the inner lips, eye closure from the eye aspect ratio
+		* \@desc distances are relative to the eye distance in the axes of the eye line, the smile to a per face neutral mouth
+		* \@param points:: x0, y0, x1, y1 ... one face after the other, faces without 68 points are skipped
+		* \@param counts:: points of each face
+		*/
+		void setLandmarks(const float* points, const int* counts, const size_t faceNum);
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
@@ -90,11 +138,24 @@ namespace Ghost
 
 	public GHOST_SIGNAL:
 		/**
-		* \@brief Found face Landmark appearing
+		* \@brief Emotion of the tracked faces changed
+		* \@desc emitted only when a face changes state, appears or is lost, never on every frame
 		* \@param func::Functions that need to be triggered
 		*/
 		void bindSlotEmotionChanged(const std::function<void(const std::vector<Ghost::EEmotion>&)>& functor);
 
+		/**
+		* \@brief Same as bindSlotEmotionChanged with the id, box and score of every tracked face
+		*/
+		void bindSlotFacesEmotion(const std::function<void(const std::vector<SFaceEmotion>&)>& functor);
+
+		/**
+		* \@brief Expression scores of every face on every frame with TYPE_Emotion_Classifier 2, without copies or allocations
+		* \@desc scores:: smile, mouth open, eye closure of each face one after the other, ids:: id of each face
+		* \@desc the buffers are reused by the next frame, copy what must outlive the call
+		*/
+		void bindSlotExpressionScores(const std::function<void(const float*, const int*, const size_t)>& functor);
+
 	private:
 		class Impl;
 		std::unique_ptr<Impl> m_pImpl;
@@ -0,0 +1,442 @@
+#include "EmotionClassifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_fileVersion = 2;
+		const char s_fileMagic[4] = { 'G', 'E', 'M', 'O' };
+		constexpr float s_cropMargin = 0.1f;			//box widened by this much of its size on every side
+
+		//对齐后两眼中心在输入中的位置 与正脸框放大10%后眼睛所在的位置相同 两种裁剪的取景一致
+		const float s_alignedEyeX[2] = { 1.f / 3.f, 2.f / 3.f };
+		constexpr float s_alignedEyeY = 0.4f;
+		//正脸检测框中眼睛的经验位置 没有landmark时代替
+		const float s_boxEyeX[2] = { 0.3f, 0.7f };
+		constexpr float s_boxEyeY = 0.38f;
+	}
+
+	EmotionClassifier::EmotionClassifier()
+		:
+		m_inputSize(0),
+		m_align(false),
+		m_isa(simd::bestIsa())
+	{
+	}
+
+	EResult EmotionClassifier::create(const int inputSize, const std::vector<SLayer>& layers, const bool align)
+	{
+		if (inputSize <= 0 || layers.empty())
+			return EResult::SR_NG;
+
+		int inputs = inputSize * inputSize;
+		for (const auto& layer : layers)
+		{
+			if (layer.weights.type() != CV_32FC1 || layer.bias.type() != CV_32FC1 || layer.weights.cols != inputs
+				|| layer.weights.rows <= 0 || static_cast<int>(layer.bias.total()) != layer.weights.rows)
+				return EResult::SR_NG;
+			inputs = layer.weights.rows;
+		}
+		if (inputs != s_classNum)
+			return EResult::SR_NG;
+
+		m_inputSize = inputSize;
+		m_align = align;
+		m_layers.clear();
+		m_packed.clear();
+		for (const auto& layer : layers)
+		{
+			SLayer copy;
+			copy.weights = layer.weights.clone();
+			copy.bias = layer.bias.reshape(1, 1).clone();
+			m_layers.push_back(copy);
+
+			SPackedLayer packed;
+			packed.inputs = layer.weights.cols;
+			packed.outputs = layer.weights.rows;
+			packed.stride = static_cast<int>(simd::alignUp(packed.outputs, 16));
+			packed.weights.assign(static_cast<size_t>(packed.inputs) * packed.stride, 0.f);
+			packed.bias.assign(packed.stride, 0.f);
+			for (int o = 0; o < packed.outputs; o++)
+			{
+				const float* row = copy.weights.ptr<float>(o);
+				for (int i = 0; i < packed.inputs; i++)
+					packed.weights[static_cast<size_t>(i) * packed.stride + o] = row[i];
+				packed.bias[o] = copy.bias.at<float>(0, o);
+			}
+			m_packed.push_back(std::move(packed));
+		}
+
+		return EResult::SR_OK;
+	}
+
+	EResult EmotionClassifier::load(const std::string& modelPath)
+	{
+		std::ifstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		char magic[4] = { 0 };
+		int32_t header[3] = { 0 };
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!file || !std::equal(magic, magic + 4, s_fileMagic) || header[0] < 1 || header[0] > s_fileVersion || header[1] <= 0 || header[2] <= 0)
+			return EResult::SR_NG;
+
+		//版本1只有框裁剪
+		int32_t align = 0;
+		if (header[0] >= 2)
+			file.read(reinterpret_cast<char*>(&align), sizeof(align));
+
+		std::vector<SLayer> layers(header[2]);
+		for (auto& layer : layers)
+		{
+			int32_t shape[2] = { 0 };
+			file.read(reinterpret_cast<char*>(shape), sizeof(shape));
+			if (!file || shape[0] <= 0 || shape[1] <= 0)
+				return EResult::SR_NG;
+
+			layer.weights.create(shape[0], shape[1], CV_32FC1);
+			layer.bias.create(1, shape[0], CV_32FC1);
+			file.read(reinterpret_cast<char*>(layer.weights.data), layer.weights.total() * sizeof(float));
+			file.read(reinterpret_cast<char*>(layer.bias.data), layer.bias.total() * sizeof(float));
+		}
+		if (!file)
+			return EResult::SR_NG;
+
+		return create(header[1], layers, align != 0);
+	}
+
+	EResult EmotionClassifier::save(const std::string& modelPath) const
+	{
+		if (!isLoaded())
+			return EResult::SR_Detector_Not_Exist;
+
+		std::ofstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		const int32_t header[4] = { s_fileVersion, m_inputSize, static_cast<int32_t>(m_layers.size()), m_align ? 1 : 0 };
+		file.write(s_fileMagic, sizeof(s_fileMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		for (const auto& layer : m_layers)
+		{
+			const int32_t shape[2] = { layer.weights.rows, layer.weights.cols };
+			file.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+			for (int r = 0; r < layer.weights.rows; r++)
+				file.write(reinterpret_cast<const char*>(layer.weights.ptr<float>(r)), layer.weights.cols * sizeof(float));
+			file.write(reinterpret_cast<const char*>(layer.bias.data), layer.bias.total() * sizeof(float));
+		}
+
+		return file ? EResult::SR_OK : EResult::SR_NG;
+	}
+
+	EResult EmotionClassifier::train(const std::vector<cv::Mat>& grays, const std::vector<cv::Rect>& faces, const std::vector<cv::Vec4f>& eyes,
+		const std::vector<int>& labels, const STrainParam& param)
+	{
+		const int faceNum = static_cast<int>(grays.size());
+		if (faceNum == 0 || faces.size() != grays.size() || labels.size() != grays.size() || (!eyes.empty() && eyes.size() != grays.size())
+			|| param.inputSize <= 0 || param.epochs <= 0 || param.batch <= 0)
+			return EResult::SR_NG;
+		for (int f = 0; f < faceNum; f++)
+		{
+			if (grays[f].type() != CV_8UC1 || labels[f] < 0 || labels[f] >= s_classNum)
+				return EResult::SR_NG;
+		}
+
+		std::vector<int> widths(1, param.inputSize * param.inputSize);
+		for (const int hidden : param.hidden)
+		{
+			if (hidden <= 0)
+				return EResult::SR_NG;
+			widths.push_back(hidden);
+		}
+		widths.push_back(s_classNum);
+
+		//每张脸只裁剪一次
+		const bool align = !eyes.empty();
+		cv::Mat samples(faceNum, widths.front(), CV_32FC1);
+		SWorkspace workspace;
+		for (int f = 0; f < faceNum; f++)
+		{
+			const cv::Vec4f faceEye = faceEyes(faces[f], eyes, f);
+			prepare(grays[f], faces[f], align ? &faceEye : nullptr, param.inputSize, samples.ptr<float>(f), workspace);
+		}
+
+		//He 初始化
+		cv::RNG rng(param.seed);
+		const size_t layerNum = widths.size() - 1;
+		std::vector<SLayer> layers(layerNum), velocities(layerNum), gradients(layerNum);
+		for (size_t l = 0; l < layerNum; l++)
+		{
+			layers[l].weights.create(widths[l + 1], widths[l], CV_32FC1);
+			rng.fill(layers[l].weights, cv::RNG::NORMAL, 0.0, std::sqrt(2.0 / widths[l]));
+			layers[l].bias = cv::Mat(1, widths[l + 1], CV_32FC1, cv::Scalar::all(0));
+			velocities[l].weights = cv::Mat(widths[l + 1], widths[l], CV_32FC1, cv::Scalar::all(0));
+			velocities[l].bias = cv::Mat(1, widths[l + 1], CV_32FC1, cv::Scalar::all(0));
+		}
+
+		std::vector<int> order(faceNum);
+		std::iota(order.begin(), order.end(), 0);
+		std::vector<cv::Mat> activations(layerNum + 1);
+		cv::Mat delta, previous;
+		for (int epoch = 0; epoch < param.epochs; epoch++)
+		{
+			//余弦退火
+			const float learningRate = param.learningRate * 0.5f * (1.f + std::cos(static_cast<float>(CV_PI) * epoch / param.epochs));
+			for (int i = faceNum - 1; i > 0; i--)
+				std::swap(order[i], order[rng.uniform(0, i + 1)]);
+
+			for (int start = 0; start < faceNum; start += param.batch)
+			{
+				const int rows = std::min(param.batch, faceNum - start);
+				activations[0].create(rows, widths.front(), CV_32FC1);
+				for (int r = 0; r < rows; r++)
+					samples.row(order[start + r]).copyTo(activations[0].row(r));
+
+				for (size_t l = 0; l < layerNum; l++)
+				{
+					cv::gemm(activations[l], layers[l].weights, 1.0, cv::noArray(), 0.0, activations[l + 1], cv::GEMM_2_T);
+					const float* bias = layers[l].bias.ptr<float>(0);
+					for (int r = 0; r < rows; r++)
+					{
+						float* row = activations[l + 1].ptr<float>(r);
+						for (int o = 0; o < widths[l + 1]; o++)
+							row[o] = (l + 1 == layerNum) ? row[o] + bias[o] : std::max(row[o] + bias[o], 0.f);
+					}
+				}
+
+				//softmax 交叉熵对 logits 的梯度:: p - onehot 按批平均
+				delta.create(rows, s_classNum, CV_32FC1);
+				for (int r = 0; r < rows; r++)
+				{
+					const float* logits = activations[layerNum].ptr<float>(r);
+					float* gradient = delta.ptr<float>(r);
+					const float maxLogit = *std::max_element(logits, logits + s_classNum);
+					float sum = 0.f;
+					for (int c = 0; c < s_classNum; c++)
+					{
+						gradient[c] = std::exp(logits[c] - maxLogit);
+						sum += gradient[c];
+					}
+					for (int c = 0; c < s_classNum; c++)
+						gradient[c] = (gradient[c] / sum - (c == labels[order[start + r]] ? 1.f : 0.f)) / rows;
+				}
+
+				for (size_t l = layerNum; l-- > 0;)
+				{
+					cv::gemm(delta, activations[l], 1.0, cv::noArray(), 0.0, gradients[l].weights, cv::GEMM_1_T);
+					cv::reduce(delta, gradients[l].bias, 0, cv::REDUCE_SUM);
+					if (l > 0)
+					{
+						//ReLU 只回传激活的单元
+						cv::gemm(delta, layers[l].weights, 1.0, cv::noArray(), 0.0, previous);
+						for (int r = 0; r < rows; r++)
+						{
+							const float* activation = activations[l].ptr<float>(r);
+							float* gradient = previous.ptr<float>(r);
+							for (int i = 0; i < widths[l]; i++)
+							{
+								if (activation[i] <= 0.f)
+									gradient[i] = 0.f;
+							}
+						}
+					}
+
+					cv::scaleAdd(layers[l].weights, param.weightDecay, gradients[l].weights, gradients[l].weights);
+					cv::addWeighted(velocities[l].weights, param.momentum, gradients[l].weights, -learningRate, 0.0, velocities[l].weights);
+					cv::addWeighted(velocities[l].bias, param.momentum, gradients[l].bias, -learningRate, 0.0, velocities[l].bias);
+					cv::add(layers[l].weights, velocities[l].weights, layers[l].weights);
+					cv::add(layers[l].bias, velocities[l].bias, layers[l].bias);
+
+					if (l > 0)
+						cv::swap(delta, previous);
+				}
+			}
+		}
+
+		return create(param.inputSize, layers, align);
+	}
+
+	void EmotionClassifier::classify(const cv::Mat& gray, const std::vector<cv::Rect>& faces, const std::vector<cv::Vec4f>& eyes, float* probabilities, SWorkspace& workspace) const
+	{
+		const int batch = static_cast<int>(faces.size());
+		if (!isLoaded() || batch == 0)
+			return;
+
+		//每张脸一行 整批一起前向
+		const size_t inputs = static_cast<size_t>(m_inputSize) * m_inputSize;
+		if (workspace.input.size() < batch * inputs)
+			workspace.input.resize(batch * inputs);
+		for (int b = 0; b < batch; b++)
+		{
+			const cv::Vec4f faceEye = faceEyes(faces[b], eyes, b);
+			prepare(gray, faces[b], m_align ? &faceEye : nullptr, m_inputSize, workspace.input.data() + b * inputs, workspace);
+		}
+
+		const float* in = workspace.input.data();
+		int ldIn = static_cast<int>(inputs);
+		for (size_t l = 0; l < m_packed.size(); l++)
+		{
+			const SPackedLayer& layer = m_packed[l];
+			auto& hidden = workspace.hidden[l & 1];
+			if (hidden.size() < static_cast<size_t>(batch) * layer.stride)
+				hidden.resize(static_cast<size_t>(batch) * layer.stride);
+
+			float* out = hidden.data();
+			simd::sgemm(batch, layer.stride, layer.inputs, in, ldIn, layer.weights.data(), layer.stride, out, layer.stride, false, m_isa);
+
+			const bool last = (l + 1 == m_packed.size());
+			for (int b = 0; b < batch; b++)
+			{
+				float* row = out + static_cast<size_t>(b) * layer.stride;
+				const float* bias = layer.bias.data();
+				if (last)
+				{
+					for (int o = 0; o < layer.outputs; o++)
+						row[o] += bias[o];
+				}
+				else
+				{
+					for (int o = 0; o < layer.stride; o++)
+						row[o] = std::max(row[o] + bias[o], 0.f);
+				}
+			}
+
+			in = out;
+			ldIn = layer.stride;
+		}
+
+		//softmax
+		for (int b = 0; b < batch; b++)
+		{
+			const float* logits = in + static_cast<size_t>(b) * ldIn;
+			float* probability = probabilities + b * s_classNum;
+			const float maxLogit = *std::max_element(logits, logits + s_classNum);
+
+			float sum = 0.f;
+			for (int c = 0; c < s_classNum; c++)
+			{
+				probability[c] = std::exp(logits[c] - maxLogit);
+				sum += probability[c];
+			}
+			for (int c = 0; c < s_classNum; c++)
+				probability[c] /= sum;
+		}
+	}
+
+	cv::Vec4f EmotionClassifier::faceEyes(const cv::Rect& face, const std::vector<cv::Vec4f>& eyes, const size_t index)
+	{
+		if (index < eyes.size())
+		{
+			const cv::Vec4f& eye = eyes[index];
+			if (eye[0] != 0.f || eye[1] != 0.f || eye[2] != 0.f || eye[3] != 0.f)
+				return eye;
+		}
+
+		const float y = face.y + face.height * s_boxEyeY;
+		return cv::Vec4f(face.x + face.width * s_boxEyeX[0], y, face.x + face.width * s_boxEyeX[1], y);
+	}
+
+	void EmotionClassifier::prepare(const cv::Mat& gray, const cv::Rect& face, const cv::Vec4f* eyes, const int inputSize, float* input, SWorkspace& workspace)
+	{
+		const size_t inputs = static_cast<size_t>(inputSize) * inputSize;
+		cv::Mat& crop = workspace.crop;
+		if (eyes == nullptr)
+		{
+			const int marginX = cvRound(face.width * s_cropMargin);
+			const int marginY = cvRound(face.height * s_cropMargin);
+			const cv::Rect box = cv::Rect(face.x - marginX, face.y - marginY, face.width + marginX * 2, face.height + marginY * 2)
+				& cv::Rect(0, 0, gray.cols, gray.rows);
+			if (box.area() <= 0)
+			{
+				std::fill(input, input + inputs, 0.f);
+				return;
+			}
+
+			cv::resize(gray(box), crop, cv::Size(inputSize, inputSize), 0.0, 0.0, cv::INTER_AREA);
+		}
+		else
+		{
+			//相似变换:: 两眼连线转平 眼距缩放到 s_alignedEyeX 的间隔
+			const cv::Point2f left((*eyes)[0], (*eyes)[1]), right((*eyes)[2], (*eyes)[3]);
+			const cv::Point2f center = (left + right) * 0.5f;
+			const float distance = std::hypot(right.x - left.x, right.y - left.y);
+			if (!(distance > 1.f))
+			{
+				std::fill(input, input + inputs, 0.f);
+				return;
+			}
+
+			const float scale = (s_alignedEyeX[1] - s_alignedEyeX[0]) * inputSize / distance;
+			const float cosine = scale * (right.x - left.x) / distance;
+			const float sine = scale * (right.y - left.y) / distance;
+			const cv::Point2f target(0.5f * inputSize, s_alignedEyeY * inputSize);
+
+			//输出四角对应的原图区域
+			float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+			for (const auto& corner : { cv::Point2f(0.f, 0.f), cv::Point2f(static_cast<float>(inputSize), 0.f),
+				cv::Point2f(0.f, static_cast<float>(inputSize)), cv::Point2f(static_cast<float>(inputSize), static_cast<float>(inputSize)) })
+			{
+				const float u = corner.x - target.x, v = corner.y - target.y;
+				const float x = center.x + (cosine * u - sine * v) / (scale * scale);
+				const float y = center.y + (sine * u + cosine * v) / (scale * scale);
+				minX = std::min(minX, x);
+				maxX = std::max(maxX, x);
+				minY = std::min(minY, y);
+				maxY = std::max(maxY, y);
+			}
+			const cv::Rect region = cv::Rect(cvFloor(minX), cvFloor(minY), cvCeil(maxX) - cvFloor(minX) + 1, cvCeil(maxY) - cvFloor(minY) + 1)
+				& cv::Rect(0, 0, gray.cols, gray.rows);
+			if (region.area() <= 0)
+			{
+				std::fill(input, input + inputs, 0.f);
+				return;
+			}
+
+			//缩小超过一半时先按面积缩小 避免双线性插值的混叠
+			cv::Mat source = gray(region);
+			float factorX = 1.f, factorY = 1.f;
+			if (scale < 0.5f)
+			{
+				const cv::Size shrunkSize(std::max(1, cvRound(region.width * scale * 2.f)), std::max(1, cvRound(region.height * scale * 2.f)));
+				cv::resize(source, workspace.shrunk, shrunkSize, 0.0, 0.0, cv::INTER_AREA);
+				source = workspace.shrunk;
+				factorX = static_cast<float>(shrunkSize.width) / region.width;
+				factorY = static_cast<float>(shrunkSize.height) / region.height;
+			}
+
+			const float offsetX = target.x - (cosine * center.x + sine * center.y) + cosine * region.x + sine * region.y;
+			const float offsetY = target.y - (-sine * center.x + cosine * center.y) - sine * region.x + cosine * region.y;
+			const cv::Matx23f transform(cosine / factorX, sine / factorY, offsetX, -sine / factorX, cosine / factorY, offsetY);
+			cv::warpAffine(source, crop, cv::Mat(transform), cv::Size(inputSize, inputSize), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+		}
+
+		//零均值单位方差 对光照不敏感
+		float sum = 0.f, squared = 0.f;
+		for (int y = 0; y < inputSize; y++)
+		{
+			const uchar* row = crop.ptr<uchar>(y);
+			float* out = input + static_cast<size_t>(y) * inputSize;
+			for (int x = 0; x < inputSize; x++)
+			{
+				out[x] = row[x];
+				sum += out[x];
+				squared += out[x] * out[x];
+			}
+		}
+
+		const float mean = sum / inputs;
+		const float scale = 1.f / std::sqrt(std::max(squared / inputs - mean * mean, 1.f));
+		for (size_t i = 0; i < inputs; i++)
+			input[i] = (input[i] - mean) * scale;
+	}
+}///namespace Ghost
@@ -1,28 +1,154 @@
 #include "EmotionDetection.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <mutex>
 #include <atomic>
 #include <filesystem>
+#include <limits>
 #include <memory>
 
 #include <fstream>
 
+#ifdef USE_SEETA
 #include "face_detection.h"
+#endif
+#include "EmotionClassifier.h"
+#include "GCascadeDetector.hpp"
 
 using namespace Ghost::signalslot;
 namespace fs = std::filesystem;
 
 namespace Ghost
 {
+	namespace
+	{
+		/**
+		* \@brief 68landmarkļ ȶĵľ
+		*/
+		struct SGeometry
+		{
+			float mouthWidth;						//Ǽ
+			float cornerLift;						//ϴе̧ĸ߶ ۾ߵķ
+			float mouthAspect;						//ڴſ߶֮
+			float eyeAspect;						//۵ƽݺ
+		};
+
+		inline float distance(const float* points, const int a, const int b)
+		{
+			return std::hypot(points[a * 2] - points[b * 2], points[a * 2 + 1] - points[b * 2 + 1]);
+		}
+
+		/**
+		* \@brief  ͼ۾ǰ (36-41, 42-47)
+		*/
+		void eyeCenters(const float* points, float eye[2][2])
+		{
+			for (int e = 0; e < 2; e++)
+			{
+				eye[e][0] = eye[e][1] = 0.f;
+				for (int i = 36 + e * 6; i < 42 + e * 6; i++)
+				{
+					eye[e][0] += points[i * 2] / 6.f;
+					eye[e][1] += points[i * 2 + 1] / 6.f;
+				}
+			}
+		}
+
+		/**
+		* \@return false غ ޷һ
+		*/
+		bool measureGeometry(const float* points, SGeometry& geometry)
+		{
+			float eye[2][2];
+			eyeCenters(points, eye);
+
+			const float eyeDistance = std::hypot(eye[1][0] - eye[0][0], eye[1][1] - eye[0][1]);
+			if (!(eyeDistance > 1e-3f))
+				return false;
+
+			//۾ߵķ ͼΪ
+			const float normalX = -(eye[1][1] - eye[0][1]) / eyeDistance;
+			const float normalY = (eye[1][0] - eye[0][0]) / eyeDistance;
+			const auto lift = [&](const int corner)
+			{
+				return ((points[51 * 2] - points[corner * 2]) * normalX + (points[51 * 2 + 1] - points[corner * 2 + 1]) * normalY) / eyeDistance;
+			};
+
+			geometry.mouthWidth = distance(points, 48, 54) / eyeDistance;
+			geometry.cornerLift = (lift(48) + lift(54)) * 0.5f;
+			geometry.mouthAspect = (distance(points, 61, 67) + distance(points, 62, 66) + distance(points, 63, 65))
+				/ (3.f * std::max(distance(points, 60, 64), 1e-3f));
+			geometry.eyeAspect = ((distance(points, 37, 41) + distance(points, 38, 40)) / std::max(distance(points, 36, 39), 1e-3f)
+				+ (distance(points, 43, 47) + distance(points, 44, 46)) / std::max(distance(points, 42, 45), 1e-3f)) * 0.25f;
+			return true;
+		}
+
+		inline float unit(const float value)
+		{
+			return std::min(std::max(value, 0.f), 1.f);
+		}
+	}
+
 	/**
 	* \@brief ˽ʵ
 	*/
 	class EmotionDetector::Impl
 	{
+	public:
+		static constexpr int s_signatureSide = 8;							//!< ͼı߳
+		static constexpr size_t s_signatureSize = s_signatureSide * s_signatureSide;
+
+		/**
+		* \@brief һűٵ
+		*/
+		struct SFace
+		{
+			SFaceEmotion emotion;
+			size_t unconfirmed;						//ûм⵽֡
+			float neutralWidth;						//ƽʱ
+			float neutralLift;						//ƽʱǸ߶
+			std::array<float, s_signatureSize> signature;	//һʶʱ
+			size_t sinceEvaluation;					//һʶ֡
+			bool evaluatedFlag;						//ʶ
+
+			SFace() : unconfirmed(0), neutralWidth(s_neutralWidth), neutralLift(s_neutralLift), sinceEvaluation(0), evaluatedFlag(false)
+			{
+				signature.fill(0.f);
+			}
+		};
+
+		/**
+		* \@brief Դ
+		*/
+		enum struct EEngine : uint8_t
+		{
+			Cascade = 0,
+			Classifier,
+			Landmark
+		};
+
 	public:
 		Impl()
 			:
+#ifdef USE_SEETA
 			m_faceDetector(nullptr),
+#endif
+			m_pFaceCascade(nullptr),
+			m_minFaceSize(60),
+			m_maxFaceSize(-1),
+			m_scoreThresh(2.f),
+			m_scaleFactor(0.8f),
+			m_engine(EEngine::Cascade),
+			m_interval(1),
+			m_changeThreshold(0.25f),
+			m_changed(false),
+			m_nextId(0),
+			m_flagInterval(1.f),
+			m_flagKnown(false),
+			m_flagSmile(false),
 			m_initFlag(false)
 		{
 
@@ -45,13 +171,62 @@ namespace Ghost
 			if (m_initFlag.load())
 				return EResult::SR_Detector_Already_Exist;
 
+#ifdef USE_SEETA
 			if (m_faceDetector != nullptr)
 				return EResult::SR_Detector_Already_Exist;
+#endif
 
-			m_faceDetector = std::make_unique<seeta::FaceDetection>(m_faceModelPath.c_str());
-			m_faceDetector->SetMinFaceSize(60);
-			m_faceDetector->SetScoreThresh(2.f);
-			m_faceDetector->SetImagePyramidScaleFactor(0.8f);
+			//xml ģʹõļ
+			if (CascadeDetector::isCascadeFile(m_faceModelPath))
+			{
+				auto pCascade = std::make_unique<CascadeDetector>();
+				const EResult result = pCascade->load(m_faceModelPath);
+				if (result != EResult::SR_OK)
+					return result;
+				m_pFaceCascade = std::move(pCascade);
+			}
+			else
+			{
+#ifdef USE_SEETA
+				m_faceDetector = std::make_unique<seeta::FaceDetection>(m_faceModelPath.c_str());
+#else
+				//δ USE_SEETA ֻ֧ xml ģ
+				return EResult::SR_Detector_Not_Exist;
+#endif
+			}
+
+			const EResult result = loadEmotionModel();
+			if (result != EResult::SR_OK)
+				return result;
+
+			m_initFlag.store(true);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief صǰѡıģ ѼصĲظ #÷#
+		*/
+		EResult loadEmotionModel()
+		{
+			if (m_engine == EEngine::Landmark)
+				return EResult::SR_OK;
+
+			if (m_engine == EEngine::Classifier)
+			{
+				if (m_pClassifier != nullptr)
+					return EResult::SR_OK;
+
+				auto pClassifier = std::make_unique<EmotionClassifier>();
+				const EResult result = pClassifier->load(m_classifierPath);
+				if (result != EResult::SR_OK)
+					return result;
+				m_pClassifier = std::move(pClassifier);
+				return EResult::SR_OK;
+			}
+
+			if (!m_emotionDetector.empty())
+				return EResult::SR_OK;
 
 			try
 			{
@@ -64,11 +239,39 @@ namespace Ghost
 				return EResult::SR_NG;
 			}
 
-			m_initFlag.store(true);
-
 			return EResult::SR_OK;
 		}
 
+		EResult setEngine(const EEngine engine)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_engine == engine)
+				return EResult::SR_OK;
+
+			const EEngine previous = m_engine;
+			m_engine = engine;
+			if (!m_initFlag.load())
+				return EResult::SR_OK;
+
+			const EResult result = loadEmotionModel();
+			if (result != EResult::SR_OK)
+				m_engine = previous;
+			return result;
+		}
+
+		void setLandmarks(const float* points, const int* counts, const size_t faceNum)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			size_t total = 0;
+			for (size_t i = 0; i < faceNum; i++)
+				total += counts[i] * 2;
+
+			m_pendingPoints.assign(points, points + total);
+			m_pendingCounts.assign(counts, counts + faceNum);
+		}
+
 		/**
 		* \@brief ʼģ
 		* \return ִн
@@ -80,11 +283,17 @@ namespace Ghost
 			if (!m_initFlag.load())
 				return EResult::SR_Detector_Not_Exist;
 
+#ifdef USE_SEETA
 			if (m_faceDetector != nullptr)
 			{
 				m_faceDetector.reset();
 				m_faceDetector = nullptr;
 			}
+#endif
+			m_pFaceCascade.reset();
+			m_pClassifier.reset();
+			m_tracked.clear();
+			m_flagKnown = false;
 
 			m_initFlag.store(false);
 
@@ -104,78 +313,543 @@ namespace Ghost
 			if(!m_initFlag.load())
 				return EResult::SR_Detector_Not_Exist;
 
+			if (m_engine == EEngine::Landmark)
+			{
+				detectLandmarks(frameOut);
+				return EResult::SR_OK;
+			}
+
 			cv::Mat img_gray;
 			cv::cvtColor(frameOut, img_gray, cv::COLOR_BGR2GRAY);
 
-			seeta::ImageData img_data;
-			img_data.data = img_gray.data;
-			img_data.width = img_gray.cols;
-			img_data.height = img_gray.rows;
-			img_data.num_channels = 1;
-			std::vector<seeta::FaceInfo> faces = m_faceDetector->Detect(img_data);
-
 			m_faces.clear();
-			for (const auto& face : faces)
+			if (m_pFaceCascade != nullptr)
+			{
+				// FaceDetection ģͬĻ:: ϵȡ ֵΪڴ
+				const float factor = std::min(0.99f, std::max(0.01f, m_scaleFactor));
+				const std::vector<CascadeDetector::SObject> objects = m_pFaceCascade->detect
+				(
+					img_gray,
+					cv::Size(m_minFaceSize, m_minFaceSize),
+					(m_maxFaceSize > 0) ? cv::Size(m_maxFaceSize, m_maxFaceSize) : cv::Size(),
+					1.0 / factor,
+					std::max(1, static_cast<int32_t>(std::lround(m_scoreThresh)))
+				);
+				for (const auto& object : objects)
+					m_faces.push_back(object.rect);
+			}
+#ifdef USE_SEETA
+			else
+			{
+				m_faceDetector->SetMinFaceSize(m_minFaceSize);
+				m_faceDetector->SetMaxFaceSize((m_maxFaceSize > 0) ? m_maxFaceSize : std::numeric_limits<int32_t>::max());
+				m_faceDetector->SetScoreThresh(m_scoreThresh);
+				m_faceDetector->SetImagePyramidScaleFactor(m_scaleFactor);
+
+				seeta::ImageData img_data;
+				img_data.data = img_gray.data;
+				img_data.width = img_gray.cols;
+				img_data.height = img_gray.rows;
+				img_data.num_channels = 1;
+				std::vector<seeta::FaceInfo> faces = m_faceDetector->Detect(img_data);
+
+				for (const auto& face : faces)
+				{
+					const cv::Rect rect(face.bbox.x, face.bbox.y, face.bbox.width, face.bbox.height);
+					m_faces.push_back(rect);
+				}
+			}
+#endif
+
+			m_observed.clear();
+			for (const auto& faceRect : m_faces)
 			{
-				const cv::Rect rect(face.bbox.x, face.bbox.y, face.bbox.width, face.bbox.height);
-				m_faces.push_back(rect);
+				if ( (faceRect.area() > 0)				&&
+					 (faceRect.x >= 0)					&&
+					 (faceRect.y < frameOut.rows)		&&
+					 (faceRect.width < frameOut.cols)	&&
+					 (faceRect.height < frameOut.rows)
+					)
+				{
+					//ɫ
+					rectangle(frameOut, faceRect, Scalar(255, 0, 0), 2, 8, 0);
+					m_observed.push_back(faceRect);
+				}
 			}
 
+			matchFaces();
+			selectFaces(img_gray);
+
+			m_probabilities.assign(m_observed.size() * s_classNum, 0.f);
 			try
 			{
-				for (const auto& faceRect : m_faces)
+				if (m_engine == EEngine::Classifier && m_pClassifier != nullptr)
 				{
-					if ( (faceRect.area() > 0)				&&
-						 (faceRect.x >= 0)					&&
-						 (faceRect.y < frameOut.rows)		&&
-						 (faceRect.width < frameOut.cols)	&&
-						 (faceRect.height < frameOut.rows)
-						)
+					//ڵһδ setLandmarkslandmarkʱ۶
+					m_dueBoxes.clear();
+					m_dueEyes.clear();
+					for (size_t i = 0; i < m_observed.size(); i++)
 					{
-						//ɫ
-						rectangle(frameOut, faceRect, Scalar(255, 0, 0), 2, 8, 0);
+						if (m_evaluated[i])
+						{
+							m_dueBoxes.push_back(m_observed[i]);
+							m_dueEyes.push_back(findEyes(m_observed[i]));
+						}
+					}
+
+					m_dueProbabilities.resize(m_dueBoxes.size() * s_classNum);
+					m_pClassifier->classify(img_gray, m_dueBoxes, m_dueEyes, m_dueProbabilities.data(), m_classifierWorkspace);
 
+					const float* due = m_dueProbabilities.data();
+					for (size_t i = 0; i < m_observed.size(); i++)
+					{
+						if (!m_evaluated[i])
+							continue;
+						std::copy(due, due + s_classNum, m_probabilities.begin() + i * s_classNum);
+						due += s_classNum;
+					}
+				}
+				else if (m_engine == EEngine::Cascade)
+				{
+					for (size_t i = 0; i < m_observed.size(); i++)
+					{
+						if (!m_evaluated[i])
+							continue;
+
+						const cv::Rect& faceRect = m_observed[i];
 						Mat faceROI = frameOut(faceRect);//Bug 
 						std::vector<Rect> smile;
 
 						//-- In each face, detect smile
 						m_emotionDetector.detectMultiScale(faceROI, smile, 1.1, 55, CASCADE_SCALE_IMAGE);
 
-						string smileFlag = m_flagPath + "\\SmileFlag";
-						if (smile.size() > 0)
+						for (const auto& rect : smile)
 						{
-							for (const auto& rect : smile)
-							{
-								Rect rect(faceRect.x + rect.x, faceRect.y + rect.y, rect.width, rect.height);
-								rectangle(frameOut, rect, Scalar(0, 0, 255), 2, 8, 0);
-							}
-
-							//޸ı־
-							fs::create_directories(smileFlag);
-						}
-						else
-						{
-							//޸ı־
-							fs::remove(smileFlag);
+							const Rect mouth(faceRect.x + rect.x, faceRect.y + rect.y, rect.width, rect.height);
+							rectangle(frameOut, mouth, Scalar(0, 0, 255), 2, 8, 0);
 						}
+
+						//ֻƽ΢Ц
+						m_probabilities[i * s_classNum + static_cast<size_t>(smile.empty() ? EEmotion::Neutral : EEmotion::Smile)] = 1.f;
 					}
 				}
+
+				commitEvaluations();
 			}
 			catch (std::exception& except)
 			{
+				//ûύ ЩȻ һ֡ʶ
 				cout << except.what() << endl;
+				m_evaluated.assign(m_observed.size(), 0);
 			}
-		
+
+			m_pendingPoints.clear();
+			m_pendingCounts.clear();
+
+			track();
+			mirrorFlag();
+
 			return EResult::SR_OK;
 		}
 
+		/**
+		* \@brief setLandmarks68еڿڵһ ûʱȫΪ0 #÷#
+		*/
+		cv::Vec4f findEyes(const cv::Rect& box) const
+		{
+			const float* points = m_pendingPoints.data();
+			for (const int count : m_pendingCounts)
+			{
+				if (count == s_landmarkNum)
+				{
+					float eye[2][2];
+					eyeCenters(points, eye);
+					if (box.contains(cv::Point2f((eye[0][0] + eye[1][0]) * 0.5f, (eye[0][1] + eye[1][1]) * 0.5f)))
+						return cv::Vec4f(eye[0][0], eye[0][1], eye[1][0], eye[1][1]);
+				}
+				points += count * 2;
+			}
+			return cv::Vec4f();
+		}
+
+		/**
+		* \@brief ֻsetLandmarkslandmark ÿʮθ #÷#
+		*/
+		void detectLandmarks(cv::Mat& frameOut)
+		{
+			m_observed.clear();
+			m_geometry.clear();
+			const float* points = m_pendingPoints.data();
+			for (const int count : m_pendingCounts)
+			{
+				SGeometry geometry;
+				if (count == s_landmarkNum && measureGeometry(points, geometry))
+				{
+					float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+					for (int i = 0; i < count; i++)
+					{
+						minX = std::min(minX, points[i * 2]);
+						maxX = std::max(maxX, points[i * 2]);
+						minY = std::min(minY, points[i * 2 + 1]);
+						maxY = std::max(maxY, points[i * 2 + 1]);
+					}
+
+					const cv::Rect box(cvFloor(minX), cvFloor(minY), cvCeil(maxX - minX) + 1, cvCeil(maxY - minY) + 1);
+					m_observed.push_back(box);
+					m_geometry.push_back(geometry);
+					if (!frameOut.empty())
+						rectangle(frameOut, box, Scalar(255, 0, 0), 2, 8, 0);
+				}
+				points += count * 2;
+			}
+			m_pendingPoints.clear();
+			m_pendingCounts.clear();
+
+			m_probabilities.assign(m_observed.size() * s_classNum, 0.f);
+			m_scores.resize(m_observed.size() * 3);
+			m_ids.resize(m_observed.size());
+
+			matchFaces();
+			m_evaluated.assign(m_observed.size(), 1);
+			track();
+			mirrorFlag();
+
+			if (!m_observed.empty())
+				m_SIGNAL_void_scores(m_scores.data(), m_ids.data(), m_ids.size());
+		}
+
+		/**
+		* \@brief ɱ÷ ƽʱͻ׼ #÷#
+		*/
+		void scoreGeometry(const SGeometry& geometry, SFace& face, float* probabilities, float* scores)
+		{
+			const float widen = (geometry.mouthWidth / face.neutralWidth - 1.f) / s_smileWiden;
+			const float lift = (geometry.cornerLift - face.neutralLift) / s_smileLift;
+			const float smile = unit(0.5f * unit(widen) + 0.5f * unit(lift));
+			const float mouthOpen = unit((geometry.mouthAspect - s_mouthClosed) / (s_mouthOpen - s_mouthClosed));
+			const float eyeClosure = unit((s_eyeOpen - geometry.eyeAspect) / (s_eyeOpen - s_eyeClosed));
+
+			face.emotion.smile = scores[0] = smile;
+			face.emotion.mouthOpen = scores[1] = mouthOpen;
+			face.emotion.eyeClosure = scores[2] = eyeClosure;
+
+			probabilities[static_cast<size_t>(EEmotion::Smile)] = smile;
+			probabilities[static_cast<size_t>(EEmotion::Surprise)] = mouthOpen * (1.f - smile);
+			probabilities[static_cast<size_t>(EEmotion::Neutral)] = (1.f - smile) * (1.f - mouthOpen);
+
+			if (face.emotion.emotion == EEmotion::Neutral)
+			{
+				face.neutralWidth += s_neutralRate * (geometry.mouthWidth - face.neutralWidth);
+				face.neutralLift += s_neutralRate * (geometry.cornerLift - face.neutralLift);
+			}
+		}
+
+		void setFlagInterval(const float seconds)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_flagInterval = std::max(0.f, seconds);
+		}
+
+		/**
+		* \@brief   FaceDetection ģͬ
+		*/
+		void setFaceParam(const EModualParamType type, const float value)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			switch (type)
+			{
+			case EModualParamType::TYPE_Face_Detection_MinFaceSize:
+				m_minFaceSize = std::max(1, static_cast<int32_t>(value));
+				break;
+			case EModualParamType::TYPE_Face_Detection_MaxFaceSize:
+				m_maxFaceSize = static_cast<int32_t>(value);
+				break;
+			case EModualParamType::TYPE_Face_Detection_ScoreThresh:
+				m_scoreThresh = value;
+				break;
+			case EModualParamType::TYPE_Face_Detection_ImagePyramidScaleFactor:
+				m_scaleFactor = value;
+				break;
+			default:
+				break;
+			}
+		}
+
+		void setInterval(const size_t interval)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_interval = std::max<size_t>(interval, 1);
+		}
+
+		void setChangeThreshold(const float threshold)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_changeThreshold = std::max(0.f, threshold);
+		}
+
+		/**
+		* \@brief ֡⵽е µ #÷#
+		*/
+		void matchFaces()
+		{
+			m_assignment.resize(m_observed.size());
+			m_matched.assign(m_tracked.size(), 0);
+			for (size_t i = 0; i < m_observed.size(); i++)
+			{
+				const cv::Rect& box = m_observed[i];
+
+				int best = -1;
+				float bestOverlap = s_matchOverlap;
+				for (size_t j = 0; j < m_tracked.size(); j++)
+				{
+					const float overlap = overlapRatio(box, m_tracked[j].emotion.box);
+					if (!m_matched[j] && overlap > bestOverlap)
+					{
+						best = static_cast<int>(j);
+						bestOverlap = overlap;
+					}
+				}
+
+				if (best < 0)
+				{
+					SFace face;
+					face.emotion.id = m_nextId++;
+					m_tracked.push_back(face);
+					m_matched.push_back(0);
+					best = static_cast<int>(m_tracked.size() - 1);
+					m_changed = true;
+				}
+
+				SFace& face = m_tracked[best];
+				m_matched[best] = 1;
+				face.unconfirmed = 0;
+				face.emotion.box = box;
+				m_assignment[i] = best;
+			}
+		}
+
+		/**
+		* \@brief 仯֡ö ÿÿm_interval֡ʶһ ۱仯m_changeThresholdʱǰʶ #÷#
+		* \@desc 8x8ͼ ֵλ һʶʱƽԲ ʶɹcommitEvaluations
+		*/
+		void selectFaces(const cv::Mat& gray)
+		{
+			m_evaluated.assign(m_observed.size(), 0);
+			m_dueSignatures.resize(m_observed.size());
+			for (size_t i = 0; i < m_observed.size(); i++)
+			{
+				SFace& face = m_tracked[m_assignment[i]];
+				face.sinceEvaluation++;
+
+				const bool due = !face.evaluatedFlag || face.sinceEvaluation >= m_interval;
+				if (!due && !(m_changeThreshold > 0.f))
+					continue;
+
+				std::array<float, s_signatureSize> signature;
+				const cv::Rect box = m_observed[i] & cv::Rect(0, 0, gray.cols, gray.rows);
+				if (box.area() <= 0)
+					continue;
+				cv::resize(gray(box), m_thumbnail, cv::Size(s_signatureSide, s_signatureSide), 0.0, 0.0, cv::INTER_AREA);
+
+				float mean = 0.f, squared = 0.f;
+				for (size_t k = 0; k < s_signatureSize; k++)
+				{
+					signature[k] = m_thumbnail.ptr<uchar>()[k];
+					mean += signature[k];
+					squared += signature[k] * signature[k];
+				}
+				mean /= s_signatureSize;
+				const float scale = 1.f / std::sqrt(std::max(squared / s_signatureSize - mean * mean, 1.f));
+
+				float difference = 0.f;
+				for (size_t k = 0; k < s_signatureSize; k++)
+				{
+					signature[k] = (signature[k] - mean) * scale;
+					difference += std::abs(signature[k] - face.signature[k]);
+				}
+				difference /= s_signatureSize;
+
+				if (due || difference > m_changeThreshold)
+				{
+					m_evaluated[i] = 1;
+					m_dueSignatures[i] = signature;
+				}
+			}
+		}
+
+		/**
+		* \@brief ֡ʶɹ۲¼ #÷#
+		*/
+		void commitEvaluations()
+		{
+			for (size_t i = 0; i < m_observed.size(); i++)
+			{
+				if (!m_evaluated[i])
+					continue;
+
+				SFace& face = m_tracked[m_assignment[i]];
+				face.signature = m_dueSignatures[i];
+				face.sinceEvaluation = 0;
+				face.evaluatedFlag = true;
+			}
+		}
+
+		/**
+		* \@brief ֡ʶƽͻл״̬ ûĽ #÷#
+		* \@desc ֻ״̬仯 ֻʧʱŷź
+		*/
+		void track()
+		{
+			bool changed = m_changed;
+			m_changed = false;
+
+			for (size_t i = 0; i < m_observed.size(); i++)
+			{
+				if (!m_evaluated[i])
+					continue;
+
+				SFace& face = m_tracked[m_assignment[i]];
+				if (m_engine == EEngine::Landmark)
+				{
+					scoreGeometry(m_geometry[i], face, m_probabilities.data() + i * s_classNum, m_scores.data() + i * 3);
+					m_ids[i] = face.emotion.id;
+				}
+
+				//ָƽ µҪȵǰ߳s_switchMarginл ֡첻ı״̬
+				auto& probabilities = face.emotion.probabilities;
+				const float* evidence = m_probabilities.data() + i * s_classNum;
+				for (size_t c = 0; c < s_classNum; c++)
+					probabilities[c] += s_smoothing * (evidence[c] - probabilities[c]);
+
+				EEmotion emotion = face.emotion.emotion;
+				const size_t top = std::max_element(probabilities.begin(), probabilities.end()) - probabilities.begin();
+				if (probabilities[top] > probabilities[static_cast<size_t>(emotion)] + s_switchMargin)
+					emotion = static_cast<EEmotion>(top);
+				face.emotion.score = probabilities[static_cast<size_t>(emotion)];
+
+				if (emotion != face.emotion.emotion)
+				{
+					face.emotion.emotion = emotion;
+					changed = true;
+				}
+			}
+
+			//֡ûм⵽Ŷ
+			for (size_t j = m_tracked.size(); j-- > 0;)
+			{
+				if (m_matched[j])
+					continue;
+
+				if (++m_tracked[j].unconfirmed > s_maxUnconfirmed)
+				{
+					m_tracked.erase(m_tracked.begin() + j);
+					changed = true;
+				}
+			}
+
+			if (!changed)
+				return;
+
+			m_emotions.resize(m_tracked.size());
+			m_faceEmotions.resize(m_tracked.size());
+			for (size_t j = 0; j < m_tracked.size(); j++)
+			{
+				m_emotions[j] = m_tracked[j].emotion.emotion;
+				m_faceEmotions[j] = m_tracked[j].emotion;
+			}
+
+			m_SIGNAL_void_emotion(m_emotions);
+			m_SIGNAL_void_faceEmotions(m_faceEmotions);
+		}
+
+		/**
+		* \@brief ɰSmileFlagļ ֻ״̬仯ʱд д֮ټm_flagInterval #÷#
+		*/
+		void mirrorFlag()
+		{
+			if (m_flagPath.empty() || !(m_flagInterval > 0.f))
+				return;
+
+			const bool smile = std::any_of(m_tracked.begin(), m_tracked.end(),
+				[](const SFace& face) { return face.emotion.emotion == EEmotion::Smile; });
+			if (m_flagKnown && smile == m_flagSmile)
+				return;
+
+			const auto now = std::chrono::steady_clock::now();
+			if (m_flagKnown && now - m_flagTime < std::chrono::duration<float>(m_flagInterval))
+				return;
+
+			std::error_code error;
+			const fs::path smileFlag = fs::path(m_flagPath) / "SmileFlag";
+			if (smile)
+				fs::create_directories(smileFlag, error);
+			else
+				fs::remove(smileFlag, error);
+
+			if (error)
+				cout << error.message() << endl;
+
+			m_flagKnown = true;
+			m_flagSmile = smile;
+			m_flagTime = now;
+		}
+
+		static float overlapRatio(const cv::Rect& a, const cv::Rect& b)
+		{
+			const int area = std::min(a.area(), b.area());
+			return (area > 0) ? static_cast<float>((a & b).area()) / area : 0.f;
+		}
+
 	public:
+#ifdef USE_SEETA
 		std::unique_ptr<seeta::FaceDetection> m_faceDetector;
+#endif
+		std::unique_ptr<CascadeDetector> m_pFaceCascade;					//!<  ģΪ xml ʱ seeta
+		int32_t m_minFaceSize;												//!< СĴС
+		int32_t m_maxFaceSize;												//!< ĴС <= 0::
+		float m_scoreThresh;												//!< ʶΪֵ Ϊڴ
+		float m_scaleFactor;												//!< ͼϵ
 
-		seeta::ImageData m_img_data;										//!< ͼ					
 		CascadeClassifier m_emotionDetector;								//!< 
 
 		std::vector<Rect> m_faces;											//!< λ
+		std::vector<Rect> m_observed;										//!< ֡˱
+		std::vector<float> m_probabilities;									//!< ֡ÿÿĸ
+
+		std::unique_ptr<EmotionClassifier> m_pClassifier;					//!< ö
+		EmotionClassifier::SWorkspace m_classifierWorkspace;
+		EEngine m_engine;													//!< Դ
+
+		std::vector<float> m_pendingPoints;									//!< setLandmarks һdetectʹ
+		std::vector<int> m_pendingCounts;
+		std::vector<SGeometry> m_geometry;									//!< ֡ÿļ
+		std::vector<float> m_scores;										//!< ֡ÿ΢Ц  ۵÷
+		std::vector<int> m_ids;
+
+		std::vector<SFace> m_tracked;										//!< е
+		std::vector<unsigned char> m_matched;								//!< ֡Ƿ
+		std::vector<int> m_assignment;										//!< ֡ÿӦĸе
+		std::vector<unsigned char> m_evaluated;								//!< ֡ÿǷʶ
+		std::vector<std::array<float, s_signatureSize>> m_dueSignatures;	//!< ʶ֡ ʶɹż
+		std::vector<cv::Rect> m_dueBoxes;									//!< ֡ʶ
+		std::vector<cv::Vec4f> m_dueEyes;									//!< ǵ δ֪ʱȫΪ0
+		std::vector<float> m_dueProbabilities;
+		cv::Mat m_thumbnail;												//!< ͼ
+		size_t m_interval;													//!< ÿʶļ֡
+		float m_changeThreshold;											//!< ۱仯ǰʶ 0::ر
+		bool m_changed;														//!< ֡µ
+		std::vector<EEmotion> m_emotions;									//!< 
+		std::vector<SFaceEmotion> m_faceEmotions;
+		int m_nextId;
+
+		float m_flagInterval;												//!< SmileFlagд 
+		bool m_flagKnown;													//!< SmileFlagǷд
+		bool m_flagSmile;													//!< һд״̬
+		std::chrono::steady_clock::time_point m_flagTime;					//!< һдʱ
 
 		size_t m_index;
 
@@ -184,16 +858,52 @@ namespace Ghost
 
 		Signal<void(const std::vector<Ghost::EEmotion>&)> m_SIGNAL_void_emotion;		//!< źŲ
 		Slot m_SLOT_void_emotions;
+		Signal<void(const std::vector<SFaceEmotion>&)> m_SIGNAL_void_faceEmotions;
+		Slot m_SLOT_void_faceEmotions;
+		Signal<void(const float*, const int*, const size_t)> m_SIGNAL_void_scores;
+		Slot m_SLOT_void_scores;
+
+		const static size_t s_classNum = static_cast<size_t>(EEmotion::Max);
+		const static float s_smoothing;										//!< ָƽϵ
+		const static float s_switchMargin;									//!< ƽĸʸ߳ǰôл
+		const static float s_matchOverlap;									//!< Ϊͬһص
+		const static size_t s_maxUnconfirmed;								//!< ûм⵽ʱٵ֡
+
+		const static int s_landmarkNum = 68;								//!< iBUG 300-W
+		const static float s_neutralWidth;									//!< ƽʱĳֵ ۾
+		const static float s_neutralLift;									//!< ƽʱǸ߶ȵĳֵ
+		const static float s_neutralRate;									//!< ƽʱ׼ĸٶ
+		const static float s_smileWiden;									//!< Ϊ
+		const static float s_smileLift;										//!< ̧߶ȼΪ
+		const static float s_mouthClosed;									//!< ڴݺ 
+		const static float s_mouthOpen;										//!< ڴݺ Ŵ
+		const static float s_eyeOpen;										//!< ۾ݺ 
+		const static float s_eyeClosed;										//!< ۾ݺ 
 
 		static std::string m_faceModelPath;									//!< Modelļ·
 		static std::string m_emotionXmlPath;								//!< ModelXmlļ·
 		static std::string m_flagPath;
+		static std::string m_classifierPath;								//!< ÷ģļ·
 		const static string s_version;										//!< 汾Ϣ
 	};
 
 	std::string EmotionDetector::Impl::m_faceModelPath = "";
 	std::string EmotionDetector::Impl::m_emotionXmlPath = "";
 	std::string EmotionDetector::Impl::m_flagPath = "";
+	std::string EmotionDetector::Impl::m_classifierPath = "";
+	const float EmotionDetector::Impl::s_smoothing = 0.35f;
+	const float EmotionDetector::Impl::s_switchMargin = 0.2f;
+	const float EmotionDetector::Impl::s_matchOverlap = 0.3f;
+	const size_t EmotionDetector::Impl::s_maxUnconfirmed = 5;
+	const float EmotionDetector::Impl::s_neutralWidth = 0.8f;
+	const float EmotionDetector::Impl::s_neutralLift = -0.1f;
+	const float EmotionDetector::Impl::s_neutralRate = 0.02f;
+	const float EmotionDetector::Impl::s_smileWiden = 0.15f;
+	const float EmotionDetector::Impl::s_smileLift = 0.08f;
+	const float EmotionDetector::Impl::s_mouthClosed = 0.1f;
+	const float EmotionDetector::Impl::s_mouthOpen = 0.6f;
+	const float EmotionDetector::Impl::s_eyeOpen = 0.28f;
+	const float EmotionDetector::Impl::s_eyeClosed = 0.15f;
 
 #if( _MSC_TOOLSET_VER_ == 140 )
 	#ifdef NDEBUG
@@ -245,6 +955,16 @@ namespace Ghost
 		return EResult::SR_OK;
 	}
 
+	EResult EmotionDetector::setClassifierPath(const string& classifierPath) noexcept(true)
+	{
+		if (!fs::exists(classifierPath))
+			return EResult::SR_Model_Path_Not_Exist;
+
+		EmotionDetector::Impl::m_classifierPath = classifierPath;
+
+		return EResult::SR_OK;
+	}
+
 	const string& EmotionDetector::getVersion() noexcept(true)
 	{
 		return EmotionDetector::Impl::s_version;
@@ -272,6 +992,29 @@ namespace Ghost
 
 	EResult EmotionDetector::setModualParam(const EModualParamType type, const float value)
 	{
+		switch (type)
+		{
+		case EModualParamType::TYPE_Face_Detection_MinFaceSize:
+		case EModualParamType::TYPE_Face_Detection_MaxFaceSize:
+		case EModualParamType::TYPE_Face_Detection_ScoreThresh:
+		case EModualParamType::TYPE_Face_Detection_ImagePyramidScaleFactor:
+			m_pImpl->setFaceParam(type, value);
+			break;
+		case EModualParamType::TYPE_Emotion_FlagInterval:
+			m_pImpl->setFlagInterval(value);
+			break;
+		case EModualParamType::TYPE_Emotion_Interval:
+			m_pImpl->setInterval(static_cast<size_t>(std::max(0.f, value)));
+			break;
+		case EModualParamType::TYPE_Emotion_ChangeThreshold:
+			m_pImpl->setChangeThreshold(value);
+			break;
+		case EModualParamType::TYPE_Emotion_Classifier:
+			return m_pImpl->setEngine(static_cast<Impl::EEngine>(std::min(2, std::max(0, cvRound(value)))));
+		default:
+			break;
+		}
+
 		return EResult::SR_OK;
 	}
 
@@ -280,6 +1023,11 @@ namespace Ghost
 		return m_pImpl->detect(frameIn, frameOut);
 	}
 
+	void EmotionDetector::setLandmarks(const float* points, const int* counts, const size_t faceNum)
+	{
+		m_pImpl->setLandmarks(points, counts, faceNum);
+	}
+
 	EDetectModual EmotionDetector::getModualType() noexcept(true)
 	{
 		return EDetectModual::HumanFace_LandMark;
@@ -289,4 +1037,14 @@ namespace Ghost
 	{
 		m_pImpl->m_SLOT_void_emotions  = m_pImpl->m_SIGNAL_void_emotion.connect(functor);
 	}
+
+	void EmotionDetector::bindSlotFacesEmotion(const std::function<void(const std::vector<SFaceEmotion>&)>& functor)
+	{
+		m_pImpl->m_SLOT_void_faceEmotions = m_pImpl->m_SIGNAL_void_faceEmotions.connect(functor);
+	}
+
+	void EmotionDetector::bindSlotExpressionScores(const std::function<void(const float*, const int*, const size_t)>& functor)
+	{
+		m_pImpl->m_SLOT_void_scores = m_pImpl->m_SIGNAL_void_scores.connect(functor);
+	}
 }///namespace Ghost
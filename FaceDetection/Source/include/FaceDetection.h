@@ -35,7 +35,7 @@ namespace Ghost
 	public:
 		/**
 		* \@brief Setting the path of the data file required by the module #####Chinese cannot be included in the path#####
-		* \@param modelPath:: model of path
+		* \@param modelPath:: model of path #seeta .bin model (needs USE_SEETA), or an OpenCV Haar/LBP cascade .xml run by the built-in SIMD engine#
 		* \@return Returns the result of execution
 		*/
 		static EResult setPath(const string& modelPath) noexcept(true);
@@ -73,6 +73,7 @@ namespace Ghost
 		/**
 		* \@brief Setting Module Parameters
 		* \@param value
+		* \@desc TYPE_Face_Detection_Threads may be set before initModual, default 1 (one detector, no split), 0::all cores
 		* \@return Results of implementation
 		*/
 		virtual EResult setModualParam(const EModualParamType type, const float value) override;
@@ -84,6 +85,16 @@ namespace Ghost
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Detect a batch of frames, with the xml cascade engine the frames are spread over its threads, one thread per frame
+		* \@desc in track mode, with auto scale or with seeta the frames are detected one after another
+		* \@param framesIn::Images for detection
+		* \@param framesOut::Empty if nothing needs to be drawn, else one image per frame
+		* \@param results::Result of each frame
+		* \@return SR_OK if every frame succeeded, else the first failure
+		*/
+		virtual EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results) override;
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
@@ -1,22 +1,51 @@
 #include "FaceDetection.h"
 
+#include <algorithm>
 #include <atomic>
 #include <filesystem>
+#include <limits>
 #include <mutex>
+#include <thread>
 
+#ifdef USE_SEETA
 #include "face_detection.h"
+#endif
+#include "GCascadeDetector.hpp"
+#include "GThreadPool.hpp"
 
 namespace fs = std::experimental::filesystem;
 using namespace std;
 
 namespace Ghost
 {
+	namespace
+	{
+		/**
+		* \@brief ⵽ ޹
+		*/
+		struct SFaceInfo
+		{
+			cv::Rect bbox;
+			double score;									//seeta:: ::ϲڴ
+
+			SFaceInfo() : score(0.0) {}
+		};
+	}
+
 	class FaceDetector::Impl
 	{
 	public:
 		Impl()
 			:
+#ifdef USE_SEETA
 			m_pDetector(nullptr),
+#endif
+			m_pCascade(nullptr),
+			m_trackInterval(0),
+			m_framesSinceDetect(0),
+			m_threadNum(1),
+			m_autoScaleFlag(false),
+			m_pPool(nullptr),
 			m_initFlag(false)
 		{}
 
@@ -33,27 +62,43 @@ namespace Ghost
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
 
-			if (m_pDetector != nullptr)
+			if (m_initFlag.load())
 				return EResult::SR_Detector_Already_Exist;
 
 			if (!FaceDetector::Impl::s_pathFlag.load())
 				return EResult::SR_Data_Path_Not_Set;
 
-			m_pDetector = std::make_unique<seeta::FaceDetection>(s_modelPath.c_str());
+			//xml ģʹõļ ʹ seeta #ûжUSE_SEETAʱֻ֧xml#
+			if (CascadeDetector::isCascadeFile(s_modelPath))
+			{
+				auto pCascade = std::make_unique<CascadeDetector>(1);
+				const EResult result = pCascade->load(s_modelPath);
+				if (result != EResult::SR_OK)
+					return result;
+				m_pCascade = std::move(pCascade);
+			}
+			else
+			{
+#ifdef USE_SEETA
+				m_pDetector = std::make_unique<seeta::FaceDetection>(s_modelPath.c_str());
+#else
+				return EResult::SR_Detector_Not_Exist;
+#endif
+			}
 			/*------------------------------Ҫȡ-----------------------------*/
 			if (!loadParam(s_modelPath))
 			{
-				m_pDetector->SetMinFaceSize(60);
-				m_pDetector->SetScoreThresh(2.f);
-				m_pDetector->SetImagePyramidScaleFactor(0.8f);
-				m_pDetector->SetWindowStep(4, 4);
+				m_param = SParam();
 			}
 			else
 			{
 				;///
 			}
+			applyParamAll();
 			/*------------------------------Ҫȡ-----------------------------*/
 
+			createWorkers();
+
 			m_initFlag.store(true);
 
 			return EResult::SR_OK;
@@ -63,11 +108,17 @@ namespace Ghost
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
 
-			if (m_pDetector == nullptr)
+			if (!m_initFlag.load())
 				return EResult::SR_Detector_Not_Exist;
 
+			m_pPool.reset();
+#ifdef USE_SEETA
+			m_workerDetectors.clear();
 			m_pDetector.reset();
 			m_pDetector = nullptr;
+#endif
+			m_pCascade.reset();
+			m_trackedFaces.clear();
 
 			m_initFlag.store(false);
 
@@ -88,33 +139,155 @@ namespace Ghost
 			cv::Mat img_gray;
 			cv::cvtColor(frameIn, img_gray, cv::COLOR_BGR2GRAY);
 
-			seeta::ImageData img_data;
-			img_data.data = img_gray.data;
-			img_data.width = img_gray.cols;
-			img_data.height = img_gray.rows;
-			img_data.num_channels = 1;
-			std::vector<seeta::FaceInfo> faces = m_pDetector->Detect(img_data);
+			//ģʽ ȫͼֻ֮ROI¼ ʱȫͼ
+			std::vector<SFaceInfo> faces;
+			if (m_trackInterval == 0 || m_trackedFaces.empty() || m_framesSinceDetect + 1 >= m_trackInterval || !trackFaces(img_gray, faces))
+			{
+				faces = m_autoScaleFlag ? detectDownscaled(img_gray) : detectFull(img_gray, m_param.minFaceSize, m_param.maxFaceSize);
+				m_framesSinceDetect = 0;
+			}
+			else
+			{
+				m_framesSinceDetect++;
+			}
+
+			if (m_trackInterval > 0)
+				m_trackedFaces = faces;
+
+			publishFaces(frameShow, faces);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief  Ѹָ֡Լ̳߳ ÿ֡һ߳ɨ
+		* \@desc ģʽһ֡ ԶҪԭͼϾ seeta̰߳ȫ Щ֡detect
+		*/
+		EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+		{
+			if (!framesOut.empty() && framesOut.size() != framesIn.size())
+				return EResult::SR_NG;
 
-			if (!frameShow.empty())
+			results.assign(framesIn.size(), EResult::SR_OK);
 			{
-				//Ƽ⵽Ŀ
-				drawFace(frameShow, faces);
+				std::lock_guard<std::mutex> lock(m_mutex);
 
-				// ⵽ź
-				if (faces.size() > 0)
-				{
-					m_faces.clear();
-					for (const auto& face : faces)
-						m_faces.push_back(Ghost::SRect(face.bbox.x, face.bbox.y, face.bbox.width, face.bbox.height));
+				if (!m_initFlag.load())
+					return EResult::SR_Detector_Not_Exist;
 
-					m_SIGNAL_void_rects(m_faces);
+				if (m_pCascade != nullptr && m_trackInterval == 0 && !m_autoScaleFlag)
+				{
+					for (size_t i = 0; i < framesIn.size(); i++)
+					{
+						if (framesIn[i].empty())
+							results[i] = EResult::SR_Image_Empty;
+					}
+
+					const float factor = std::min(0.99f, std::max(0.01f, m_param.scaleFactor));
+					const std::vector<std::vector<CascadeDetector::SObject>> objects = m_pCascade->detectBatch
+					(
+						framesIn,
+						cv::Size(m_param.minFaceSize, m_param.minFaceSize),
+						(m_param.maxFaceSize > 0) ? cv::Size(m_param.maxFaceSize, m_param.maxFaceSize) : cv::Size(),
+						1.0 / factor,
+						std::max(1, static_cast<int32_t>(std::lround(m_param.scoreThresh)))
+					);
+
+					for (size_t i = 0; i < framesIn.size(); i++)
+					{
+						std::vector<SFaceInfo> faces = toFaces(objects[i]);
+						cv::Mat frameEmpty;
+						publishFaces(framesOut.empty() ? frameEmpty : framesOut[i], faces);
+					}
+
+					return EResult::SR_OK;
 				}
 			}
 
+			for (size_t i = 0; i < framesIn.size(); i++)
+			{
+				cv::Mat frameEmpty;
+				results[i] = detect(framesIn[i], framesOut.empty() ? frameEmpty : framesOut[i]);
+			}
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief Ƽ⵽ ʱź #frameShowΪʱ#
+		*/
+		void publishFaces(cv::Mat& frameShow, std::vector<SFaceInfo>& faces)
+		{
+			if (frameShow.empty())
+				return;
+
+			//Ƽ⵽Ŀ
+			drawFace(frameShow, faces);
+
+			// ⵽ź
+			if (faces.size() > 0)
+			{
+				m_faces.clear();
+				for (const auto& face : faces)
+					m_faces.push_back(Ghost::SRect(face.bbox.x, face.bbox.y, face.bbox.width, face.bbox.height));
+
+				m_SIGNAL_void_rects(m_faces);
+			}
+		}
+
+		/**
+		* \@brief ü ͬʱһ seeta ûжӦĻȡӿ
+		*/
+		EResult setParam(const EModualParamType type, const float value)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			//߳ڳʼǰ ʼʱȰĬֵ
+			if (type == EModualParamType::TYPE_Face_Detection_Threads)
+			{
+				m_threadNum = static_cast<size_t>(std::max(0.f, value));
+				if (m_initFlag.load())
+					createWorkers();
+				return EResult::SR_OK;
+			}
+
+			if (!m_initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			switch (type)
+			{
+			case EModualParamType::TYPE_Face_Detection_MinFaceSize:
+				m_param.minFaceSize = static_cast<int32_t>(value);
+				break;
+			case EModualParamType::TYPE_Face_Detection_MaxFaceSize:
+				m_param.maxFaceSize = static_cast<int32_t>(value);
+				break;
+			case EModualParamType::TYPE_Face_Detection_ScoreThresh:
+				m_param.scoreThresh = value;
+				break;
+			case EModualParamType::TYPE_Face_Detection_ImagePyramidScaleFactor:
+				m_param.scaleFactor = value;
+				break;
+			case EModualParamType::TYPE_Face_Detection_WindowStep:
+				m_param.windowStep = static_cast<int32_t>(value);
+				break;
+			case EModualParamType::TYPE_Face_Detection_TrackInterval:
+				m_trackInterval = static_cast<size_t>(std::max(0.f, value));
+				m_trackedFaces.clear();
+				return EResult::SR_OK;
+			case EModualParamType::TYPE_Face_Detection_AutoScale:
+				m_autoScaleFlag = value > 0.5f;
+				return EResult::SR_OK;
+			default:
+				return EResult::SR_OK;
+			}
+
+			applyParamAll();
+
 			return EResult::SR_OK;
 		}
 
-		void drawFace(cv::Mat& mat_img, std::vector<seeta::FaceInfo>& faces, int current_det_fps = -1, int current_cap_fps = -1)
+		void drawFace(cv::Mat& mat_img, std::vector<SFaceInfo>& faces, int current_det_fps = -1, int current_cap_fps = -1)
 		{
 			cv::Rect face_rect;
 			int32_t num_face = static_cast<int32_t>(faces.size());
@@ -148,11 +321,435 @@ namespace Ghost
 			return true;
 		}
 
+	private:
+		/**
+		* \@brief 
+		*/
+		struct SParam
+		{
+			int32_t minFaceSize;								//СĴС
+			int32_t maxFaceSize;								//ĴС -1::
+			float scoreThresh;									//ʶΪֵ Ϊڴ
+			float scaleFactor;									//ͼϵ
+			int32_t windowStep;									//ڲ 治ʹ
+
+			SParam()
+				:
+				minFaceSize(60), maxFaceSize(-1), scoreThresh(2.f), scaleFactor(0.8f), windowStep(4)
+			{}
+		};
+
+#ifdef USE_SEETA
+		static void applyParam(seeta::FaceDetection& detector, const SParam& param)
+		{
+			detector.SetMinFaceSize(param.minFaceSize);
+			//seeta Ըֵ ֵʾ
+			detector.SetMaxFaceSize((param.maxFaceSize > 0) ? param.maxFaceSize : std::numeric_limits<int32_t>::max());
+			detector.SetScoreThresh(param.scoreThresh);
+			detector.SetImagePyramidScaleFactor(param.scaleFactor);
+			detector.SetWindowStep(param.windowStep, param.windowStep);
+		}
+#endif
+
+		/**
+		* \@brief ѲӦõ seeta ʵ ÿμʱȡ
+		*/
+		void applyParamAll()
+		{
+#ifdef USE_SEETA
+			if (m_pDetector == nullptr)
+				return;
+
+			for (size_t i = 0; i < detectorNum(); i++)
+				applyParam(detectorAt(i), m_param);
+#endif
+		}
+
+		/**
+		* \@brief ⴰڵı߳ seeta ̶Ϊ40
+		*/
+		int32_t windowSize() const
+		{
+			if (m_pCascade == nullptr)
+				return 40;
+
+			const cv::Size window = m_pCascade->getWindowSize();
+			return std::max(window.width, window.height);
+		}
+
+#ifdef USE_SEETA
+		static seeta::ImageData toImageData(const cv::Mat& gray)
+		{
+			seeta::ImageData imageData;
+			imageData.data = gray.data;
+			imageData.width = gray.cols;
+			imageData.height = gray.rows;
+			imageData.num_channels = 1;
+			return imageData;
+		}
+#endif
+
+		/**
+		* \@brief һ:: ͼɨ [minFaceSize, maxFaceSize] ӦĽ
+		*/
+		struct SScanJob
+		{
+			int32_t minFaceSize;
+			int32_t maxFaceSize;
+			cv::Rect stripe;
+		};
+
+#ifdef USE_SEETA
+		size_t detectorNum() const noexcept(true) { return m_workerDetectors.size() + 1; }
+
+		seeta::FaceDetection& detectorAt(const size_t index)
+		{
+			return (index == 0) ? *m_pDetector : *m_workerDetectors[index - 1];
+		}
+#else
+		size_t detectorNum() const noexcept(true) { return 1; }
+#endif
+
+		/**
+		* \@brief ÿ߳һ seeta ʵ #seeta ̰߳ȫ# Դ̳߳
+		*/
+		void createWorkers()
+		{
+			const size_t threadNum = (m_threadNum == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : m_threadNum;
+
+			m_pPool.reset();
+#ifdef USE_SEETA
+			m_workerDetectors.clear();
+#endif
+			if (m_pCascade != nullptr)
+			{
+				m_pCascade->setThreadNum(threadNum);
+				return;
+			}
+
+#ifdef USE_SEETA
+			for (size_t i = 1; i < threadNum; i++)
+			{
+				m_workerDetectors.push_back(std::make_unique<seeta::FaceDetection>(s_modelPath.c_str()));
+				applyParam(*m_workerDetectors.back(), m_param);
+			}
+#endif
+
+			//߳Ҳ
+			if (threadNum > 1)
+				m_pPool = std::make_unique<ThreadPool>(threadNum - 1);
+		}
+
+		/**
+		* \@brief detector i ± i, i + n, i + 2n ... 
+		*/
+		void runOnDetectors(const size_t jobNum, const std::function<void(size_t, size_t)>& func)
+		{
+			const size_t workers = std::min(jobNum, detectorNum());
+			if (m_pPool == nullptr || workers <= 1)
+			{
+				for (size_t job = 0; job < jobNum; job++)
+					func(0, job);
+				return;
+			}
+
+			m_pPool->parallelFor(0, workers, [&](size_t begin, size_t end)
+			{
+				for (size_t index = begin; index < end; index++)
+				{
+					for (size_t job = index; job < jobNum; job += workers)
+						func(index, job);
+				}
+			});
+		}
+
+		/**
+		* \@brief õ detector  [minFaceSize, maxFaceSize] ڵ #maxFaceSize <= 0::#
+		* \@desc Զ߳ͬʱ Ϊϲڴ
+		*/
+		std::vector<SFaceInfo> detectWith(const size_t detector, const cv::Mat& gray, const int32_t minFaceSize, const int32_t maxFaceSize)
+		{
+			if (m_pCascade != nullptr)
+			{
+				const float factor = std::min(0.99f, std::max(0.01f, m_param.scaleFactor));
+				const std::vector<CascadeDetector::SObject> objects = m_pCascade->detect
+				(
+					gray,
+					cv::Size(minFaceSize, minFaceSize),
+					(maxFaceSize > 0) ? cv::Size(maxFaceSize, maxFaceSize) : cv::Size(),
+					1.0 / factor,
+					std::max(1, static_cast<int32_t>(std::lround(m_param.scoreThresh)))
+				);
+
+				return toFaces(objects);
+			}
+
+#ifdef USE_SEETA
+			seeta::FaceDetection& seetaDetector = detectorAt(detector);
+			seetaDetector.SetMinFaceSize(minFaceSize);
+			seetaDetector.SetMaxFaceSize((maxFaceSize > 0) ? maxFaceSize : std::numeric_limits<int32_t>::max());
+			const std::vector<seeta::FaceInfo> detected = seetaDetector.Detect(toImageData(gray));
+			applyParam(seetaDetector, m_param);
+
+			std::vector<SFaceInfo> faces(detected.size());
+			for (size_t i = 0; i < detected.size(); i++)
+			{
+				faces[i].bbox = cv::Rect(detected[i].bbox.x, detected[i].bbox.y, detected[i].bbox.width, detected[i].bbox.height);
+				faces[i].score = detected[i].score;
+			}
+			return faces;
+#else
+			return std::vector<SFaceInfo>();
+#endif
+		}
+
+		/**
+		* \@brief Ľ Ϊϲڴ
+		*/
+		static std::vector<SFaceInfo> toFaces(const std::vector<CascadeDetector::SObject>& objects)
+		{
+			std::vector<SFaceInfo> faces(objects.size());
+			for (size_t i = 0; i < objects.size(); i++)
+			{
+				faces[i].bbox = objects[i].rect;
+				faces[i].score = objects[i].neighbors;
+			}
+			return faces;
+		}
+
+		/**
+		* \@brief ѽֳɶ ϸһʱٰг
+		* \@desc Ϊ w ʱ ߴ s ĲΪ w/s  (w/s)^2 
+		*/
+		std::vector<SScanJob> planScanJobs(const int32_t width, const int32_t height, const size_t jobNum, const int32_t minFaceSize, const int32_t maxFaceSize) const
+		{
+			const float window = static_cast<float>(windowSize());
+			const float factor = std::min(0.99f, std::max(0.01f, m_param.scaleFactor));
+			const float minFace = static_cast<float>(std::max(20, minFaceSize));
+			const float maxFace = static_cast<float>((maxFaceSize > 0) ? std::min(maxFaceSize, std::min(width, height)) : std::min(width, height));
+
+			std::vector<float> sizes, works;
+			float total = 0.f;
+			for (float size = minFace; size <= maxFace; size /= factor)
+			{
+				const float scale = window / size;
+				sizes.push_back(size);
+				works.push_back(scale * scale);
+				total += scale * scale;
+			}
+
+			std::vector<SScanJob> jobs;
+			const cv::Rect full(0, 0, width, height);
+			if (sizes.empty() || jobNum <= 1)
+			{
+				jobs.push_back({ minFaceSize, maxFaceSize, full });
+				return jobs;
+			}
+
+			//ϸ㵥ɶʱг ֮صһߴ
+			const float average = total / jobNum;
+			size_t stripeNum = std::min(jobNum, static_cast<size_t>(works[0] / average + 0.5f));
+			size_t level = 0;
+			if (stripeNum >= 2)
+			{
+				const int32_t face = static_cast<int32_t>(std::ceil(sizes[0]));
+				const int32_t band = (height + static_cast<int32_t>(stripeNum) - 1) / static_cast<int32_t>(stripeNum);
+				for (size_t i = 0; i < stripeNum; i++)
+				{
+					const int32_t top = std::max(0, static_cast<int32_t>(i) * band - face);
+					const int32_t bottom = std::min(height, (static_cast<int32_t>(i) + 1) * band + face);
+					if (bottom - top >= face)
+						jobs.push_back({ std::max(20, face - 1), face, cv::Rect(0, top, width, bottom - top) });
+				}
+				total -= works[0];
+				level = 1;
+			}
+
+			//㰴ۼƼ
+			const size_t restJobs = std::max<size_t>(1, jobNum - jobs.size());
+			const float target = total / restJobs;
+			while (level < sizes.size())
+			{
+				float work = 0.f;
+				const size_t first = level;
+				while (level < sizes.size() && (level == first || work + works[level] <= target * 1.1f))
+					work += works[level++];
+
+				const int32_t low = static_cast<int32_t>(std::floor(sizes[first]));
+				const int32_t high = (level == sizes.size()) ? static_cast<int32_t>(maxFace) : static_cast<int32_t>(std::ceil(sizes[level - 1]));
+				jobs.push_back({ std::max(20, low), high, full });
+			}
+
+			return jobs;
+		}
+
+		/**
+		* \@brief ϲĺѡ NMS
+		*/
+		static std::vector<SFaceInfo> mergeFaces(std::vector<SFaceInfo>& candidates, const float iouThresh)
+		{
+			std::sort(candidates.begin(), candidates.end(), [](const SFaceInfo& a, const SFaceInfo& b) { return a.score > b.score; });
+
+			std::vector<SFaceInfo> faces;
+			for (const auto& candidate : candidates)
+			{
+				const cv::Rect a(candidate.bbox.x, candidate.bbox.y, candidate.bbox.width, candidate.bbox.height);
+				bool suppressed = false;
+				for (const auto& face : faces)
+				{
+					const cv::Rect b(face.bbox.x, face.bbox.y, face.bbox.width, face.bbox.height);
+					const float inter = static_cast<float>((a & b).area());
+					if (inter / (a.area() + b.area() - inter) > iouThresh)
+					{
+						suppressed = true;
+						break;
+					}
+				}
+				if (!suppressed)
+					faces.push_back(candidate);
+			}
+
+			return faces;
+		}
+
+		/**
+		* \@brief ȫͼ [minFaceSize, maxFaceSize] ڵ ߳ʱ߳ɨ費ͬĽ
+		*/
+		std::vector<SFaceInfo> detectFull(const cv::Mat& gray, const int32_t minFaceSize, const int32_t maxFaceSize)
+		{
+			if (detectorNum() <= 1)
+				return detectWith(0, gray, minFaceSize, maxFaceSize);
+
+			const std::vector<SScanJob> jobs = planScanJobs(gray.cols, gray.rows, detectorNum(), minFaceSize, maxFaceSize);
+			std::vector<std::vector<SFaceInfo>> results(jobs.size());
+
+			runOnDetectors(jobs.size(), [&](size_t detector, size_t index)
+			{
+				const SScanJob& job = jobs[index];
+				const cv::Mat stripe = (job.stripe.height == gray.rows) ? gray : gray(job.stripe).clone();
+
+				results[index] = detectWith(detector, stripe, job.minFaceSize, job.maxFaceSize);
+
+				for (auto& face : results[index])
+					face.bbox.y += job.stripe.y;
+			});
+
+			std::vector<SFaceInfo> candidates;
+			for (const auto& result : results)
+				candidates.insert(candidates.end(), result.begin(), result.end());
+
+			return mergeFaces(candidates, 0.3f);
+		}
+
+		/**
+		* \@brief Զż:: СŵⴰڴССͼȫͼ
+		* \@desc ӳԭͼԭֱʵROIھ ʧʱӳĿ
+		*/
+		std::vector<SFaceInfo> detectDownscaled(const cv::Mat& gray)
+		{
+			const int32_t window = windowSize();
+			const double scale = static_cast<double>(window) / std::max(20, m_param.minFaceSize);
+			if (scale >= 1.0)
+				return detectFull(gray, m_param.minFaceSize, m_param.maxFaceSize);
+
+			cv::Mat small;
+			cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
+
+			//Сͼֻߴ緶Χ ֵ봰ڲ m_param
+			const int32_t maxFaceSize = (m_param.maxFaceSize > 0) ? std::max(window, static_cast<int32_t>(m_param.maxFaceSize * scale)) : -1;
+			std::vector<SFaceInfo> faces = detectFull(small, window, maxFaceSize);
+
+			for (auto& face : faces)
+			{
+				face.bbox.x = static_cast<int32_t>(face.bbox.x / scale);
+				face.bbox.y = static_cast<int32_t>(face.bbox.y / scale);
+				face.bbox.width = static_cast<int32_t>(face.bbox.width / scale);
+				face.bbox.height = static_cast<int32_t>(face.bbox.height / scale);
+			}
+
+			runOnDetectors(faces.size(), [&](size_t detector, size_t index)
+			{
+				SFaceInfo refined;
+				if (redetect(detector, gray, faces[index].bbox, 1.5f, refined))
+					faces[index] = refined;
+			});
+
+			return faces;
+		}
+
+		/**
+		* \@brief ΧŴROI¼ ֻǸĳ߶
+		* \@return false::ROIûҵ
+		*/
+		bool redetect(const size_t detector, const cv::Mat& gray, const cv::Rect& bbox, const float enlarge, SFaceInfo& face)
+		{
+			const int32_t size = std::max(bbox.width, bbox.height);
+			const int32_t roiSize = static_cast<int32_t>(size * enlarge);
+			const cv::Rect roi = cv::Rect
+			(
+				bbox.x + bbox.width / 2 - roiSize / 2,
+				bbox.y + bbox.height / 2 - roiSize / 2,
+				roiSize,
+				roiSize
+			) & cv::Rect(0, 0, gray.cols, gray.rows);
+
+			const int32_t minFaceSize = std::max(20, static_cast<int32_t>(size * 0.7f));
+			const int32_t maxFaceSize = std::min(std::min(roi.width, roi.height), static_cast<int32_t>(size * 1.4f));
+			if (maxFaceSize < minFaceSize)
+				return false;
+
+			//seeta Ҫڴ
+			const cv::Mat roiGray = gray(roi).clone();
+
+			const std::vector<SFaceInfo> candidates = detectWith(detector, roiGray, minFaceSize, maxFaceSize);
+
+			if (candidates.empty())
+				return false;
+
+			const auto best = std::max_element(candidates.begin(), candidates.end(), [](const SFaceInfo& a, const SFaceInfo& b) { return a.score < b.score; });
+			face = *best;
+			face.bbox.x += roi.x;
+			face.bbox.y += roi.y;
+
+			return true;
+		}
+
+		/**
+		* \@brief һ֡
+		* \@return false:: Ҫȫͼ
+		*/
+		bool trackFaces(const cv::Mat& gray, std::vector<SFaceInfo>& faces)
+		{
+			faces.resize(m_trackedFaces.size());
+			std::vector<uint8_t> found(m_trackedFaces.size(), 0);
+
+			runOnDetectors(m_trackedFaces.size(), [&](size_t detector, size_t index)
+			{
+				found[index] = redetect(detector, gray, m_trackedFaces[index].bbox, 2.f, faces[index]) ? 1 : 0;
+			});
+
+			return std::all_of(found.begin(), found.end(), [](const uint8_t flag) { return flag != 0; });
+		}
+
 	public:
+#ifdef USE_SEETA
 		std::unique_ptr<seeta::FaceDetection> m_pDetector;
+#endif
+		std::unique_ptr<CascadeDetector> m_pCascade;		// ģΪ xml ʱ seeta
+		SParam m_param;										//
+
+		size_t m_trackInterval;								//ģʽȫͼļ֡ 0::ÿ֡ȫͼ
+		size_t m_framesSinceDetect;							//ϴȫͼ֡
+		std::vector<SFaceInfo> m_trackedFaces;		//ڸٵ
+
+		size_t m_threadNum;									//߳ Ĭ1::߳ 0::к
+		bool m_autoScaleFlag;								//Զż־
+#ifdef USE_SEETA
+		std::vector<std::unique_ptr<seeta::FaceDetection>> m_workerDetectors;	//߳ʹõļ
+#endif
+		std::unique_ptr<ThreadPool> m_pPool;				//̳߳
 
 		std::atomic<bool> m_initFlag;						//ʼ־
-		seeta::ImageData m_img_data;						//ͼ
 		std::vector<Ghost::SRect> m_faces;				//faces
 
 		std::mutex m_mutex;									//
@@ -248,41 +845,7 @@ namespace Ghost
 
 	EResult FaceDetector::setModualParam(const EModualParamType type, const float value)
 	{
-		if (m_pImpl->m_pDetector == nullptr)
-			return EResult::SR_Detector_Not_Exist;
-
-		switch (type)
-		{
-		case EModualParamType::TYPE_Face_Detection_MinFaceSize:
-		{
-			m_pImpl->m_pDetector->SetMinFaceSize(static_cast<int32_t>(value));
-			break;
-		}
-		case EModualParamType::TYPE_Face_Detection_MaxFaceSize:
-		{
-			m_pImpl->m_pDetector->SetMaxFaceSize(static_cast<int32_t>(value));
-			break;
-		}
-		case EModualParamType::TYPE_Face_Detection_ScoreThresh:
-		{
-			m_pImpl->m_pDetector->SetScoreThresh(value);
-			break;
-		}
-		case EModualParamType::TYPE_Face_Detection_ImagePyramidScaleFactor:
-		{
-			m_pImpl->m_pDetector->SetImagePyramidScaleFactor(value);
-			break;
-		}
-		case EModualParamType::TYPE_Face_Detection_WindowStep:
-		{
-			m_pImpl->m_pDetector->SetWindowStep(static_cast<int32_t>(value), static_cast<int32_t>(value));
-			break;
-		}
-		default:
-			break;
-		}
-
-		return EResult::SR_OK;
+		return m_pImpl->setParam(type, value);
 	}
 
 	EResult FaceDetector::detect(const cv::Mat& frameIn, cv::Mat& frameOut)
@@ -290,6 +853,15 @@ namespace Ghost
 		return m_pImpl->detect(frameIn, frameOut);
 	}
 
+	EResult FaceDetector::detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+	{
+		const EResult result = m_pImpl->detectBatch(framesIn, framesOut, results);
+		if (result != EResult::SR_OK)
+			return result;
+
+		return firstFailure(results);
+	}
+
 	EDetectModual FaceDetector::getModualType() noexcept(true)
 	{
 		return EDetectModual::HumanFace_Detection_Modual;
@@ -0,0 +1,130 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				BlendshapeSolver.h
+* \@brief Desc:				Blendshape weights from 2D face landmarks for the FaceGood facial stream
+* \@brief prerequisite::	C++17
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+#include "opencv2/opencv.hpp"
+
+#ifndef FACERECOGNITION_API
+#define FACERECOGNITION_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Linear blendshape model:: shape = neutral + sum_k w_k * delta_k, 0 <= w_k <= 1
+	* \@desc the landmarks are first aligned to the neutral shape by a similarity transform on stable points (nose, eye corners
+	* \@desc and jaw ends of the 68 layout, every point otherwise), so head motion does not drive the weights
+	* \@desc the normal equations (B'B + lambda I) are precomputed, a frame costs one K x 2N GEMV and a few
+	* \@desc projected Gauss-Seidel sweeps warm started from the previous weights, no allocation
+	* \@desc solve is const, one instance serves any number of faces and threads
+	*/
+	class FACERECOGNITION_API BlendshapeSolver final
+	{
+	public:
+		/**
+		* \@brief How the weights are computed from the aligned offsets
+		*/
+		enum struct EMethod : uint8_t
+		{
+			BoundedLeastSquares = 0,					//exact box constrained least squares
+			Linear										//precomputed regularized pseudo inverse then clamped, one GEMV
+		};
+
+		/**
+		* \@brief Scratch of one thread, sized on first use
+		*/
+		struct SWorkspace
+		{
+			simd::AlignedVector<float> offsets;			//aligned landmarks minus neutral, x0, y0, x1, y1 ...
+			simd::AlignedVector<float> projection;		//B' * offsets
+		};
+
+	public:
+		BlendshapeSolver();
+
+		/**
+		* \@brief Build from a neutral shape and one offset shape per blendshape
+		* \@param deltas:: CV_32F, K rows of x0, y0, x1, y1 ... in the units of neutral
+		* \@param names:: K names, e.g. ARKit's eyeBlinkLeft, jawOpen ... may be empty
+		*/
+		EResult create(const std::vector<cv::Point2f>& neutral, const cv::Mat& deltas, const std::vector<std::string>& names);
+
+		/**
+		* \@brief Built-in basis on the iBUG 68 layout, derived from the landmark geometry of the 300-W mean face
+		* \@desc 15 ARKit names:: jawOpen, eyeBlink/eyeWide, browDown/browOuterUp Left/Right, browInnerUp,
+		* \@desc mouthSmile/mouthFrown Left/Right, mouthPucker, Left is the subject's left (the right of an unmirrored image)
+		* \@desc the mean face is a generic neutral, call setNeutral with the user's relaxed face before relying on the weights
+		*/
+		EResult createDefault();
+
+		/**
+		* \@brief Model file:: "GBSM", int32 version, int32 landmarks, int32 blendshapes, per blendshape int32 length and the name,
+		* then float neutral[2N] and float deltas[K][2N]
+		*/
+		EResult load(const std::string& modelPath);
+		EResult save(const std::string& modelPath) const;
+
+		/**
+		* \@brief Replace the neutral shape by the user's, points of a relaxed face looking into the camera
+		*/
+		EResult setNeutral(const cv::Point2f* points, const int pointNum);
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setMethod(const EMethod method) noexcept(true) { m_method = method; }
+		EMethod getMethod() const noexcept(true) { return m_method; }
+		void setRegularization(const float regularization);				//!< relative to the mean diagonal of B'B, default 0.01
+		float getRegularization() const noexcept(true) { return m_regularization; }
+		bool isLoaded() const noexcept(true) { return m_blendshapeNum > 0; }
+		int landmarkNum() const noexcept(true) { return m_landmarkNum; }
+		int blendshapeNum() const noexcept(true) { return m_blendshapeNum; }
+		const std::vector<std::string>& names() const noexcept(true) { return m_names; }
+
+		/**
+		* \@brief Weights of one face
+		* \@param points:: landmarkNum() landmarks in frame pixels
+		* \@param weights:: blendshapeNum() values, in:: weights of the previous frame (zeros for a new face), out:: this frame
+		* \@return false if the model is not loaded or the landmarks do not fit it
+		*/
+		bool solve(const cv::Point2f* points, const int pointNum, float* weights, SWorkspace& workspace) const;
+
+	private:
+		/**
+		* \@brief Similarity transform that maps points onto the neutral shape, written into offsets as points - neutral
+		*/
+		bool align(const cv::Point2f* points, float* offsets) const;
+		void normalize();
+		void build();
+
+	private:
+		int m_landmarkNum;
+		int m_blendshapeNum;
+		size_t m_shapeStride;							//!< 2N rounded up to 16 floats
+		size_t m_weightStride;							//!< K rounded up to 16 floats
+		std::vector<std::string> m_names;
+		std::vector<int> m_alignIndex;					//!< stable landmarks used by the alignment
+
+		simd::AlignedVector<float> m_neutral;			//!< 2N, the stable points centered with unit RMS
+		simd::AlignedVector<float> m_basis;				//!< K x m_shapeStride, B'
+		simd::AlignedVector<float> m_normal;			//!< K x m_weightStride, B'B + lambda I
+		simd::AlignedVector<float> m_inverseDiagonal;	//!< 1 / diagonal of m_normal
+		simd::AlignedVector<float> m_pseudoInverse;		//!< K x m_shapeStride, (B'B + lambda I)^-1 B'
+
+		EMethod m_method;
+		float m_regularization;
+		int m_maxSweeps;
+		float m_tolerance;
+	};
+}///namespace Ghost
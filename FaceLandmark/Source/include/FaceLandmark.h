@@ -9,6 +9,8 @@
 #pragma once
 
 #include "GIVisionDetect.h"
+#include "BlendshapeSolver.h"
+#include "HeadPose.h"
 
 #ifndef FACERECOGNITION_API
 #define FACERECOGNITION_API
@@ -24,6 +26,20 @@ using namespace cv;
 
 namespace Ghost
 {
+	/**
+	* \@brief Landmarks of one tracked face
+	*/
+	struct SFaceLandmark
+	{
+		int id;									//stays the same while the face is tracked
+		cv::Rect box;							//bounding box of the points
+		std::vector<cv::Point2f> points;		//in frameIn pixels
+		SHeadPose pose;							//valid only with TYPE_Face_Landmark_HeadPose and 68 points
+		std::vector<float> blendshapes;			//weights in [0, 1] in the order of getBlendshapeNames, empty unless TYPE_Face_Landmark_Blendshape
+
+		SFaceLandmark() : id(-1) {}
+	};
+
 	/**
 	* \@brief face alignment
 	*/
@@ -42,6 +58,21 @@ namespace Ghost
 		*/
 		static EResult setPath(const string& modelPath, const string& modelXmlPath) noexcept(true);
 
+		/**
+		* \@brief Setting the model of the in-tree SDM engine, see SdmLandmarker::load
+		* \@param enginePath:: "GSDM" model file, built by SdmLandmarker::train (TestLib FACE_LANDMARK_TRAIN from 300-W annotations)
+		* \@return Returns the result of execution
+		*/
+		static EResult setEnginePath(const string& enginePath) noexcept(true);
+
+		/**
+		* \@brief Setting the blendshape model, see BlendshapeSolver::load
+		* \@desc without a model the built-in 68 point basis of BlendshapeSolver::createDefault is used
+		* \@param blendshapePath:: "GBSM" model file
+		* \@return Returns the result of execution
+		*/
+		static EResult setBlendshapePath(const string& blendshapePath) noexcept(true);
+
 		/**
 		* \@brief Get the version number of the current library
 		* \@return Returns the result of execution
@@ -75,6 +106,12 @@ namespace Ghost
 
 		/**
 		* \@brief Setting Module Parameters
+		* \@desc TYPE_Face_Landmark_Threads number of faces regressed at once, default 1 (no split), 0 uses every core
+		* \@desc TYPE_Face_Landmark_Engine 0::ldmarkmodel 1::in-tree SDM #needs setEnginePath and face boxes, new faces start from the box without Haar#
+		* \@desc TYPE_Face_Landmark_Precision regressors of the in-tree SDM 0::fp32 1::fp16 2::int8
+		* \@desc TYPE_Face_Landmark_HeadPose roll/yaw/pitch of every tracked face from its landmarks 0::close 1::open
+		* \@desc TYPE_Face_Landmark_Blendshape blendshape weights of every tracked face 0::close 1::linear model 2::bounded least squares
+		* \@desc TYPE_Face_Landmark_Blendshape_Neutral value is the id of a tracked face (negative:: the first face), its current expression becomes the neutral one
 		* \@param type Setting the type of parameter
 		* \@param value 0.0::close---1.0::open
 		* \@return Results of implementation
@@ -90,6 +127,21 @@ namespace Ghost
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Landmarks of every face, the faces stay tracked from frame to frame
+		* \@desc a box overlapping a tracked face confirms it, the others start new faces #the only time the Haar detector runs, inside the box#
+		* \@desc tracked faces regress from their previous shape in parallel, faceBoxes may be empty on frames the face detector skips
+		* \@param faceBoxes::Face boxes in frameIn pixels, e.g. from FaceDetector
+		* \@param frameOut::Landmarks are drawn on it unless it is empty
+		*/
+		EResult detectFaces(const cv::Mat& frameIn, const std::vector<cv::Rect>& faceBoxes, cv::Mat& frameOut);
+
+		/**
+		* \@brief Face boxes for the next detect, bind it to FaceDetector::bindSlotFaceFind
+		* \@desc once boxes have been given detect tracks every face as detectFaces does, before that it tracks the largest face only
+		*/
+		void setFaceBoxes(const std::vector<Ghost::SRect>& faces);
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
@@ -104,13 +156,40 @@ namespace Ghost
 		*/
 		EResult saveFaceToDataBase(const cv::Mat& frameSave, const SPersonalInformation& infor);
 
+		/**
+		* \@brief Names of the blendshapes in the order of the weights, empty until the blendshape model is loaded
+		*/
+		std::vector<std::string> getBlendshapeNames();
+
 	public GHOST_SIGNAL:
 	/**
 	* \@brief Found face Landmark appearing
+	* \@desc the points of every face as x0, y0, x1, y1 ... one face after the other
 	* \@param func::Functions that need to be triggered
 	*/
 	void bindSlotLandMarkFind(const std::function<void(const std::vector<float>&)>& func);
 
+	/**
+	* \@brief Found face Landmark appearing, without copies or allocations
+	* \@desc points:: x0, y0, x1, y1 ... one face after the other, counts:: points of each face, faceNum:: entries of counts
+	* \@desc the buffers are reused by the next frame, copy what must outlive the call
+	* \@param func::Functions that need to be triggered
+	*/
+	void bindSlotLandmarkBuffer(const std::function<void(const float*, const int*, const size_t)>& func);
+
+	/**
+	* \@brief Landmarks of every tracked face with its id
+	*/
+	void bindSlotFacesLandmark(const std::function<void(const std::vector<SFaceLandmark>&)>& func);
+
+	/**
+	* \@brief Blendshape weights of every tracked face, once per frame, without copies or allocations
+	* \@desc weights:: faceNum x blendshapeNum one face after the other, ids:: id of each face
+	* \@desc the buffers are reused by the next frame, copy what must outlive the call
+	* \@param func::Functions that need to be triggered
+	*/
+	void bindSlotBlendshapes(const std::function<void(const float*, const int*, const size_t, const size_t)>& func);
+
 	private:
 		class Impl;
 		std::unique_ptr<Impl> m_pImpl;
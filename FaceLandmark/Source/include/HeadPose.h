@@ -0,0 +1,82 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				HeadPose.h
+* \@brief Desc:				Head pose from 68 face landmarks against a 3D mean face
+* \@brief prerequisite::	C++17
+*/
+#pragma once
+
+#include "opencv2/opencv.hpp"
+
+#ifndef FACERECOGNITION_API
+#define FACERECOGNITION_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Head pose in camera axes:: x right, y down, z forward, all angles 0 when the face looks into the camera
+	*/
+	struct SHeadPose
+	{
+		float roll;								//degrees about z, positive tilts the head clockwise in the image
+		float yaw;								//degrees about y
+		float pitch;							//degrees about x
+		cv::Matx33f rotation;					//mean face to camera
+		cv::Vec3f translation;					//mean face origin in camera axes, about centimetres
+		float error;							//RMS reprojection error in pixels
+		bool valid;
+
+		SHeadPose() : roll(0.f), yaw(0.f), pitch(0.f), rotation(cv::Matx33f::eye()), error(0.f), valid(false) {}
+	};
+
+	/**
+	* \@brief Perspective-n-point on 14 stable landmarks (brows, eye corners, nose wings, mouth, chin)
+	* \@desc a valid previous pose is refined by a few Gauss-Newton steps on the rotation and translation, a couple of microseconds,
+	* \@desc without one or when the refinement does not fit, cv::solvePnP (EPnP) starts it again
+	* \@desc estimate is const, one instance serves any number of faces and threads
+	*/
+	class FACERECOGNITION_API HeadPoseEstimator final
+	{
+	public:
+		static constexpr int s_landmarkNum = 68;		//!< iBUG 300-W layout
+		static constexpr int s_modelNum = 14;			//!< landmarks of the mean face used
+
+	public:
+		HeadPoseEstimator();
+
+		/**
+		* \@brief Focal length in pixels, 0 takes the larger side of the frame #about 53 degrees of view#
+		*/
+		void setFocalLength(const float focalLength) noexcept(true) { m_focalLength = focalLength; }
+		float getFocalLength() const noexcept(true) { return m_focalLength; }
+
+		/**
+		* \@brief Largest RMS reprojection error accepted, relative to the size of the face
+		*/
+		void setMaxError(const float maxError) noexcept(true) { m_maxError = maxError; }
+		float getMaxError() const noexcept(true) { return m_maxError; }
+
+		/**
+		* \@brief Pose of one face
+		* \@param points:: s_landmarkNum landmarks in frame pixels
+		* \@param pose:: in:: pose of the previous frame, used as the starting point when valid; out:: pose of this frame
+		* \@return pose.valid
+		*/
+		bool estimate(const cv::Point2f* points, const int pointNum, const cv::Size& frameSize, SHeadPose& pose) const;
+
+	private:
+		/**
+		* \@brief Damped Gauss-Newton on exp(w) * R and t
+		* \@return RMS reprojection error, negative if a point falls behind the camera
+		*/
+		double refine(const cv::Point2f* observed, const double focal, const cv::Point2d& center,
+			cv::Matx33d& rotation, cv::Vec3d& translation, const int iterations) const;
+
+	private:
+		float m_focalLength;
+		float m_maxError;
+	};
+}///namespace Ghost
@@ -0,0 +1,177 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				SdmLandmarker.h
+* \@brief Desc:				In-tree supervised descent (SDM) face landmark regression
+* \@brief prerequisite::	C++17 SSE4.1 (AVX2/AVX-512 used when present)
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+#include "opencv2/opencv.hpp"
+
+#ifndef FACERECOGNITION_API
+#define FACERECOGNITION_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Cascade of linear regressors over gradient orientation descriptors sampled around every landmark
+	* \@desc one stage:: shape += size * (R * [descriptors; 1]), size is the larger side of the shape's bounding box
+	* \@desc the regressors are packed in panels of s_panelRows rows so the GEMV streams them once, stored as fp32, fp16 or int8
+	* \@desc fit/track are const and take the scratch from the caller, one instance serves any number of threads
+	*/
+	class FACERECOGNITION_API SdmLandmarker final
+	{
+	public:
+		/**
+		* \@brief Regressor storage
+		*/
+		enum struct EPrecision : uint8_t
+		{
+			FP32 = 0,
+			FP16,										//half the bandwidth, relative error ~1e-3
+			INT8										//a quarter of the bandwidth, one scale per row
+		};
+
+		static constexpr int s_patchSize = 32;			//!< samples per patch side
+		static constexpr int s_cellSize = 8;			//!< samples per cell side
+		static constexpr int s_cellNum = s_patchSize / s_cellSize;
+		static constexpr int s_binNum = 9;				//!< unsigned orientations over 180 degrees
+		static constexpr int s_descriptorSize = s_cellNum * s_cellNum * s_binNum;
+		static constexpr int s_panelRows = 16;			//!< regressor rows interleaved per panel
+
+		/**
+		* \@brief One regression stage
+		*/
+		struct SStage
+		{
+			float patchScale;							//patch side relative to the shape size
+			cv::Mat regressor;							//CV_32F, 2N rows (x0, y0, x1, y1 ...) x (N * s_descriptorSize + 1), bias in the last column
+
+			SStage() : patchScale(0.f) {}
+		};
+
+		/**
+		* \@brief Scratch of one thread, sized on first use
+		*/
+		struct SWorkspace
+		{
+			simd::AlignedVector<float> image;			//gray frame as float
+			simd::AlignedVector<float> patch;			//sampled patch with a one sample border
+			simd::AlignedVector<float> columns;			//per bin column sums of the current cell row
+			simd::AlignedVector<float> features;		//descriptors of every landmark
+			simd::AlignedVector<float> delta;			//regressor output
+		};
+
+		/**
+		* \@brief Settings of train
+		*/
+		struct STrainParam
+		{
+			std::vector<float> patchScales;				//patch side relative to the shape size, one stage each
+			int initNum;								//starting shapes per face, the first is the one fit uses
+			float shiftJitter;							//random shift of the other starting shapes, relative to the box
+			float scaleJitter;							//random scale of the other starting shapes
+			float lambda;								//ridge, relative to the mean diagonal of X'X
+			uint64_t seed;
+
+			STrainParam() : patchScales{ 0.3f, 0.25f, 0.2f, 0.15f }, initNum(5), shiftJitter(0.08f), scaleJitter(0.1f), lambda(0.05f), seed(7) {}
+		};
+
+	public:
+		SdmLandmarker();
+
+		/**
+		* \@brief Build from a mean shape and trained stages
+		* \@param meanShape:: relative to the face box, (0, 0) top left and (1, 1) bottom right
+		*/
+		EResult create(const std::vector<cv::Point2f>& meanShape, const std::vector<SStage>& stages);
+
+		/**
+		* \@brief Model file:: "GSDM", int32 version, int32 landmarks, int32 stages, float mean shape[2N],
+		* then per stage float patchScale and the float regressor row by row
+		*/
+		EResult load(const std::string& modelPath);
+		EResult save(const std::string& modelPath) const;
+
+		/**
+		* \@brief Train the stages by ridge regression and replace the model, save writes the "GSDM" file FaceLandmark loads
+		* \@param grays:: CV_8UC1 images, one face each
+		* \@param shapes:: annotated landmarks of every face, same count and order for all (68 points for FaceLandmark)
+		* \@param boxes:: face boxes from the detector used at run time, fit starts from them
+		* \@desc X'X is accumulated in blocks of samples, memory is about (N * s_descriptorSize)^2 floats whatever the sample count
+		*/
+		EResult train(const std::vector<cv::Mat>& grays, const std::vector<std::vector<cv::Point2f>>& shapes,
+			const std::vector<cv::Rect>& boxes, const STrainParam& param);
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setPrecision(const EPrecision precision);
+		EPrecision getPrecision() const noexcept(true) { return m_precision; }
+		void setIsa(const simd::EIsa isa) noexcept(true);
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+		bool isLoaded() const noexcept(true) { return !m_stages.empty(); }
+		int landmarkNum() const noexcept(true) { return static_cast<int>(m_meanShape.size()); }
+
+		/**
+		* \@brief Bytes of packed regressors read per fit, all stages
+		*/
+		size_t regressorBytes() const noexcept(true);
+
+		/**
+		* \@brief Landmarks of the face in box, starting from the mean shape
+		* \@param gray:: CV_8UC1
+		*/
+		void fit(const cv::Mat& gray, const cv::Rect& box, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const;
+
+		/**
+		* \@brief Refine the landmarks of the previous frame
+		*/
+		void track(const cv::Mat& gray, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const;
+
+	private:
+		/**
+		* \@brief Stage regressor in the packed layout [panel][column][s_panelRows]
+		*/
+		struct SPackedStage
+		{
+			float patchScale;
+			int rows, panels, cols;						//cols excludes the bias
+			simd::AlignedVector<float> weights32;
+			simd::AlignedVector<uint16_t> weights16;
+			simd::AlignedVector<int8_t> weights8;
+			simd::AlignedVector<float> scales;			//int8 row scales
+			simd::AlignedVector<float> bias;
+
+			SPackedStage() : patchScale(0.f), rows(0), panels(0), cols(0) {}
+		};
+
+		using DescribeFunc = void(*)(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor);
+		using GemvFunc = void(*)(const void* weights, const int panels, const int cols, const float* x, float* y);
+
+		void pack();
+		void selectKernels() noexcept(true);
+		void regress(const cv::Mat& gray, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const;
+		cv::Rect prepareImage(const cv::Mat& gray, const std::vector<cv::Point2f>& shape, const float maxScale, SWorkspace& workspace) const;
+		float describeShape(const cv::Rect& roi, const std::vector<cv::Point2f>& shape, const float patchScale, SWorkspace& workspace) const;
+
+	private:
+		std::vector<cv::Point2f> m_meanShape;
+		std::vector<SStage> m_stages;					//!< fp32 source, kept for repacking and saving
+		std::vector<SPackedStage> m_packed;
+
+		EPrecision m_precision;
+		simd::EIsa m_isa;
+		DescribeFunc m_describe;
+		GemvFunc m_gemv;
+	};
+}///namespace Ghost
@@ -0,0 +1,416 @@
+#include "BlendshapeSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_fileVersion = 1;
+		const char s_fileMagic[4] = { 'G', 'B', 'S', 'M' };
+
+		//iBUG 300-W points that barely move with the expression:: jaw ends, nose bridge and base, eye corners
+		const int s_stableIndex[] = { 0, 16, 27, 28, 29, 30, 31, 33, 35, 36, 39, 42, 45 };
+		constexpr int s_stableLandmarkNum = 68;
+
+		//iBUG 300-W 平均脸 (OpenFace 的对齐模板) 宽约0.9
+		const float s_meanFace[s_stableLandmarkNum][2] =
+		{
+			{ 0.0792397f, 0.3392237f }, { 0.0829219f, 0.4569554f }, { 0.0967927f, 0.5756480f }, { 0.1221415f, 0.6919216f },
+			{ 0.1686879f, 0.8003413f }, { 0.2397894f, 0.8957325f }, { 0.3256625f, 0.9770688f }, { 0.4223183f, 1.0432900f },
+			{ 0.5317778f, 1.0608037f }, { 0.6412963f, 1.0398192f }, { 0.7381059f, 0.9722688f }, { 0.8244444f, 0.8896241f },
+			{ 0.8947927f, 0.7924942f }, { 0.9393955f, 0.6815466f }, { 0.9611193f, 0.5622383f }, { 0.9705798f, 0.4417589f },
+			{ 0.9711933f, 0.3221187f }, { 0.1638462f, 0.2491517f }, { 0.2178035f, 0.2042559f }, { 0.2912994f, 0.1923673f },
+			{ 0.3674602f, 0.2035822f }, { 0.4392945f, 0.2331356f }, { 0.5864460f, 0.2281416f }, { 0.6601527f, 0.1959238f },
+			{ 0.7374664f, 0.1823610f }, { 0.8132365f, 0.1928280f }, { 0.8707572f, 0.2352934f }, { 0.5153453f, 0.3186355f },
+			{ 0.5162214f, 0.3962004f }, { 0.5171189f, 0.4737977f }, { 0.5181643f, 0.5531578f }, { 0.4337012f, 0.6040545f },
+			{ 0.4755012f, 0.6207634f }, { 0.5207129f, 0.6342682f }, { 0.5658741f, 0.6187966f }, { 0.6070540f, 0.6015767f },
+			{ 0.2524187f, 0.3310523f }, { 0.2986630f, 0.3026464f }, { 0.3557497f, 0.3030207f }, { 0.4037190f, 0.3386771f },
+			{ 0.3525072f, 0.3499876f }, { 0.2967918f, 0.3504790f }, { 0.6313261f, 0.3341367f }, { 0.6790734f, 0.2964540f },
+			{ 0.7359724f, 0.2947213f }, { 0.7828654f, 0.3213053f }, { 0.7403123f, 0.3418494f }, { 0.6849985f, 0.3437343f },
+			{ 0.3531678f, 0.7461892f }, { 0.4145878f, 0.7190538f }, { 0.4776777f, 0.7068359f }, { 0.5227329f, 0.7170923f },
+			{ 0.5698321f, 0.7054145f }, { 0.6351958f, 0.7156557f }, { 0.6995167f, 0.7394192f }, { 0.6394472f, 0.8052369f },
+			{ 0.5764105f, 0.8354367f }, { 0.5253984f, 0.8417064f }, { 0.4764155f, 0.8375059f }, { 0.4137955f, 0.8100456f },
+			{ 0.3800848f, 0.7499796f }, { 0.4779560f, 0.7451323f }, { 0.5233898f, 0.7489243f }, { 0.5710578f, 0.7433289f },
+			{ 0.6724091f, 0.7441770f }, { 0.5725396f, 0.7766093f }, { 0.5240107f, 0.7833708f }, { 0.4775612f, 0.7784763f }
+		};
+
+		/**
+		* \@brief 内置基的一个blendshape:: 若干点的位移 单位与s_meanFace相同 图像坐标 y向下
+		* \@desc Left/Right 按ARKit指本人的左右 即不镜像的画面中的右/左 (左眼 42-47 左眉 22-26 左嘴角 54 64)
+		*/
+		struct SMove
+		{
+			int index;
+			float dx, dy;
+		};
+	}
+
+	BlendshapeSolver::BlendshapeSolver()
+		:
+		m_landmarkNum(0),
+		m_blendshapeNum(0),
+		m_shapeStride(0),
+		m_weightStride(0),
+		m_method(EMethod::BoundedLeastSquares),
+		m_regularization(0.01f),
+		m_maxSweeps(16),
+		m_tolerance(1e-4f)
+	{
+	}
+
+	EResult BlendshapeSolver::create(const std::vector<cv::Point2f>& neutral, const cv::Mat& deltas, const std::vector<std::string>& names)
+	{
+		const int landmarkNum = static_cast<int>(neutral.size());
+		if (landmarkNum < 3 || deltas.type() != CV_32FC1 || deltas.rows <= 0 || deltas.cols != landmarkNum * 2
+			|| (!names.empty() && static_cast<int>(names.size()) != deltas.rows))
+			return EResult::SR_NG;
+
+		m_landmarkNum = landmarkNum;
+		m_blendshapeNum = deltas.rows;
+		m_shapeStride = simd::alignUp(landmarkNum * 2, 16);
+		m_weightStride = simd::alignUp(deltas.rows, 16);
+
+		m_names = names;
+		for (int k = static_cast<int>(m_names.size()); k < m_blendshapeNum; k++)
+			m_names.push_back(std::to_string(k));
+
+		m_alignIndex.clear();
+		if (landmarkNum == s_stableLandmarkNum)
+			m_alignIndex.assign(std::begin(s_stableIndex), std::end(s_stableIndex));
+		else
+		{
+			for (int i = 0; i < landmarkNum; i++)
+				m_alignIndex.push_back(i);
+		}
+
+		m_neutral.assign(landmarkNum * 2, 0.f);
+		for (int i = 0; i < landmarkNum; i++)
+		{
+			m_neutral[i * 2] = neutral[i].x;
+			m_neutral[i * 2 + 1] = neutral[i].y;
+		}
+
+		m_basis.assign(m_blendshapeNum * m_shapeStride, 0.f);
+		for (int k = 0; k < m_blendshapeNum; k++)
+			std::copy_n(deltas.ptr<float>(k), landmarkNum * 2, m_basis.data() + k * m_shapeStride);
+
+		normalize();
+		build();
+		return EResult::SR_OK;
+	}
+
+	EResult BlendshapeSolver::createDefault()
+	{
+		std::vector<cv::Point2f> neutral(s_stableLandmarkNum);
+		for (int i = 0; i < s_stableLandmarkNum; i++)
+			neutral[i] = cv::Point2f(s_meanFace[i][0], s_meanFace[i][1]);
+
+		//闭眼:: 上眼睑落到下眼睑 睁大:: 上眼睑抬起眼裂的一半 下眼睑略降 避免与闭眼共线
+		auto lid = [&neutral](const int upper, const int lower, const float amount) { return SMove{ upper, 0.f, amount * (neutral[lower].y - neutral[upper].y) }; };
+
+		//其余幅度为平均脸上的经验值 张嘴约为脸宽的1/6 嘴角与眉毛约为1/25
+		const std::vector<std::pair<std::string, std::vector<SMove>>> blendshapes =
+		{
+			{ "jawOpen", {
+				{ 4, 0.f, 0.02f }, { 5, 0.f, 0.05f }, { 6, 0.f, 0.09f }, { 7, 0.f, 0.13f }, { 8, 0.f, 0.15f }, { 9, 0.f, 0.13f },
+				{ 10, 0.f, 0.09f }, { 11, 0.f, 0.05f }, { 12, 0.f, 0.02f }, { 48, 0.f, 0.045f }, { 54, 0.f, 0.045f },
+				{ 55, 0.f, 0.075f }, { 56, 0.f, 0.12f }, { 57, 0.f, 0.135f }, { 58, 0.f, 0.12f }, { 59, 0.f, 0.075f },
+				{ 60, 0.f, 0.045f }, { 64, 0.f, 0.045f }, { 65, 0.f, 0.12f }, { 66, 0.f, 0.135f }, { 67, 0.f, 0.12f } } },
+			{ "eyeBlinkLeft", { lid(43, 47, 1.f), lid(44, 46, 1.f) } },
+			{ "eyeBlinkRight", { lid(37, 41, 1.f), lid(38, 40, 1.f) } },
+			{ "eyeWideLeft", { lid(43, 47, -0.5f), lid(44, 46, -0.5f), lid(47, 43, -0.15f), lid(46, 44, -0.15f) } },
+			{ "eyeWideRight", { lid(37, 41, -0.5f), lid(38, 40, -0.5f), lid(41, 37, -0.15f), lid(40, 38, -0.15f) } },
+			{ "browDownLeft", { { 22, -0.015f, 0.03f }, { 23, -0.01f, 0.03f }, { 24, 0.f, 0.03f }, { 25, 0.f, 0.025f }, { 26, 0.f, 0.02f } } },
+			{ "browDownRight", { { 21, 0.015f, 0.03f }, { 20, 0.01f, 0.03f }, { 19, 0.f, 0.03f }, { 18, 0.f, 0.025f }, { 17, 0.f, 0.02f } } },
+			{ "browInnerUp", { { 19, 0.f, -0.01f }, { 20, 0.f, -0.03f }, { 21, 0.f, -0.05f }, { 22, 0.f, -0.05f }, { 23, 0.f, -0.03f }, { 24, 0.f, -0.01f } } },
+			{ "browOuterUpLeft", { { 24, 0.f, -0.02f }, { 25, 0.f, -0.035f }, { 26, 0.f, -0.045f } } },
+			{ "browOuterUpRight", { { 19, 0.f, -0.02f }, { 18, 0.f, -0.035f }, { 17, 0.f, -0.045f } } },
+			{ "mouthSmileLeft", { { 54, 0.035f, -0.035f }, { 64, 0.035f, -0.035f }, { 53, 0.015f, -0.015f }, { 55, 0.015f, -0.015f } } },
+			{ "mouthSmileRight", { { 48, -0.035f, -0.035f }, { 60, -0.035f, -0.035f }, { 49, -0.015f, -0.015f }, { 59, -0.015f, -0.015f } } },
+			{ "mouthFrownLeft", { { 54, 0.f, 0.035f }, { 64, 0.f, 0.035f }, { 55, 0.f, 0.015f } } },
+			{ "mouthFrownRight", { { 48, 0.f, 0.035f }, { 60, 0.f, 0.035f }, { 59, 0.f, 0.015f } } },
+			{ "mouthPucker", {
+				{ 48, 0.05f, 0.f }, { 60, 0.05f, 0.f }, { 49, 0.02f, 0.f }, { 59, 0.02f, 0.f },
+				{ 54, -0.05f, 0.f }, { 64, -0.05f, 0.f }, { 53, -0.02f, 0.f }, { 55, -0.02f, 0.f } } }
+		};
+
+		cv::Mat deltas(static_cast<int>(blendshapes.size()), s_stableLandmarkNum * 2, CV_32FC1, cv::Scalar::all(0));
+		std::vector<std::string> names;
+		for (size_t k = 0; k < blendshapes.size(); k++)
+		{
+			names.push_back(blendshapes[k].first);
+			float* delta = deltas.ptr<float>(static_cast<int>(k));
+			for (const auto& move : blendshapes[k].second)
+			{
+				delta[move.index * 2] += move.dx;
+				delta[move.index * 2 + 1] += move.dy;
+			}
+		}
+
+		return create(neutral, deltas, names);
+	}
+
+	EResult BlendshapeSolver::load(const std::string& modelPath)
+	{
+		std::ifstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		char magic[4] = { 0 };
+		int32_t header[3] = { 0 };
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!file || !std::equal(magic, magic + 4, s_fileMagic) || header[0] != s_fileVersion || header[1] <= 0 || header[2] <= 0)
+			return EResult::SR_NG;
+
+		const int landmarkNum = header[1];
+		std::vector<std::string> names(header[2]);
+		for (auto& name : names)
+		{
+			int32_t length = 0;
+			file.read(reinterpret_cast<char*>(&length), sizeof(length));
+			if (!file || length < 0 || length > 256)
+				return EResult::SR_NG;
+
+			name.resize(length);
+			file.read(&name[0], length);
+		}
+
+		std::vector<float> points(landmarkNum * 2);
+		file.read(reinterpret_cast<char*>(points.data()), points.size() * sizeof(float));
+
+		std::vector<cv::Point2f> neutral(landmarkNum);
+		for (int i = 0; i < landmarkNum; i++)
+			neutral[i] = cv::Point2f(points[i * 2], points[i * 2 + 1]);
+
+		cv::Mat deltas(header[2], landmarkNum * 2, CV_32FC1);
+		file.read(reinterpret_cast<char*>(deltas.data), deltas.total() * sizeof(float));
+		if (!file)
+			return EResult::SR_NG;
+
+		return create(neutral, deltas, names);
+	}
+
+	EResult BlendshapeSolver::save(const std::string& modelPath) const
+	{
+		if (!isLoaded())
+			return EResult::SR_Detector_Not_Exist;
+
+		std::ofstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		const int32_t header[3] = { s_fileVersion, m_landmarkNum, m_blendshapeNum };
+		file.write(s_fileMagic, sizeof(s_fileMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		for (const auto& name : m_names)
+		{
+			const int32_t length = static_cast<int32_t>(name.size());
+			file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			file.write(name.data(), length);
+		}
+		file.write(reinterpret_cast<const char*>(m_neutral.data()), m_landmarkNum * 2 * sizeof(float));
+		for (int k = 0; k < m_blendshapeNum; k++)
+			file.write(reinterpret_cast<const char*>(m_basis.data() + k * m_shapeStride), m_landmarkNum * 2 * sizeof(float));
+
+		return file ? EResult::SR_OK : EResult::SR_NG;
+	}
+
+	EResult BlendshapeSolver::setNeutral(const cv::Point2f* points, const int pointNum)
+	{
+		if (!isLoaded())
+			return EResult::SR_Detector_Not_Exist;
+		if (points == nullptr || pointNum != m_landmarkNum)
+			return EResult::SR_NG;
+
+		std::vector<float> offsets(m_landmarkNum * 2);
+		if (!align(points, offsets.data()))
+			return EResult::SR_NG;
+
+		for (size_t i = 0; i < offsets.size(); i++)
+			m_neutral[i] += offsets[i];
+
+		normalize();
+		build();
+		return EResult::SR_OK;
+	}
+
+	void BlendshapeSolver::setRegularization(const float regularization)
+	{
+		m_regularization = std::max(regularization, 0.f);
+		if (isLoaded())
+			build();
+	}
+
+	bool BlendshapeSolver::solve(const cv::Point2f* points, const int pointNum, float* weights, SWorkspace& workspace) const
+	{
+		if (!isLoaded() || points == nullptr || weights == nullptr || pointNum != m_landmarkNum)
+			return false;
+
+		const size_t shapeSize = m_landmarkNum * 2;
+		const size_t K = m_blendshapeNum;
+		if (workspace.offsets.size() < m_shapeStride)
+			workspace.offsets.assign(m_shapeStride, 0.f);
+		if (workspace.projection.size() < m_weightStride)
+			workspace.projection.assign(m_weightStride, 0.f);
+
+		float* offsets = workspace.offsets.data();
+		float* projection = workspace.projection.data();
+		if (!align(points, offsets))
+			return false;
+
+		if (m_method == EMethod::Linear)
+		{
+			for (size_t k = 0; k < K; k++)
+				weights[k] = std::min(std::max(simd::dot(m_pseudoInverse.data() + k * m_shapeStride, offsets, shapeSize), 0.f), 1.f);
+			return true;
+		}
+
+		for (size_t k = 0; k < K; k++)
+		{
+			projection[k] = simd::dot(m_basis.data() + k * m_shapeStride, offsets, shapeSize);
+			weights[k] = std::min(std::max(weights[k], 0.f), 1.f);
+		}
+
+		//投影Gauss-Seidel 上一帧的权重作为初值 表情变化不大时一两轮就收敛
+		for (int sweep = 0; sweep < m_maxSweeps; sweep++)
+		{
+			float maxChange = 0.f;
+			for (size_t k = 0; k < K; k++)
+			{
+				const float* row = m_normal.data() + k * m_weightStride;
+				const float residual = projection[k] - simd::dot(row, weights, K);
+				const float updated = std::min(std::max(weights[k] + residual * m_inverseDiagonal[k], 0.f), 1.f);
+				maxChange = std::max(maxChange, std::abs(updated - weights[k]));
+				weights[k] = updated;
+			}
+			if (maxChange < m_tolerance)
+				break;
+		}
+
+		return true;
+	}
+
+	bool BlendshapeSolver::align(const cv::Point2f* points, float* offsets) const
+	{
+		double centerX = 0.0, centerY = 0.0;
+		for (const int i : m_alignIndex)
+		{
+			centerX += points[i].x;
+			centerY += points[i].y;
+		}
+		centerX /= m_alignIndex.size();
+		centerY /= m_alignIndex.size();
+
+		//points - center ~= s * R * neutral, s * cos = a / norm, s * sin = b / norm
+		double a = 0.0, b = 0.0, norm = 0.0;
+		for (const int i : m_alignIndex)
+		{
+			const double x = points[i].x - centerX, y = points[i].y - centerY;
+			const double mx = m_neutral[i * 2], my = m_neutral[i * 2 + 1];
+			a += x * mx + y * my;
+			b += mx * y - my * x;
+			norm += mx * mx + my * my;
+		}
+		const double cosine = a / norm, sine = b / norm;
+		const double squared = cosine * cosine + sine * sine;
+		if (!(squared > 1e-12))
+			return false;
+
+		//逆变换回到中性脸的坐标系
+		const float m00 = static_cast<float>(cosine / squared), m01 = static_cast<float>(sine / squared);
+		const float offsetX = static_cast<float>(centerX), offsetY = static_cast<float>(centerY);
+		for (int i = 0; i < m_landmarkNum; i++)
+		{
+			const float x = points[i].x - offsetX, y = points[i].y - offsetY;
+			offsets[i * 2] = m00 * x + m01 * y - m_neutral[i * 2];
+			offsets[i * 2 + 1] = m00 * y - m01 * x - m_neutral[i * 2 + 1];
+		}
+		return true;
+	}
+
+	void BlendshapeSolver::normalize()
+	{
+		//稳定点中心在原点 均方根为1
+		double centerX = 0.0, centerY = 0.0;
+		for (const int i : m_alignIndex)
+		{
+			centerX += m_neutral[i * 2];
+			centerY += m_neutral[i * 2 + 1];
+		}
+		centerX /= m_alignIndex.size();
+		centerY /= m_alignIndex.size();
+
+		double squared = 0.0;
+		for (const int i : m_alignIndex)
+		{
+			const double x = m_neutral[i * 2] - centerX, y = m_neutral[i * 2 + 1] - centerY;
+			squared += x * x + y * y;
+		}
+		const double rms = std::sqrt(squared / m_alignIndex.size());
+		const float scale = (rms > 1e-12) ? static_cast<float>(1.0 / rms) : 1.f;
+
+		for (int i = 0; i < m_landmarkNum; i++)
+		{
+			m_neutral[i * 2] = static_cast<float>((m_neutral[i * 2] - centerX) * scale);
+			m_neutral[i * 2 + 1] = static_cast<float>((m_neutral[i * 2 + 1] - centerY) * scale);
+		}
+		for (auto& value : m_basis)
+			value *= scale;
+	}
+
+	void BlendshapeSolver::build()
+	{
+		const int K = m_blendshapeNum;
+		const size_t shapeSize = m_landmarkNum * 2;
+
+		//B'B + lambda I 双精度累加
+		cv::Mat normal(K, K, CV_64FC1);
+		double trace = 0.0;
+		for (int k = 0; k < K; k++)
+		{
+			const float* a = m_basis.data() + k * m_shapeStride;
+			for (int j = k; j < K; j++)
+			{
+				const float* b = m_basis.data() + j * m_shapeStride;
+				double sum = 0.0;
+				for (size_t c = 0; c < shapeSize; c++)
+					sum += static_cast<double>(a[c]) * b[c];
+				normal.at<double>(k, j) = normal.at<double>(j, k) = sum;
+			}
+			trace += normal.at<double>(k, k);
+		}
+		const double lambda = m_regularization * std::max(trace / K, 1e-12);
+
+		m_normal.assign(K * m_weightStride, 0.f);
+		m_inverseDiagonal.assign(m_weightStride, 0.f);
+		for (int k = 0; k < K; k++)
+		{
+			normal.at<double>(k, k) += lambda;
+			for (int j = 0; j < K; j++)
+				m_normal[k * m_weightStride + j] = static_cast<float>(normal.at<double>(k, j));
+			m_inverseDiagonal[k] = static_cast<float>(1.0 / std::max(normal.at<double>(k, k), 1e-12));
+		}
+
+		cv::Mat inverse;
+		cv::invert(normal, inverse, cv::DECOMP_SVD);
+
+		m_pseudoInverse.assign(K * m_shapeStride, 0.f);
+		for (int k = 0; k < K; k++)
+		{
+			float* row = m_pseudoInverse.data() + k * m_shapeStride;
+			for (int j = 0; j < K; j++)
+			{
+				const float weight = static_cast<float>(inverse.at<double>(k, j));
+				const float* basis = m_basis.data() + j * m_shapeStride;
+				for (size_t c = 0; c < shapeSize; c++)
+					row[c] += weight * basis[c];
+			}
+		}
+	}
+}///namespace Ghost
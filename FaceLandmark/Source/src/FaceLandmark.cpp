@@ -1,14 +1,20 @@
 #include "FaceLandmark.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <filesystem>
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <thread>
 
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/objdetect/objdetect.hpp>
 
+#include "GThreadPool.hpp"
+#include "SdmLandmarker.h"
 #include "ldmarkmodel.h"
 
 namespace fs = std::filesystem;
@@ -18,10 +24,35 @@ namespace Ghost
 {
 	class FaceLandmark::Impl
 	{
+	public:
+		/**
+		* \@brief һűٵ
+		*/
+		struct SFace
+		{
+			int id;
+			cv::Rect box;							//Ϊ ֮Ϊһ֡״ӿ
+			cv::Mat shape;							//1 x 2N xy ԭͼ ::δʼ
+			std::vector<cv::Point2f> points;		//SDM״ ԭͼ
+			SHeadPose pose;							//һ֡ͷ̬ Ϊ֡ĳֵ
+			std::vector<float> weights;				//һ֡blendshapeȨ Ϊ֡ĳֵ
+			size_t unconfirmed;						//ûԵ֡
+			bool lostFlag;							//֡
+
+			SFace() : id(-1), unconfirmed(0), lostFlag(false) {}
+		};
+
 	public:
 		Impl()
 			:m_initFlag(false),
-			m_pDetector(nullptr)
+			m_pDetector(nullptr),
+			m_threadNum(1),
+			m_engineFlag(false),
+			m_precision(SdmLandmarker::EPrecision::FP32),
+			m_poseFlag(false),
+			m_blendshapeMode(0),
+			m_nextId(0),
+			m_boxesFlag(false)
 		{
 
 		}
@@ -43,14 +74,15 @@ namespace Ghost
 			if (m_initFlag.load())
 				return EResult::SR_Detector_Already_Exist;
 
-			if (m_pDetector == nullptr)
-			{
-				m_pDetector = std::make_unique<ldmarkmodel>();
+			EResult result = loadEngine();
+			if (result != EResult::SR_OK)
+				return result;
 
-				if (!load_ldmarkmodel(Impl::m_modelPath, Impl::m_modelXmlPath, *m_pDetector))
-					return EResult::SR_NG;
-			}
+			result = loadBlendshape();
+			if (result != EResult::SR_OK)
+				return result;
 
+			createWorkers();
 			m_initFlag.store(true);
 
 			return EResult::SR_OK;
@@ -73,6 +105,13 @@ namespace Ghost
 				m_pDetector = nullptr;
 			}
 
+			m_pEngine.reset();
+			m_workspaces.clear();
+			m_pBlendshape.reset();
+			m_pPool.reset();
+			m_workerModels.clear();
+			m_faces.clear();
+			m_currentShape.release();
 			m_initFlag.store(false);
 
 			return EResult::SR_OK;
@@ -91,57 +130,671 @@ namespace Ghost
 			if (!m_initFlag.load())
 				return EResult::SR_Detector_Not_Exist;
 
+			// е SDMû ֻܰ
+			if (m_boxesFlag || m_engineFlag)
+			{
+				const EResult result = alignFaces(frameIn, m_pendingBoxes, frameOut);
+				m_pendingBoxes.clear();
+				return result;
+			}
+
 			if (m_pDetector != nullptr)
 			{
 				m_pDetector->track(frameIn, m_currentShape);
 
-				if (!frameOut.empty())
+				publishShape(m_currentShape);
+				render(frameOut);
+			}
+
+			return EResult::SR_OK;
+		}
+
+		EResult detectFaces(const cv::Mat& frameIn, const std::vector<cv::Rect>& faceBoxes, cv::Mat& frameOut)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			return alignFaces(frameIn, faceBoxes, frameOut);
+		}
+
+		void setFaceBoxes(const std::vector<Ghost::SRect>& faces)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_boxesFlag = true;
+			m_pendingBoxes.clear();
+			for (const auto& face : faces)
+				m_pendingBoxes.push_back(cv::Rect(face.x, face.y, face.width, face.height));
+		}
+
+		EResult setThreadNum(const size_t threadNum)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_threadNum = threadNum;
+			if (m_initFlag.load())
+				createWorkers();
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief лع ״ͨ еȫ
+		*/
+		EResult setEngine(const bool engineFlag)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_engineFlag == engineFlag)
+				return EResult::SR_OK;
+
+			m_engineFlag = engineFlag;
+			m_faces.clear();
+			if (!m_initFlag.load())
+				return EResult::SR_OK;
+
+			const EResult result = loadEngine();
+			if (result != EResult::SR_OK)
+				m_engineFlag = !engineFlag;
+			return result;
+		}
+
+		void setHeadPose(const bool poseFlag)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_poseFlag = poseFlag;
+			for (auto& face : m_faces)
+				face.pose.valid = false;
+		}
+
+		/**
+		* \@brief 0::ر 1::ģ 2::нС
+		*/
+		EResult setBlendshape(const int blendshapeMode)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_blendshapeMode = blendshapeMode;
+			if (!m_initFlag.load())
+				return EResult::SR_OK;
+
+			const EResult result = loadBlendshape();
+			if (result != EResult::SR_OK)
+				m_blendshapeMode = 0;
+			return result;
+		}
+
+		/**
+		* \@brief ָidǰ״ΪԱ ȡһ
+		*/
+		EResult setNeutral(const int faceId)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_pBlendshape == nullptr)
+				return EResult::SR_Detector_Not_Exist;
+			if (m_faces.empty() || m_landmarks.empty())
+				return EResult::SR_NG;
+
+			auto landmark = m_landmarks.cbegin();
+			if (faceId >= 0)
+			{
+				landmark = std::find_if(m_landmarks.cbegin(), m_landmarks.cend(), [faceId](const SFaceLandmark& item) { return item.id == faceId; });
+				if (landmark == m_landmarks.cend())
+					return EResult::SR_NG;
+			}
+
+			const auto& points = landmark->points;
+			const EResult result = m_pBlendshape->setNeutral(points.data(), static_cast<int>(points.size()));
+			if (result == EResult::SR_OK)
+			{
+				for (auto& face : m_faces)
+					face.weights.clear();
+			}
+			return result;
+		}
+
+		std::vector<std::string> getBlendshapeNames()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_pBlendshape == nullptr)
+				return std::vector<std::string>();
+			return m_pBlendshape->names();
+		}
+
+		EResult setPrecision(const SdmLandmarker::EPrecision precision)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_precision = precision;
+			if (m_pEngine != nullptr)
+				m_pEngine->setPrecision(precision);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief صǰѡ ѼصĲظ #÷#
+		*/
+		EResult loadEngine()
+		{
+			if (m_engineFlag)
+			{
+				if (m_pEngine != nullptr)
+					return EResult::SR_OK;
+
+				auto pEngine = std::make_unique<SdmLandmarker>();
+				const EResult result = pEngine->load(Impl::m_enginePath);
+				if (result != EResult::SR_OK)
+					return result;
+
+				pEngine->setPrecision(m_precision);
+				m_pEngine = std::move(pEngine);
+				return EResult::SR_OK;
+			}
+
+			if (m_pDetector == nullptr)
+			{
+				auto pDetector = std::make_unique<ldmarkmodel>();
+				if (!load_ldmarkmodel(Impl::m_modelPath, Impl::m_modelXmlPath, *pDetector))
+					return EResult::SR_NG;
+				m_pDetector = std::move(pDetector);
+			}
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief blendshapeʱģ ѼصĲظ #÷#
+		*/
+		EResult loadBlendshape()
+		{
+			if (m_blendshapeMode == 0)
+				return EResult::SR_OK;
+
+			if (m_pBlendshape == nullptr)
+			{
+				auto pBlendshape = std::make_unique<BlendshapeSolver>();
+				//δģʱʹõ68
+				const EResult result = Impl::m_blendshapePath.empty() ? pBlendshape->createDefault() : pBlendshape->load(Impl::m_blendshapePath);
+				if (result != EResult::SR_OK)
+					return result;
+				m_pBlendshape = std::move(pBlendshape);
+			}
+
+			m_pBlendshape->setMethod((m_blendshapeMode == 1) ? BlendshapeSolver::EMethod::Linear : BlendshapeSolver::EMethod::BoundedLeastSquares);
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief Ѹٵ ÿԼģϻع #÷#
+		*/
+		EResult alignFaces(const cv::Mat& frameIn, const std::vector<cv::Rect>& faceBoxes, cv::Mat& frameOut)
+		{
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			matchBoxes(faceBoxes);
+
+			if (m_engineFlag)
+			{
+				//SDMģֻ ̹߳ ÿ߳һݹ
+				if (frameIn.channels() == 1)
+					m_gray = frameIn;
+				else
+					cv::cvtColor(frameIn, m_gray, (frameIn.channels() == 4) ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+
+				runOnModels(m_faces.size(), m_workspaces.size(), [&](size_t worker, size_t job)
 				{
-					draw(frameOut, m_currentShape);
-				}
+					alignFace(*m_pEngine, m_gray, m_workspaces[worker], m_faces[job]);
+				});
 			}
+			else
+			{
+				//ģڲһε ̹ܶ߳ ÿ߳һģ
+				const size_t models = ensureModels(m_faces.size());
+				runOnModels(m_faces.size(), models, [&](size_t model, size_t job)
+				{
+					alignFace(model == 0 ? *m_pDetector : *m_workerModels[model - 1], frameIn, m_faces[job]);
+				});
+			}
+
+			removeLost();
+			publish(frameIn.size());
+			render(frameOut);
 
 			return EResult::SR_OK;
 		}
 
 		/**
-		* \@brief ͼ
-		* \@param frameDraw 
-		* \@param data ҪƵ
+		* \@brief ѸٵصĿȷϸ ĿΪ #÷#
+		*/
+		void matchBoxes(const std::vector<cv::Rect>& faceBoxes)
+		{
+			m_matched.assign(m_faces.size(), 0);
+			for (const auto& box : faceBoxes)
+			{
+				int best = -1;
+				float bestOverlap = s_matchOverlap;
+				for (size_t i = 0; i < m_faces.size(); i++)
+				{
+					const float overlap = overlapRatio(box, m_faces[i].box);
+					if (!m_matched[i] && overlap > bestOverlap)
+					{
+						best = static_cast<int>(i);
+						bestOverlap = overlap;
+					}
+				}
+
+				if (best >= 0)
+				{
+					m_matched[best] = 1;
+					m_faces[best].unconfirmed = 0;
+					continue;
+				}
+
+				SFace face;
+				face.id = m_nextId++;
+				face.box = box;
+				m_faces.push_back(face);
+				m_matched.push_back(1);
+			}
+
+			//û֡ Ը֡
+			if (faceBoxes.empty())
+				return;
+			for (size_t i = 0; i < m_faces.size(); i++)
+			{
+				if (!m_matched[i])
+					m_faces[i].unconfirmed++;
+			}
+		}
+
+		/**
+		* \@brief üŵ̶Сع ڲüͼHaarʼ Ѹٵһ֡״ʼ
+		* \@desc üģڲHaarֻῴһ СҲŴ󵽲ᴥ¼ĴС
 		*/
-		void draw(cv::Mat& frameDraw, const cv::Mat& data)
+		static void alignFace(ldmarkmodel& model, const cv::Mat& frame, SFace& face)
 		{
-			int numLandmarks = data.cols / 2;
+			const bool initFlag = face.shape.empty();
+			const float side = static_cast<float>(std::max(face.box.width, face.box.height));
+			if (side <= 0.f)
+			{
+				face.lostFlag = true;
+				return;
+			}
+
+			const float scale = s_faceSize / side;
+			const float cropSide = side * s_cropMargin;
+			const cv::Rect crop
+			(
+				cvRound(face.box.x + face.box.width * 0.5f - cropSide * 0.5f),
+				cvRound(face.box.y + face.box.height * 0.5f - cropSide * 0.5f),
+				cvRound(cropSide), cvRound(cropSide)
+			);
+			const cv::Rect inside = crop & cv::Rect(0, 0, frame.cols, frame.rows);
+			if (inside.area() <= 0)
+			{
+				face.lostFlag = true;
+				return;
+			}
+
+			cv::Mat patch;
+			cv::copyMakeBorder(frame(inside), patch, inside.y - crop.y, crop.br().y - inside.br().y,
+				inside.x - crop.x, crop.br().x - inside.br().x, cv::BORDER_CONSTANT, cv::Scalar::all(0));
+			cv::resize(patch, patch, cv::Size(cvRound(s_faceSize * s_cropMargin), cvRound(s_faceSize * s_cropMargin)), 0, 0, cv::INTER_LINEAR);
+
+			cv::Mat shape;
+			if (!initFlag)
+				shape = transformShape(face.shape, -crop.x, -crop.y, scale);
+
+			if (model.track(patch, shape, initFlag) != 0 || shape.empty())
+			{
+				face.lostFlag = true;
+				return;
+			}
+
+			face.shape = transformShape(shape, 0.f, 0.f, 1.f / scale);
+			const int numLandmarks = face.shape.cols / 2;
 			for (int j = 0; j < numLandmarks; j++)
 			{
-				int x = data.at<float>(j);
-				int y = data.at<float>(j + numLandmarks);
-				std::stringstream ss;
-				ss << j;
+				face.shape.at<float>(j) += crop.x;
+				face.shape.at<float>(j + numLandmarks) += crop.y;
+			}
+			face.box = shapeBox(face.shape);
+		}
 
-				cv::circle(frameDraw, cv::Point(x, y), 2, cv::Scalar(0, 0, 255), -1);
+		/**
+		* \@brief SDM ֱӴƽ״ʼ Ѹٵһ֡״ʼ Ҫü
+		*/
+		static void alignFace(const SdmLandmarker& engine, const cv::Mat& gray, SdmLandmarker::SWorkspace& workspace, SFace& face)
+		{
+			if (face.shape.empty())
+				engine.fit(gray, face.box, face.points, workspace);
+			else
+				engine.track(gray, face.points, workspace);
+
+			const int numLandmarks = static_cast<int>(face.points.size());
+			face.shape.create(1, numLandmarks * 2, CV_32F);
+			for (int j = 0; j < numLandmarks; j++)
+			{
+				face.shape.at<float>(j) = face.points[j].x;
+				face.shape.at<float>(j + numLandmarks) = face.points[j].y;
 			}
+			face.box = shapeBox(face.shape);
+
+			//Ƴͼ Ϊ
+			if (numLandmarks == 0 || (face.box & cv::Rect(0, 0, gray.cols, gray.rows)).area() <= 0)
+				face.lostFlag = true;
+		}
+
+		/**
+		* \@brief (x + offsetX, y + offsetY) * scale #״Ϊxy1 x 2N#
+		*/
+		static cv::Mat transformShape(const cv::Mat& shape, const float offsetX, const float offsetY, const float scale)
+		{
+			cv::Mat result(shape.size(), CV_32F);
+			const int numLandmarks = shape.cols / 2;
+			for (int j = 0; j < numLandmarks; j++)
+			{
+				result.at<float>(j) = (shape.at<float>(j) + offsetX) * scale;
+				result.at<float>(j + numLandmarks) = (shape.at<float>(j + numLandmarks) + offsetY) * scale;
+			}
+			return result;
+		}
+
+		static cv::Rect shapeBox(const cv::Mat& shape)
+		{
+			const int numLandmarks = shape.cols / 2;
+			float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+			for (int j = 0; j < numLandmarks; j++)
+			{
+				minX = std::min(minX, shape.at<float>(j));
+				maxX = std::max(maxX, shape.at<float>(j));
+				minY = std::min(minY, shape.at<float>(j + numLandmarks));
+				maxY = std::max(maxY, shape.at<float>(j + numLandmarks));
+			}
+			if (numLandmarks == 0)
+				return cv::Rect();
+
+			return cv::Rect(cvFloor(minX), cvFloor(minY), cvCeil(maxX - minX) + 1, cvCeil(maxY - minY) + 1);
+		}
+
+		/**
+		* \@brief ռСεı
+		*/
+		static float overlapRatio(const cv::Rect& a, const cv::Rect& b)
+		{
+			const int area = std::min(a.area(), b.area());
+			return (area > 0) ? static_cast<float>((a & b).area()) / area : 0.f;
+		}
+
+		/**
+		* \@brief ɾ ʱûȷϵ ԼͬһϵĽµ #÷#
+		*/
+		void removeLost()
+		{
+			m_faces.erase(std::remove_if(m_faces.begin(), m_faces.end(), [](const SFace& face)
+			{
+				return face.lostFlag || face.unconfirmed > s_maxUnconfirmed;
+			}), m_faces.end());
+
+			for (size_t i = 0; i < m_faces.size(); i++)
+			{
+				for (size_t j = m_faces.size() - 1; j > i; j--)
+				{
+					if (overlapRatio(m_faces[i].box, m_faces[j].box) > s_duplicateOverlap)
+						m_faces.erase(m_faces.begin() + j);
+				}
+			}
+		}
+
+		/**
+		* \@brief landmark #÷#
+		* \@desc ֻ ȶٷڴ
+		* \@desc ͷ̬ʱ ÿһ̬֡ʼ ÿ΢
+		* \@desc blendshapeʱ ÿһ֡Ȩؿʼ ÿ΢
+		*/
+		void publish(const cv::Size& frameSize)
+		{
+			size_t total = 0;
+			for (const auto& face : m_faces)
+				total += face.shape.cols;
+
+			const bool blendshapeFlag = (m_blendshapeMode != 0 && m_pBlendshape != nullptr);
+			const size_t blendshapeNum = blendshapeFlag ? m_pBlendshape->blendshapeNum() : 0;
+
+			m_matrix.resize(total);
+			m_counts.resize(m_faces.size());
+			m_landmarks.resize(m_faces.size());
+			m_weights.resize(m_faces.size() * blendshapeNum);
+			m_ids.resize(m_faces.size());
+			float* out = m_matrix.data();
+			for (size_t i = 0; i < m_faces.size(); i++)
+			{
+				SFace& face = m_faces[i];
+				const int numLandmarks = face.shape.cols / 2;
+				interleave(face.shape, out);
+
+				SFaceLandmark& landmark = m_landmarks[i];
+				landmark.id = face.id;
+				landmark.box = face.box;
+				landmark.points.resize(numLandmarks);
+				for (int j = 0; j < numLandmarks; j++)
+					landmark.points[j] = cv::Point2f(out[j * 2], out[j * 2 + 1]);
+
+				if (m_poseFlag)
+					m_poseEstimator.estimate(landmark.points.data(), numLandmarks, frameSize, face.pose);
+				landmark.pose = face.pose;
+
+				if (blendshapeFlag)
+				{
+					face.weights.resize(blendshapeNum, 0.f);
+					if (!m_pBlendshape->solve(landmark.points.data(), numLandmarks, face.weights.data(), m_blendshapeWorkspace))
+						std::fill(face.weights.begin(), face.weights.end(), 0.f);
+					std::copy(face.weights.begin(), face.weights.end(), m_weights.begin() + i * blendshapeNum);
+					landmark.blendshapes.assign(face.weights.begin(), face.weights.end());
+				}
+				else
+				{
+					landmark.blendshapes.clear();
+				}
+
+				m_ids[i] = face.id;
+				m_counts[i] = numLandmarks;
+				out += numLandmarks * 2;
+			}
+
+			m_SIGNAL_void_vecFloat(m_matrix);
+			m_SIGNAL_void_buffer(m_matrix.data(), m_counts.data(), m_counts.size());
+			m_SIGNAL_void_landmarks(m_landmarks);
+			if (blendshapeFlag)
+				m_SIGNAL_void_blendshapes(m_weights.data(), m_ids.data(), m_ids.size(), blendshapeNum);
+		}
+
+		/**
+		* \@brief ٵĽ ʱ0 #÷#
+		*/
+		void publishShape(const cv::Mat& shape)
+		{
+			const int numLandmarks = shape.cols / 2;
+			m_matrix.resize(numLandmarks * 2);
+			m_counts.assign((numLandmarks > 0) ? 1 : 0, numLandmarks);
+			interleave(shape, m_matrix.data());
+
+			m_SIGNAL_void_vecFloat(m_matrix);
+			m_SIGNAL_void_buffer(m_matrix.data(), m_counts.data(), m_counts.size());
+		}
+
+		/**
+		* \@brief xy1 x 2N״дx0, y0, x1, y1 ...
+		*/
+		static void interleave(const cv::Mat& shape, float* out)
+		{
+			const int numLandmarks = shape.cols / 2;
+			if (numLandmarks == 0)
+				return;
+
+			const float* data = shape.ptr<float>(0);
+			for (int j = 0; j < numLandmarks; j++)
+			{
+				out[j * 2] = data[j];
+				out[j * 2 + 1] = data[j + numLandmarks];
+			}
+		}
+
+		/**
+		* \@brief ̳߳ ÿ߳ڻعʱԼģ #÷#
+		*/
+		void createWorkers()
+		{
+			const size_t threadNum = (m_threadNum == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : m_threadNum;
+
+			m_pPool.reset();
+			m_workerModels.clear();
+
+			//߳Ҳ
+			if (threadNum > 1)
+				m_pPool = std::make_unique<ThreadPool>(threadNum - 1);
+			m_workspaces.resize(threadNum);
+		}
+
+		/**
+		* \@brief ߳õģ ģͽϴ ʱ
+		* \@return õģ
+		*/
+		size_t ensureModels(const size_t faceNum)
+		{
+			const size_t wanted = std::min(faceNum, (m_pPool == nullptr) ? 1 : m_pPool->size() + 1);
+			while (m_workerModels.size() + 1 < wanted)
+			{
+				auto pModel = std::make_unique<ldmarkmodel>();
+				if (!load_ldmarkmodel(Impl::m_modelPath, Impl::m_modelXmlPath, *pModel))
+					break;
+				m_workerModels.push_back(std::move(pModel));
+			}
+			return m_workerModels.size() + 1;
+		}
+
+		/**
+		* \@brief ģ i ± i, i + n, i + 2n ... 
+		*/
+		void runOnModels(const size_t jobNum, const size_t modelNum, const std::function<void(size_t, size_t)>& func)
+		{
+			const size_t workers = std::min(jobNum, modelNum);
+			if (m_pPool == nullptr || workers <= 1)
+			{
+				for (size_t job = 0; job < jobNum; job++)
+					func(0, job);
+				return;
+			}
+
+			m_pPool->parallelFor(0, workers, [&](size_t begin, size_t end)
+			{
+				for (size_t index = begin; index < end; index++)
+				{
+					for (size_t job = index; job < jobNum; job += workers)
+						func(index, job);
+				}
+			});
+		}
+
+		/**
+		* \@brief ѷеһλͼ Ҫʾʱֱӷ #÷#
+		* \@desc ÿһֻһıպ һpolylinesеĵ
+		* \@param frameDraw 
+		*/
+		void render(cv::Mat& frameDraw)
+		{
+			if (frameDraw.empty() || m_matrix.empty())
+				return;
+
+			const size_t pointNum = m_matrix.size() / 2;
+			m_drawPoints.resize(pointNum);
+			m_drawContours.resize(pointNum);
+			m_drawCounts.assign(pointNum, 1);
+			for (size_t j = 0; j < pointNum; j++)
+			{
+				m_drawPoints[j] = cv::Point(cvRound(m_matrix[j * 2]), cvRound(m_matrix[j * 2 + 1]));
+				m_drawContours[j] = &m_drawPoints[j];
+			}
+
+			cv::polylines(frameDraw, m_drawContours.data(), m_drawCounts.data(), static_cast<int>(pointNum), true, cv::Scalar(0, 0, 255), 4);
 		}
 
 	public:
-		std::unique_ptr<ldmarkmodel> m_pDetector;							//!< 
+		std::unique_ptr<ldmarkmodel> m_pDetector;							//!<  Ҳ0̵߳ģ
 		cv::Mat m_currentShape;												//!< 
-		std::vector<float> m_matrix;										//!< landmark
+		std::vector<float> m_matrix;										//!< ĵ x/y һһ
+		std::vector<int> m_counts;											//!< ÿĵ
+		std::vector<cv::Point> m_drawPoints;								//!< 
+		std::vector<const cv::Point*> m_drawContours;
+		std::vector<int> m_drawCounts;
+
+		std::vector<std::unique_ptr<ldmarkmodel>> m_workerModels;			//!< 1Ժ̵߳ģ
+		std::unique_ptr<ThreadPool> m_pPool;								//!< ̳߳
+		size_t m_threadNum;													//!< ߳ Ĭ1::߳ 0::к
+
+		std::unique_ptr<SdmLandmarker> m_pEngine;							//!< SDM ̹߳
+		std::vector<SdmLandmarker::SWorkspace> m_workspaces;				//!< ÿ̵߳Ĺ
+		cv::Mat m_gray;														//!< SDMõĻҶͼ
+		bool m_engineFlag;													//!< ǷʹSDM
+		SdmLandmarker::EPrecision m_precision;								//!< SDMĻع󾫶
+
+		HeadPoseEstimator m_poseEstimator;									//!< ͷ̬
+		bool m_poseFlag;													//!< Ƿͷ̬
+
+		std::unique_ptr<BlendshapeSolver> m_pBlendshape;					//!< landmarkblendshapeȨ
+		BlendshapeSolver::SWorkspace m_blendshapeWorkspace;
+		std::vector<float> m_weights;										//!< Ȩ һһ
+		std::vector<int> m_ids;												//!< ÿid
+		int m_blendshapeMode;												//!< 0::ر 1::ģ 2::нС
+
+		std::vector<SFace> m_faces;											//!< е
+		std::vector<unsigned char> m_matched;								//!< ֡Ƿ
+		std::vector<SFaceLandmark> m_landmarks;								//!< 
+		std::vector<cv::Rect> m_pendingBoxes;								//!< setFaceBoxes һdetectʹ
+		int m_nextId;
+		bool m_boxesFlag;													//!< Ƿ
 
 		std::atomic_bool m_initFlag;
 		std::mutex m_mutex;													//!< 
 
 		Signal<void(const std::vector<float>&)> m_SIGNAL_void_vecFloat;		//!< źŲ
 		Slot m_SLOT_void_vecFloat;
+		Signal<void(const std::vector<SFaceLandmark>&)> m_SIGNAL_void_landmarks;
+		Slot m_SLOT_void_landmarks;
+		Signal<void(const float*, const int*, const size_t)> m_SIGNAL_void_buffer;
+		Slot m_SLOT_void_buffer;
+		Signal<void(const float*, const int*, const size_t, const size_t)> m_SIGNAL_void_blendshapes;
+		Slot m_SLOT_void_blendshapes;
+
+		const static float s_faceSize;										//!< üͼı߳
+		const static float s_cropMargin;									//!< ü֮߳߳
+		const static float s_matchOverlap;									//!< еΪͬһص
+		const static float s_duplicateOverlap;								//!< ŸеΪظص
+		const static size_t s_maxUnconfirmed;								//!< ûȷʱٵ֡
 
 		static std::string m_modelPath;										//!< Modelļ·
 		static std::string m_modelXmlPath;									//!< ModelXmlļ·
+		static std::string m_enginePath;									//!< SDMģļ·
+		static std::string m_blendshapePath;								//!< blendshapeģļ·
 		const static string s_version;										//!< 汾Ϣ
 	};
 
 	
 	std::string FaceLandmark::Impl::m_modelPath = "";
 	std::string FaceLandmark::Impl::m_modelXmlPath = "";
+	std::string FaceLandmark::Impl::m_enginePath = "";
+	std::string FaceLandmark::Impl::m_blendshapePath = "";
+	const float FaceLandmark::Impl::s_faceSize = 128.f;
+	const float FaceLandmark::Impl::s_cropMargin = 2.f;
+	const float FaceLandmark::Impl::s_matchOverlap = 0.3f;
+	const float FaceLandmark::Impl::s_duplicateOverlap = 0.6f;
+	const size_t FaceLandmark::Impl::s_maxUnconfirmed = 3;
 
 #if( _MSC_TOOLSET_VER_ == 140 )
 	#ifdef NDEBUG
@@ -192,6 +845,26 @@ namespace Ghost
 		return EResult::SR_OK;
 	}
 
+	EResult FaceLandmark::setEnginePath(const string& enginePath) noexcept(true)
+	{
+		if (!fs::exists(enginePath))
+			return EResult::SR_Model_Path_Not_Exist;
+
+		FaceLandmark::Impl::m_enginePath = enginePath;
+
+		return EResult::SR_OK;
+	}
+
+	EResult FaceLandmark::setBlendshapePath(const string& blendshapePath) noexcept(true)
+	{
+		if (!fs::exists(blendshapePath))
+			return EResult::SR_Model_Path_Not_Exist;
+
+		FaceLandmark::Impl::m_blendshapePath = blendshapePath;
+
+		return EResult::SR_OK;
+	}
+
 	const string& FaceLandmark::getVersion() noexcept(true)
 	{
 		return FaceLandmark::Impl::s_version;
@@ -219,6 +892,25 @@ namespace Ghost
 
 	EResult FaceLandmark::setModualParam(const EModualParamType type, const float value)
 	{
+		switch (type)
+		{
+		case EModualParamType::TYPE_Face_Landmark_Threads:
+			return m_pImpl->setThreadNum(static_cast<size_t>(std::max(0.f, value)));
+		case EModualParamType::TYPE_Face_Landmark_Engine:
+			return m_pImpl->setEngine(value > 0.5f);
+		case EModualParamType::TYPE_Face_Landmark_HeadPose:
+			m_pImpl->setHeadPose(value > 0.5f);
+			return EResult::SR_OK;
+		case EModualParamType::TYPE_Face_Landmark_Precision:
+			return m_pImpl->setPrecision(static_cast<SdmLandmarker::EPrecision>(std::min(2, std::max(0, cvRound(value)))));
+		case EModualParamType::TYPE_Face_Landmark_Blendshape:
+			return m_pImpl->setBlendshape(std::min(2, std::max(0, cvRound(value))));
+		case EModualParamType::TYPE_Face_Landmark_Blendshape_Neutral:
+			return m_pImpl->setNeutral(cvRound(value));
+		default:
+			break;
+		}
+
 		return EResult::SR_OK;
 	}
 
@@ -227,6 +919,21 @@ namespace Ghost
 		return m_pImpl->detect(frameIn, frameOut);
 	}
 
+	EResult FaceLandmark::detectFaces(const cv::Mat& frameIn, const std::vector<cv::Rect>& faceBoxes, cv::Mat& frameOut)
+	{
+		return m_pImpl->detectFaces(frameIn, faceBoxes, frameOut);
+	}
+
+	void FaceLandmark::setFaceBoxes(const std::vector<Ghost::SRect>& faces)
+	{
+		m_pImpl->setFaceBoxes(faces);
+	}
+
+	std::vector<std::string> FaceLandmark::getBlendshapeNames()
+	{
+		return m_pImpl->getBlendshapeNames();
+	}
+
 	EDetectModual FaceLandmark::getModualType() noexcept(true)
 	{
 		return EDetectModual::HumanFace_LandMark;
@@ -239,6 +946,21 @@ namespace Ghost
 
 	void FaceLandmark::bindSlotLandMarkFind(const std::function<void(const std::vector<float>&)>& func)
 	{
+		m_pImpl->m_SLOT_void_vecFloat = m_pImpl->m_SIGNAL_void_vecFloat.connect(func);
+	}
+
+	void FaceLandmark::bindSlotLandmarkBuffer(const std::function<void(const float*, const int*, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_buffer = m_pImpl->m_SIGNAL_void_buffer.connect(func);
+	}
 
+	void FaceLandmark::bindSlotFacesLandmark(const std::function<void(const std::vector<SFaceLandmark>&)>& func)
+	{
+		m_pImpl->m_SLOT_void_landmarks = m_pImpl->m_SIGNAL_void_landmarks.connect(func);
+	}
+
+	void FaceLandmark::bindSlotBlendshapes(const std::function<void(const float*, const int*, const size_t, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_blendshapes = m_pImpl->m_SIGNAL_void_blendshapes.connect(func);
 	}
 }///namespace Ghost
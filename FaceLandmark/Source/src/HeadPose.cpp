@@ -0,0 +1,195 @@
+#include "HeadPose.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_warmIterations = 3;
+		constexpr int s_coldIterations = 8;
+		constexpr double s_radToDeg = 57.29577951308232;
+
+		//landmarks of the mean face used, iBUG 300-W indices
+		const int s_modelIndex[HeadPoseEstimator::s_modelNum] = { 17, 21, 22, 26, 36, 39, 42, 45, 31, 35, 48, 54, 57, 8 };
+
+		//mean face in camera axes (x right, y down, z away from the camera) looking into the camera, about centimetres
+		const double s_modelPoints[HeadPoseEstimator::s_modelNum][3] =
+		{
+			{ -6.825897, -6.760612, -4.402142 },	{ -1.330353, -7.122144, -6.903745 },	//brows
+			{ 1.330353, -7.122144, -6.903745 },		{ 6.825897, -6.760612, -4.402142 },
+			{ -5.311432, -5.485328, -3.987654 },	{ -1.789930, -5.393625, -4.413414 },	//eye corners
+			{ 1.789930, -5.393625, -4.413414 },		{ 5.311432, -5.485328, -3.987654 },
+			{ -2.005628, -1.409845, -6.165652 },	{ 2.005628, -1.409845, -6.165652 },		//nose wings
+			{ -2.774015, 2.080775, -5.048531 },		{ 2.774015, 2.080775, -5.048531 },		//mouth corners
+			{ 0.000000, 3.116408, -6.097667 },		{ 0.000000, 7.415691, -4.070434 }		//lower lip, chin
+		};
+
+		/**
+		* \@brief Rotation of angle |w| about w
+		*/
+		inline cv::Matx33d rodrigues(const cv::Vec3d& w)
+		{
+			const double theta = std::sqrt(w.dot(w));
+			const cv::Matx33d cross(0.0, -w[2], w[1], w[2], 0.0, -w[0], -w[1], w[0], 0.0);
+			if (theta < 1e-12)
+				return cv::Matx33d::eye() + cross;
+
+			const double a = std::sin(theta) / theta;
+			const double b = (1.0 - std::cos(theta)) / (theta * theta);
+			return cv::Matx33d::eye() + cross * a + cross * cross * b;
+		}
+	}
+
+	HeadPoseEstimator::HeadPoseEstimator()
+		:
+		m_focalLength(0.f),
+		m_maxError(0.08f)
+	{
+	}
+
+	bool HeadPoseEstimator::estimate(const cv::Point2f* points, const int pointNum, const cv::Size& frameSize, SHeadPose& pose) const
+	{
+		if (points == nullptr || pointNum != s_landmarkNum || frameSize.area() <= 0)
+		{
+			pose.valid = false;
+			return false;
+		}
+
+		cv::Point2f observed[s_modelNum];
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		for (int i = 0; i < s_modelNum; i++)
+		{
+			observed[i] = points[s_modelIndex[i]];
+			minX = std::min(minX, observed[i].x);
+			maxX = std::max(maxX, observed[i].x);
+			minY = std::min(minY, observed[i].y);
+			maxY = std::max(maxY, observed[i].y);
+		}
+		const double maxError = m_maxError * std::max({ maxX - minX, maxY - minY, 1.f });
+
+		const double focal = (m_focalLength > 0.f) ? m_focalLength : std::max(frameSize.width, frameSize.height);
+		const cv::Point2d center(frameSize.width * 0.5, frameSize.height * 0.5);
+
+		//上一帧的姿态作为初值 只迭代几步
+		cv::Matx33d rotation;
+		cv::Vec3d translation;
+		double error = -1.0;
+		if (pose.valid)
+		{
+			rotation = pose.rotation;
+			translation = pose.translation;
+			error = refine(observed, focal, center, rotation, translation, s_warmIterations);
+		}
+
+		//没有初值或者没有收敛 EPnP重新开始
+		if (error < 0.0 || error > maxError)
+		{
+			cv::Point3f model[s_modelNum];
+			for (int i = 0; i < s_modelNum; i++)
+				model[i] = cv::Point3f(static_cast<float>(s_modelPoints[i][0]), static_cast<float>(s_modelPoints[i][1]), static_cast<float>(s_modelPoints[i][2]));
+
+			const cv::Matx33d camera(focal, 0.0, center.x, 0.0, focal, center.y, 0.0, 0.0, 1.0);
+			cv::Vec3d rvec, tvec;
+			if (!cv::solvePnP(cv::Mat(s_modelNum, 1, CV_32FC3, model), cv::Mat(s_modelNum, 1, CV_32FC2, observed),
+				camera, cv::noArray(), rvec, tvec, false, cv::SOLVEPNP_EPNP))
+			{
+				pose.valid = false;
+				return false;
+			}
+
+			rotation = rodrigues(rvec);
+			translation = tvec;
+			error = refine(observed, focal, center, rotation, translation, s_coldIterations);
+		}
+
+		pose.valid = (error >= 0.0 && error <= maxError);
+		if (!pose.valid)
+			return false;
+
+		//R = Rz(roll) * Ry(yaw) * Rx(pitch)
+		pose.rotation = rotation;
+		pose.translation = translation;
+		pose.error = static_cast<float>(error);
+		pose.yaw = static_cast<float>(std::asin(std::min(1.0, std::max(-1.0, -rotation(2, 0)))) * s_radToDeg);
+		pose.pitch = static_cast<float>(std::atan2(rotation(2, 1), rotation(2, 2)) * s_radToDeg);
+		pose.roll = static_cast<float>(std::atan2(rotation(1, 0), rotation(0, 0)) * s_radToDeg);
+
+		return true;
+	}
+
+	double HeadPoseEstimator::refine(const cv::Point2f* observed, const double focal, const cv::Point2d& center,
+		cv::Matx33d& rotation, cv::Vec3d& translation, const int iterations) const
+	{
+		double squared = 0.0;
+		for (int iteration = 0; iteration <= iterations; iteration++)
+		{
+			cv::Matx66d normal = cv::Matx66d::zeros();
+			cv::Vec6d gradient = cv::Vec6d::all(0.0);
+			squared = 0.0;
+
+			for (int i = 0; i < s_modelNum; i++)
+			{
+				const cv::Vec3d rotated = rotation * cv::Vec3d(s_modelPoints[i][0], s_modelPoints[i][1], s_modelPoints[i][2]);
+				const cv::Vec3d camera = rotated + translation;
+				if (camera[2] <= 1e-6)
+					return -1.0;
+
+				const double inverseZ = 1.0 / camera[2];
+				const double u = focal * camera[0] * inverseZ + center.x;
+				const double v = focal * camera[1] * inverseZ + center.y;
+				const double residual[2] = { u - observed[i].x, v - observed[i].y };
+				squared += residual[0] * residual[0] + residual[1] * residual[1];
+				if (iteration == iterations)
+					continue;
+
+				//d(u, v)/dP, dP/dw = -[R * X]x, dP/dt = I
+				const double du[3] = { focal * inverseZ, 0.0, -focal * camera[0] * inverseZ * inverseZ };
+				const double dv[3] = { 0.0, focal * inverseZ, -focal * camera[1] * inverseZ * inverseZ };
+				const double* rows[2] = { du, dv };
+				for (int r = 0; r < 2; r++)
+				{
+					const double* d = rows[r];
+					const double jacobian[6] =
+					{
+						-d[1] * rotated[2] + d[2] * rotated[1],
+						d[0] * rotated[2] - d[2] * rotated[0],
+						-d[0] * rotated[1] + d[1] * rotated[0],
+						d[0], d[1], d[2]
+					};
+					for (int a = 0; a < 6; a++)
+					{
+						gradient[a] += jacobian[a] * residual[r];
+						for (int b = a; b < 6; b++)
+							normal(a, b) += jacobian[a] * jacobian[b];
+					}
+				}
+			}
+			if (iteration == iterations)
+				break;
+
+			//对角线加一点阻尼 远离最优时也不发散
+			for (int a = 0; a < 6; a++)
+			{
+				normal(a, a) *= 1.0 + 1e-3;
+				for (int b = 0; b < a; b++)
+					normal(a, b) = normal(b, a);
+			}
+
+			const cv::Vec6d step = normal.solve(-gradient, cv::DECOMP_CHOLESKY);
+			rotation = rodrigues(cv::Vec3d(step[0], step[1], step[2])) * rotation;
+			translation += cv::Vec3d(step[3], step[4], step[5]);
+
+			if (step.dot(step) < 1e-12)
+			{
+				iteration = iterations - 1;		//收敛 只剩最后一次计算误差
+			}
+		}
+
+		return std::sqrt(squared / s_modelNum);
+	}
+}///namespace Ghost
@@ -0,0 +1,884 @@
+#include "SdmLandmarker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_patchSide = SdmLandmarker::s_patchSize + 2;		//samples per side with the gradient border
+		constexpr int s_patchStride = 48;								//row stride of the sampled patch, a multiple of every lane count
+		constexpr int s_blockCols = 2048;								//regressor columns per block, the slice of x stays in L1
+		constexpr int s_fileVersion = 1;
+		const char s_fileMagic[4] = { 'G', 'S', 'D', 'M' };
+
+		//cos/sin of twice the bin orientations, the gradient is turned into (|g| cos 2t, |g| sin 2t) so opposite directions share a bin
+		const float s_binCos[SdmLandmarker::s_binNum] = { 1.f, 0.766044f, 0.173648f, -0.5f, -0.939693f, -0.939693f, -0.5f, 0.173648f, 0.766044f };
+		const float s_binSin[SdmLandmarker::s_binNum] = { 0.f, 0.642788f, 0.984808f, 0.866025f, 0.342020f, -0.342020f, -0.866025f, -0.984808f, -0.642788f };
+
+		//sample index of every lane
+		alignas(64) const float s_ramp[s_patchStride] =
+		{
+			0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+			24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47
+		};
+
+		inline uint32_t floatBits(const float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		inline float bitsFloat(const uint32_t bits)
+		{
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		/**
+		* \@brief IEEE half, round to nearest #used when packing only#
+		*/
+		inline uint16_t floatToHalf(const float value)
+		{
+			const uint32_t bits = floatBits(value);
+			const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+			const int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127 + 15;
+			uint32_t mantissa = bits & 0x7fffffu;
+
+			if (exponent >= 31)
+				return static_cast<uint16_t>(sign | 0x7c00u);
+			if (exponent <= 0)
+			{
+				if (exponent < -10)
+					return sign;
+				mantissa |= 0x800000u;
+				const int shift = 14 - exponent;
+				uint32_t half = mantissa >> shift;
+				if ((mantissa >> (shift - 1)) & 1u)
+					half++;
+				return static_cast<uint16_t>(sign | half);
+			}
+
+			uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+			if (mantissa & 0x1000u)
+				half++;													//a carry rounds up into the exponent
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		/**
+		* \@brief Half to float by rebiasing the exponent #no inf/nan in the weights#
+		* \@desc half denormals are built as 2^-14 * (1 + m) - 2^-14, a float multiply would see denormal inputs and stall
+		*/
+		inline float halfToFloat(const uint16_t half)
+		{
+			const uint32_t bits = static_cast<uint32_t>(half & 0x7fffu) << 13;
+			const float magnitude = ((bits & 0x0f800000u) != 0) ? bitsFloat(bits + (112u << 23))
+				: bitsFloat(bits + (113u << 23)) - bitsFloat(113u << 23);
+			return bitsFloat(floatBits(magnitude) | (static_cast<uint32_t>(half & 0x8000u) << 16));
+		}
+
+		/**
+		* \@brief Lane operations, one struct per instruction set, the kernels below are written once against them
+		*/
+		struct OpsScalar
+		{
+			static const int lanes = 1;
+			using VI = int32_t;
+			using VF = float;
+
+			static VF loadf(const float* p) { return *p; }
+			static void storef(float* p, const VF a) { *p = a; }
+			static VF setf(const float a) { return a; }
+			static VF addf(const VF a, const VF b) { return a + b; }
+			static VF subf(const VF a, const VF b) { return a - b; }
+			static VF mulf(const VF a, const VF b) { return a * b; }
+			static VF divf(const VF a, const VF b) { return a / b; }
+			static VF fmadd(const VF a, const VF b, const VF c) { return a * b + c; }
+			static VF maxf(const VF a, const VF b) { return std::max(a, b); }
+			static VF minf(const VF a, const VF b) { return std::min(a, b); }
+			static VF sqrtf(const VF a) { return std::sqrt(a); }
+			static VF floorf(const VF a) { return std::floor(a); }
+			static VI cvtt(const VF a) { return static_cast<int32_t>(a); }
+			static VF gather(const float* base, const VI index) { return base[index]; }
+			static VF loadw(const float* p) { return *p; }
+			static VF loadw(const uint16_t* p) { return halfToFloat(*p); }
+			static VF loadw(const int8_t* p) { return static_cast<float>(*p); }
+		};
+
+		struct OpsSse41
+		{
+			static const int lanes = 4;
+			using VI = __m128i;
+			using VF = __m128;
+
+			GHOST_TARGET_SSE41 static VF loadf(const float* p) { return _mm_loadu_ps(p); }
+			GHOST_TARGET_SSE41 static void storef(float* p, const VF a) { _mm_storeu_ps(p, a); }
+			GHOST_TARGET_SSE41 static VF setf(const float a) { return _mm_set1_ps(a); }
+			GHOST_TARGET_SSE41 static VF addf(const VF a, const VF b) { return _mm_add_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF subf(const VF a, const VF b) { return _mm_sub_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF mulf(const VF a, const VF b) { return _mm_mul_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF divf(const VF a, const VF b) { return _mm_div_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF fmadd(const VF a, const VF b, const VF c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+			GHOST_TARGET_SSE41 static VF maxf(const VF a, const VF b) { return _mm_max_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF minf(const VF a, const VF b) { return _mm_min_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF sqrtf(const VF a) { return _mm_sqrt_ps(a); }
+			GHOST_TARGET_SSE41 static VF floorf(const VF a) { return _mm_floor_ps(a); }
+			GHOST_TARGET_SSE41 static VI cvtt(const VF a) { return _mm_cvttps_epi32(a); }
+			GHOST_TARGET_SSE41 static VF gather(const float* base, const VI index)
+			{
+				//no gather before AVX2
+				return _mm_setr_ps(base[_mm_cvtsi128_si32(index)], base[_mm_extract_epi32(index, 1)],
+					base[_mm_extract_epi32(index, 2)], base[_mm_extract_epi32(index, 3)]);
+			}
+			GHOST_TARGET_SSE41 static VF loadw(const float* p) { return _mm_load_ps(p); }
+			GHOST_TARGET_SSE41 static VF loadw(const uint16_t* p)
+			{
+				//no F16C before AVX2, same rebias as halfToFloat
+				const __m128i half = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+				const __m128i sign = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16);
+				const __m128i bits = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7fff)), 13);
+				const __m128i denormal = _mm_cmpeq_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x0f800000)), _mm_setzero_si128());
+				const __m128 normal = _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(112 << 23)));
+				const __m128 small = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(113 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+				return _mm_or_ps(_mm_blendv_ps(normal, small, _mm_castsi128_ps(denormal)), _mm_castsi128_ps(sign));
+			}
+			GHOST_TARGET_SSE41 static VF loadw(const int8_t* p)
+			{
+				int32_t packed;
+				std::memcpy(&packed, p, sizeof(packed));
+				return _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(packed)));
+			}
+		};
+
+		struct OpsAvx2
+		{
+			static const int lanes = 8;
+			using VI = __m256i;
+			using VF = __m256;
+
+			GHOST_TARGET_AVX2 static VF loadf(const float* p) { return _mm256_loadu_ps(p); }
+			GHOST_TARGET_AVX2 static void storef(float* p, const VF a) { _mm256_storeu_ps(p, a); }
+			GHOST_TARGET_AVX2 static VF setf(const float a) { return _mm256_set1_ps(a); }
+			GHOST_TARGET_AVX2 static VF addf(const VF a, const VF b) { return _mm256_add_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF subf(const VF a, const VF b) { return _mm256_sub_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF mulf(const VF a, const VF b) { return _mm256_mul_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF divf(const VF a, const VF b) { return _mm256_div_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF fmadd(const VF a, const VF b, const VF c) { return _mm256_fmadd_ps(a, b, c); }
+			GHOST_TARGET_AVX2 static VF maxf(const VF a, const VF b) { return _mm256_max_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF minf(const VF a, const VF b) { return _mm256_min_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF sqrtf(const VF a) { return _mm256_sqrt_ps(a); }
+			GHOST_TARGET_AVX2 static VF floorf(const VF a) { return _mm256_floor_ps(a); }
+			GHOST_TARGET_AVX2 static VI cvtt(const VF a) { return _mm256_cvttps_epi32(a); }
+			GHOST_TARGET_AVX2 static VF gather(const float* base, const VI index) { return _mm256_i32gather_ps(base, index, 4); }
+			GHOST_TARGET_AVX2 static VF loadw(const float* p) { return _mm256_load_ps(p); }
+			GHOST_TARGET_AVX2 static VF loadw(const uint16_t* p) { return _mm256_cvtph_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(p))); }
+			GHOST_TARGET_AVX2 static VF loadw(const int8_t* p) { return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))); }
+		};
+
+		struct OpsAvx512
+		{
+			static const int lanes = 16;
+			using VI = __m512i;
+			using VF = __m512;
+
+			GHOST_TARGET_AVX512 static VF loadf(const float* p) { return _mm512_loadu_ps(p); }
+			GHOST_TARGET_AVX512 static void storef(float* p, const VF a) { _mm512_storeu_ps(p, a); }
+			GHOST_TARGET_AVX512 static VF setf(const float a) { return _mm512_set1_ps(a); }
+			GHOST_TARGET_AVX512 static VF addf(const VF a, const VF b) { return _mm512_add_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF subf(const VF a, const VF b) { return _mm512_sub_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF mulf(const VF a, const VF b) { return _mm512_mul_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF divf(const VF a, const VF b) { return _mm512_div_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF fmadd(const VF a, const VF b, const VF c) { return _mm512_fmadd_ps(a, b, c); }
+			GHOST_TARGET_AVX512 static VF maxf(const VF a, const VF b) { return _mm512_max_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF minf(const VF a, const VF b) { return _mm512_min_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF sqrtf(const VF a) { return _mm512_sqrt_ps(a); }
+			GHOST_TARGET_AVX512 static VF floorf(const VF a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+			GHOST_TARGET_AVX512 static VI cvtt(const VF a) { return _mm512_cvttps_epi32(a); }
+			GHOST_TARGET_AVX512 static VF gather(const float* base, const VI index) { return _mm512_i32gather_ps(index, base, 4); }
+			GHOST_TARGET_AVX512 static VF loadw(const float* p) { return _mm512_load_ps(p); }
+			GHOST_TARGET_AVX512 static VF loadw(const uint16_t* p) { return _mm512_cvtph_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(p))); }
+			GHOST_TARGET_AVX512 static VF loadw(const int8_t* p) { return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(p)))); }
+		};
+
+		/**
+		* \@brief Descriptor of one landmark
+		* \@desc 1. bilinear samples on a (s_patchSize + 2)^2 grid of pitch side / s_patchSize, lanes samples of a row per instruction
+		* \@desc 2. central differences, each gradient votes max(0, |g| cos 2(t - t_bin)) into every bin, summed per 8x8 cell
+		* \@desc 3. L2 normalized, clipped at 0.2 and normalized again
+		* \@param image:: float image, width and height at least 2
+		*/
+		template<class Ops>
+		inline void describe(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor)
+		{
+			using VF = typename Ops::VF;
+			using VI = typename Ops::VI;
+			constexpr int L = Ops::lanes;
+			constexpr int P = SdmLandmarker::s_patchSize;
+			constexpr int B = SdmLandmarker::s_binNum;
+			constexpr int C = SdmLandmarker::s_cellSize;
+			constexpr int X = s_patchStride / L;
+
+			const float step = side / P;
+			const float origin = (s_patchSide - 1) * 0.5f;
+
+			//the columns sampled are the same for every row
+			const VF zero = Ops::setf(0.f);
+			const VF maxX = Ops::setf(static_cast<float>(width - 1)), lastX = Ops::setf(static_cast<float>(width - 2));
+			VI columnIndex[X];
+			VF columnFraction[X];
+			for (int v = 0; v < X; v++)
+			{
+				const VF x = Ops::minf(Ops::maxf(Ops::fmadd(Ops::subf(Ops::loadf(s_ramp + v * L), Ops::setf(origin)), Ops::setf(step), Ops::setf(centerX)), zero), maxX);
+				const VF x0 = Ops::minf(Ops::floorf(x), lastX);
+				columnIndex[v] = Ops::cvtt(x0);
+				columnFraction[v] = Ops::subf(x, x0);
+			}
+
+			for (int r = 0; r < s_patchSide; r++)
+			{
+				const float y = std::min(std::max(centerY + (r - origin) * step, 0.f), static_cast<float>(height - 1));
+				const int y0 = std::min(static_cast<int>(y), height - 2);
+				const VF fy = Ops::setf(y - y0);
+				const float* top = image + static_cast<size_t>(y0) * width;
+				const float* bottom = top + width;
+
+				float* row = patch + r * s_patchStride;
+				for (int v = 0; v < X; v++)
+				{
+					const VF a = Ops::gather(top, columnIndex[v]), b = Ops::gather(top + 1, columnIndex[v]);
+					const VF c = Ops::gather(bottom, columnIndex[v]), d = Ops::gather(bottom + 1, columnIndex[v]);
+					const VF upper = Ops::fmadd(columnFraction[v], Ops::subf(b, a), a);
+					const VF lower = Ops::fmadd(columnFraction[v], Ops::subf(d, c), c);
+					Ops::storef(row + v * L, Ops::fmadd(fy, Ops::subf(lower, upper), upper));
+				}
+			}
+
+			VF binCos[B], binSin[B];
+			for (int b = 0; b < B; b++)
+			{
+				binCos[b] = Ops::setf(s_binCos[b]);
+				binSin[b] = Ops::setf(s_binSin[b]);
+			}
+			const VF epsilon = Ops::setf(1e-6f), two = Ops::setf(2.f);
+
+			for (int cellY = 0; cellY < SdmLandmarker::s_cellNum; cellY++)
+			{
+				std::fill_n(columns, B * P, 0.f);
+
+				for (int r = cellY * C + 1; r <= cellY * C + C; r++)
+				{
+					const float* up = patch + (r - 1) * s_patchStride + 1;
+					const float* row = patch + r * s_patchStride;
+					const float* down = patch + (r + 1) * s_patchStride + 1;
+
+					for (int c = 0; c < P; c += L)
+					{
+						const VF gx = Ops::subf(Ops::loadf(row + c + 2), Ops::loadf(row + c));
+						const VF gy = Ops::subf(Ops::loadf(down + c), Ops::loadf(up + c));
+						const VF xx = Ops::mulf(gx, gx), yy = Ops::mulf(gy, gy);
+						const VF inverse = Ops::divf(Ops::setf(1.f), Ops::sqrtf(Ops::addf(Ops::addf(xx, yy), epsilon)));
+						const VF cos2 = Ops::mulf(Ops::subf(xx, yy), inverse);
+						const VF sin2 = Ops::mulf(Ops::mulf(two, Ops::mulf(gx, gy)), inverse);
+
+						for (int b = 0; b < B; b++)
+						{
+							const VF vote = Ops::maxf(Ops::fmadd(cos2, binCos[b], Ops::mulf(sin2, binSin[b])), zero);
+							Ops::storef(columns + b * P + c, Ops::addf(Ops::loadf(columns + b * P + c), vote));
+						}
+					}
+				}
+
+				for (int cellX = 0; cellX < SdmLandmarker::s_cellNum; cellX++)
+				{
+					float* cell = descriptor + (cellY * SdmLandmarker::s_cellNum + cellX) * B;
+					for (int b = 0; b < B; b++)
+					{
+						const float* column = columns + b * P + cellX * C;
+						float sum = 0.f;
+						for (int i = 0; i < C; i++)
+							sum += column[i];
+						cell[b] = sum;
+					}
+				}
+			}
+
+			//SIFT style normalization, strong edges do not dominate
+			for (int pass = 0; pass < 2; pass++)
+			{
+				float norm = 0.f;
+				for (int i = 0; i < SdmLandmarker::s_descriptorSize; i++)
+					norm += descriptor[i] * descriptor[i];
+				const float inverse = 1.f / std::sqrt(norm + 1e-12f);
+				for (int i = 0; i < SdmLandmarker::s_descriptorSize; i++)
+					descriptor[i] = (pass == 0) ? std::min(descriptor[i] * inverse, 0.2f) : descriptor[i] * inverse;
+			}
+		}
+
+		/**
+		* \@brief y += W * x over the packed panels, weights are read exactly once
+		* \@desc the columns are walked in blocks of s_blockCols so the slice of x is reused from L1 by every panel,
+		* \@desc two accumulator sets over even and odd columns hide the FMA latency
+		*/
+		template<class Ops, class T>
+		inline void gemvPacked(const T* weights, const int panels, const int cols, const float* x, float* y)
+		{
+			using VF = typename Ops::VF;
+			constexpr int L = Ops::lanes;
+			constexpr int R = SdmLandmarker::s_panelRows;
+			constexpr int V = R / L;
+
+			for (int kBegin = 0; kBegin < cols; kBegin += s_blockCols)
+			{
+				const int kEnd = std::min(cols, kBegin + s_blockCols);
+				for (int panel = 0; panel < panels; panel++)
+				{
+					const T* w = weights + (static_cast<size_t>(panel) * cols + kBegin) * R;
+					float* out = y + panel * R;
+
+					VF even[V], odd[V];
+					for (int v = 0; v < V; v++)
+					{
+						even[v] = Ops::loadf(out + v * L);
+						odd[v] = Ops::setf(0.f);
+					}
+
+					int k = kBegin;
+					for (; k + 1 < kEnd; k += 2, w += 2 * R)
+					{
+						const VF x0 = Ops::setf(x[k]), x1 = Ops::setf(x[k + 1]);
+						for (int v = 0; v < V; v++)
+						{
+							even[v] = Ops::fmadd(Ops::loadw(w + v * L), x0, even[v]);
+							odd[v] = Ops::fmadd(Ops::loadw(w + R + v * L), x1, odd[v]);
+						}
+					}
+					if (k < kEnd)
+					{
+						const VF x0 = Ops::setf(x[k]);
+						for (int v = 0; v < V; v++)
+							even[v] = Ops::fmadd(Ops::loadw(w + v * L), x0, even[v]);
+					}
+
+					for (int v = 0; v < V; v++)
+						Ops::storef(out + v * L, Ops::addf(even[v], odd[v]));
+				}
+			}
+		}
+
+		inline void describeScalar(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor)
+		{
+			describe<OpsScalar>(image, width, height, centerX, centerY, side, patch, columns, descriptor);
+		}
+
+		GHOST_TARGET_SSE41 GHOST_FLATTEN inline void describeSse41(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor)
+		{
+			describe<OpsSse41>(image, width, height, centerX, centerY, side, patch, columns, descriptor);
+		}
+
+		GHOST_TARGET_AVX2 GHOST_FLATTEN inline void describeAvx2(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor)
+		{
+			describe<OpsAvx2>(image, width, height, centerX, centerY, side, patch, columns, descriptor);
+		}
+
+		GHOST_TARGET_AVX512 GHOST_FLATTEN inline void describeAvx512(const float* image, const int width, const int height,
+			const float centerX, const float centerY, const float side, float* patch, float* columns, float* descriptor)
+		{
+			describe<OpsAvx512>(image, width, height, centerX, centerY, side, patch, columns, descriptor);
+		}
+
+		template<class T>
+		inline void gemvScalar(const void* weights, const int panels, const int cols, const float* x, float* y)
+		{
+			gemvPacked<OpsScalar>(static_cast<const T*>(weights), panels, cols, x, y);
+		}
+
+		template<class T>
+		GHOST_TARGET_SSE41 GHOST_FLATTEN inline void gemvSse41(const void* weights, const int panels, const int cols, const float* x, float* y)
+		{
+			gemvPacked<OpsSse41>(static_cast<const T*>(weights), panels, cols, x, y);
+		}
+
+		template<class T>
+		GHOST_TARGET_AVX2 GHOST_FLATTEN inline void gemvAvx2(const void* weights, const int panels, const int cols, const float* x, float* y)
+		{
+			gemvPacked<OpsAvx2>(static_cast<const T*>(weights), panels, cols, x, y);
+		}
+
+		template<class T>
+		GHOST_TARGET_AVX512 GHOST_FLATTEN inline void gemvAvx512(const void* weights, const int panels, const int cols, const float* x, float* y)
+		{
+			gemvPacked<OpsAvx512>(static_cast<const T*>(weights), panels, cols, x, y);
+		}
+
+		/**
+		* \@brief Larger side of the bounding box of the points
+		*/
+		inline float shapeSize(const std::vector<cv::Point2f>& shape, cv::Rect2f& bounds)
+		{
+			float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+			for (const auto& point : shape)
+			{
+				minX = std::min(minX, point.x);
+				maxX = std::max(maxX, point.x);
+				minY = std::min(minY, point.y);
+				maxY = std::max(maxY, point.y);
+			}
+			bounds = cv::Rect2f(minX, minY, maxX - minX, maxY - minY);
+			return std::max({ maxX - minX, maxY - minY, 1.f });
+		}
+	}
+
+	SdmLandmarker::SdmLandmarker()
+		:
+		m_precision(EPrecision::FP32),
+		m_isa(simd::EIsa::Scalar),
+		m_describe(nullptr),
+		m_gemv(nullptr)
+	{
+		setIsa(simd::bestIsa());
+	}
+
+	EResult SdmLandmarker::create(const std::vector<cv::Point2f>& meanShape, const std::vector<SStage>& stages)
+	{
+		const int landmarkNum = static_cast<int>(meanShape.size());
+		if (landmarkNum == 0 || stages.empty())
+			return EResult::SR_NG;
+
+		for (const auto& stage : stages)
+		{
+			if (stage.regressor.type() != CV_32FC1 || stage.regressor.rows != landmarkNum * 2
+				|| stage.regressor.cols != landmarkNum * s_descriptorSize + 1 || !(stage.patchScale > 0.f))
+				return EResult::SR_NG;
+		}
+
+		m_meanShape = meanShape;
+		m_stages.clear();
+		for (const auto& stage : stages)
+		{
+			SStage copy;
+			copy.patchScale = stage.patchScale;
+			copy.regressor = stage.regressor.clone();
+			m_stages.push_back(copy);
+		}
+
+		pack();
+		return EResult::SR_OK;
+	}
+
+	EResult SdmLandmarker::load(const std::string& modelPath)
+	{
+		std::ifstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		char magic[4] = { 0 };
+		int32_t header[3] = { 0 };
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!file || !std::equal(magic, magic + 4, s_fileMagic) || header[0] != s_fileVersion || header[1] <= 0 || header[2] <= 0)
+			return EResult::SR_NG;
+
+		const int landmarkNum = header[1];
+		std::vector<float> mean(landmarkNum * 2);
+		file.read(reinterpret_cast<char*>(mean.data()), mean.size() * sizeof(float));
+
+		std::vector<cv::Point2f> meanShape(landmarkNum);
+		for (int i = 0; i < landmarkNum; i++)
+			meanShape[i] = cv::Point2f(mean[i * 2], mean[i * 2 + 1]);
+
+		std::vector<SStage> stages(header[2]);
+		for (auto& stage : stages)
+		{
+			file.read(reinterpret_cast<char*>(&stage.patchScale), sizeof(float));
+			stage.regressor.create(landmarkNum * 2, landmarkNum * s_descriptorSize + 1, CV_32FC1);
+			file.read(reinterpret_cast<char*>(stage.regressor.data), stage.regressor.total() * sizeof(float));
+		}
+		if (!file)
+			return EResult::SR_NG;
+
+		return create(meanShape, stages);
+	}
+
+	EResult SdmLandmarker::save(const std::string& modelPath) const
+	{
+		if (!isLoaded())
+			return EResult::SR_Detector_Not_Exist;
+
+		std::ofstream file(modelPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Model_Path_Not_Exist;
+
+		const int32_t header[3] = { s_fileVersion, landmarkNum(), static_cast<int32_t>(m_stages.size()) };
+		file.write(s_fileMagic, sizeof(s_fileMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		for (const auto& point : m_meanShape)
+		{
+			file.write(reinterpret_cast<const char*>(&point.x), sizeof(float));
+			file.write(reinterpret_cast<const char*>(&point.y), sizeof(float));
+		}
+		for (const auto& stage : m_stages)
+		{
+			file.write(reinterpret_cast<const char*>(&stage.patchScale), sizeof(float));
+			for (int r = 0; r < stage.regressor.rows; r++)
+				file.write(reinterpret_cast<const char*>(stage.regressor.ptr<float>(r)), stage.regressor.cols * sizeof(float));
+		}
+
+		return file ? EResult::SR_OK : EResult::SR_NG;
+	}
+
+	void SdmLandmarker::setPrecision(const EPrecision precision)
+	{
+		if (m_precision == precision)
+			return;
+
+		m_precision = precision;
+		pack();
+		selectKernels();
+	}
+
+	void SdmLandmarker::setIsa(const simd::EIsa isa) noexcept(true)
+	{
+		m_isa = simd::resolveIsa(isa);
+		selectKernels();
+	}
+
+	void SdmLandmarker::selectKernels() noexcept(true)
+	{
+		switch (m_isa)
+		{
+		case simd::EIsa::AVX512:
+		case simd::EIsa::AVX512_VNNI:
+			m_describe = &describeAvx512;
+			m_gemv = (m_precision == EPrecision::FP16) ? &gemvAvx512<uint16_t> : (m_precision == EPrecision::INT8) ? &gemvAvx512<int8_t> : &gemvAvx512<float>;
+			break;
+		case simd::EIsa::AVX2:
+			m_describe = &describeAvx2;
+			m_gemv = (m_precision == EPrecision::FP16) ? &gemvAvx2<uint16_t> : (m_precision == EPrecision::INT8) ? &gemvAvx2<int8_t> : &gemvAvx2<float>;
+			break;
+		case simd::EIsa::SSE41:
+			m_describe = &describeSse41;
+			m_gemv = (m_precision == EPrecision::FP16) ? &gemvSse41<uint16_t> : (m_precision == EPrecision::INT8) ? &gemvSse41<int8_t> : &gemvSse41<float>;
+			break;
+		default:
+			m_describe = &describeScalar;
+			m_gemv = (m_precision == EPrecision::FP16) ? &gemvScalar<uint16_t> : (m_precision == EPrecision::INT8) ? &gemvScalar<int8_t> : &gemvScalar<float>;
+			break;
+		}
+	}
+
+	void SdmLandmarker::pack()
+	{
+		m_packed.resize(m_stages.size());
+		for (size_t s = 0; s < m_stages.size(); s++)
+		{
+			const cv::Mat& regressor = m_stages[s].regressor;
+			SPackedStage& packed = m_packed[s];
+			packed.patchScale = m_stages[s].patchScale;
+			packed.rows = regressor.rows;
+			packed.panels = (regressor.rows + s_panelRows - 1) / s_panelRows;
+			packed.cols = regressor.cols - 1;
+
+			const size_t padded = static_cast<size_t>(packed.panels) * s_panelRows;
+			const size_t count = padded * packed.cols;
+			packed.bias.assign(padded, 0.f);
+			packed.scales.assign(padded, 1.f);
+			packed.weights32.clear();
+			packed.weights16.clear();
+			packed.weights8.clear();
+			packed.weights32.shrink_to_fit();
+			packed.weights16.shrink_to_fit();
+			packed.weights8.shrink_to_fit();
+
+			switch (m_precision)
+			{
+			case EPrecision::FP16: packed.weights16.assign(count, 0); break;
+			case EPrecision::INT8: packed.weights8.assign(count, 0); break;
+			default: packed.weights32.assign(count, 0.f); break;
+			}
+
+			for (int r = 0; r < packed.rows; r++)
+			{
+				const float* source = regressor.ptr<float>(r);
+				packed.bias[r] = source[packed.cols];
+
+				//int8:: symmetric, one scale per row
+				float scale = 1.f;
+				if (m_precision == EPrecision::INT8)
+				{
+					float peak = 0.f;
+					for (int k = 0; k < packed.cols; k++)
+						peak = std::max(peak, std::abs(source[k]));
+					scale = (peak > 0.f) ? peak / 127.f : 1.f;
+					packed.scales[r] = scale;
+				}
+
+				const size_t base = static_cast<size_t>(r / s_panelRows) * packed.cols * s_panelRows + r % s_panelRows;
+				for (int k = 0; k < packed.cols; k++)
+				{
+					const size_t index = base + static_cast<size_t>(k) * s_panelRows;
+					switch (m_precision)
+					{
+					case EPrecision::FP16: packed.weights16[index] = floatToHalf(source[k]); break;
+					case EPrecision::INT8: packed.weights8[index] = static_cast<int8_t>(std::lround(source[k] / scale)); break;
+					default: packed.weights32[index] = source[k]; break;
+					}
+				}
+			}
+		}
+	}
+
+	size_t SdmLandmarker::regressorBytes() const noexcept(true)
+	{
+		size_t bytes = 0;
+		for (const auto& packed : m_packed)
+			bytes += packed.weights32.size() * sizeof(float) + packed.weights16.size() * sizeof(uint16_t) + packed.weights8.size();
+		return bytes;
+	}
+
+	void SdmLandmarker::fit(const cv::Mat& gray, const cv::Rect& box, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const
+	{
+		shape.resize(m_meanShape.size());
+		for (size_t i = 0; i < m_meanShape.size(); i++)
+			shape[i] = cv::Point2f(box.x + m_meanShape[i].x * box.width, box.y + m_meanShape[i].y * box.height);
+
+		regress(gray, shape, workspace);
+	}
+
+	void SdmLandmarker::track(const cv::Mat& gray, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const
+	{
+		if (shape.size() != m_meanShape.size())
+			return;
+
+		regress(gray, shape, workspace);
+	}
+
+	void SdmLandmarker::regress(const cv::Mat& gray, std::vector<cv::Point2f>& shape, SWorkspace& workspace) const
+	{
+		if (!isLoaded() || gray.type() != CV_8UC1 || gray.cols < 2 || gray.rows < 2)
+			return;
+
+		//只转换脸附近的区域 最大的采样块加上各级可能的位移
+		float maxScale = 0.f;
+		int maxPanels = 0;
+		for (const auto& packed : m_packed)
+		{
+			maxScale = std::max(maxScale, packed.patchScale);
+			maxPanels = std::max(maxPanels, packed.panels);
+		}
+		const cv::Rect roi = prepareImage(gray, shape, maxScale, workspace);
+		if (roi.area() <= 0)
+			return;
+
+		const size_t landmarkNum = m_meanShape.size();
+		workspace.delta.resize(static_cast<size_t>(maxPanels) * s_panelRows);
+
+		for (const auto& packed : m_packed)
+		{
+			const float stageSize = describeShape(roi, shape, packed.patchScale, workspace);
+
+			const void* weights = (m_precision == EPrecision::FP16) ? static_cast<const void*>(packed.weights16.data())
+				: (m_precision == EPrecision::INT8) ? static_cast<const void*>(packed.weights8.data()) : static_cast<const void*>(packed.weights32.data());
+			float* delta = workspace.delta.data();
+			std::fill_n(delta, packed.panels * s_panelRows, 0.f);
+			m_gemv(weights, packed.panels, packed.cols, workspace.features.data(), delta);
+
+			//位移以形状大小为单位
+			for (size_t i = 0; i < landmarkNum; i++)
+			{
+				shape[i].x += stageSize * (packed.bias[i * 2] + packed.scales[i * 2] * delta[i * 2]);
+				shape[i].y += stageSize * (packed.bias[i * 2 + 1] + packed.scales[i * 2 + 1] * delta[i * 2 + 1]);
+			}
+		}
+	}
+
+	cv::Rect SdmLandmarker::prepareImage(const cv::Mat& gray, const std::vector<cv::Point2f>& shape, const float maxScale, SWorkspace& workspace) const
+	{
+		//只转换脸附近的区域 最大的采样块加上各级可能的位移
+		cv::Rect2f bounds;
+		const float size = shapeSize(shape, bounds);
+		const float margin = size * (maxScale * 0.6f + 0.25f);
+		const cv::Rect roi = cv::Rect(cvFloor(bounds.x - margin), cvFloor(bounds.y - margin),
+			cvCeil(bounds.width + margin * 2.f) + 1, cvCeil(bounds.height + margin * 2.f) + 1) & cv::Rect(0, 0, gray.cols, gray.rows);
+		if (roi.width < 2 || roi.height < 2)
+			return cv::Rect();
+
+		workspace.image.resize(static_cast<size_t>(roi.area()));
+		cv::Mat image(roi.height, roi.width, CV_32FC1, workspace.image.data());
+		gray(roi).convertTo(image, CV_32F);
+
+		workspace.patch.resize(s_patchSide * s_patchStride);
+		workspace.columns.resize(s_binNum * s_patchSize);
+		workspace.features.resize(shape.size() * s_descriptorSize);
+
+		return roi;
+	}
+
+	float SdmLandmarker::describeShape(const cv::Rect& roi, const std::vector<cv::Point2f>& shape, const float patchScale, SWorkspace& workspace) const
+	{
+		cv::Rect2f bounds;
+		const float size = shapeSize(shape, bounds);
+		const float side = patchScale * size;
+		for (size_t i = 0; i < shape.size(); i++)
+		{
+			m_describe(workspace.image.data(), roi.width, roi.height, shape[i].x - roi.x, shape[i].y - roi.y, side,
+				workspace.patch.data(), workspace.columns.data(), workspace.features.data() + i * s_descriptorSize);
+		}
+		return size;
+	}
+
+	EResult SdmLandmarker::train(const std::vector<cv::Mat>& grays, const std::vector<std::vector<cv::Point2f>>& shapes,
+		const std::vector<cv::Rect>& boxes, const STrainParam& param)
+	{
+		const size_t faceNum = grays.size();
+		if (faceNum == 0 || shapes.size() != faceNum || boxes.size() != faceNum || param.patchScales.empty() || param.initNum < 1)
+			return EResult::SR_NG;
+
+		const size_t landmarkNum = shapes.front().size();
+		for (size_t f = 0; f < faceNum; f++)
+		{
+			if (landmarkNum == 0 || shapes[f].size() != landmarkNum || grays[f].type() != CV_8UC1 || boxes[f].area() <= 0)
+				return EResult::SR_NG;
+		}
+		for (const float patchScale : param.patchScales)
+		{
+			if (!(patchScale > 0.f))
+				return EResult::SR_NG;
+		}
+
+		//平均形状 以人脸框归一化 与fit的起点相同
+		std::vector<cv::Point2f> meanShape(landmarkNum, cv::Point2f(0.f, 0.f));
+		for (size_t f = 0; f < faceNum; f++)
+		{
+			const cv::Rect& box = boxes[f];
+			for (size_t i = 0; i < landmarkNum; i++)
+				meanShape[i] += cv::Point2f((shapes[f][i].x - box.x) / box.width, (shapes[f][i].y - box.y) / box.height);
+		}
+		for (auto& point : meanShape)
+			point *= 1.f / faceNum;
+
+		//每张脸initNum个起点 第一个就是fit的起点 其余在人脸框内随机平移缩放 覆盖检测框的误差
+		const size_t sampleNum = faceNum * param.initNum;
+		std::vector<std::vector<cv::Point2f>> current(sampleNum, std::vector<cv::Point2f>(landmarkNum));
+		cv::RNG rng(param.seed);
+		for (size_t n = 0; n < sampleNum; n++)
+		{
+			const cv::Rect& box = boxes[n / param.initNum];
+			const bool jitterFlag = (n % param.initNum) != 0;
+			const float scale = jitterFlag ? 1.f + rng.uniform(-param.scaleJitter, param.scaleJitter) : 1.f;
+			const float shiftX = jitterFlag ? rng.uniform(-param.shiftJitter, param.shiftJitter) * box.width : 0.f;
+			const float shiftY = jitterFlag ? rng.uniform(-param.shiftJitter, param.shiftJitter) * box.height : 0.f;
+			const float centerX = box.x + box.width * 0.5f + shiftX;
+			const float centerY = box.y + box.height * 0.5f + shiftY;
+			for (size_t i = 0; i < landmarkNum; i++)
+				current[n][i] = cv::Point2f(centerX + (meanShape[i].x - 0.5f) * box.width * scale, centerY + (meanShape[i].y - 0.5f) * box.height * scale);
+		}
+
+		//各样本的转换区域由起点决定 与regress相同
+		const float maxScale = *std::max_element(param.patchScales.begin(), param.patchScales.end());
+		std::vector<cv::Rect> rois(sampleNum);
+		SWorkspace workspace;
+		for (size_t n = 0; n < sampleNum; n++)
+			rois[n] = prepareImage(grays[n / param.initNum], current[n], maxScale, workspace);
+
+		const int cols = static_cast<int>(landmarkNum) * s_descriptorSize + 1;
+		const int rows = static_cast<int>(landmarkNum) * 2;
+		const int chunkRows = 256;
+		cv::Mat chunk(chunkRows, cols, CV_32FC1), chunkTargets(chunkRows, rows, CV_32FC1);
+		std::vector<float> sizes(chunkRows);
+
+		//第begin个样本起的一块 每行为[描述子; 1] 目标为以形状大小为单位的剩余位移
+		auto describeChunk = [&](const size_t begin, const int count, const float patchScale)
+		{
+			for (int r = 0; r < count; r++)
+			{
+				const size_t n = begin + r;
+				float* row = chunk.ptr<float>(r);
+				float* target = chunkTargets.ptr<float>(r);
+				if (rois[n].area() <= 0)
+				{
+					std::fill_n(row, cols, 0.f);
+					std::fill_n(target, rows, 0.f);
+					sizes[r] = 0.f;
+					continue;
+				}
+
+				prepareImage(grays[n / param.initNum], current[n], maxScale, workspace);
+				sizes[r] = describeShape(rois[n], current[n], patchScale, workspace);
+				std::copy_n(workspace.features.data(), cols - 1, row);
+				row[cols - 1] = 1.f;
+
+				const std::vector<cv::Point2f>& truth = shapes[n / param.initNum];
+				for (size_t i = 0; i < landmarkNum; i++)
+				{
+					target[i * 2] = (truth[i].x - current[n][i].x) / sizes[r];
+					target[i * 2 + 1] = (truth[i].y - current[n][i].y) / sizes[r];
+				}
+			}
+		};
+
+		std::vector<SStage> stages(param.patchScales.size());
+		for (size_t s = 0; s < stages.size(); s++)
+		{
+			const float patchScale = param.patchScales[s];
+
+			//岭回归 分块累加 X'X 与 X'Y 内存与样本数无关
+			cv::Mat gram(cols, cols, CV_32FC1, cv::Scalar::all(0));
+			cv::Mat correlation(cols, rows, CV_32FC1, cv::Scalar::all(0));
+			for (size_t begin = 0; begin < sampleNum; begin += chunkRows)
+			{
+				const int count = static_cast<int>(std::min<size_t>(chunkRows, sampleNum - begin));
+				describeChunk(begin, count, patchScale);
+				const cv::Mat features = chunk.rowRange(0, count);
+				cv::gemm(features, features, 1.0, gram, 1.0, gram, cv::GEMM_1_T);
+				cv::gemm(features, chunkTargets.rowRange(0, count), 1.0, correlation, 1.0, correlation, cv::GEMM_1_T);
+			}
+
+			//正则项按对角线均值缩放 偏置列不加
+			const float ridge = param.lambda * static_cast<float>(cv::trace(gram)[0] / cols);
+			for (int c = 0; c < cols - 1; c++)
+				gram.at<float>(c, c) += ridge;
+
+			cv::Mat weights;
+			if (!cv::solve(gram, correlation, weights, cv::DECOMP_CHOLESKY))
+				return EResult::SR_NG;
+			gram.release();
+
+			stages[s].patchScale = patchScale;
+			cv::transpose(weights, stages[s].regressor);
+
+			//本级的结果作为下一级的起点
+			if (s + 1 == stages.size())
+				break;
+			for (size_t begin = 0; begin < sampleNum; begin += chunkRows)
+			{
+				const int count = static_cast<int>(std::min<size_t>(chunkRows, sampleNum - begin));
+				describeChunk(begin, count, patchScale);
+				cv::Mat delta;
+				cv::gemm(chunk.rowRange(0, count), weights, 1.0, cv::noArray(), 0.0, delta);
+				for (int r = 0; r < count; r++)
+				{
+					const float* step = delta.ptr<float>(r);
+					for (size_t i = 0; i < landmarkNum; i++)
+					{
+						current[begin + r][i].x += sizes[r] * step[i * 2];
+						current[begin + r][i].y += sizes[r] * step[i * 2 + 1];
+					}
+				}
+			}
+		}
+
+		return create(meanShape, stages);
+	}
+}///namespace Ghost
@@ -0,0 +1,127 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				FaceGallery.h
+* \@brief Desc:				In-process gallery of face embeddings with top-k cosine search
+* \@brief prerequisite::	C++17 (AVX2/AVX-512 VNNI used when present)
+*/
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+
+#ifndef FACERECOGNITION_API
+#define FACERECOGNITION_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Brute force cosine search over L2 normalized embeddings
+	* \@desc identities live in segments of s_segmentSize, each an SoA matrix of int8 codes, blocks of 16 identities with
+	* \@desc 4 consecutive dimensions per 32 bit lane, 64 byte aligned, so one block is scored by broadcasting the query
+	* \@desc (vpdpbusd on AVX-512 VNNI, widened madd on AVX2) without horizontal sums, at one byte per dimension of memory traffic
+	* \@desc the best candidates of the int8 scan are rescored exactly with the fp32 embeddings
+	* \@desc galleries of 32 segments or more are split across sharedThreadPool(), at least 16 segments per task
+	* \@desc segments are immutable once published, insert and erase copy the one or two segments they touch and swap the
+	* \@desc snapshot atomically, searches never wait for a writer and keep the snapshot they started with
+	*/
+	class FACERECOGNITION_API FaceGallery final
+	{
+	public:
+		static constexpr size_t s_blockSize = 16;				//identities per SIMD block
+		static constexpr size_t s_segmentSize = 256;			//identities per copy-on-write segment
+
+		/**
+		* \@brief One search result
+		*/
+		struct SMatch
+		{
+			size_t ID;
+			float score;								//cosine similarity, -1 ~ 1
+
+			SMatch() : ID(0), score(-1.f) {}
+		};
+
+		/**
+		* \@brief Scratch of one thread, sized on first use
+		*/
+		struct SWorkspace
+		{
+			simd::AlignedVector<float> query;			//normalized query, fp32
+			simd::AlignedVector<int32_t> packed;		//quantized query, 4 dimensions per int32
+			std::vector<SMatch> candidates;				//min-heap of the int8 scan, ID holds the index in the gallery
+			std::vector<std::vector<SMatch>> partials;	//min-heap of each pool task of a parallel scan
+		};
+
+	public:
+		FaceGallery();
+		~FaceGallery();
+
+		/**
+		* \@brief Empty gallery of embeddings with dimension values
+		*/
+		EResult create(const int dimension);
+
+		/**
+		* \@brief Gallery file:: "GFGL", int32 version, int32 dimension, uint64 identities,
+		* then per identity uint64 ID and float embedding[dimension] (normalized)
+		*/
+		EResult load(const std::string& galleryPath);
+		EResult save(const std::string& galleryPath) const;
+
+		/**
+		* \@brief Add an identity, or replace its embedding if the ID is already in the gallery
+		* \@param embedding:: dimension() values, normalized here
+		*/
+		EResult insert(const size_t ID, const float* embedding);
+
+		/**
+		* \@brief Remove an identity, the last identity takes its place
+		* \@return false if the ID is not in the gallery
+		*/
+		bool erase(const size_t ID);
+
+		void clear();
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setIsa(const simd::EIsa isa) noexcept(true) { m_isa = simd::resolveIsa(isa); }
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+		void setRerank(const size_t rerank) noexcept(true) { m_rerank = std::max<size_t>(rerank, 1); }	//!< candidates rescored per result, default 4
+		int dimension() const;
+		size_t size() const;
+		bool contains(const size_t ID) const;
+
+		/**
+		* \@brief The k most similar identities, best first
+		* \@param query:: dimension() values, need not be normalized
+		* \@param matches:: k results
+		* \@return number of results, min(k, size())
+		*/
+		size_t search(const float* query, const size_t k, SMatch* matches, SWorkspace& workspace) const;
+
+	private:
+		struct SSegment;
+		struct SSnapshot;
+
+		std::shared_ptr<const SSnapshot> snapshot() const;
+		void publish(const std::shared_ptr<const SSnapshot>& snapshot);
+
+	private:
+		std::shared_ptr<const SSnapshot> m_snapshot;			//!< read and swapped with std::atomic_load/atomic_store
+		std::unordered_map<size_t, size_t> m_positions;			//!< ID -> index in the gallery, writers only
+		mutable std::mutex m_mutex;								//!< serializes writers
+		simd::EIsa m_isa;
+		size_t m_rerank;
+	};
+}///namespace Ghost
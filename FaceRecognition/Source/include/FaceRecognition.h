@@ -38,7 +38,8 @@ namespace Ghost
 	public:
 		/**
 		* \@brief Setting the path of the data file required by the module #####Chinese cannot be included in the path#####
-		* \@param dataPath:: data file Path
+		* \@param databasePath:: folder of the local face database, created if missing, loaded by initModual
+		* \@desc the database is a snapshot (faces.gallery, persons.txt, faces.features) plus faces.journal, the changes made since
 		* \@param cfgPath:: cfg file Path
 		* \@param weightPath:: weight File Path
 		* \@return Returns the result of execution
@@ -79,6 +80,10 @@ namespace Ghost
 		* \@brief Setting Module Parameters
 		* \@param type Setting the type of parameter
 		* \@param value 0.0::close---1.0::open
+		* \@desc TYPE_FACE_RECONGNITION_Compare identify the faces of every frame against the local face database
+		* \@desc TYPE_FACE_RECONGNITION_Threshold lowest ASFFaceFeatureCompare similarity accepted as a match, default 0.8
+		* \@desc the gallery search only picks the candidates, the best of them by ASFFaceFeatureCompare is the match
+		* \@desc the gallery search is used only after its ranking agreed with ASFFaceFeatureCompare on stored faces, otherwise every stored face is compared
 		* \@return Results of implementation
 		*/
 		virtual EResult setModualParam(const EModualParamType type, const float value) override;
@@ -92,6 +97,15 @@ namespace Ghost
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Detect a batch of frames, image conversion runs on the shared thread pool and the engine handles the frames back to back under one lock
+		* \@param framesIn::Images for detection
+		* \@param framesOut::Empty if nothing needs to be drawn, else one image per frame
+		* \@param results::Result of each frame
+		* \@return SR_OK if every frame succeeded, else the first failure
+		*/
+		virtual EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results) override;
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
@@ -99,13 +113,21 @@ namespace Ghost
 		virtual EDetectModual getModualType() noexcept(true) override;
 
 		/**
-		* \@brief Add Face Data to Local Face Database
-		* \@param frameSave
-		* \@param infor
+		* \@brief Add Face Data to Local Face Database, appended to the journal of the database folder at once
+		* \@desc the journal is folded into the snapshot once it outgrows a quarter of the database and on antiModual,
+		* \@desc disk writes do not hold the lock of detect
+		* \@param frameSave:: image of the person, the largest face is used
+		* \@param infor:: the person, an existing ID has its face replaced
 		* \@return Results of implementation
 		*/
 		EResult saveFaceToDataBase(const cv::Mat& frameSave, const SPersonInfor& infor);
 
+		/**
+		* \@brief Remove a person from the Local Face Database, searches running meanwhile are not blocked, journaled like saveFaceToDataBase
+		* \@return SR_NG if the ID is not in the database
+		*/
+		EResult removeFaceFromDataBase(const size_t ID);
+
 	public GHOST_SIGNAL:
 	/**
 	* \@brief Found friend appearing
@@ -0,0 +1,599 @@
+#include "FaceGallery.h"
+#include "GThreadPool.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_fileVersion = 1;
+		const char s_fileMagic[4] = { 'G', 'F', 'G', 'L' };
+		constexpr size_t s_groupBytes = FaceGallery::s_blockSize * 4;		//16 identities x 4 dimensions
+		constexpr size_t s_taskSegments = 16;							//fewest segments scanned by one pool task
+
+		/**
+		* \@brief L2 normalize into out, padded with zeros to stride
+		* \@return false for a zero vector
+		*/
+		inline bool normalize(const float* in, const int dimension, const size_t stride, float* out)
+		{
+			const float norm = std::sqrt(simd::dot(in, in, dimension));
+			if (!(norm > FLT_MIN) || !std::isfinite(norm))
+				return false;
+
+			const float inverse = 1.f / norm;
+			for (int d = 0; d < dimension; d++)
+				out[d] = in[d] * inverse;
+			std::fill(out + dimension, out + stride, 0.f);
+			return true;
+		}
+
+		/**
+		* \@brief Best candidates of the int8 scan, a min-heap on score
+		*/
+		struct SCollector
+		{
+			std::vector<FaceGallery::SMatch>& heap;
+			size_t capacity;
+			float threshold;								//score to beat, -FLT_MAX until the heap is full
+
+			static bool greater(const FaceGallery::SMatch& a, const FaceGallery::SMatch& b) { return a.score > b.score; }
+
+			void offer(const float score, const size_t index)
+			{
+				if (heap.size() < capacity)
+				{
+					FaceGallery::SMatch match;
+					match.ID = index;
+					match.score = score;
+					heap.push_back(match);
+					std::push_heap(heap.begin(), heap.end(), greater);
+					if (heap.size() == capacity)
+						threshold = heap.front().score;
+					return;
+				}
+
+				if (!(score > threshold))
+					return;
+
+				std::pop_heap(heap.begin(), heap.end(), greater);
+				heap.back().ID = index;
+				heap.back().score = score;
+				std::push_heap(heap.begin(), heap.end(), greater);
+				threshold = heap.front().score;
+			}
+
+			void offerMask(uint32_t mask, const float* scores, const size_t index)
+			{
+				for (size_t lane = 0; mask != 0; lane++, mask >>= 1)
+				{
+					if (mask & 1u)
+						offer(scores[lane], index + lane);
+				}
+			}
+		};
+
+		/**
+		* \@brief One segment seen by the kernels
+		*/
+		struct SScan
+		{
+			size_t count;
+			size_t groups;
+			const int8_t* codes;
+			const int32_t* corrections;
+			const float* inverseScales;
+			const int32_t* query;						//4 s8 dimensions per int32
+			float queryInverse;							//1 / query scale
+			size_t index;								//index in the gallery of the first identity
+		};
+
+		void scanScalar(const SScan& s, SCollector& collector)
+		{
+			const int8_t* query = reinterpret_cast<const int8_t*>(s.query);
+			for (size_t slot = 0; slot < s.count; slot++)
+			{
+				const int8_t* code = s.codes + (slot / FaceGallery::s_blockSize) * s.groups * s_groupBytes + (slot % FaceGallery::s_blockSize) * 4;
+				int32_t acc = 0;
+				for (size_t j = 0; j < s.groups; j++)
+				{
+					for (size_t b = 0; b < 4; b++)
+						acc += static_cast<int32_t>(code[j * s_groupBytes + b]) * static_cast<int32_t>(query[j * 4 + b]);
+				}
+
+				collector.offer(static_cast<float>(acc) * s.inverseScales[slot] * s.queryInverse, s.index + slot);
+			}
+		}
+
+		/**
+		* \@brief s8 x s8 widened to s16 and multiplied with madd #exact#, 4 identities per 16 bytes
+		*/
+		GHOST_TARGET_AVX2 void scanAvx2(const SScan& s, SCollector& collector)
+		{
+			const __m256 queryInverse = _mm256_set1_ps(s.queryInverse);
+			alignas(32) float scores[FaceGallery::s_blockSize];
+
+			for (size_t first = 0; first < s.count; first += FaceGallery::s_blockSize)
+			{
+				const int8_t* block = s.codes + (first / FaceGallery::s_blockSize) * s.groups * s_groupBytes;
+				__m256i acc0 = _mm256_setzero_si256();
+				__m256i acc1 = _mm256_setzero_si256();
+				__m256i acc2 = _mm256_setzero_si256();
+				__m256i acc3 = _mm256_setzero_si256();
+				for (size_t j = 0; j < s.groups; j++)
+				{
+					const int8_t* code = block + j * s_groupBytes;
+					const __m256i q = _mm256_cvtepi8_epi16(_mm_set1_epi32(s.query[j]));
+					acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(code))), q));
+					acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(code + 16))), q));
+					acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(code + 32))), q));
+					acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(code + 48))), q));
+				}
+
+				//每个identity两个部分和 hadd后128位两半交错 再按64位重排
+				const __m256i sum0 = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc0, acc1), _MM_SHUFFLE(3, 1, 2, 0));
+				const __m256i sum1 = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc2, acc3), _MM_SHUFFLE(3, 1, 2, 0));
+				const __m256 score0 = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(sum0), _mm256_load_ps(s.inverseScales + first)), queryInverse);
+				const __m256 score1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(sum1), _mm256_load_ps(s.inverseScales + first + 8)), queryInverse);
+
+				const __m256 threshold = _mm256_set1_ps(collector.threshold);
+				const size_t rest = s.count - first;
+				uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(score0, threshold, _CMP_GT_OQ)))
+					| (static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(score1, threshold, _CMP_GT_OQ))) << 8);
+				if (rest < FaceGallery::s_blockSize)
+					mask &= (1u << rest) - 1u;
+				if (mask == 0)
+					continue;
+
+				_mm256_store_ps(scores, score0);
+				_mm256_store_ps(scores + 8, score1);
+				collector.offerMask(mask, scores, s.index + first);
+			}
+		}
+
+		/**
+		* \@brief u8 x s8 with vpdpbusd, the query flipped to u8 = s8 + 128 and corrected with 128 * sum(code)
+		*/
+		GHOST_TARGET_AVX512VNNI void scanVnni(const SScan& s, SCollector& collector)
+		{
+			const __m512 queryInverse = _mm512_set1_ps(s.queryInverse);
+			const int32_t flip = static_cast<int32_t>(0x80808080u);
+			alignas(64) float scores[FaceGallery::s_blockSize];
+
+			for (size_t first = 0; first < s.count; first += FaceGallery::s_blockSize)
+			{
+				const int8_t* block = s.codes + (first / FaceGallery::s_blockSize) * s.groups * s_groupBytes;
+				__m512i acc0 = _mm512_setzero_si512();
+				__m512i acc1 = _mm512_setzero_si512();
+				size_t j = 0;
+				for (; j + 2 <= s.groups; j += 2)
+				{
+					acc0 = _mm512_dpbusd_epi32(acc0, _mm512_set1_epi32(s.query[j] ^ flip), _mm512_load_si512(block + j * s_groupBytes));
+					acc1 = _mm512_dpbusd_epi32(acc1, _mm512_set1_epi32(s.query[j + 1] ^ flip), _mm512_load_si512(block + (j + 1) * s_groupBytes));
+				}
+				if (j < s.groups)
+					acc0 = _mm512_dpbusd_epi32(acc0, _mm512_set1_epi32(s.query[j] ^ flip), _mm512_load_si512(block + j * s_groupBytes));
+
+				const __m512i acc = _mm512_sub_epi32(_mm512_add_epi32(acc0, acc1), _mm512_load_si512(s.corrections + first));
+				const __m512 score = _mm512_mul_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(acc), _mm512_load_ps(s.inverseScales + first)), queryInverse);
+
+				const size_t rest = s.count - first;
+				const __mmask16 valid = (rest < FaceGallery::s_blockSize) ? static_cast<__mmask16>((1u << rest) - 1u) : static_cast<__mmask16>(0xFFFF);
+				const __mmask16 mask = _mm512_mask_cmp_ps_mask(valid, score, _mm512_set1_ps(collector.threshold), _CMP_GT_OQ);
+				if (mask == 0)
+					continue;
+
+				_mm512_store_ps(scores, score);
+				collector.offerMask(mask, scores, s.index + first);
+			}
+		}
+	}///namespace
+
+	/**
+	* \@brief s_segmentSize identities, allocated in full so a copy is one memcpy per array
+	*/
+	struct FaceGallery::SSegment
+	{
+		size_t count;
+		std::vector<size_t> IDs;
+		simd::AlignedVector<int8_t> codes;				//blocks x groups x [16 identities][4 dimensions]
+		simd::AlignedVector<int32_t> corrections;		//128 * sum(code), for the u8 x s8 path
+		simd::AlignedVector<float> inverseScales;		//1 / quantization scale
+		simd::AlignedVector<float> rows;				//normalized fp32 embedding, rowStride apart
+
+		SSegment(const size_t groups, const size_t rowStride)
+			:
+			count(0),
+			IDs(s_segmentSize, 0),
+			codes(s_segmentSize * groups * 4, 0),
+			corrections(s_segmentSize, 0),
+			inverseScales(s_segmentSize, 0.f),
+			rows(s_segmentSize * rowStride, 0.f)
+		{}
+	};
+
+	/**
+	* \@brief Everything a search needs, immutable once published
+	*/
+	struct FaceGallery::SSnapshot
+	{
+		int dimension;
+		size_t groups;									//dimension / 4 rounded up
+		size_t rowStride;								//dimension rounded up to 16 floats
+		size_t count;
+		std::vector<std::shared_ptr<const SSegment>> segments;	//all full but the last
+
+		explicit SSnapshot(const int _dimension)
+			:
+			dimension(_dimension),
+			groups(simd::alignUp(_dimension, 4) / 4),
+			rowStride(simd::alignUp(_dimension, 16)),
+			count(0)
+		{}
+
+		/**
+		* \@brief Private copy of a segment to write into, a new one past the end
+		*/
+		std::shared_ptr<SSegment> modify(const size_t segment)
+		{
+			std::shared_ptr<SSegment> copy;
+			if (segment == segments.size())
+			{
+				copy = std::make_shared<SSegment>(groups, rowStride);
+				segments.push_back(copy);
+			}
+			else
+			{
+				copy = std::make_shared<SSegment>(*segments[segment]);
+				segments[segment] = copy;
+			}
+			return copy;
+		}
+
+		/**
+		* \@brief Store a normalized embedding and its int8 code
+		*/
+		void write(SSegment& segment, const size_t slot, const size_t ID, const float* normalized) const
+		{
+			segment.IDs[slot] = ID;
+			float* row = segment.rows.data() + slot * rowStride;
+			std::copy(normalized, normalized + dimension, row);
+			std::fill(row + dimension, row + rowStride, 0.f);
+
+			float absMax = 0.f;
+			for (int d = 0; d < dimension; d++)
+				absMax = std::max(absMax, std::abs(row[d]));
+			const float scale = (absMax > 0.f) ? 127.f / absMax : 0.f;
+
+			int8_t* code = segment.codes.data() + (slot / s_blockSize) * groups * s_groupBytes + (slot % s_blockSize) * 4;
+			int32_t sum = 0;
+			for (size_t d = 0; d < groups * 4; d++)
+			{
+				const int8_t value = static_cast<int8_t>(std::lround(row[d] * scale));
+				code[(d / 4) * s_groupBytes + d % 4] = value;
+				sum += value;
+			}
+			segment.corrections[slot] = 128 * sum;
+			segment.inverseScales[slot] = (scale > 0.f) ? 1.f / scale : 0.f;
+		}
+	};
+
+	FaceGallery::FaceGallery()
+		:
+		m_isa(simd::bestIsa()),
+		m_rerank(4)
+	{
+	}
+
+	FaceGallery::~FaceGallery()
+	{
+	}
+
+	std::shared_ptr<const FaceGallery::SSnapshot> FaceGallery::snapshot() const
+	{
+		return std::atomic_load(&m_snapshot);
+	}
+
+	void FaceGallery::publish(const std::shared_ptr<const SSnapshot>& snapshot)
+	{
+		std::atomic_store(&m_snapshot, snapshot);
+	}
+
+	EResult FaceGallery::create(const int dimension)
+	{
+		if (dimension <= 0)
+			return EResult::SR_NG;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_positions.clear();
+		publish(std::make_shared<const SSnapshot>(dimension));
+
+		return EResult::SR_OK;
+	}
+
+	EResult FaceGallery::load(const std::string& galleryPath)
+	{
+		std::ifstream file(galleryPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Saved_Data_Does_Not_Exist;
+
+		char magic[4] = { 0 };
+		int32_t header[2] = { 0 };
+		uint64_t count = 0;
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		file.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!file || !std::equal(magic, magic + 4, s_fileMagic) || header[0] != s_fileVersion || header[1] <= 0)
+			return EResult::SR_NG;
+
+		//整个库在本地建好再一次发布
+		auto next = std::make_shared<SSnapshot>(header[1]);
+		std::unordered_map<size_t, size_t> positions;
+		std::vector<float> embedding(next->dimension);
+		std::vector<float> normalized(next->rowStride);
+		std::shared_ptr<SSegment> segment;
+		for (uint64_t i = 0; i < count; i++)
+		{
+			uint64_t ID = 0;
+			file.read(reinterpret_cast<char*>(&ID), sizeof(ID));
+			file.read(reinterpret_cast<char*>(embedding.data()), embedding.size() * sizeof(float));
+			if (!file || !normalize(embedding.data(), next->dimension, next->rowStride, normalized.data())
+				|| !positions.emplace(static_cast<size_t>(ID), next->count).second)
+				return EResult::SR_NG;
+
+			const size_t slot = next->count % s_segmentSize;
+			if (slot == 0)
+				segment = next->modify(next->segments.size());
+			next->write(*segment, slot, static_cast<size_t>(ID), normalized.data());
+			segment->count++;
+			next->count++;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_positions.swap(positions);
+		publish(next);
+
+		return EResult::SR_OK;
+	}
+
+	EResult FaceGallery::save(const std::string& galleryPath) const
+	{
+		const auto current = snapshot();
+		if (current == nullptr)
+			return EResult::SR_Detector_Not_Exist;
+
+		std::ofstream file(galleryPath, std::ios::binary);
+		if (!file.is_open())
+			return EResult::SR_Data_Path_Not_Set;
+
+		const int32_t header[2] = { s_fileVersion, current->dimension };
+		const uint64_t count = current->count;
+		file.write(s_fileMagic, sizeof(s_fileMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (const auto& segment : current->segments)
+		{
+			for (size_t slot = 0; slot < segment->count; slot++)
+			{
+				const uint64_t ID = segment->IDs[slot];
+				file.write(reinterpret_cast<const char*>(&ID), sizeof(ID));
+				file.write(reinterpret_cast<const char*>(segment->rows.data() + slot * current->rowStride), current->dimension * sizeof(float));
+			}
+		}
+
+		return file ? EResult::SR_OK : EResult::SR_NG;
+	}
+
+	EResult FaceGallery::insert(const size_t ID, const float* embedding)
+	{
+		if (embedding == nullptr)
+			return EResult::SR_NG;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto current = snapshot();
+		if (current == nullptr)
+			return EResult::SR_Detector_Not_Exist;
+
+		std::vector<float> normalized(current->rowStride);
+		if (!normalize(embedding, current->dimension, current->rowStride, normalized.data()))
+			return EResult::SR_NG;
+
+		//只复制要写的段 其余段与旧快照共享
+		auto next = std::make_shared<SSnapshot>(*current);
+		const auto iter = m_positions.find(ID);
+		const bool added = (iter == m_positions.end());
+		const size_t position = added ? next->count : iter->second;
+
+		auto segment = next->modify(position / s_segmentSize);
+		next->write(*segment, position % s_segmentSize, ID, normalized.data());
+		if (added)
+		{
+			segment->count++;
+			next->count++;
+			m_positions.emplace(ID, position);
+		}
+
+		publish(next);
+
+		return EResult::SR_OK;
+	}
+
+	bool FaceGallery::erase(const size_t ID)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto iter = m_positions.find(ID);
+		const auto current = snapshot();
+		if (iter == m_positions.end() || current == nullptr)
+			return false;
+
+		//最后一个identity填到删除的位置 保持连续
+		auto next = std::make_shared<SSnapshot>(*current);
+		const size_t position = iter->second;
+		const size_t last = next->count - 1;
+		if (position != last)
+		{
+			const auto source = next->segments[last / s_segmentSize];
+			const size_t sourceSlot = last % s_segmentSize;
+			const size_t movedID = source->IDs[sourceSlot];
+
+			auto target = next->modify(position / s_segmentSize);
+			next->write(*target, position % s_segmentSize, movedID, source->rows.data() + sourceSlot * next->rowStride);
+			m_positions[movedID] = position;
+		}
+
+		if (last % s_segmentSize == 0)
+			next->segments.pop_back();
+		else
+			next->modify(last / s_segmentSize)->count--;
+		next->count--;
+		m_positions.erase(ID);
+
+		publish(next);
+
+		return true;
+	}
+
+	void FaceGallery::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto current = snapshot();
+		if (current == nullptr)
+			return;
+
+		m_positions.clear();
+		publish(std::make_shared<const SSnapshot>(current->dimension));
+	}
+
+	int FaceGallery::dimension() const
+	{
+		const auto current = snapshot();
+		return (current == nullptr) ? 0 : current->dimension;
+	}
+
+	size_t FaceGallery::size() const
+	{
+		const auto current = snapshot();
+		return (current == nullptr) ? 0 : current->count;
+	}
+
+	bool FaceGallery::contains(const size_t ID) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		return m_positions.find(ID) != m_positions.end();
+	}
+
+	size_t FaceGallery::search(const float* query, const size_t k, SMatch* matches, SWorkspace& workspace) const
+	{
+		const auto current = snapshot();
+		if (current == nullptr || current->count == 0 || query == nullptr || k == 0)
+			return 0;
+
+		const int dimension = current->dimension;
+		if (workspace.query.size() < current->rowStride)
+			workspace.query.resize(current->rowStride);
+		if (workspace.packed.size() < current->groups)
+			workspace.packed.resize(current->groups);
+
+		float* normalized = workspace.query.data();
+		if (!normalize(query, dimension, current->rowStride, normalized))
+			return 0;
+
+		//查询向量按最大绝对值量化到s8 四个维度一组
+		float absMax = 0.f;
+		for (int d = 0; d < dimension; d++)
+			absMax = std::max(absMax, std::abs(normalized[d]));
+		const float scale = 127.f / absMax;
+		int8_t* packed = reinterpret_cast<int8_t*>(workspace.packed.data());
+		for (size_t d = 0; d < current->groups * 4; d++)
+			packed[d] = static_cast<int8_t>(std::lround(normalized[d] * scale));
+
+		auto& candidates = workspace.candidates;
+		candidates.clear();
+		const size_t capacity = std::min(current->count, k * m_rerank);
+
+		const simd::EIsa isa = simd::resolveIsa(m_isa);
+		auto scanSegments = [&](const size_t first, const size_t last, SCollector& collector)
+		{
+			SScan scan;
+			scan.groups = current->groups;
+			scan.query = workspace.packed.data();
+			scan.queryInverse = absMax / 127.f;
+			for (size_t i = first; i < last; i++)
+			{
+				const SSegment& segment = *current->segments[i];
+				scan.count = segment.count;
+				scan.codes = segment.codes.data();
+				scan.corrections = segment.corrections.data();
+				scan.inverseScales = segment.inverseScales.data();
+				scan.index = i * s_segmentSize;
+
+				if (isa >= simd::EIsa::AVX512_VNNI)
+					scanVnni(scan, collector);
+				else if (isa >= simd::EIsa::AVX2)
+					scanAvx2(scan, collector);
+				else
+					scanScalar(scan, collector);
+			}
+		};
+
+		//大库按段分给共享线程池 每个任务保留自己的前capacity个 合并后再取前capacity个
+		const size_t segmentNum = current->segments.size();
+		ThreadPool& pool = sharedThreadPool();
+		const size_t tasks = std::min(pool.size(), segmentNum / s_taskSegments);
+		if (tasks <= 1)
+		{
+			SCollector collector = { candidates, capacity, -FLT_MAX };
+			scanSegments(0, segmentNum, collector);
+		}
+		else
+		{
+			if (workspace.partials.size() < tasks)
+				workspace.partials.resize(tasks);
+
+			const size_t step = (segmentNum + tasks - 1) / tasks;
+			pool.parallelFor(0, tasks, [&](size_t begin, size_t end)
+			{
+				for (size_t task = begin; task < end; task++)
+				{
+					auto& partial = workspace.partials[task];
+					partial.clear();
+					SCollector collector = { partial, capacity, -FLT_MAX };
+					scanSegments(std::min(segmentNum, task * step), std::min(segmentNum, (task + 1) * step), collector);
+				}
+			});
+
+			for (size_t task = 0; task < tasks; task++)
+				candidates.insert(candidates.end(), workspace.partials[task].begin(), workspace.partials[task].end());
+			if (candidates.size() > capacity)
+			{
+				std::nth_element(candidates.begin(), candidates.begin() + capacity, candidates.end(), SCollector::greater);
+				candidates.resize(capacity);
+			}
+		}
+
+		//候选用fp32重新打分
+		for (auto& candidate : candidates)
+		{
+			const SSegment& segment = *current->segments[candidate.ID / s_segmentSize];
+			const size_t slot = candidate.ID % s_segmentSize;
+			candidate.score = simd::dot(segment.rows.data() + slot * current->rowStride, normalized, dimension);
+			candidate.ID = segment.IDs[slot];
+		}
+		std::sort(candidates.begin(), candidates.end(), SCollector::greater);
+
+		const size_t found = std::min(k, candidates.size());
+		std::copy(candidates.begin(), candidates.begin() + found, matches);
+		return found;
+	}
+}///namespace Ghost
@@ -1,11 +1,20 @@
 #include "FaceRecognition.h"
+#include "FaceGallery.h"
 
 #include "arcsoft_face_sdk.h"
 #include "amcomdef.h"
 #include "merror.h"
 #include "direct.h"
 
+#include "GThreadPool.hpp"
+
 #include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <thread>
 #include <mutex>
@@ -15,6 +24,7 @@
 #define SafeDelete(p) { if ((p)) delete (p); (p) = NULL; }
 
 using namespace std;
+namespace fs = std::filesystem;
 
 namespace Ghost
 {
@@ -26,7 +36,10 @@ namespace Ghost
 	public:
 		Impl()
 			:
-			m_handleEngine(NULL)
+			m_handleEngine(NULL),
+			m_compareThreshold(0.8f),
+			m_journalRecords(0),
+			m_proxyState(EProxyState::Unchecked)
 		{
 			//~~~~~~~~~~~~~~~~~~~~~~
 			//loadFaceDataBase();
@@ -44,6 +57,7 @@ namespace Ghost
 		*/
 		EResult initModual()
 		{
+			std::lock_guard<std::mutex> databaseLock(m_databaseMutex);
 			std::lock_guard<std::mutex> lock(m_mutex);
 
 			if ((m_checkFlags.initFalg.load()) || (m_handleEngine != NULL))
@@ -73,6 +87,9 @@ namespace Ghost
 
 			m_checkFlags.initFalg.store(true);
 
+			//ⲻʱӿտ⿪ʼ
+			loadFaceDataBase(m_databasePath);
+
 			return EResult::SR_OK;
 		}
 
@@ -82,6 +99,12 @@ namespace Ghost
 		*/
 		EResult antiModual()
 		{
+			std::lock_guard<std::mutex> databaseLock(m_databaseMutex);
+
+			//־ϲ ´ط
+			if (m_journalRecords > 0)
+				compactDataBase();
+
 			std::lock_guard<std::mutex> lock(m_mutex);
 
 			if ((m_handleEngine == NULL) || (!m_checkFlags.initFalg.load()))
@@ -100,22 +123,341 @@ namespace Ghost
 		}
 
 		/**
-		* \@brief رݿϢ	###ݿǶʱö̲߳ѯ###
-		* \@param databasePath ļ·
+		* \@brief رݿ ȶ ط֮ɾ־ #÷#
+		* \@desc :: FaceGalleryļ ԱϢÿһ SDKԭ
+		* \@desc ־:: ÿɾ׷һ 'A' uint64 ID, int32 Ա  ְλ, int32 ֳ, , int32 ,  / 'R' uint64 ID
+		* \@param databasePath ݿļ
 		* \@return ִеĽ
 		*/
 		EResult loadFaceDataBase(const string& databasePath)
 		{
+			if (databasePath.empty())
+				return EResult::SR_Data_Path_Not_Set;
+
+			m_gallery.clear();
+			m_persons.clear();
+			m_features.clear();
+			m_journalRecords = 0;
+			m_proxyState = EProxyState::Unchecked;
+
+			//ʱֻSDKȶ
+			const fs::path folder(databasePath);
+			if (fs::exists(folder / s_galleryFile) && m_gallery.load((folder / s_galleryFile).string()) != EResult::SR_OK)
+				m_gallery.clear();
+
+			//ID Ա  ְλ 
+			std::ifstream file((folder / s_personFile).string());
+			size_t ID = 0;
+			int gender = 0, age = 0, post = 0;
+			while (file >> ID >> gender >> age >> post)
+			{
+				SPersonInfor& person = m_persons[ID];
+				person.ID = ID;
+				person.gender = static_cast<uint8_t>(gender);
+				person.age = static_cast<uint8_t>(age);
+				person.post = static_cast<uint8_t>(post);
+				file.get();
+				std::getline(file, person.name);
+			}
+
+			//uint64 ID, int32 , SDK
+			std::ifstream features((folder / s_featureFile).string(), std::ios::binary);
+			uint64_t featureID = 0;
+			std::vector<MByte> feature;
+			while (readFeature(features, featureID, feature))
+				m_features[static_cast<size_t>(featureID)] = feature;
+
+			//֮ɾ дһһ
+			std::ifstream journal((folder / s_journalFile).string(), std::ios::binary);
+			std::vector<float> embedding;
+			char op = 0;
+			while (journal.get(op))
+			{
+				uint64_t ID = 0;
+				if (!journal.read(reinterpret_cast<char*>(&ID), sizeof(ID)))
+					break;
+
+				if (op == s_journalRemove)
+				{
+					m_gallery.erase(static_cast<size_t>(ID));
+					m_persons.erase(static_cast<size_t>(ID));
+					m_features.erase(static_cast<size_t>(ID));
+				}
+				else
+				{
+					SPersonInfor person;
+					int32_t fields[4] = { 0 };
+					if (op != s_journalAdd || !journal.read(reinterpret_cast<char*>(fields), sizeof(fields)) || fields[3] < 0)
+						break;
+					person.ID = static_cast<size_t>(ID);
+					person.gender = static_cast<uint8_t>(fields[0]);
+					person.age = static_cast<uint8_t>(fields[1]);
+					person.post = static_cast<uint8_t>(fields[2]);
+					person.name.resize(fields[3]);
+					if (!journal.read(&person.name[0], fields[3]) || !readFeature(journal, ID, feature, false))
+						break;
+
+					toEmbedding(feature, embedding);
+					if (insertFace(person, feature, embedding) != EResult::SR_OK)
+						break;
+				}
+				m_journalRecords++;
+			}
+
+			//мŲFaceGallery
+			if (m_gallery.size() != m_features.size())
+				m_proxyState = EProxyState::Invalid;
+
 			return EResult::SR_OK;
 		}
 
 		/**
-		* \@brief ҪӵݿϢ
+		* \@brief һ withIDΪfalseʱֻ ͷһfloat̵ļ¼Ϊ
+		*/
+		static bool readFeature(std::istream& file, uint64_t& ID, std::vector<MByte>& feature, const bool withID = true)
+		{
+			int32_t size = 0;
+			if ((withID && !file.read(reinterpret_cast<char*>(&ID), sizeof(ID))) || !file.read(reinterpret_cast<char*>(&size), sizeof(size))
+				|| size < static_cast<int32_t>(s_featureHeader + sizeof(float)))
+				return false;
+
+			feature.resize(size);
+			return static_cast<bool>(file.read(reinterpret_cast<char*>(feature.data()), size));
+		}
+
+		static void writeFeature(std::ostream& file, const std::vector<MByte>& feature)
+		{
+			const int32_t size = static_cast<int32_t>(feature.size());
+			file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			file.write(reinterpret_cast<const char*>(feature.data()), size);
+		}
+
+		/**
+		* \@brief ڴеĿ IDѴʱ滻 #÷#
+		* \@desc ŲFaceGalleryʱԼ ֮ıȶԲʹü
+		*/
+		EResult insertFace(const SPersonInfor& infor, const std::vector<MByte>& feature, const std::vector<float>& embedding)
+		{
+			//һά
+			if (m_gallery.dimension() == 0 && !embedding.empty())
+				m_gallery.create(static_cast<int>(embedding.size()));
+			if (m_gallery.dimension() != static_cast<int>(embedding.size()) || m_gallery.insert(infor.ID, embedding.data()) != EResult::SR_OK)
+			{
+				m_gallery.erase(infor.ID);
+				m_proxyState = EProxyState::Invalid;
+			}
+
+			m_persons[infor.ID] = infor;
+			m_features[infor.ID] = feature;
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ׷һɾ־ ־1/4ʱϲΪ #÷m_databaseMutex m_mutex#
+		* \@param infor ʱԱϢ ɾʱΪnullptr
+		*/
+		EResult appendJournal(const size_t ID, const SPersonInfor* infor, const std::vector<MByte>& feature)
+		{
+			if (m_databasePath.empty())
+				return EResult::SR_Data_Path_Not_Set;
+
+			std::ofstream file((fs::path(m_databasePath) / s_journalFile).string(), std::ios::binary | std::ios::app);
+			const uint64_t journalID = ID;
+			file.put((infor != nullptr) ? s_journalAdd : s_journalRemove);
+			file.write(reinterpret_cast<const char*>(&journalID), sizeof(journalID));
+			if (infor != nullptr)
+			{
+				const int32_t fields[4] = { infor->gender, infor->age, infor->post, static_cast<int32_t>(infor->name.size()) };
+				file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+				file.write(infor->name.data(), infor->name.size());
+				writeFeature(file, feature);
+			}
+			file.flush();
+			if (!file)
+				return EResult::SR_NG;
+
+			m_journalRecords++;
+			if (m_journalRecords > std::max(s_minJournalRecords, m_gallery.size() / 4))
+				return compactDataBase();
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief дɿղ־ дʱļ滻 ;ʧʱɿ־Ȼ
+		* \@desc ֻڴеĿ ֻд ˲Ҫm_mutex #÷m_databaseMutex#
+		*/
+		EResult compactDataBase()
+		{
+			if (m_databasePath.empty())
+				return EResult::SR_Data_Path_Not_Set;
+
+			const fs::path folder(m_databasePath);
+			const string temporary = ".tmp";
+			EResult result = m_gallery.save((folder / (s_galleryFile + temporary)).string());
+			if (result != EResult::SR_OK)
+				return result;
+
+			{
+				std::ofstream file((folder / (s_personFile + temporary)).string(), std::ios::trunc);
+				for (const auto& iter : m_persons)
+				{
+					const SPersonInfor& person = iter.second;
+					file << person.ID << ' ' << static_cast<int>(person.gender) << ' ' << static_cast<int>(person.age) << ' '
+						<< static_cast<int>(person.post) << ' ' << person.name << '\n';
+				}
+
+				std::ofstream features((folder / (s_featureFile + temporary)).string(), std::ios::binary | std::ios::trunc);
+				for (const auto& iter : m_features)
+				{
+					const uint64_t ID = iter.first;
+					features.write(reinterpret_cast<const char*>(&ID), sizeof(ID));
+					writeFeature(features, iter.second);
+				}
+
+				if (!file || !features)
+					return EResult::SR_NG;
+			}
+
+			//־еɾظִ 滻־ǰжҲ
+			std::error_code error;
+			for (const string& name : { s_galleryFile, s_personFile, s_featureFile })
+			{
+				fs::rename(folder / (name + temporary), folder / name, error);
+				if (error)
+					return EResult::SR_NG;
+			}
+			std::ofstream journal((folder / s_journalFile).string(), std::ios::binary | std::ios::trunc);
+			m_journalRecords = 0;
+
+			return journal ? EResult::SR_OK : EResult::SR_NG;
+		}
+
+		/**
+		* \@brief ҪӵݿϢ ȡͼ IDѴʱ
+		* \@desc ֻȡڴеɾm_mutex д̲
 		* \@return ִеĽ
 		*/
 		EResult saveFaceToDataBase(const cv::Mat& frameSave, const SPersonInfor& infor)
 		{
-			return EResult::SR_OK;
+			if (frameSave.empty())
+				return EResult::SR_Image_Empty;
+
+			std::lock_guard<std::mutex> databaseLock(m_databaseMutex);
+			std::vector<MByte> feature;
+			const EResult result = addFace(frameSave, infor, feature);
+			if (result != EResult::SR_OK)
+				return result;
+
+			return appendJournal(infor.ID, &infor, feature);
+		}
+
+		/**
+		* \@brief ȡڴеĿ featureΪSDKĿ #÷m_databaseMutex#
+		*/
+		EResult addFace(const cv::Mat& frameSave, const SPersonInfor& infor, std::vector<MByte>& feature)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_handleEngine == NULL)
+				return EResult::SR_ASF_Engine_Handle_NULL;
+
+			if (!m_checkFlags.initFalg.load())
+				return EResult::SR_ASF_Engine_Not_Init;
+
+			IplImage* cutImg = cutImage(frameSave);
+			ASF_MultiFaceInfo faces = { 0 };
+			MRESULT res = ASFDetectFaces(m_handleEngine, cutImg->width, cutImg->height, ASVL_PAF_RGB24_B8G8R8, (MUInt8*)cutImg->imageData, &faces);
+			if (res != MOK || faces.faceNum <= 0)
+			{
+				cvReleaseImage(&cutImg);
+				return EResult::SR_NG;
+			}
+
+			int largest = 0;
+			for (int i = 1; i < faces.faceNum; i++)
+			{
+				const MRECT& rect = faces.faceRect[i];
+				const MRECT& best = faces.faceRect[largest];
+				if ((rect.right - rect.left) * (rect.bottom - rect.top) > (best.right - best.left) * (best.bottom - best.top))
+					largest = i;
+			}
+
+			const bool extracted = extractEmbedding(cutImg, faces.faceRect[largest], faces.faceOrient[largest]);
+			cvReleaseImage(&cutImg);
+			if (!extracted)
+				return EResult::SR_ASF_Face_Feature_Extraction_Failed;
+
+			feature = m_feature;
+			return insertFace(infor, feature, m_embedding);
+		}
+
+		/**
+		* \@brief ݿɾһ д̲
+		* \@return ִеĽ
+		*/
+		EResult removeFaceFromDataBase(const size_t ID)
+		{
+			std::lock_guard<std::mutex> databaseLock(m_databaseMutex);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_gallery.erase(ID);
+				if (m_features.erase(ID) == 0)
+					return EResult::SR_NG;
+
+				m_persons.erase(ID);
+			}
+
+			return appendJournal(ID, nullptr, std::vector<MByte>());
+		}
+
+		void setCompareThreshold(const float threshold)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_compareThreshold = threshold;
+		}
+
+		/**
+		* \@brief ȡһ m_featureΪSDKĿ m_embeddingΪļ #÷#
+		*/
+		bool extractEmbedding(IplImage* cutImg, const MRECT& faceRect, const MInt32 faceOrient)
+		{
+			m_infos.singleFaceInfos.faceRect = faceRect;
+			m_infos.singleFaceInfos.faceOrient = faceOrient;
+			m_infos.faceFeature = { 0 };
+			const MRESULT res = ASFFaceFeatureExtract(m_handleEngine, cutImg->width, cutImg->height, ASVL_PAF_RGB24_B8G8R8, (MUInt8*)cutImg->imageData, &m_infos.singleFaceInfos, &m_infos.faceFeature);
+			if (res != MOK || m_infos.faceFeature.feature == NULL || m_infos.faceFeature.featureSize < static_cast<MInt32>(s_featureHeader + sizeof(float)))
+				return false;
+
+			//SDKĻ´γȡʱ
+			m_feature.assign(m_infos.faceFeature.feature, m_infos.faceFeature.feature + m_infos.faceFeature.featureSize);
+			toEmbedding(m_feature, m_embedding);
+			return true;
+		}
+
+		/**
+		* \@brief SDKͷfloat ֻFaceGalleryеĺѡ ƶASFFaceFeatureCompareΪ׼
+		* \@desc ArcFace 2.x/3.x Ϊ1032ֽ SDKʽ 8ֽͷ256floatǰƶϵ
+		* \@desc ƶϲʱû checkProxy()ASFFaceFeatureCompareպʹ ֵ0 Ӱһ
+		*/
+		static void toEmbedding(const std::vector<MByte>& feature, std::vector<float>& embedding)
+		{
+			if (feature.size() < s_featureHeader + sizeof(float))
+			{
+				embedding.clear();
+				return;
+			}
+
+			embedding.resize((feature.size() - s_featureHeader) / sizeof(float));
+			std::memcpy(embedding.data(), feature.data() + s_featureHeader, embedding.size() * sizeof(float));
+			for (auto& value : embedding)
+			{
+				if (!std::isfinite(value))
+					value = 0.f;
+			}
 		}
 
 		/**
@@ -137,10 +479,75 @@ namespace Ghost
 				return EResult::SR_ASF_Engine_Not_Init;
 
 			//ͼת
+			IplImage* cutImg = cutImage(frameIn);
+			const EResult result = process(cutImg, frameOut);
+			cvReleaseImage(&cutImg);
+
+			return result;
+		}
+
+		/**
+		* \@brief ʶ ͼת̳߳ϲ  һγδ
+		* \@param framesIn Ҫмͼ
+		* \@param framesOut Ϊʱ framesInһһӦ
+		* \@param results ÿһ֡Ľ
+		* \@return ִеĽ
+		*/
+		EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+		{
+			if (!framesOut.empty() && framesOut.size() != framesIn.size())
+				return EResult::SR_NG;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_handleEngine == NULL)
+				return EResult::SR_ASF_Engine_Handle_NULL;
+
+			if (!m_checkFlags.initFalg.load())
+				return EResult::SR_ASF_Engine_Not_Init;
+
+			results.assign(framesIn.size(), EResult::SR_OK);
+			std::vector<IplImage*> cutImgs(framesIn.size(), nullptr);
+			Ghost::sharedThreadPool().parallelFor(0, framesIn.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (framesIn[i].empty())
+						results[i] = EResult::SR_Image_Empty;
+					else
+						cutImgs[i] = cutImage(framesIn[i]);
+				}
+			});
+
+			for (size_t i = 0; i < framesIn.size(); i++)
+			{
+				if (cutImgs[i] == nullptr)
+					continue;
+
+				cv::Mat frameEmpty;
+				results[i] = process(cutImgs[i], framesOut.empty() ? frameEmpty : framesOut[i]);
+				cvReleaseImage(&cutImgs[i]);
+			}
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ȲüΪ4ı Ҫ #÷ͷ#
+		*/
+		IplImage* cutImage(const cv::Mat& frameIn)
+		{
 			IplImage temp = frameIn;
 			IplImage* cutImg = cvCreateImage(cvSize(temp.width - temp.width % 4, temp.height), IPL_DEPTH_8U, temp.nChannels);
 			CutIplImage(&temp, cutImg, 0, 0);
+			return cutImg;
+		}
 
+		/**
+		* \@brief תͼмʶ  #÷#
+		*/
+		EResult process(IplImage* cutImg, cv::Mat& frameOut)
+		{
 			//ȼ
 			MRESULT res = MOK;
 			m_infos.multiFaceInfos = { 0 };
@@ -155,10 +562,7 @@ namespace Ghost
 				m_infos.ageInfos = { 0 };
 				res = ASFGetAge(m_handleEngine, &m_infos.ageInfos);
 				if (res != MOK)
-				{
-					cvReleaseImage(&cutImg);
 					return EResult::SR_ASF_Get_Age_Failed;
-				}
 			}
 			//Ա
 			if (m_checkFlags.gender.load())
@@ -166,10 +570,7 @@ namespace Ghost
 				m_infos.genderInfos = { 0 };
 				res = ASFGetGender(m_handleEngine, &m_infos.genderInfos);
 				if (res != MOK)
-				{
-					cvReleaseImage(&cutImg);
 					return EResult::SR_ASF_Get_Gender_Failed;
-				}
 			}
 			//3DǶ
 			if (m_checkFlags.angle.load())
@@ -177,10 +578,7 @@ namespace Ghost
 				m_infos.angleInfos = { 0 };
 				res = ASFGetFace3DAngle(m_handleEngine, &m_infos.angleInfos);
 				if (res != MOK)
-				{
-					cvReleaseImage(&cutImg);
 					return EResult::SR_ASF_Get_Face3DAngle_Failed;
-				}
 			}
 			//Ϣ
 			if (m_checkFlags.liveness.load())
@@ -188,23 +586,22 @@ namespace Ghost
 				m_infos.rgbLivenessInfos = { 0 };
 				res = ASFGetLivenessScore(m_handleEngine, &m_infos.rgbLivenessInfos);
 				if (res != MOK)
-				{
-					cvReleaseImage(&cutImg);
 					return EResult::SR_ASF_Get_LivenessScore_Failed;
-				}
 			}
 			//ȶ
-			//if (m_checkFlags.compare.load())
-			//{
-			//	//ȡ
-			//	res = ASFFaceFeatureExtract(m_handleEngine, cutImg->width, cutImg->height, ASVL_PAF_RGB24_B8G8R8, (MUInt8*)cutImg->imageData,&m_infos.singleFaceInfos,&m_infos.faceFeature);
-			//	if (res != MOK)
-			//		return EResult::SR_ASF_Face_Feature_Extraction_Failed;
-
-			//	//MFloat confidenceLevel = ASFFaceFeatureCompare();
-			//}
+			m_identities.assign(std::max<MInt32>(m_infos.multiFaceInfos.faceNum, 0), SPersonInfor());
+			if (m_checkFlags.compare.load() && !m_features.empty())
+			{
+				for (int i = 0; i < m_infos.multiFaceInfos.faceNum; i++)
+				{
+					//ȡ
+					if (!extractEmbedding(cutImg, m_infos.multiFaceInfos.faceRect[i], m_infos.multiFaceInfos.faceOrient[i]))
+						return EResult::SR_ASF_Face_Feature_Extraction_Failed;
 
-			cvReleaseImage(&cutImg);
+					float confidence = 0.f;
+					compareToLocalDataBase(confidence, m_identities[i]);
+				}
+			}
 
 			//
 			//λϢ
@@ -230,7 +627,8 @@ namespace Ghost
 			const cv::Scalar attributeRectColor(255, 191, 0);
 
 			std::vector<cv::Point> vecPoint;
-			std::vector<Ghost::SPersonInfor> persons(m_infos.multiFaceInfos.faceNum);
+			std::vector<Ghost::SPersonInfor> persons(m_identities);
+			persons.resize(m_infos.multiFaceInfos.faceNum);
 
 			int textCount = 0;
 			int textHeight = 15;
@@ -247,6 +645,8 @@ namespace Ghost
 					Rect faceRect(left, top, width, height);
 					Rect attributeRect(left + width + 12, top+ height /2 - textHeight * 1.5, width/3*2, textHeight*4);
 					cv::rectangle(tobedraw, faceRect, faceRectColor, 2);					//
+					if (!persons[i].name.empty())
+						cv::putText(tobedraw, persons[i].name, cv::Point(left, top - 4), FONT_HERSHEY_PLAIN, 1.0, faceRectColor);
 
 					cv::Point tranglePoints[1][3];
 					tranglePoints[0][0] = cv::Point(left + width, top + height/2); 
@@ -316,13 +716,119 @@ namespace Ghost
 		}
 
 		/**
-		* \@brief				뱾ݽбȶ
-		* \@param confidence	ƥŶ
-		* \@param infor			ƥ䵽˭
+		* \@brief տǰs_checkNum֮ļASFFaceFeatureCompareƶ #÷#
+		* \@desc һ(Kendall taus_checkAgreement)ΪtoEmbeddingƶϳ 3ʱδ
+		*/
+		void checkProxy()
+		{
+			std::vector<const std::vector<MByte>*> samples;
+			for (const auto& iter : m_features)
+			{
+				if (samples.size() == s_checkNum)
+					break;
+				samples.push_back(&iter.second);
+			}
+			if (samples.size() < 3)
+				return;
+
+			std::vector<float> first, second;
+			std::vector<std::pair<float, float>> pairs;
+			for (size_t i = 0; i < samples.size(); i++)
+			{
+				for (size_t j = i + 1; j < samples.size(); j++)
+				{
+					ASF_FaceFeature a = { const_cast<MByte*>(samples[i]->data()), static_cast<MInt32>(samples[i]->size()) };
+					ASF_FaceFeature b = { const_cast<MByte*>(samples[j]->data()), static_cast<MInt32>(samples[j]->size()) };
+					MFloat level = 0.f;
+					toEmbedding(*samples[i], first);
+					toEmbedding(*samples[j], second);
+					if (ASFFaceFeatureCompare(m_handleEngine, &a, &b, &level) != MOK || first.size() != second.size())
+					{
+						m_proxyState = EProxyState::Invalid;
+						return;
+					}
+
+					double dot = 0.0, normA = 0.0, normB = 0.0;
+					for (size_t k = 0; k < first.size(); k++)
+					{
+						dot += static_cast<double>(first[k]) * second[k];
+						normA += static_cast<double>(first[k]) * first[k];
+						normB += static_cast<double>(second[k]) * second[k];
+					}
+					const double norm = std::sqrt(normA * normB);
+					pairs.emplace_back((norm > 0.0) ? static_cast<float>(dot / norm) : 0.f, level);
+				}
+			}
+
+			//һ¶Լһ¶ ԿɱȽϵĶ
+			int agree = 0, total = 0;
+			for (size_t i = 0; i < pairs.size(); i++)
+			{
+				for (size_t j = i + 1; j < pairs.size(); j++)
+				{
+					const float proxy = pairs[i].first - pairs[j].first;
+					const float sdk = pairs[i].second - pairs[j].second;
+					if (proxy == 0.f || sdk == 0.f)
+						continue;
+					agree += ((proxy > 0.f) == (sdk > 0.f)) ? 1 : -1;
+					total++;
+				}
+			}
+			m_proxyState = (total > 0 && agree >= s_checkAgreement * total) ? EProxyState::Valid : EProxyState::Invalid;
+		}
+
+		/**
+		* \@brief				ǰ뱾ݽбȶ FaceGalleryǰs_rescoreNumѡ ASFFaceFeatureCompareȶSDK #÷#
+		* \@desc				δͨcheckProxy()ʱ ÿSDKȶ
+		* \@param confidence	ƥŶ ASFFaceFeatureCompareƶ m_compareThresholdʱΪ0
+		* \@param infor			ƥ䵽˭ ûƥʱ޸
 		*/
 		void compareToLocalDataBase(float& confidence, SPersonInfor& infor)
 		{
+			confidence = 0.f;
+			if (m_proxyState == EProxyState::Unchecked)
+				checkProxy();
+
+			m_candidates.clear();
+			if (m_proxyState == EProxyState::Valid && m_gallery.dimension() == static_cast<int>(m_embedding.size()))
+			{
+				FaceGallery::SMatch matches[s_rescoreNum];
+				const size_t found = m_gallery.search(m_embedding.data(), s_rescoreNum, matches, m_galleryWorkspace);
+				for (size_t i = 0; i < found; i++)
+					m_candidates.push_back(matches[i].ID);
+			}
+			else
+			{
+				for (const auto& iter : m_features)
+					m_candidates.push_back(iter.first);
+			}
+
+			ASF_FaceFeature current = { m_feature.data(), static_cast<MInt32>(m_feature.size()) };
+			MFloat best = -1.f;
+			size_t bestID = 0;
+			for (const size_t ID : m_candidates)
+			{
+				const auto feature = m_features.find(ID);
+				if (feature == m_features.end())
+					continue;
 
+				ASF_FaceFeature stored = { const_cast<MByte*>(feature->second.data()), static_cast<MInt32>(feature->second.size()) };
+				MFloat level = 0.f;
+				if (ASFFaceFeatureCompare(m_handleEngine, &current, &stored, &level) == MOK && level > best)
+				{
+					best = level;
+					bestID = ID;
+				}
+			}
+			if (best < m_compareThreshold)
+				return;
+
+			confidence = best;
+			const auto iter = m_persons.find(bestID);
+			if (iter != m_persons.end())
+				infor = iter->second;
+			else
+				infor.ID = bestID;
 		}
 
 		/**
@@ -384,8 +890,30 @@ namespace Ghost
 		};
 		Sinfor m_infos;
 
-		//
+		//
+		FaceGallery m_gallery;								// ѯɾ
+		FaceGallery::SWorkspace m_galleryWorkspace;
+		std::map<size_t, SPersonInfor> m_persons;			//ID -> ԱϢ
+		std::unordered_map<size_t, std::vector<MByte>> m_features;	//ID -> SDK ASFFaceFeatureCompare
+		std::vector<MByte> m_feature;						//ǰSDK
+		std::vector<float> m_embedding;						//ǰļ
+		std::vector<size_t> m_candidates;					//ASFFaceFeatureCompareȶԵID
+		std::vector<SPersonInfor> m_identities;				//֡ÿ˭
+		float m_compareThreshold;							//Ϊڿ
+		size_t m_journalRecords;							//֮־еɾ
+
+		//Ƿ غһαȶʱ
+		enum struct EProxyState : uint8_t
+		{
+			Unchecked = 0,
+			Valid,
+			Invalid
+		};
+		EProxyState m_proxyState;
+
+		// m_mutexȡڴ m_databaseMutexлɾд ȡm_databaseMutex
 		std::mutex m_mutex;
+		std::mutex m_databaseMutex;
 
 		//źŲ
 		Ghost::signalslot::Signal<void(const std::vector<Ghost::SPersonInfor>&)> m_SINGNAL_void_persons;
@@ -393,6 +921,20 @@ namespace Ghost
 
 		//汾Ϣ
 		const static string s_version;
+		//ļ
+		static string m_databasePath;
+		//еļ
+		const static string s_galleryFile;
+		const static string s_personFile;
+		const static string s_featureFile;
+		const static string s_journalFile;
+		static constexpr char s_journalAdd = 'A';
+		static constexpr char s_journalRemove = 'R';
+		static constexpr size_t s_minJournalRecords = 256;		//־ôźϲ
+		static constexpr size_t s_featureHeader = 8;			//SDKͷֽ
+		static constexpr size_t s_rescoreNum = 32;				//SDKȶԵĺѡ
+		static constexpr size_t s_checkNum = 8;					//checkProxy()յ
+		static constexpr double s_checkAgreement = 0.8;			//checkProxy()ҪKendall tau
 		//SDK app ID
 		const static string s_ArcVisionAppID;
 		//SDK Key
@@ -419,6 +961,12 @@ namespace Ghost
 #endif
 #endif
 
+	string FaceRecognition::Impl::m_databasePath = "";
+	const string FaceRecognition::Impl::s_galleryFile = "faces.gallery";
+	const string FaceRecognition::Impl::s_personFile = "persons.txt";
+	const string FaceRecognition::Impl::s_featureFile = "faces.features";
+	const string FaceRecognition::Impl::s_journalFile = "faces.journal";
+
 	const string FaceRecognition::Impl::s_ArcVisionAppID = "9Wi3M1eb6QN8rxraQsuXSgTTeex42goNbtCHCTgvve4z";
 	const string FaceRecognition::Impl::s_ArcVisionKey = "8v36mvg9Ee4x9quV8sPcTqHMw2FukHvTWnnpCH2k5A3P";
 
@@ -439,6 +987,12 @@ namespace Ghost
 
 	EResult FaceRecognition::setPath(const string& databasePath, const string& cfgPath, const string& weightPath) noexcept(true)
 	{
+		std::error_code error;
+		if (!fs::exists(databasePath, error) && !fs::create_directories(databasePath, error))
+			return EResult::SR_Folder_Not_Exist;
+
+		FaceRecognition::Impl::m_databasePath = databasePath;
+
 		return EResult::SR_OK;
 	}
 
@@ -497,6 +1051,16 @@ namespace Ghost
 			m_pImpl->m_checkFlags.liveness.store(switchFlag);
 			break;
 		}
+		case EModualParamType::TYPE_FACE_RECONGNITION_Compare:
+		{
+			m_pImpl->m_checkFlags.compare.store(switchFlag);
+			break;
+		}
+		case EModualParamType::TYPE_FACE_RECONGNITION_Threshold:
+		{
+			m_pImpl->setCompareThreshold(value);
+			break;
+		}
 		default:
 			break;
 		}
@@ -509,6 +1073,15 @@ namespace Ghost
 		return m_pImpl->detect(frameIn, frameOut);
 	}
 
+	EResult FaceRecognition::detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+	{
+		const EResult result = m_pImpl->detectBatch(framesIn, framesOut, results);
+		if (result != EResult::SR_OK)
+			return result;
+
+		return firstFailure(results);
+	}
+
 	EDetectModual FaceRecognition::getModualType() noexcept(true)
 	{
 		return EDetectModual::HumanFace_Recognition_Modual;
@@ -519,6 +1092,11 @@ namespace Ghost
 		return m_pImpl->saveFaceToDataBase(frameSave, infor);
 	}
 
+	EResult FaceRecognition::removeFaceFromDataBase(const size_t ID)
+	{
+		return m_pImpl->removeFaceFromDataBase(ID);
+	}
+
 	void FaceRecognition::bindSlotFaceFind(const std::function<void(const std::vector<Ghost::SPersonInfor>&)>& func)
 	{
 		m_pImpl->m_SLOT_void_rects = m_pImpl->m_SINGNAL_void_persons.connect(func);
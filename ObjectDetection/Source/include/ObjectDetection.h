@@ -47,6 +47,13 @@ namespace Ghost
 		*/
 		static EResult setPath(const string& dataPath, const string& cfgPath, const string& weightPath) noexcept(true);
 
+		/**
+		* \@brief Setting the path of the INT8 calibration table #the file is written by calibrateInt8 and may not exist yet#
+		* \@param calibrationPath:: calibration table Path
+		* \@return Returns the result of execution
+		*/
+		static EResult setCalibrationPath(const string& calibrationPath) noexcept(true);
+
 		/**
 		* \@brief Get the version number of the current library
 		*/
@@ -91,18 +98,67 @@ namespace Ghost
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Detect a batch of frames, resizing and drawing run on the shared thread pool while the network runs the frames back to back under one lock
+		* \@param framesIn::Images for detection
+		* \@param framesOut::Empty if nothing needs to be drawn, else one image per frame
+		* \@param results::Result of each frame
+		* \@return SR_OK if every frame succeeded, else the first failure
+		*/
+		virtual EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results) override;
+
+		/**
+		* \@brief Queue a frame into the preprocess -> infer -> postprocess pipeline, the drawn frame arrives through bindSlotAsyncResult
+		* \@desc frame N+1 is preprocessed and frame N-1 is drawn while frame N is in the network
+		* \@warning call from one thread only, the stage threads start on the first call and stop in antiModual,
+		* \@warning setInt8, setModualParam(thread number), calibrateInt8 and reportInt8 also stop them and drop the frames in flight
+		* \@warning while the pipeline runs bindSlotObjectFind, bindSlotPersonFind and bindSlotAsyncResult are called on the postprocess thread,
+		* \@warning from those slots detectAsync, antiModual, setInt8, setModualParam(thread number), calibrateInt8 and reportInt8 return SR_Pipeline_Thread_Call
+		* \@param frameIn::Image for detection #copied, the caller may reuse it#
+		* \@param frameIndex::Index handed back with the result
+		* \@return SR_Pipeline_Full if the pipeline is full and the frame was dropped
+		*/
+		EResult detectAsync(const cv::Mat& frameIn, const size_t frameIndex);
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
 		*/
 		virtual EDetectModual getModualType() noexcept(true) override;
 
+		/**
+		* \@brief Run the FP32 network over every image in the folder and write the INT8 activation table to the calibration path
+		* \@param imageFolder:: folder of representative images #jpg/png/bmp#
+		* \@return Returns the result of execution
+		*/
+		EResult calibrateInt8(const string& imageFolder);
+
+		/**
+		* \@brief Run FP32 and INT8 over every image in the folder and write the accuracy-vs-speed report
+		* \@desc accuracy is measured against the FP32 detections #same class, IoU >= 0.5#
+		* \@param imageFolder:: folder of evaluation images
+		* \@param reportPath:: report file Path
+		* \@return Returns the result of execution
+		*/
+		EResult reportInt8(const string& imageFolder, const string& reportPath);
+
 	public GHOST_SIGNAL:
 	/**
-	* \@brief
+	* \@brief Names of the classes #called on the postprocess thread for frames of detectAsync#
 	*/
 	void bindSlotObjectFind(const std::function<void(const std::vector<std::string>&)>& func);
 
+	/**
+	* \@brief Result of detectAsync #called on the postprocess thread, frameShow is only valid during the call#
+	*/
+	void bindSlotAsyncResult(const std::function<void(const size_t frameIndex, const cv::Mat& frameShow)>& func);
+
+	/**
+	* \@brief Boxes of the "person" class in frame pixels, emitted for every detected frame #feeds PoseDetector::detectRois#
+	* \@desc called on the postprocess thread for frames of detectAsync
+	*/
+	void bindSlotPersonFind(const std::function<void(const std::vector<cv::Rect>&)>& func);
+
 	private:
 		class Impl;
 		unique_ptr<Impl> m_pImpl;
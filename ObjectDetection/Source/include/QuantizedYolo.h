@@ -0,0 +1,168 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				QuantizedYolo.h
+* \@brief Desc:				In-tree CPU inference of darknet YOLO cfg/weights with FP32 and INT8 paths
+* \@brief prerequisite::	C++17 SSE4.1 (AVX2/AVX-512-VNNI used when present)
+*/
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace Ghost
+{
+	class ThreadPool;
+
+	/**
+	* \@brief YOLO (v3 / v3-tiny layer set) running on our own kernels
+	* \@desc INT8 mode quantizes the weights per output channel and the activations per tensor with the calibration table,
+	* \@desc the first convolution stays FP32. The network is not thread safe, use one instance per inference thread.
+	*/
+	class QuantizedYolo final
+	{
+	public:
+		/**
+		* \@brief Arithmetic used by the convolutions
+		*/
+		enum struct EPrecision : uint8_t
+		{
+			FP32 = 0,
+			INT8
+		};
+
+		/**
+		* \@brief One detection in source image pixels
+		*/
+		struct SBox
+		{
+			float x, y, w, h;						//top-left corner, width, height
+			float prob;								//objectness * class probability
+			int classID;							//class index in the names file
+
+			SBox() : x(0.f), y(0.f), w(0.f), h(0.f), prob(0.f), classID(-1) {}
+		};
+
+		/**
+		* \@brief Preprocessed network input #net size, RGB planar, 0~1#
+		*/
+		struct SInput
+		{
+			simd::AlignedVector<float> data;
+			int imageWidth;							//width of the source frame
+			int imageHeight;						//height of the source frame
+
+			SInput() : imageWidth(0), imageHeight(0) {}
+		};
+
+		/**
+		* \@brief Raw output of every yolo layer, owned by the caller so postprocessing can overlap the next forward
+		*/
+		struct SOutput
+		{
+			std::vector<simd::AlignedVector<float>> yoloOutputs;
+			int imageWidth;
+			int imageHeight;
+
+			SOutput() : imageWidth(0), imageHeight(0) {}
+		};
+
+	public:
+		QuantizedYolo();
+		~QuantizedYolo();
+
+		QuantizedYolo(const QuantizedYolo&) = delete;
+		QuantizedYolo& operator=(const QuantizedYolo&) = delete;
+
+	public:
+		/**
+		* \@brief Parse the darknet cfg and load the weights #BN is folded into the convolutions#
+		* \@return Returns the result of execution
+		*/
+		EResult load(const std::string& cfgPath, const std::string& weightPath);
+
+		/**
+		* \@brief Load/Save the activation table written by the calibration
+		* \@return Returns the result of execution
+		*/
+		EResult loadCalibration(const std::string& calibrationPath);
+		EResult saveCalibration(const std::string& calibrationPath) const;
+
+		/**
+		* \@brief Calibration: reset -> calibrate(per image, runs FP32) -> finishCalibration
+		*/
+		void resetCalibration();
+		void calibrate(const SInput& input);
+		EResult finishCalibration();
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setPrecision(const EPrecision precision);
+		EPrecision getPrecision() const noexcept(true) { return m_precision; }
+		void setThreadNum(const size_t threadNum);			//!< the pool is created on the first forward pass that needs it
+		void setIsa(const simd::EIsa isa) noexcept(true) { m_isa = simd::resolveIsa(isa); }
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+		void setNms(const float nms) noexcept(true) { m_nms = nms; }
+		int getNetWidth() const noexcept(true) { return m_netWidth; }
+		int getNetHeight() const noexcept(true) { return m_netHeight; }
+		bool isLoaded() const noexcept(true) { return !m_layers.empty(); }
+		bool isCalibrated() const noexcept(true) { return m_calibrated; }
+
+		/**
+		* \@brief Stage 1::resize to the net size, BGR->RGB, scale to 0~1, HWC->CHW
+		*/
+		void preprocess(const cv::Mat& frame, SInput& input) const;
+
+		/**
+		* \@brief Stage 2::run the network and copy the yolo layers out
+		*/
+		void infer(const SInput& input, SOutput& output);
+
+		/**
+		* \@brief Stage 3::decode the yolo layers and apply per-class NMS
+		*/
+		std::vector<SBox> postprocess(const SOutput& output, const float thresh) const;
+
+		/**
+		* \@brief All three stages
+		*/
+		std::vector<SBox> detect(const cv::Mat& frame, const float thresh = 0.2f);
+
+	private:
+		struct SLayer;
+
+		const float* forward(const float* input, const bool calibrate);
+		void forwardConvolution(SLayer& layer, const float* input, const bool calibrate);
+		void convolutionFp32(SLayer& layer, const float* input);
+		void convolutionInt8(SLayer& layer, const float* input);
+		void activate(SLayer& layer);
+		void forwardMaxpool(SLayer& layer, const float* input);
+		void forwardUpsample(SLayer& layer, const float* input);
+		void forwardYolo(SLayer& layer, const float* input);
+		void parallelFor(const size_t begin, const size_t end, const std::function<void(size_t, size_t)>& func, const size_t grain = 1);
+
+	private:
+		std::vector<std::unique_ptr<SLayer>> m_layers;		//!< network layers in cfg order
+		std::unique_ptr<ThreadPool> m_pPool;				//!< worker pool for the GEMM, created on the first parallel layer
+		size_t m_threadNum;									//!< 0::all cores
+
+		simd::AlignedVector<float> m_colBuffer;				//!< FP32 im2col workspace
+		simd::AlignedVector<int8_t> m_quantInput;			//!< quantized input tensor
+		simd::AlignedVector<int8_t> m_quantCol;				//!< INT8 transposed im2col workspace
+
+		EPrecision m_precision;
+		simd::EIsa m_isa;
+		float m_nms;
+		int m_netWidth, m_netHeight, m_netChannels;
+		size_t m_calibrationImages;
+		bool m_calibrated;
+	};
+}///namespace Ghost
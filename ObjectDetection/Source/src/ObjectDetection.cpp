@@ -1,16 +1,61 @@
 #include "ObjectDetection.h"
 
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <mutex>
+#include <thread>
 
+#include "GSpscQueue.hpp"
+#include "GThreadPool.hpp"
+#include "QuantizedYolo.h"
 #include "yolo_v2_class.hpp"
 
 using namespace std;
 namespace fs = std::filesystem;
 using namespace Ghost::signalslot;
 
+namespace
+{
+	/**
+	* \@brief Images of the folder in name order
+	*/
+	std::vector<fs::path> listImages(const string& imageFolder)
+	{
+		std::vector<fs::path> images;
+		if (!fs::is_directory(imageFolder))
+			return images;
+
+		for (const auto& entry : fs::directory_iterator(imageFolder))
+		{
+			if (!entry.is_regular_file())
+				continue;
+
+			string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return static_cast<char>(::tolower(c)); });
+			if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp")
+				images.push_back(entry.path());
+		}
+		std::sort(images.begin(), images.end());
+
+		return images;
+	}
+
+	float intersectionOverUnion(const Ghost::QuantizedYolo::SBox& a, const Ghost::QuantizedYolo::SBox& b)
+	{
+		const float iw = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+		const float ih = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+		if (iw <= 0.f || ih <= 0.f)
+			return 0.f;
+
+		const float inter = iw * ih;
+		return inter / (a.w * a.h + b.w * b.h - inter);
+	}
+}
+
 
 namespace Ghost
 {
@@ -24,7 +69,10 @@ namespace Ghost
 		*/
 	public:
 		Impl()
-			: m_pDetector(nullptr)
+			:
+			m_pDetector(nullptr), m_pQuantized(nullptr), m_threadNum(0),
+			m_inputQueue(s_pipelineDepth), m_inferQueue(s_pipelineDepth), m_postQueue(s_pipelineDepth),
+			m_pipelineStopFlag(true)
 		{}
 
 		~Impl()
@@ -39,17 +87,27 @@ namespace Ghost
 		{
 			std::lock_guard<std::mutex> lock(m_mutex);
 
-			if (m_pDetector != nullptr)
+			if (m_States.initFlag.load())
 				return EResult::SR_Detector_Already_Exist;
 
 			if (!ObjectDetector::Impl::s_pathFlag.load())
 				return EResult::SR_Data_Path_Not_Set;
 
-			m_pDetector = std::make_unique<Detector>(s_Paths.cfgPath, s_Paths.weightPath);
-			if (m_pDetector == nullptr)
+			//INT8 ģʽֻCPU darknet
+			if (m_States.int8Flag.load())
+			{
+				EResult result = loadQuantized();
+				if (result != EResult::SR_OK)
+					return result;
+			}
+			else
 			{
-				m_States.initFlag.store(false);
-				return EResult::SR_Detector_Memory_Allocation_Failed;
+				m_pDetector = std::make_unique<Detector>(s_Paths.cfgPath, s_Paths.weightPath);
+				if (m_pDetector == nullptr)
+				{
+					m_States.initFlag.store(false);
+					return EResult::SR_Detector_Memory_Allocation_Failed;
+				}
 			}
 
 			auto funcGetObjectsNamefromFile = [](const std::string& filename) ->std::vector<std::string>
@@ -71,13 +129,21 @@ namespace Ghost
 
 		EResult antiModual()
 		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+			stopPipeline();
+
 			std::lock_guard<std::mutex> lock(m_mutex);
 
-			if (m_pDetector == nullptr)
+			if (m_pDetector == nullptr && m_pQuantized == nullptr)
 				return EResult::SR_Detector_Not_Exist;
 
 			m_pDetector.reset();
 			m_pDetector = nullptr;
+			m_pQuantized.reset();
+			m_pQuantized = nullptr;
 
 			m_States.initFlag.store(false);
 
@@ -94,7 +160,14 @@ namespace Ghost
 			if (frameIn.empty())
 				return EResult::SR_Image_Empty;
 
-			m_resultBoxs = m_pDetector->detect(frameIn);
+			if (m_States.int8Flag.load())
+				m_resultBoxs = toBoxes(m_pQuantized->detect(frameIn));
+			else
+			{
+				m_resultBoxs = m_pDetector->detect(frameIn);
+			}
+
+			emitPersons(m_resultBoxs);
 
 			if (!frameShow.empty())
 			{
@@ -108,6 +181,310 @@ namespace Ghost
 			return EResult::SR_OK;
 		}
 
+		/**
+		* \@brief  Ԥ̳߳ϲ ǰһγִ
+		*/
+		EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+		{
+			if (!framesOut.empty() && framesOut.size() != framesIn.size())
+				return EResult::SR_NG;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_States.initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			const bool int8Flag = m_States.int8Flag.load();
+			std::vector<SPipelineFrame> frames(framesIn.size());
+			results.assign(framesIn.size(), EResult::SR_OK);
+
+			auto& pool = Ghost::sharedThreadPool();
+			pool.parallelFor(0, frames.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (framesIn[i].empty())
+					{
+						results[i] = EResult::SR_Image_Empty;
+						continue;
+					}
+
+					if (int8Flag)
+						m_pQuantized->preprocess(framesIn[i], frames[i].input);
+					else
+						frames[i].image = m_pDetector->mat_to_image_resize(framesIn[i]);
+				}
+			});
+
+			for (size_t i = 0; i < frames.size(); i++)
+			{
+				if (results[i] != EResult::SR_OK)
+					continue;
+
+				if (int8Flag)
+					m_pQuantized->infer(frames[i].input, frames[i].output);
+				else
+					frames[i].boxes = m_pDetector->detect_resized(*frames[i].image, framesIn[i].cols, framesIn[i].rows);
+			}
+
+			pool.parallelFor(0, frames.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (results[i] != EResult::SR_OK)
+						continue;
+
+					if (int8Flag)
+						frames[i].boxes = toBoxes(m_pQuantized->postprocess(frames[i].output, 0.2f));
+
+					if (!framesOut.empty() && !framesOut[i].empty())
+						drawObject(framesOut[i], frames[i].boxes, m_vecObjName);
+				}
+			});
+
+			for (size_t i = 0; i < frames.size(); i++)
+			{
+				if (results[i] == EResult::SR_OK)
+					emitPersons(frames[i].boxes);
+			}
+
+			if (!frames.empty())
+				m_resultBoxs = frames.back().boxes;
+
+			if (!framesOut.empty())
+				m_SIGNAL_void_Objects(m_vecObjName);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ˮ һ̵߳ ʱ֡
+		* \@desc m_pipelineMutex ֹͣˮ߲޸ļڳֱ޸ ڼ滻ʱ
+		*/
+		EResult detectAsync(const cv::Mat& frameIn, const size_t frameIndex)
+		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+
+			if (!m_States.initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			if (m_pipelineStopFlag.load())
+				startPipeline();
+
+			auto pFrame = std::make_unique<SPipelineFrame>();
+			pFrame->index = frameIndex;
+			pFrame->frame = frameIn.clone();
+
+			if (!m_inputQueue.tryPush(pFrame))
+				return EResult::SR_Pipeline_Full;
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief л FP32/INT8  ѳʼʱضӦļ
+		* \@desc ˮ߸׶βʹü ͣˮ һdetectAsync
+		*/
+		EResult setInt8(const bool int8Flag)
+		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+			stopPipeline();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_States.initFlag.load())
+			{
+				if (int8Flag)
+				{
+					EResult result = loadQuantized();
+					if (result != EResult::SR_OK)
+						return result;
+				}
+				else if (m_pDetector == nullptr)
+				{
+					m_pDetector = std::make_unique<Detector>(s_Paths.cfgPath, s_Paths.weightPath);
+					if (m_pDetector == nullptr)
+						return EResult::SR_Detector_Memory_Allocation_Failed;
+				}
+			}
+
+			m_States.int8Flag.store(int8Flag);
+
+			return EResult::SR_OK;
+		}
+
+		EResult setThreadNum(const size_t threadNum)
+		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+			stopPipeline();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_threadNum = threadNum;
+			if (m_pQuantized != nullptr)
+				m_pQuantized->setThreadNum(threadNum);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief У׼޸CPU ͣˮ
+		*/
+		EResult calibrateInt8(const string& imageFolder)
+		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+			stopPipeline();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (s_Paths.calibrationPath.empty())
+				return EResult::SR_Data_Path_Not_Set;
+
+			const std::vector<fs::path> images = listImages(imageFolder);
+			if (images.empty())
+				return EResult::SR_Calibration_Image_Not_Exist;
+
+			EResult result = loadQuantized();
+			if (result != EResult::SR_OK)
+				return result;
+
+			QuantizedYolo::SInput input;
+			m_pQuantized->resetCalibration();
+			for (const auto& path : images)
+			{
+				cv::Mat image = cv::imread(path.string());
+				if (image.empty())
+					continue;
+
+				m_pQuantized->preprocess(image, input);
+				m_pQuantized->calibrate(input);
+			}
+
+			result = m_pQuantized->finishCalibration();
+			if (result != EResult::SR_OK)
+				return result;
+
+			return m_pQuantized->saveCalibration(s_Paths.calibrationPath);
+		}
+
+		/**
+		* \@brief ʱFP32/INT8֮л ͣˮ е֡ỻ
+		*/
+		EResult reportInt8(const string& imageFolder, const string& reportPath)
+		{
+			if (onPipelineThread())
+				return EResult::SR_Pipeline_Thread_Call;
+
+			std::lock_guard<std::mutex> pipelineLock(m_pipelineMutex);
+			stopPipeline();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			const std::vector<fs::path> images = listImages(imageFolder);
+			if (images.empty())
+				return EResult::SR_Calibration_Image_Not_Exist;
+
+			EResult result = loadQuantized();
+			if (result != EResult::SR_OK)
+				return result;
+
+			using Clock = std::chrono::steady_clock;
+			double fp32Time = 0.0, int8Time = 0.0, iouSum = 0.0;
+			size_t fp32Boxes = 0, int8Boxes = 0, matched = 0, imageNum = 0;
+
+			for (const auto& path : images)
+			{
+				cv::Mat image = cv::imread(path.string());
+				if (image.empty())
+					continue;
+
+				m_pQuantized->setPrecision(QuantizedYolo::EPrecision::FP32);
+				auto start = Clock::now();
+				const auto baseline = m_pQuantized->detect(image);
+				fp32Time += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+				m_pQuantized->setPrecision(QuantizedYolo::EPrecision::INT8);
+				start = Clock::now();
+				const auto quantized = m_pQuantized->detect(image);
+				int8Time += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+				//̰ƥ ͬ IoU >= 0.5
+				std::vector<bool> used(baseline.size(), false);
+				for (const auto& box : quantized)
+				{
+					int best = -1;
+					float bestIou = 0.5f;
+					for (size_t i = 0; i < baseline.size(); i++)
+					{
+						if (used[i] || baseline[i].classID != box.classID)
+							continue;
+
+						const float iou = intersectionOverUnion(baseline[i], box);
+						if (iou >= bestIou)
+						{
+							bestIou = iou;
+							best = static_cast<int>(i);
+						}
+					}
+					if (best >= 0)
+					{
+						used[best] = true;
+						matched++;
+						iouSum += bestIou;
+					}
+				}
+
+				fp32Boxes += baseline.size();
+				int8Boxes += quantized.size();
+				imageNum++;
+			}
+
+			m_pQuantized->setPrecision(m_States.int8Flag.load() ? QuantizedYolo::EPrecision::INT8 : QuantizedYolo::EPrecision::FP32);
+			if (imageNum == 0)
+				return EResult::SR_Calibration_Image_Not_Exist;
+
+			std::ofstream file(reportPath, std::ios::trunc);
+			if (!file.is_open())
+				return EResult::SR_NG;
+
+			const double fp32Mean = fp32Time / imageNum;
+			const double int8Mean = int8Time / imageNum;
+			file << std::fixed << std::setprecision(3);
+			file << "ObjectDetector INT8 report\n";
+			file << "images:        " << imageNum << "\n";
+			file << "isa:           " << simd::isaName(m_pQuantized->getIsa()) << "\n";
+			file << "threads:       " << ((m_threadNum == 0) ? std::thread::hardware_concurrency() : m_threadNum) << "\n";
+			file << "calibrated:    " << (m_pQuantized->isCalibrated() ? "yes" : "no (per frame activation range)") << "\n";
+			file << "\n";
+			file << "FP32 mean ms:  " << fp32Mean << "   fps: " << ((fp32Mean > 0.0) ? 1000.0 / fp32Mean : 0.0) << "\n";
+			file << "INT8 mean ms:  " << int8Mean << "   fps: " << ((int8Mean > 0.0) ? 1000.0 / int8Mean : 0.0) << "\n";
+			file << "speedup:       " << ((int8Mean > 0.0) ? fp32Mean / int8Mean : 0.0) << "\n";
+			file << "\n";
+			file << "FP32 boxes:    " << fp32Boxes << "\n";
+			file << "INT8 boxes:    " << int8Boxes << "\n";
+			file << "matched:       " << matched << "\n";
+			file << "precision:     " << ((int8Boxes > 0) ? static_cast<double>(matched) / int8Boxes : 1.0) << "\n";
+			file << "recall:        " << ((fp32Boxes > 0) ? static_cast<double>(matched) / fp32Boxes : 1.0) << "\n";
+			file << "mean IoU:      " << ((matched > 0) ? iouSum / matched : 0.0) << "\n";
+
+			return EResult::SR_OK;
+		}
+
 		void drawObject(cv::Mat& mat_img, std::vector<bbox_t> result_vec, std::vector<std::string> obj_names, int current_det_fps = -1, int current_cap_fps = -1)
 		{
 			int const colors[6][3] = { { 1,0,1 },{ 0,0,1 },{ 0,1,1 },{ 0,1,0 },{ 1,1,0 },{ 1,0,0 } };
@@ -165,6 +542,196 @@ namespace Ghost
 			}
 		}
 
+	private:
+		/**
+		* \@brief ˮеһ֡ ׶
+		*/
+		struct SPipelineFrame
+		{
+			size_t index;								//÷֡
+			bool int8Flag;								//Ԥʱģʽ
+			cv::Mat frame;								//ԭͼ ʱϻ
+			QuantizedYolo::SInput input;				//CPU
+			QuantizedYolo::SOutput output;				//CPU
+			std::shared_ptr<image_t> image;				//darknet
+			std::vector<bbox_t> boxes;					//darknet/Ľ
+
+			SPipelineFrame() : index(0), int8Flag(false) {}
+		};
+		using FramePtr = std::unique_ptr<SPipelineFrame>;
+
+		/**
+		* \@brief ׶߳ #÷m_pipelineMutex#
+		*/
+		void startPipeline()
+		{
+			if (!m_pipelineStopFlag.load())
+				return;
+
+			m_pipelineStopFlag.store(false);
+			m_pipelineThreads.emplace_back([this]() { s_pPipelineOwner = this; this->preprocessLoop(); });
+			m_pipelineThreads.emplace_back([this]() { s_pPipelineOwner = this; this->inferLoop(); });
+			m_pipelineThreads.emplace_back([this]() { s_pPipelineOwner = this; this->postprocessLoop(); });
+		}
+
+		/**
+		* \@brief ͣ²ȴ׶߳ е֡ #÷m_pipelineMutex m_mutex ׶Ҫȡm_mutex#
+		*/
+		void stopPipeline()
+		{
+			if (m_pipelineStopFlag.load())
+				return;
+
+			m_pipelineStopFlag.store(true);
+			for (auto& thread : m_pipelineThreads)
+			{
+				if (thread.joinable())
+					thread.join();
+			}
+			m_pipelineThreads.clear();
+
+			//δɵ֡
+			FramePtr pFrame;
+			while (m_inputQueue.tryPop(pFrame)) {}
+			while (m_inferQueue.tryPop(pFrame)) {}
+			while (m_postQueue.tryPop(pFrame)) {}
+		}
+
+		/**
+		* \@brief źں߳Ϸ ֹͣˮ߻joinԼ Щڽ׶ֱ߳ӷش
+		*/
+		bool onPipelineThread() const noexcept(true)
+		{
+			return s_pPipelineOwner == this;
+		}
+
+		/**
+		* \@brief ׶1::ŵߴ 
+		* \@desc ׶̲߳ʹm_pQuantized/m_pDetector 滻޸ļڶstopPipeline
+		*/
+		void preprocessLoop()
+		{
+			FramePtr pFrame;
+			while (m_inputQueue.waitPop(pFrame, m_pipelineStopFlag))
+			{
+				pFrame->int8Flag = m_States.int8Flag.load();
+				if (pFrame->int8Flag && m_pQuantized != nullptr)
+					m_pQuantized->preprocess(pFrame->frame, pFrame->input);
+				else if (!pFrame->int8Flag && m_pDetector != nullptr)
+					pFrame->image = m_pDetector->mat_to_image_resize(pFrame->frame);
+				else
+					continue;
+
+				if (!m_inferQueue.waitPush(pFrame, m_pipelineStopFlag))
+					return;
+			}
+		}
+
+		/**
+		* \@brief ׶2::ǰ ͬdetectü ˳
+		*/
+		void inferLoop()
+		{
+			FramePtr pFrame;
+			while (m_inferQueue.waitPop(pFrame, m_pipelineStopFlag))
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (pFrame->int8Flag)
+						m_pQuantized->infer(pFrame->input, pFrame->output);
+					else
+						pFrame->boxes = m_pDetector->detect_resized(*pFrame->image, pFrame->frame.cols, pFrame->frame.rows);
+				}
+
+				if (!m_postQueue.waitPush(pFrame, m_pipelineStopFlag))
+					return;
+			}
+		}
+
+		/**
+		* \@brief ׶3:: NMS  ź
+		*/
+		void postprocessLoop()
+		{
+			FramePtr pFrame;
+			while (m_postQueue.waitPop(pFrame, m_pipelineStopFlag))
+			{
+				if (pFrame->int8Flag)
+					pFrame->boxes = toBoxes(m_pQuantized->postprocess(pFrame->output, 0.2f));
+
+				drawObject(pFrame->frame, pFrame->boxes, m_vecObjName);
+
+				emitPersons(pFrame->boxes);
+				m_SIGNAL_void_Objects(m_vecObjName);
+				m_SIGNAL_void_AsyncResult(pFrame->index, pFrame->frame);
+			}
+		}
+
+		/**
+		* \@brief "person"Ŀ ֱӽPoseDetector::detectRois
+		*/
+		void emitPersons(const std::vector<bbox_t>& boxes)
+		{
+			std::vector<cv::Rect> persons;
+			for (const auto& box : boxes)
+			{
+				if (box.obj_id < m_vecObjName.size() && m_vecObjName[box.obj_id] == "person")
+					persons.emplace_back(box.x, box.y, box.w, box.h);
+			}
+			m_SIGNAL_void_Persons(persons);
+		}
+
+		static std::vector<bbox_t> toBoxes(const std::vector<QuantizedYolo::SBox>& boxes)
+		{
+			std::vector<bbox_t> results;
+			results.reserve(boxes.size());
+			for (const auto& box : boxes)
+			{
+				bbox_t result;
+				result.x = static_cast<unsigned int>(box.x);
+				result.y = static_cast<unsigned int>(box.y);
+				result.w = static_cast<unsigned int>(box.w);
+				result.h = static_cast<unsigned int>(box.h);
+				result.prob = box.prob;
+				result.obj_id = static_cast<unsigned int>(box.classID);
+				result.track_id = 0;
+				result.frames_counter = 0;
+				result.x_3d = result.y_3d = result.z_3d = NAN;
+				results.push_back(result);
+			}
+			return results;
+		}
+
+		/**
+		* \@brief CPU У׼ʱһ #÷#
+		*/
+		EResult loadQuantized()
+		{
+			if (m_pQuantized != nullptr)
+				return EResult::SR_OK;
+
+			if (!ObjectDetector::Impl::s_pathFlag.load())
+				return EResult::SR_Data_Path_Not_Set;
+
+			auto pQuantized = std::make_unique<QuantizedYolo>();
+			EResult result = pQuantized->load(s_Paths.cfgPath, s_Paths.weightPath);
+			if (result != EResult::SR_OK)
+				return result;
+
+			if (!s_Paths.calibrationPath.empty() && fs::exists(s_Paths.calibrationPath))
+			{
+				result = pQuantized->loadCalibration(s_Paths.calibrationPath);
+				if (result != EResult::SR_OK)
+					return result;
+			}
+
+			pQuantized->setThreadNum(m_threadNum);
+			pQuantized->setPrecision(QuantizedYolo::EPrecision::INT8);
+			m_pQuantized = std::move(pQuantized);
+
+			return EResult::SR_OK;
+		}
+
 		/**
 		* \@brief Ա
 		*/
@@ -174,10 +741,11 @@ namespace Ghost
 			string dataPath;					//Data Path
 			string cfgPath;						//CFG Path
 			string weightPath;					//Weight Path
+			string calibrationPath;				//INT8 calibration table Path
 
 			SDataPath()
 				:
-				dataPath(""), cfgPath(""), weightPath("")
+				dataPath(""), cfgPath(""), weightPath(""), calibrationPath("")
 			{}
 		};
 
@@ -189,10 +757,11 @@ namespace Ghost
 		{
 			std::atomic<bool> initFlag;			//ʼ־
 			std::atomic<bool> filterFlag;		//kalman˲־
+			std::atomic<bool> int8Flag;			//INT8 CPU־
 
 			SState()
 				:
-				initFlag(false), filterFlag(false)
+				initFlag(false), filterFlag(false), int8Flag(false)
 			{}
 		};
 		SState m_States;
@@ -200,6 +769,10 @@ namespace Ghost
 		//
 		std::unique_ptr<Detector> m_pDetector;
 
+		//INT8/FP32 CPU
+		std::unique_ptr<QuantizedYolo> m_pQuantized;
+		size_t m_threadNum;
+
 		//
 		std::vector<std::string> m_vecObjName;
 
@@ -209,6 +782,20 @@ namespace Ghost
 		//źŲ
 		Ghost::signalslot::Signal<void(const std::vector<std::string>&)> m_SIGNAL_void_Objects;
 		Ghost::signalslot::Slot m_SLOT_void_Objects;
+		Ghost::signalslot::Signal<void(const size_t, const cv::Mat&)> m_SIGNAL_void_AsyncResult;
+		Ghost::signalslot::Slot m_SLOT_void_AsyncResult;
+		Ghost::signalslot::Signal<void(const std::vector<cv::Rect>&)> m_SIGNAL_void_Persons;
+		Ghost::signalslot::Slot m_SLOT_void_Persons;
+
+		//ˮ ->Ԥ->-> ׶֮Ϊߵ߶
+		const static size_t s_pipelineDepth;
+		SpscQueue<FramePtr> m_inputQueue;
+		SpscQueue<FramePtr> m_inferQueue;
+		SpscQueue<FramePtr> m_postQueue;
+		std::vector<std::thread> m_pipelineThreads;
+		std::atomic<bool> m_pipelineStopFlag;
+		std::mutex m_pipelineMutex;								//ֹͣˮ m_mutexȡ
+		static thread_local const Impl* s_pPipelineOwner;		//׶߳ʵ
 
 		//
 		std::mutex m_mutex;
@@ -219,6 +806,8 @@ namespace Ghost
 
 	ObjectDetector::Impl::SDataPath ObjectDetector::Impl::s_Paths;
 	std::atomic<bool> ObjectDetector::Impl::s_pathFlag = false;
+	const size_t ObjectDetector::Impl::s_pipelineDepth = 2;
+	thread_local const ObjectDetector::Impl* ObjectDetector::Impl::s_pPipelineOwner = nullptr;
 
 #if( _MSC_TOOLSET_VER_ == 140 )
 #ifdef NDEBUG
@@ -284,6 +873,17 @@ namespace Ghost
 		return EResult::SR_OK;
 	}
 
+	EResult ObjectDetector::setCalibrationPath(const string& calibrationPath) noexcept(true)
+	{
+		const fs::path folder = fs::path(calibrationPath).parent_path();
+		if (!folder.empty() && !fs::exists(folder))
+			return EResult::SR_Folder_Not_Exist;
+
+		ObjectDetector::Impl::s_Paths.calibrationPath = calibrationPath;
+
+		return EResult::SR_OK;
+	}
+
 	const string& ObjectDetector::getVersion() noexcept(true)
 	{
 		return ObjectDetector::Impl::s_version;
@@ -317,6 +917,10 @@ namespace Ghost
 		{
 		case ::EModualParamType::TYPE_XXX:
 			break;
+		case EModualParamType::TYPE_Object_Detection_Int8:
+			return m_pImpl->setInt8(value > 0.5f);
+		case EModualParamType::TYPE_Object_Detection_Threads:
+			return m_pImpl->setThreadNum(static_cast<size_t>(std::max(0.f, value)));
 		case EModualParamType::TYPE_UNDEFINE:
 			break;
 		default:
@@ -333,13 +937,49 @@ namespace Ghost
 		return m_pImpl->detect(frameIn, frameShow);
 	}
 
+	EResult ObjectDetector::detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+	{
+		const EResult result = m_pImpl->detectBatch(framesIn, framesOut, results);
+		if (result != EResult::SR_OK)
+			return result;
+
+		return firstFailure(results);
+	}
+
 	EDetectModual ObjectDetector::getModualType() noexcept(true)
 	{
 		return EDetectModual::Object_Detection_Modual;
 	};
 
+	EResult ObjectDetector::detectAsync(const cv::Mat& frameIn, const size_t frameIndex)
+	{
+		if (frameIn.empty()) return EResult::SR_Image_Empty;
+
+		return m_pImpl->detectAsync(frameIn, frameIndex);
+	}
+
+	EResult ObjectDetector::calibrateInt8(const string& imageFolder)
+	{
+		return m_pImpl->calibrateInt8(imageFolder);
+	}
+
+	EResult ObjectDetector::reportInt8(const string& imageFolder, const string& reportPath)
+	{
+		return m_pImpl->reportInt8(imageFolder, reportPath);
+	}
+
 	void ObjectDetector::bindSlotObjectFind(const std::function<void(const std::vector<std::string>&)>& func)
 	{
 		m_pImpl->m_SLOT_void_Objects = m_pImpl->m_SIGNAL_void_Objects.connect(func);
 	}
+
+	void ObjectDetector::bindSlotAsyncResult(const std::function<void(const size_t, const cv::Mat&)>& func)
+	{
+		m_pImpl->m_SLOT_void_AsyncResult = m_pImpl->m_SIGNAL_void_AsyncResult.connect(func);
+	}
+
+	void ObjectDetector::bindSlotPersonFind(const std::function<void(const std::vector<cv::Rect>&)>& func)
+	{
+		m_pImpl->m_SLOT_void_Persons = m_pImpl->m_SIGNAL_void_Persons.connect(func);
+	}
 }///namespace Ghost
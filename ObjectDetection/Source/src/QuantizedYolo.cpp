@@ -0,0 +1,1130 @@
+#include "QuantizedYolo.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "GThreadPool.hpp"
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		enum struct ELayerType : uint8_t
+		{
+			Convolutional = 0,
+			Maxpool,
+			Route,
+			Shortcut,
+			Upsample,
+			Yolo
+		};
+
+		enum struct EActivation : uint8_t
+		{
+			Linear = 0,
+			Leaky,
+			Relu,
+			Logistic,
+			Mish
+		};
+
+		/**
+		* \@brief One [section] of the cfg file
+		*/
+		struct SSection
+		{
+			string name;
+			map<string, string> options;
+
+			int getInt(const string& key, const int defaultValue) const
+			{
+				auto iter = options.find(key);
+				return (iter == options.end()) ? defaultValue : std::atoi(iter->second.c_str());
+			}
+
+			float getFloat(const string& key, const float defaultValue) const
+			{
+				auto iter = options.find(key);
+				return (iter == options.end()) ? defaultValue : static_cast<float>(std::atof(iter->second.c_str()));
+			}
+
+			string getString(const string& key, const string& defaultValue) const
+			{
+				auto iter = options.find(key);
+				return (iter == options.end()) ? defaultValue : iter->second;
+			}
+
+			template<class T>
+			vector<T> getList(const string& key) const
+			{
+				vector<T> values;
+				auto iter = options.find(key);
+				if (iter == options.end())
+					return values;
+
+				stringstream ss(iter->second);
+				string item;
+				while (std::getline(ss, item, ','))
+				{
+					if (item.find_first_not_of(" \t") == string::npos)
+						continue;
+					values.push_back(static_cast<T>(std::atof(item.c_str())));
+				}
+				return values;
+			}
+		};
+
+		vector<SSection> parseCfg(const string& cfgPath)
+		{
+			vector<SSection> sections;
+			std::ifstream file(cfgPath);
+			if (!file.is_open())
+				return sections;
+
+			for (string line; std::getline(file, line);)
+			{
+				line.erase(std::remove_if(line.begin(), line.end(), [](const char c) { return c == ' ' || c == '\t' || c == '\r'; }), line.end());
+				if (line.empty() || line[0] == '#' || line[0] == ';')
+					continue;
+
+				if (line[0] == '[')
+				{
+					SSection section;
+					section.name = line.substr(1, line.find(']') - 1);
+					sections.push_back(section);
+					continue;
+				}
+
+				const size_t pos = line.find('=');
+				if (pos == string::npos || sections.empty())
+					continue;
+
+				sections.back().options[line.substr(0, pos)] = line.substr(pos + 1);
+			}
+
+			return sections;
+		}
+
+		EActivation toActivation(const string& name)
+		{
+			if (name == "leaky")		return EActivation::Leaky;
+			if (name == "relu")			return EActivation::Relu;
+			if (name == "logistic")		return EActivation::Logistic;
+			if (name == "mish")			return EActivation::Mish;
+			return EActivation::Linear;
+		}
+
+		inline float logistic(const float x)
+		{
+			return 1.f / (1.f + std::exp(-x));
+		}
+
+		/*-------------------------------------- INT8 GEMM kernels --------------------------------------*/
+		/*  C[m][n] = sum_k W[m][k] * X[n][k] * scale[m] + bias[m]                                        */
+		/*  W:: s8 [M][Kpad]  X:: s8 [N][Kpad] (u8 = s8 + 128 for VNNI, corrected with 128 * sum(W[m]))    */
+		/*  tiles beyond M/N repeat the last valid row, their results are dropped                         */
+
+		struct SGemmInt8
+		{
+			int M, N, Kpad;
+			const int8_t* W;
+			const int8_t* X;
+			const float* scale;				//input scale * weight scale[m]
+			const float* bias;
+			const int32_t* weightSum;		//only for the u8 path
+			float* C;						//[M][N]
+			int ldc;
+		};
+
+		inline void storeTile(const SGemmInt8& g, const int m, const int n, const int rows, const int cols, const int32_t acc[4][4])
+		{
+			for (int i = 0; i < rows; i++)
+			{
+				const float s = g.scale[m + i];
+				const float b = g.bias[m + i];
+				float* c = g.C + static_cast<size_t>(m + i) * g.ldc + n;
+				for (int j = 0; j < cols; j++)
+					c[j] = static_cast<float>(acc[i][j]) * s + b;
+			}
+		}
+
+		void gemmInt8Scalar(const SGemmInt8& g, const int nBegin, const int nEnd)
+		{
+			for (int m = 0; m < g.M; m++)
+			{
+				const int8_t* w = g.W + static_cast<size_t>(m) * g.Kpad;
+				float* c = g.C + static_cast<size_t>(m) * g.ldc;
+				for (int n = nBegin; n < nEnd; n++)
+				{
+					const int8_t* x = g.X + static_cast<size_t>(n) * g.Kpad;
+					int32_t acc = 0;
+					for (int k = 0; k < g.Kpad; k++)
+						acc += static_cast<int32_t>(w[k]) * static_cast<int32_t>(x[k]);
+					c[n] = static_cast<float>(acc) * g.scale[m] + g.bias[m];
+				}
+			}
+		}
+
+		GHOST_TARGET_AVX2 inline int32_t reduceAvx2(const __m256i v)
+		{
+			__m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+			s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+			s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(s);
+		}
+
+		/**
+		* \@brief s8 x s8 widened to s16 and multiplied with madd #exact, no saturation#
+		*/
+		GHOST_TARGET_AVX2 void gemmInt8Avx2(const SGemmInt8& g, const int nBegin, const int nEnd)
+		{
+			const int MB = 32;
+			for (int mBlock = 0; mBlock < g.M; mBlock += MB)
+			{
+				const int mBlockEnd = std::min(g.M, mBlock + MB);
+				for (int n = nBegin; n < nEnd; n += 4)
+				{
+					const int cols = std::min(4, nEnd - n);
+					const int8_t* x0 = g.X + static_cast<size_t>(n) * g.Kpad;
+					const int8_t* x1 = g.X + static_cast<size_t>(n + std::min(1, cols - 1)) * g.Kpad;
+					const int8_t* x2 = g.X + static_cast<size_t>(n + std::min(2, cols - 1)) * g.Kpad;
+					const int8_t* x3 = g.X + static_cast<size_t>(n + std::min(3, cols - 1)) * g.Kpad;
+
+					for (int m = mBlock; m < mBlockEnd; m += 2)
+					{
+						const int rows = std::min(2, mBlockEnd - m);
+						const int8_t* w0 = g.W + static_cast<size_t>(m) * g.Kpad;
+						const int8_t* w1 = g.W + static_cast<size_t>(m + rows - 1) * g.Kpad;
+
+						__m256i a00 = _mm256_setzero_si256(), a01 = _mm256_setzero_si256(), a02 = _mm256_setzero_si256(), a03 = _mm256_setzero_si256();
+						__m256i a10 = _mm256_setzero_si256(), a11 = _mm256_setzero_si256(), a12 = _mm256_setzero_si256(), a13 = _mm256_setzero_si256();
+
+						for (int k = 0; k < g.Kpad; k += 16)
+						{
+							const __m256i vw0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w0 + k)));
+							const __m256i vw1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w1 + k)));
+							__m256i vx = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x0 + k)));
+							a00 = _mm256_add_epi32(a00, _mm256_madd_epi16(vw0, vx));
+							a10 = _mm256_add_epi32(a10, _mm256_madd_epi16(vw1, vx));
+							vx = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x1 + k)));
+							a01 = _mm256_add_epi32(a01, _mm256_madd_epi16(vw0, vx));
+							a11 = _mm256_add_epi32(a11, _mm256_madd_epi16(vw1, vx));
+							vx = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x2 + k)));
+							a02 = _mm256_add_epi32(a02, _mm256_madd_epi16(vw0, vx));
+							a12 = _mm256_add_epi32(a12, _mm256_madd_epi16(vw1, vx));
+							vx = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x3 + k)));
+							a03 = _mm256_add_epi32(a03, _mm256_madd_epi16(vw0, vx));
+							a13 = _mm256_add_epi32(a13, _mm256_madd_epi16(vw1, vx));
+						}
+
+						const int32_t acc[4][4] =
+						{
+							{ reduceAvx2(a00), reduceAvx2(a01), reduceAvx2(a02), reduceAvx2(a03) },
+							{ reduceAvx2(a10), reduceAvx2(a11), reduceAvx2(a12), reduceAvx2(a13) },
+							{ 0, 0, 0, 0 },
+							{ 0, 0, 0, 0 }
+						};
+						storeTile(g, m, n, rows, cols, acc);
+					}
+				}
+			}
+		}
+
+		/**
+		* \@brief u8 x s8 with vpdpbusd, 64 bytes of K per instruction
+		*/
+		GHOST_TARGET_AVX512VNNI void gemmInt8Vnni(const SGemmInt8& g, const int nBegin, const int nEnd)
+		{
+			const int MB = 32;
+			for (int mBlock = 0; mBlock < g.M; mBlock += MB)
+			{
+				const int mBlockEnd = std::min(g.M, mBlock + MB);
+				for (int n = nBegin; n < nEnd; n += 4)
+				{
+					const int cols = std::min(4, nEnd - n);
+					const int8_t* x[4];
+					for (int j = 0; j < 4; j++)
+						x[j] = g.X + static_cast<size_t>(n + std::min(j, cols - 1)) * g.Kpad;
+
+					for (int m = mBlock; m < mBlockEnd; m += 4)
+					{
+						const int rows = std::min(4, mBlockEnd - m);
+						const int8_t* w[4];
+						for (int i = 0; i < 4; i++)
+							w[i] = g.W + static_cast<size_t>(m + std::min(i, rows - 1)) * g.Kpad;
+
+						__m512i acc[4][4];
+						for (int i = 0; i < 4; i++)
+							for (int j = 0; j < 4; j++)
+								acc[i][j] = _mm512_setzero_si512();
+
+						for (int k = 0; k < g.Kpad; k += 64)
+						{
+							const __m512i vx0 = _mm512_loadu_si512(x[0] + k);
+							const __m512i vx1 = _mm512_loadu_si512(x[1] + k);
+							const __m512i vx2 = _mm512_loadu_si512(x[2] + k);
+							const __m512i vx3 = _mm512_loadu_si512(x[3] + k);
+							for (int i = 0; i < 4; i++)
+							{
+								const __m512i vw = _mm512_loadu_si512(w[i] + k);
+								acc[i][0] = _mm512_dpbusd_epi32(acc[i][0], vx0, vw);
+								acc[i][1] = _mm512_dpbusd_epi32(acc[i][1], vx1, vw);
+								acc[i][2] = _mm512_dpbusd_epi32(acc[i][2], vx2, vw);
+								acc[i][3] = _mm512_dpbusd_epi32(acc[i][3], vx3, vw);
+							}
+						}
+
+						int32_t result[4][4];
+						for (int i = 0; i < 4; i++)
+						{
+							const int32_t correction = 128 * g.weightSum[m + std::min(i, rows - 1)];
+							for (int j = 0; j < 4; j++)
+								result[i][j] = _mm512_reduce_add_epi32(acc[i][j]) - correction;
+						}
+						storeTile(g, m, n, rows, cols, result);
+					}
+				}
+			}
+		}
+	}///namespace
+
+	/**
+	* \@brief Layer parameters and output
+	*/
+	struct QuantizedYolo::SLayer
+	{
+		ELayerType type;
+		int c, h, w;								//input shape
+		int outC, outH, outW;						//output shape
+		simd::AlignedVector<float> output;
+
+		//convolutional / maxpool
+		int filters, size, stride, padding;
+		EActivation activation;
+		simd::AlignedVector<float> weights;			//[filters][c * size * size], BN folded
+		simd::AlignedVector<float> biases;
+
+		//INT8
+		bool quantized;								//false for the first convolution
+		int Kpad;
+		simd::AlignedVector<int8_t> qweights;		//[filters][Kpad]
+		simd::AlignedVector<float> weightScale;		//per output channel
+		simd::AlignedVector<int32_t> weightSum;		//per output channel, for the u8 path
+		simd::AlignedVector<float> outScale;		//input scale * weight scale, workspace
+		float inputAbsMax;							//calibrated activation range, <=0 means dynamic
+
+		//calibration statistics
+		double calibrationSum;
+		size_t calibrationCount;
+
+		//route / shortcut
+		vector<int> routes;
+
+		//upsample
+		int upsampleStride;
+
+		//yolo
+		vector<int> mask;
+		vector<float> anchors;
+		int classes;
+		float scaleXY;
+
+		SLayer()
+			:
+			type(ELayerType::Convolutional), c(0), h(0), w(0), outC(0), outH(0), outW(0),
+			filters(0), size(0), stride(1), padding(0), activation(EActivation::Linear),
+			quantized(false), Kpad(0), inputAbsMax(0.f), calibrationSum(0.0), calibrationCount(0),
+			upsampleStride(1), classes(0), scaleXY(1.f)
+		{}
+	};
+
+	QuantizedYolo::QuantizedYolo()
+		:
+		m_pPool(nullptr),
+		m_threadNum(0),
+		m_precision(EPrecision::FP32),
+		m_isa(simd::bestIsa()),
+		m_nms(0.4f),
+		m_netWidth(0), m_netHeight(0), m_netChannels(3),
+		m_calibrationImages(0),
+		m_calibrated(false)
+	{
+	}
+
+	QuantizedYolo::~QuantizedYolo()
+	{
+		m_pPool.reset();
+	}
+
+	void QuantizedYolo::setThreadNum(const size_t threadNum)
+	{
+		m_threadNum = threadNum;
+		m_pPool.reset();
+	}
+
+	void QuantizedYolo::setPrecision(const EPrecision precision)
+	{
+		m_precision = precision;
+	}
+
+	void QuantizedYolo::parallelFor(const size_t begin, const size_t end, const std::function<void(size_t, size_t)>& func, const size_t grain)
+	{
+		//the calling thread takes part in parallelFor
+		const size_t num = (m_threadNum == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : m_threadNum;
+		if (m_pPool == nullptr && num > 1)
+			m_pPool = std::make_unique<ThreadPool>(num - 1);
+
+		if (m_pPool == nullptr)
+			func(begin, end);
+		else
+			m_pPool->parallelFor(begin, end, func, grain);
+	}
+
+	EResult QuantizedYolo::load(const string& cfgPath, const string& weightPath)
+	{
+		m_layers.clear();
+		m_calibrated = false;
+
+		const vector<SSection> sections = parseCfg(cfgPath);
+		if (sections.empty() || (sections[0].name != "net" && sections[0].name != "network"))
+			return EResult::SR_Cfg_File_Not_Exist;
+
+		std::ifstream weightFile(weightPath, std::ios::binary);
+		if (!weightFile.is_open())
+			return EResult::SR_Weight_File_Not_Exist;
+
+		//header:: major minor revision seen
+		int32_t version[3] = { 0 };
+		weightFile.read(reinterpret_cast<char*>(version), sizeof(version));
+		if ((version[0] * 10 + version[1]) >= 2 && version[0] < 1000 && version[1] < 1000)
+		{
+			uint64_t seen = 0;
+			weightFile.read(reinterpret_cast<char*>(&seen), sizeof(seen));
+		}
+		else
+		{
+			uint32_t seen = 0;
+			weightFile.read(reinterpret_cast<char*>(&seen), sizeof(seen));
+		}
+
+		const SSection& net = sections[0];
+		m_netWidth = net.getInt("width", 416);
+		m_netHeight = net.getInt("height", 416);
+		m_netChannels = net.getInt("channels", 3);
+
+		int c = m_netChannels, h = m_netHeight, w = m_netWidth;
+		bool firstConvolution = true;
+
+		for (size_t i = 1; i < sections.size(); i++)
+		{
+			const SSection& section = sections[i];
+			const int index = static_cast<int>(m_layers.size());
+			auto layer = std::make_unique<SLayer>();
+			layer->c = c; layer->h = h; layer->w = w;
+
+			auto toAbsolute = [index](const int value) { return (value < 0) ? index + value : value; };
+
+			if (section.name == "convolutional" || section.name == "conv")
+			{
+				layer->type = ELayerType::Convolutional;
+				layer->filters = section.getInt("filters", 1);
+				layer->size = section.getInt("size", 1);
+				layer->stride = section.getInt("stride", 1);
+				layer->padding = section.getInt("pad", 0) ? layer->size / 2 : section.getInt("padding", 0);
+				layer->activation = toActivation(section.getString("activation", "logistic"));
+				if (section.getInt("groups", 1) != 1)
+					return EResult::SR_NG;
+
+				layer->outC = layer->filters;
+				layer->outH = (h + 2 * layer->padding - layer->size) / layer->stride + 1;
+				layer->outW = (w + 2 * layer->padding - layer->size) / layer->stride + 1;
+
+				const int n = layer->filters;
+				const size_t K = static_cast<size_t>(c) * layer->size * layer->size;
+				const bool batchNormalize = section.getInt("batch_normalize", 0) != 0;
+
+				layer->biases.resize(n);
+				layer->weights.resize(n * K);
+				vector<float> scales(n, 1.f), mean(n, 0.f), variance(n, 1.f);
+
+				weightFile.read(reinterpret_cast<char*>(layer->biases.data()), n * sizeof(float));
+				if (batchNormalize)
+				{
+					weightFile.read(reinterpret_cast<char*>(scales.data()), n * sizeof(float));
+					weightFile.read(reinterpret_cast<char*>(mean.data()), n * sizeof(float));
+					weightFile.read(reinterpret_cast<char*>(variance.data()), n * sizeof(float));
+				}
+				weightFile.read(reinterpret_cast<char*>(layer->weights.data()), n * K * sizeof(float));
+				if (!weightFile)
+					return EResult::SR_Weight_File_Not_Exist;
+
+				//BN folding, the same epsilon as darknet normalize_cpu
+				if (batchNormalize)
+				{
+					for (int f = 0; f < n; f++)
+					{
+						const float alpha = scales[f] / (std::sqrt(variance[f]) + .000001f);
+						float* wf = layer->weights.data() + f * K;
+						for (size_t k = 0; k < K; k++)
+							wf[k] *= alpha;
+						layer->biases[f] = layer->biases[f] - mean[f] * alpha;
+					}
+				}
+
+				//per output channel symmetric quantization
+				layer->quantized = !firstConvolution;
+				firstConvolution = false;
+				layer->Kpad = static_cast<int>(simd::alignUp(K, 64));
+				layer->qweights.assign(static_cast<size_t>(n) * layer->Kpad, 0);
+				layer->weightScale.resize(n);
+				layer->weightSum.resize(n);
+				layer->outScale.resize(n);
+				for (int f = 0; f < n; f++)
+				{
+					const float* wf = layer->weights.data() + f * K;
+					float absMax = 0.f;
+					for (size_t k = 0; k < K; k++)
+						absMax = std::max(absMax, std::fabs(wf[k]));
+
+					const float scale = (absMax > 0.f) ? absMax / 127.f : 1.f;
+					int32_t sum = 0;
+					int8_t* q = layer->qweights.data() + static_cast<size_t>(f) * layer->Kpad;
+					for (size_t k = 0; k < K; k++)
+					{
+						const int value = static_cast<int>(std::lround(wf[k] / scale));
+						q[k] = static_cast<int8_t>(std::max(-127, std::min(127, value)));
+						sum += q[k];
+					}
+					layer->weightScale[f] = scale;
+					layer->weightSum[f] = sum;
+				}
+			}
+			else if (section.name == "maxpool" || section.name == "max")
+			{
+				layer->type = ELayerType::Maxpool;
+				layer->size = section.getInt("size", 2);
+				layer->stride = section.getInt("stride", layer->size);
+				layer->padding = section.getInt("padding", layer->size - 1);
+				layer->outC = c;
+				layer->outH = (h + layer->padding - layer->size) / layer->stride + 1;
+				layer->outW = (w + layer->padding - layer->size) / layer->stride + 1;
+			}
+			else if (section.name == "route")
+			{
+				layer->type = ELayerType::Route;
+				for (const int value : section.getList<int>("layers"))
+					layer->routes.push_back(toAbsolute(value));
+				if (layer->routes.empty())
+					return EResult::SR_NG;
+
+				int channels = 0;
+				for (const int route : layer->routes)
+				{
+					if (route < 0 || route >= index)
+						return EResult::SR_NG;
+
+					const SLayer& src = *m_layers[route];
+					if (channels > 0 && (src.outH != m_layers[layer->routes[0]]->outH || src.outW != m_layers[layer->routes[0]]->outW))
+						return EResult::SR_NG;
+					channels += src.outC;
+				}
+				layer->outC = channels;
+				layer->outH = m_layers[layer->routes[0]]->outH;
+				layer->outW = m_layers[layer->routes[0]]->outW;
+			}
+			else if (section.name == "shortcut")
+			{
+				layer->type = ELayerType::Shortcut;
+				layer->routes.push_back(toAbsolute(section.getInt("from", -1)));
+				layer->activation = toActivation(section.getString("activation", "linear"));
+				const int from = layer->routes[0];
+				if (from < 0 || from >= index || m_layers[from]->outC != c || m_layers[from]->outH != h || m_layers[from]->outW != w)
+					return EResult::SR_NG;
+				layer->outC = c; layer->outH = h; layer->outW = w;
+			}
+			else if (section.name == "upsample")
+			{
+				layer->type = ELayerType::Upsample;
+				layer->upsampleStride = section.getInt("stride", 2);
+				layer->outC = c;
+				layer->outH = h * layer->upsampleStride;
+				layer->outW = w * layer->upsampleStride;
+			}
+			else if (section.name == "yolo")
+			{
+				layer->type = ELayerType::Yolo;
+				layer->classes = section.getInt("classes", 80);
+				layer->scaleXY = section.getFloat("scale_x_y", 1.f);
+				layer->anchors = section.getList<float>("anchors");
+				layer->mask = section.getList<int>("mask");
+				if (layer->mask.empty())
+				{
+					for (int n = 0; n < section.getInt("num", 1); n++)
+						layer->mask.push_back(n);
+				}
+				if (c != static_cast<int>(layer->mask.size()) * (layer->classes + 5))
+					return EResult::SR_NG;
+				layer->outC = c; layer->outH = h; layer->outW = w;
+			}
+			else
+			{
+				//darknet layer that YOLOv3 does not use
+				return EResult::SR_NG;
+			}
+
+			layer->output.resize(static_cast<size_t>(layer->outC) * layer->outH * layer->outW);
+			c = layer->outC; h = layer->outH; w = layer->outW;
+			m_layers.push_back(std::move(layer));
+		}
+
+		return m_layers.empty() ? EResult::SR_NG : EResult::SR_OK;
+	}
+
+	EResult QuantizedYolo::loadCalibration(const string& calibrationPath)
+	{
+		std::ifstream file(calibrationPath);
+		if (!file.is_open())
+			return EResult::SR_Calibration_File_Not_Exist;
+
+		string title;
+		size_t layerNum = 0;
+		file >> title >> layerNum;
+		if (title != "QuantizedYolo-Calibration" || layerNum != m_layers.size())
+			return EResult::SR_Calibration_File_Not_Exist;
+
+		int index = 0;
+		float absMax = 0.f;
+		while (file >> index >> absMax)
+		{
+			if (index < 0 || index >= static_cast<int>(m_layers.size()))
+				return EResult::SR_Calibration_File_Not_Exist;
+			m_layers[index]->inputAbsMax = absMax;
+		}
+
+		m_calibrated = true;
+		return EResult::SR_OK;
+	}
+
+	EResult QuantizedYolo::saveCalibration(const string& calibrationPath) const
+	{
+		if (!m_calibrated)
+			return EResult::SR_NG;
+
+		std::ofstream file(calibrationPath, std::ios::trunc);
+		if (!file.is_open())
+			return EResult::SR_NG;
+
+		file << "QuantizedYolo-Calibration " << m_layers.size() << "\n";
+		for (size_t i = 0; i < m_layers.size(); i++)
+		{
+			if (m_layers[i]->type == ELayerType::Convolutional && m_layers[i]->quantized)
+				file << i << " " << m_layers[i]->inputAbsMax << "\n";
+		}
+
+		return EResult::SR_OK;
+	}
+
+	void QuantizedYolo::resetCalibration()
+	{
+		for (auto& layer : m_layers)
+		{
+			layer->calibrationSum = 0.0;
+			layer->calibrationCount = 0;
+		}
+		m_calibrationImages = 0;
+	}
+
+	void QuantizedYolo::calibrate(const SInput& input)
+	{
+		if (!isLoaded())
+			return;
+
+		forward(input.data.data(), true);
+		m_calibrationImages++;
+	}
+
+	EResult QuantizedYolo::finishCalibration()
+	{
+		if (m_calibrationImages == 0)
+			return EResult::SR_Image_Empty;
+
+		for (auto& layer : m_layers)
+		{
+			if (layer->type == ELayerType::Convolutional && layer->quantized && layer->calibrationCount > 0)
+				layer->inputAbsMax = static_cast<float>(layer->calibrationSum / layer->calibrationCount);
+		}
+		m_calibrated = true;
+
+		return EResult::SR_OK;
+	}
+
+	void QuantizedYolo::preprocess(const cv::Mat& frame, SInput& input) const
+	{
+		input.imageWidth = frame.cols;
+		input.imageHeight = frame.rows;
+
+		cv::Mat resized;
+		if (frame.cols != m_netWidth || frame.rows != m_netHeight)
+			cv::resize(frame, resized, cv::Size(m_netWidth, m_netHeight));
+		else
+			resized = frame;
+
+		cv::Mat rgb;
+		if (resized.channels() == 3)
+			cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+		else if (resized.channels() == 4)
+			cv::cvtColor(resized, rgb, cv::COLOR_BGRA2RGB);
+		else
+			cv::cvtColor(resized, rgb, cv::COLOR_GRAY2RGB);
+
+		const size_t plane = static_cast<size_t>(m_netWidth) * m_netHeight;
+		input.data.resize(plane * 3);
+
+		//HWC u8 -> CHW float, split writes straight into the planes
+		std::vector<cv::Mat> planes =
+		{
+			cv::Mat(m_netHeight, m_netWidth, CV_32FC1, input.data.data()),
+			cv::Mat(m_netHeight, m_netWidth, CV_32FC1, input.data.data() + plane),
+			cv::Mat(m_netHeight, m_netWidth, CV_32FC1, input.data.data() + plane * 2)
+		};
+		cv::Mat rgbFloat;
+		rgb.convertTo(rgbFloat, CV_32FC3, 1.0 / 255.0);
+		cv::split(rgbFloat, planes);
+	}
+
+	void QuantizedYolo::infer(const SInput& input, SOutput& output)
+	{
+		output.imageWidth = input.imageWidth;
+		output.imageHeight = input.imageHeight;
+		output.yoloOutputs.clear();
+
+		if (!isLoaded() || input.data.size() != static_cast<size_t>(m_netWidth) * m_netHeight * m_netChannels)
+			return;
+
+		forward(input.data.data(), false);
+
+		for (const auto& layer : m_layers)
+		{
+			if (layer->type == ELayerType::Yolo)
+				output.yoloOutputs.push_back(layer->output);
+		}
+	}
+
+	vector<QuantizedYolo::SBox> QuantizedYolo::postprocess(const SOutput& output, const float thresh) const
+	{
+		vector<SBox> candidates;
+
+		size_t yoloIndex = 0;
+		for (const auto& pLayer : m_layers)
+		{
+			const SLayer& layer = *pLayer;
+			if (layer.type != ELayerType::Yolo)
+				continue;
+			if (yoloIndex >= output.yoloOutputs.size())
+				break;
+
+			const float* data = output.yoloOutputs[yoloIndex++].data();
+			const int plane = layer.outW * layer.outH;
+			const int entries = layer.classes + 5;
+
+			for (size_t n = 0; n < layer.mask.size(); n++)
+			{
+				const float* anchor = data + n * entries * plane;
+				const int anchorIndex = layer.mask[n];
+				const float anchorW = (2 * anchorIndex + 1 < static_cast<int>(layer.anchors.size())) ? layer.anchors[2 * anchorIndex] : 1.f;
+				const float anchorH = (2 * anchorIndex + 1 < static_cast<int>(layer.anchors.size())) ? layer.anchors[2 * anchorIndex + 1] : 1.f;
+
+				for (int loc = 0; loc < plane; loc++)
+				{
+					const float objectness = anchor[4 * plane + loc];
+					if (objectness <= thresh)
+						continue;
+
+					int bestClass = -1;
+					float bestProb = thresh;
+					for (int j = 0; j < layer.classes; j++)
+					{
+						const float prob = objectness * anchor[(5 + j) * plane + loc];
+						if (prob > bestProb)
+						{
+							bestProb = prob;
+							bestClass = j;
+						}
+					}
+					if (bestClass < 0)
+						continue;
+
+					const int col = loc % layer.outW;
+					const int row = loc / layer.outW;
+					const float bx = (col + anchor[loc]) / layer.outW;
+					const float by = (row + anchor[plane + loc]) / layer.outH;
+					const float bw = std::exp(anchor[2 * plane + loc]) * anchorW / m_netWidth;
+					const float bh = std::exp(anchor[3 * plane + loc]) * anchorH / m_netHeight;
+
+					SBox box;
+					box.w = bw * output.imageWidth;
+					box.h = bh * output.imageHeight;
+					box.x = std::max(0.f, (bx - bw / 2.f) * output.imageWidth);
+					box.y = std::max(0.f, (by - bh / 2.f) * output.imageHeight);
+					box.prob = bestProb;
+					box.classID = bestClass;
+					candidates.push_back(box);
+				}
+			}
+		}
+
+		//per-class greedy NMS
+		std::sort(candidates.begin(), candidates.end(), [](const SBox& a, const SBox& b) { return a.prob > b.prob; });
+		vector<SBox> result;
+		vector<bool> suppressed(candidates.size(), false);
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			if (suppressed[i])
+				continue;
+
+			const SBox& a = candidates[i];
+			result.push_back(a);
+			for (size_t j = i + 1; j < candidates.size(); j++)
+			{
+				const SBox& b = candidates[j];
+				if (suppressed[j] || b.classID != a.classID)
+					continue;
+
+				const float iw = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+				const float ih = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+				if (iw <= 0.f || ih <= 0.f)
+					continue;
+
+				const float inter = iw * ih;
+				if (inter / (a.w * a.h + b.w * b.h - inter) > m_nms)
+					suppressed[j] = true;
+			}
+		}
+
+		return result;
+	}
+
+	vector<QuantizedYolo::SBox> QuantizedYolo::detect(const cv::Mat& frame, const float thresh)
+	{
+		SInput input;
+		SOutput output;
+		preprocess(frame, input);
+		infer(input, output);
+		return postprocess(output, thresh);
+	}
+
+	const float* QuantizedYolo::forward(const float* input, const bool calibrate)
+	{
+		const float* current = input;
+		for (size_t i = 0; i < m_layers.size(); i++)
+		{
+			SLayer& layer = *m_layers[i];
+			switch (layer.type)
+			{
+			case ELayerType::Convolutional:
+				forwardConvolution(layer, current, calibrate);
+				break;
+			case ELayerType::Maxpool:
+				forwardMaxpool(layer, current);
+				break;
+			case ELayerType::Route:
+			{
+				float* dst = layer.output.data();
+				for (const int route : layer.routes)
+				{
+					const auto& src = m_layers[route]->output;
+					std::memcpy(dst, src.data(), src.size() * sizeof(float));
+					dst += src.size();
+				}
+				break;
+			}
+			case ELayerType::Shortcut:
+			{
+				const float* from = m_layers[layer.routes[0]]->output.data();
+				float* dst = layer.output.data();
+				const size_t count = layer.output.size();
+				for (size_t k = 0; k < count; k++)
+					dst[k] = current[k] + from[k];
+				activate(layer);
+				break;
+			}
+			case ELayerType::Upsample:
+				forwardUpsample(layer, current);
+				break;
+			case ELayerType::Yolo:
+				forwardYolo(layer, current);
+				break;
+			}
+			current = layer.output.data();
+		}
+
+		return current;
+	}
+
+	void QuantizedYolo::forwardConvolution(SLayer& layer, const float* input, const bool calibrate)
+	{
+		if (calibrate && layer.quantized)
+		{
+			//per image 99.99th percentile of |x|, averaged over the calibration set
+			const size_t count = static_cast<size_t>(layer.c) * layer.h * layer.w;
+			const size_t stride = std::max<size_t>(1, count / 65536);
+			vector<float> samples;
+			samples.reserve(count / stride + 1);
+			for (size_t k = 0; k < count; k += stride)
+				samples.push_back(std::fabs(input[k]));
+
+			const size_t nth = std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.9999));
+			std::nth_element(samples.begin(), samples.begin() + nth, samples.end());
+			layer.calibrationSum += samples[nth];
+			layer.calibrationCount++;
+		}
+
+		if (!calibrate && m_precision == EPrecision::INT8 && layer.quantized)
+			convolutionInt8(layer, input);
+		else
+			convolutionFp32(layer, input);
+
+		activate(layer);
+	}
+
+	void QuantizedYolo::convolutionFp32(SLayer& layer, const float* input)
+	{
+		const int M = layer.filters;
+		const int N = layer.outH * layer.outW;
+		const int K = layer.c * layer.size * layer.size;
+
+		const float* B = input;
+		if (!(layer.size == 1 && layer.stride == 1 && layer.padding == 0))
+		{
+			//darknet im2col:: [c * size * size][outH * outW]
+			m_colBuffer.resize(static_cast<size_t>(K) * N);
+			float* col = m_colBuffer.data();
+			parallelFor(0, K, [&](size_t kBegin, size_t kEnd)
+			{
+				for (size_t k = kBegin; k < kEnd; k++)
+				{
+					const int wOffset = static_cast<int>(k) % layer.size;
+					const int hOffset = (static_cast<int>(k) / layer.size) % layer.size;
+					const int channel = static_cast<int>(k) / layer.size / layer.size;
+					const float* src = input + static_cast<size_t>(channel) * layer.h * layer.w;
+					float* dst = col + k * N;
+					for (int y = 0; y < layer.outH; y++)
+					{
+						const int row = hOffset + y * layer.stride - layer.padding;
+						for (int x = 0; x < layer.outW; x++)
+						{
+							const int column = wOffset + x * layer.stride - layer.padding;
+							dst[y * layer.outW + x] = (row < 0 || column < 0 || row >= layer.h || column >= layer.w) ? 0.f : src[row * layer.w + column];
+						}
+					}
+				}
+			}, 8);
+			B = col;
+		}
+
+		const float* W = layer.weights.data();
+		float* C = layer.output.data();
+		const simd::EIsa isa = m_isa;
+		parallelFor(0, N, [&](size_t nBegin, size_t nEnd)
+		{
+			simd::sgemm(M, static_cast<int>(nEnd - nBegin), K, W, K, B + nBegin, N, C + nBegin, N, false, isa);
+		}, 64);
+
+		for (int f = 0; f < M; f++)
+		{
+			float* out = C + static_cast<size_t>(f) * N;
+			const float bias = layer.biases[f];
+			for (int n = 0; n < N; n++)
+				out[n] += bias;
+		}
+	}
+
+	void QuantizedYolo::convolutionInt8(SLayer& layer, const float* input)
+	{
+		const int M = layer.filters;
+		const int N = layer.outH * layer.outW;
+		const int K = layer.c * layer.size * layer.size;
+		const size_t count = static_cast<size_t>(layer.c) * layer.h * layer.w;
+
+		//activation scale:: calibrated, or the absolute maximum of this frame
+		float absMax = layer.inputAbsMax;
+		if (absMax <= 0.f)
+		{
+			for (size_t k = 0; k < count; k++)
+				absMax = std::max(absMax, std::fabs(input[k]));
+		}
+		const float inputScale = (absMax > 0.f) ? absMax / 127.f : 1.f;
+		const float inverse = 1.f / inputScale;
+
+		//the VNNI path wants u8 = s8 + 128, the same bit pattern with the sign bit flipped
+		const bool unsignedInput = (m_isa == simd::EIsa::AVX512_VNNI);
+		const int8_t flip = unsignedInput ? static_cast<int8_t>(-128) : 0;
+
+		m_quantInput.resize(count);
+		int8_t* q = m_quantInput.data();
+		parallelFor(0, count, [&](size_t begin, size_t end)
+		{
+			for (size_t k = begin; k < end; k++)
+			{
+				const int value = static_cast<int>(std::lrint(input[k] * inverse));
+				q[k] = static_cast<int8_t>(std::max(-127, std::min(127, value)));
+			}
+		}, 4096);
+
+		//transposed im2col:: [outH * outW][Kpad], padding keeps the zero point
+		m_quantCol.resize(static_cast<size_t>(N) * layer.Kpad);
+		int8_t* col = m_quantCol.data();
+		parallelFor(0, N, [&](size_t nBegin, size_t nEnd)
+		{
+			for (size_t n = nBegin; n < nEnd; n++)
+			{
+				const int y = static_cast<int>(n) / layer.outW;
+				const int x = static_cast<int>(n) % layer.outW;
+				int8_t* dst = col + n * layer.Kpad;
+				int k = 0;
+				for (int channel = 0; channel < layer.c; channel++)
+				{
+					const int8_t* src = q + static_cast<size_t>(channel) * layer.h * layer.w;
+					for (int ky = 0; ky < layer.size; ky++)
+					{
+						const int row = y * layer.stride - layer.padding + ky;
+						for (int kx = 0; kx < layer.size; kx++, k++)
+						{
+							const int column = x * layer.stride - layer.padding + kx;
+							const int8_t value = (row < 0 || column < 0 || row >= layer.h || column >= layer.w) ? 0 : src[row * layer.w + column];
+							dst[k] = static_cast<int8_t>(value ^ flip);
+						}
+					}
+				}
+				std::memset(dst + K, unsignedInput ? 0x80 : 0, layer.Kpad - K);
+			}
+		}, 16);
+
+		for (int f = 0; f < M; f++)
+			layer.outScale[f] = inputScale * layer.weightScale[f];
+
+		SGemmInt8 gemm;
+		gemm.M = M; gemm.N = N; gemm.Kpad = layer.Kpad;
+		gemm.W = layer.qweights.data();
+		gemm.X = col;
+		gemm.scale = layer.outScale.data();
+		gemm.bias = layer.biases.data();
+		gemm.weightSum = layer.weightSum.data();
+		gemm.C = layer.output.data();
+		gemm.ldc = N;
+
+		const simd::EIsa isa = m_isa;
+		parallelFor(0, N, [&](size_t nBegin, size_t nEnd)
+		{
+			if (isa == simd::EIsa::AVX512_VNNI)
+				gemmInt8Vnni(gemm, static_cast<int>(nBegin), static_cast<int>(nEnd));
+			else if (isa >= simd::EIsa::AVX2)
+				gemmInt8Avx2(gemm, static_cast<int>(nBegin), static_cast<int>(nEnd));
+			else
+				gemmInt8Scalar(gemm, static_cast<int>(nBegin), static_cast<int>(nEnd));
+		}, 16);
+	}
+
+	void QuantizedYolo::activate(SLayer& layer)
+	{
+		float* data = layer.output.data();
+		const size_t count = layer.output.size();
+
+		switch (layer.activation)
+		{
+		case EActivation::Leaky:
+			for (size_t k = 0; k < count; k++)
+				data[k] = (data[k] > 0.f) ? data[k] : .1f * data[k];
+			break;
+		case EActivation::Relu:
+			for (size_t k = 0; k < count; k++)
+				data[k] = std::max(0.f, data[k]);
+			break;
+		case EActivation::Logistic:
+			for (size_t k = 0; k < count; k++)
+				data[k] = logistic(data[k]);
+			break;
+		case EActivation::Mish:
+			for (size_t k = 0; k < count; k++)
+			{
+				const float x = data[k];
+				const float softplus = (x > 20.f) ? x : std::log1p(std::exp(x));
+				data[k] = x * std::tanh(softplus);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	void QuantizedYolo::forwardMaxpool(SLayer& layer, const float* input)
+	{
+		const int offset = -layer.padding / 2;
+		for (int channel = 0; channel < layer.outC; channel++)
+		{
+			const float* src = input + static_cast<size_t>(channel) * layer.h * layer.w;
+			float* dst = layer.output.data() + static_cast<size_t>(channel) * layer.outH * layer.outW;
+			for (int y = 0; y < layer.outH; y++)
+			{
+				for (int x = 0; x < layer.outW; x++)
+				{
+					float value = -FLT_MAX;
+					for (int ky = 0; ky < layer.size; ky++)
+					{
+						const int row = offset + y * layer.stride + ky;
+						if (row < 0 || row >= layer.h)
+							continue;
+						for (int kx = 0; kx < layer.size; kx++)
+						{
+							const int column = offset + x * layer.stride + kx;
+							if (column >= 0 && column < layer.w)
+								value = std::max(value, src[row * layer.w + column]);
+						}
+					}
+					dst[y * layer.outW + x] = value;
+				}
+			}
+		}
+	}
+
+	void QuantizedYolo::forwardUpsample(SLayer& layer, const float* input)
+	{
+		const int stride = layer.upsampleStride;
+		for (int channel = 0; channel < layer.outC; channel++)
+		{
+			const float* src = input + static_cast<size_t>(channel) * layer.h * layer.w;
+			float* dst = layer.output.data() + static_cast<size_t>(channel) * layer.outH * layer.outW;
+			for (int y = 0; y < layer.outH; y++)
+			{
+				const float* srcRow = src + (y / stride) * layer.w;
+				float* dstRow = dst + y * layer.outW;
+				for (int x = 0; x < layer.outW; x++)
+					dstRow[x] = srcRow[x / stride];
+			}
+		}
+	}
+
+	void QuantizedYolo::forwardYolo(SLayer& layer, const float* input)
+	{
+		std::memcpy(layer.output.data(), input, layer.output.size() * sizeof(float));
+
+		//logistic on x, y, objectness and classes, the same as darknet forward_yolo_layer
+		const size_t plane = static_cast<size_t>(layer.outW) * layer.outH;
+		const size_t entries = static_cast<size_t>(layer.classes) + 5;
+		for (size_t n = 0; n < layer.mask.size(); n++)
+		{
+			float* anchor = layer.output.data() + n * entries * plane;
+			for (size_t k = 0; k < 2 * plane; k++)
+				anchor[k] = logistic(anchor[k]) * layer.scaleXY - (layer.scaleXY - 1.f) * 0.5f;
+			for (size_t k = 4 * plane; k < entries * plane; k++)
+				anchor[k] = logistic(anchor[k]);
+		}
+	}
+}///namespace Ghost
@@ -0,0 +1,138 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				CpuPoseNet.h
+* \@brief Desc:				In-tree CPU inference of the OpenPose BODY_25 caffe prototxt/caffemodel
+* \@brief prerequisite::	C++17 SSE4.1 (AVX2/AVX-512 used when present)
+*/
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GSimd.hpp"
+#include "GUtilities.hpp"
+#include "PoseParser.h"
+#include "opencv2/opencv.hpp"
+
+namespace Ghost
+{
+	class ThreadPool;
+
+	/**
+	* \@brief Caffe network (Convolution/ReLU/PReLU/Pooling/Concat layer set) running on our own kernels
+	* \@desc activations following a convolution in place are fused into it, blob memory is recycled once a blob is dead
+	* \@warning not thread safe, use one instance per inference thread
+	*/
+	class CpuPoseNet final
+	{
+	public:
+		/**
+		* \@brief Preprocessed network input #BGR planar, value / 256 - 0.5#
+		*/
+		struct SInput
+		{
+			simd::AlignedVector<float> data;
+			int netWidth, netHeight;
+			int imageWidth, imageHeight;
+
+			SInput() : netWidth(0), netHeight(0), imageWidth(0), imageHeight(0) {}
+		};
+
+		/**
+		* \@brief Raw network output at 1/8 of the input size
+		*/
+		struct SOutput
+		{
+			simd::AlignedVector<float> data;
+			int channels, width, height;
+			int heatmapOffset, pafOffset;			//first heatmap / PAF channel
+			int imageWidth, imageHeight;
+
+			SOutput() : channels(0), width(0), height(0), heatmapOffset(0), pafOffset(0), imageWidth(0), imageHeight(0) {}
+		};
+
+	public:
+		CpuPoseNet();
+		~CpuPoseNet();
+
+		CpuPoseNet(const CpuPoseNet&) = delete;
+		CpuPoseNet& operator=(const CpuPoseNet&) = delete;
+
+	public:
+		/**
+		* \@brief Parse the prototxt and load the caffemodel blobs
+		* \@return Returns the result of execution
+		*/
+		EResult load(const std::string& prototxtPath, const std::string& caffeModelPath);
+
+		/**
+		* \@brief Setter/Getter
+		*/
+		void setThreadNum(const size_t threadNum);
+		void setIsa(const simd::EIsa isa) noexcept(true) { m_isa = simd::resolveIsa(isa); m_parser.setIsa(m_isa); }
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+		void setNetHeight(const int netHeight) noexcept(true) { m_netHeight = std::max(16, netHeight / 16 * 16); }
+		int getNetHeight() const noexcept(true) { return m_netHeight; }
+		PoseParser& parser() noexcept(true) { return m_parser; }
+		bool isLoaded() const noexcept(true) { return !m_layers.empty(); }
+
+		/**
+		* \@brief Stage 1::resize to the net height keeping the aspect ratio #width a multiple of 16#
+		*/
+		void preprocess(const cv::Mat& frame, SInput& input) const;
+
+		/**
+		* \@brief Stage 2::run the network
+		*/
+		void infer(const SInput& input, SOutput& output);
+
+		/**
+		* \@brief Stage 3::peaks, limbs and people
+		* \@param keypoints:: float[people][25][3] in source image pixels
+		* \@return number of people
+		*/
+		size_t postprocess(const SOutput& output, std::vector<float>& keypoints);
+
+		/**
+		* \@brief All three stages
+		*/
+		size_t detect(const cv::Mat& frame, std::vector<float>& keypoints);
+
+		/**
+		* \@brief Several frames, preprocessed in parallel then run through the network one after another
+		* \@desc frames of one size share the planned blobs, e.g. person crops of a fixed aspect ratio
+		* \@param keypoints:: resized to frames.size(), keypoints[i] as in detect
+		*/
+		void detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<float>>& keypoints);
+
+	private:
+		struct SLayer;
+		struct SBlob;
+
+		void planBlobs(const int netWidth, const int netHeight);
+		void forwardConvolution(const SLayer& layer, const float* input, float* output);
+		void forwardPooling(const SLayer& layer, const float* input, float* output);
+		void forwardActivation(const SLayer& layer, float* data, const size_t plane);
+		void parallelFor(const size_t begin, const size_t end, const std::function<void(size_t, size_t)>& func, const size_t grain = 1);
+
+	private:
+		std::vector<std::unique_ptr<SLayer>> m_layers;		//!< layers in prototxt order
+		std::vector<SBlob> m_blobs;							//!< named blobs, in place layers share one
+		std::vector<simd::AlignedVector<float>> m_buffers;	//!< storage recycled between blobs
+		std::unique_ptr<ThreadPool> m_pPool;				//!< worker pool for the GEMM
+		PoseParser m_parser;
+
+		SInput m_input;
+		SOutput m_output;
+		std::vector<SInput> m_batchInputs;
+
+		simd::EIsa m_isa;
+		int m_netHeight;
+		int m_inputBlob, m_outputBlob;
+		int m_plannedWidth, m_plannedHeight;
+	};
+}///namespace Ghost
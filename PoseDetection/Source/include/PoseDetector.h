@@ -9,6 +9,7 @@
 #pragma once
 
 #include "GIVisionDetect.h"
+#include "PoseSmoother.h"
 
 #include <vector>
 #include <string>
@@ -25,6 +26,31 @@ using namespace std;
 
 namespace Ghost
 {
+	/**
+	* \@brief Settings of one PoseDetector, several detectors with different settings can live in one process
+	* \@desc the model paths fall back to the ones given to setPath when modelsFolderPath is empty
+	*/
+	struct SPoseConfig
+	{
+		std::string modelsFolderPath;		//folder holding the models, ends with a separator
+		std::string prototxtName;
+		std::string caffeModelName;
+		int netWidth;						//network input, multiples of 16, width -1 follows the frame aspect ratio
+		int netHeight;
+		int scaleNumber;					//scales averaged by openpose
+		float scaleGap;						//scale step between them
+		int numberPeopleMax;				//-1 keeps everybody
+		size_t threadNum;					//CPU engine workers, 0 uses every core
+		int numGpu;							//openpose GPUs, -1 uses every GPU
+		int numGpuStart;					//first GPU, lets cameras share out the GPUs
+
+		SPoseConfig()
+			:
+			netWidth(-1), netHeight(368), scaleNumber(1), scaleGap(0.25f),
+			numberPeopleMax(-1), threadNum(0), numGpu(-1), numGpuStart(0)
+		{}
+	};
+
 	/**
 	* \@brief Pose detection in human body
 	*/
@@ -32,6 +58,11 @@ namespace Ghost
 	{
 	public:
 		PoseDetector();
+
+		/**
+		* \@brief Throws if setConfig rejects the config
+		*/
+		explicit PoseDetector(const SPoseConfig& config);
 		virtual ~PoseDetector() override;
 
 	public:
@@ -49,6 +80,14 @@ namespace Ghost
 		*/
 		static const string& getVersion() noexcept(true);
 
+		/**
+		* \@brief Settings of this instance, a running detector rebuilds its engine with them
+		* \@return SR_NG for a resolution that is not a multiple of 16 or a bad scale setting
+		* \@return on any failure the previous settings and engine stay in use
+		*/
+		EResult setConfig(const SPoseConfig& config);
+		SPoseConfig getConfig();
+
 		/**
 		* \@brief Loading modual parameters
 		* \@param modualLoadPath::
@@ -76,6 +115,13 @@ namespace Ghost
 
 		/**
 		* \@brief Setting Module Parameters
+		* \@desc TYPE_POSE_Detection_Cpu runs the same prototxt/caffemodel on the in-tree CPU engine instead of OpenPose
+		* \@desc OpenPose is compiled only with USE_OPENPOSE, without it the CPU engine is the default and TYPE_POSE_Detection_Cpu 0 fails
+		* \@desc TYPE_POSE_Dtection_Gui 0 turns rendering off, frameOut is left untouched and only the keypoint signals fire
+		* \@desc TYPE_POSE_Dtection_Face/Hand switch the openpose face/hand networks per frame, a network is loaded the first time it is turned on
+		* \@desc TYPE_POSE_Detection_Roi N > 0 makes detect run the full frame every N frames and only the people boxes of the previous frame in between
+		* \@desc TYPE_POSE_Detection_Smooth 1 smooths every keypoint over time per tracked person
+		* \@desc TYPE_POSE_Detection_Skip N > 1 runs the network every N frames, the frames between get the skeletons extrapolated by the filter
 		* \@param value
 		* \@return Results of implementation
 		*/
@@ -86,9 +132,55 @@ namespace Ghost
 		* \@consume time::
 		* \@param frameIn::Image for detection
 		* \@param frameShow::Need to draw detected objects #may be emtpy!!!#
+		* \@return SR_Pipeline_Full in async mode if the frame was dropped, frameShow still gets the latest finished frame
 		*/
 		virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) override;
 
+		/**
+		* \@brief Detect a batch of frames, several frames are queued into openpose at once so its stage threads overlap them
+		* \@param framesIn::Images for detection
+		* \@param framesOut::Empty if the rendered frames are not needed, else one image per frame
+		* \@param results::Result of each frame
+		* \@return SR_OK if every frame succeeded, else the first failure
+		*/
+		virtual EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results) override;
+
+		/**
+		* \@brief Tune the temporal filter used by TYPE_POSE_Detection_Smooth/Skip
+		*/
+		void setSmoothParams(const PoseSmoother::SParams& params);
+
+		/**
+		* \@brief Choose the people the face/hand networks run on, called per person with its float[25][3] body keypoints
+		* \@desc the rectangles of a frame come from the body keypoints of the previous frame, an empty filter selects everybody
+		*/
+		void setSubnetFilter(const std::function<bool(const float*)>& filter);
+
+		/**
+		* \@brief Pose of the people inside the given boxes only, each box is cropped, resized and run as a single person
+		* \@desc the boxes may come from ObjectDetector::bindSlotPersonFind, one person at most is reported per box
+		* \@param personBoxes::Person boxes in frameIn pixels
+		* \@param frameOut::Skeletons are drawn on it unless it is empty or rendering is off
+		*/
+		EResult detectRois(const cv::Mat& frameIn, const std::vector<cv::Rect>& personBoxes, cv::Mat& frameOut);
+
+		/**
+		* \@brief Submit a frame without waiting for the network, openpose runs it on its own worker threads
+		* \@desc detect behaves the same way once TYPE_POSE_Detection_Async is on, frameOut then receives the latest finished frame
+		* \@param frameIn::Image for detection #copied, the caller may reuse it#
+		* \@param frameIndex::Index handed back by getLatestResult
+		* \@return SR_Pipeline_Full if too many frames are in flight and the frame was dropped
+		*/
+		EResult detectAsync(const cv::Mat& frameIn, const size_t frameIndex);
+
+		/**
+		* \@brief Latest finished pose result, never waits
+		* \@param frameIndex::Index of the frame the result belongs to
+		* \@param frameShow::Rendered result
+		* \@return false if no frame has finished yet
+		*/
+		bool getLatestResult(size_t& frameIndex, cv::Mat& frameShow);
+
 		/**
 		* \@brief Get the module type
 		* \@return module type
@@ -97,10 +189,31 @@ namespace Ghost
 
 	public GHOST_SIGNAL:
 	/**
-	* \@brief
+	* \@brief Keypoints of the frame, 25 BODY_25 points per person, score 0 marks a missing point
 	*/
 	void bindSlotPoseFind(const std::function<void(const std::vector<Ghost::SPoint2D>&)>& func);
 
+	/**
+	* \@brief Keypoints of the frame as float[people][25][3] = x, y, score in frameIn pixels, score 0 marks a missing point
+	* \@desc the buffer belongs to the detector and is reused for the next frame, copy what is needed inside the slot
+	*/
+	void bindSlotPoseKeypoints(const std::function<void(const float*, const size_t)>& func);
+
+	/**
+	* \@brief Filtered keypoints as in bindSlotPoseKeypoints plus a stable id per person #only while the filter is on#
+	*/
+	void bindSlotPoseTracks(const std::function<void(const float*, const int*, const size_t)>& func);
+
+	/**
+	* \@brief Face keypoints as float[faces][70][3], one face per selected person of the previous frame #openpose only#
+	*/
+	void bindSlotFaceKeypoints(const std::function<void(const float*, const size_t)>& func);
+
+	/**
+	* \@brief Hand keypoints as float[people][2][21][3], left hand first #openpose only#
+	*/
+	void bindSlotHandKeypoints(const std::function<void(const float*, const size_t)>& func);
+
 	private:
 		class Impl;
 		std::unique_ptr<Impl> m_pImpl;
@@ -0,0 +1,124 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				PoseParser.h
+* \@brief Desc:				BODY_25 heatmap peak extraction and part affinity field assembly
+* \@brief prerequisite::	C++17
+*/
+#pragma once
+
+#include <vector>
+
+#include "GSimd.hpp"
+#include "opencv2/opencv.hpp"
+
+#ifndef POSEDETECTOR_API
+#define POSEDETECTOR_API
+#endif
+
+namespace Ghost
+{
+	/**
+	* \@brief Turns the BODY_25 network output (26 heatmaps + 52 PAF channels) into people
+	* \@desc keypoints are written as float[people][25][3] = x, y, score in source image pixels, score 0 marks a missing part
+	* \@desc peak rows and limb line integrals run on SIMD kernels, scratch is sized once so a steady stream does not allocate
+	* \@warning not thread safe, the scratch buffers are reused between calls
+	*/
+	class POSEDETECTOR_API PoseParser final
+	{
+	public:
+		static constexpr int s_partNum = 25;				//!< body parts, the background heatmap is not counted
+		static constexpr int s_pairNum = 26;				//!< limbs with a PAF, two channels each
+
+		/**
+		* \@brief Thresholds, the defaults are the OpenPose BODY_25 ones
+		*/
+		struct SParams
+		{
+			float peakThreshold;							//heatmap value a peak needs
+			float interThreshold;							//PAF projection a sample needs
+			float interMinAboveThreshold;					//fraction of samples above interThreshold
+			int intermediatePoints;							//samples along a limb
+			int minSubsetCount;								//parts a person needs
+			float minSubsetScore;							//average score a person needs
+			int maxPeaks;									//peaks kept per part
+
+			SParams()
+				:
+				peakThreshold(0.05f), interThreshold(0.05f), interMinAboveThreshold(0.95f),
+				intermediatePoints(10), minSubsetCount(3), minSubsetScore(0.4f), maxPeaks(64)
+			{}
+		};
+
+	public:
+		PoseParser();
+
+		void setParams(const SParams& params);
+		const SParams& getParams() const noexcept(true) { return m_params; }
+
+		/**
+		* \@brief Kernel instruction set, clamped to what the CPU supports
+		*/
+		void setIsa(const simd::EIsa isa) noexcept(true);
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+
+		/**
+		* \@brief Extract peaks, score every limb candidate and assemble people
+		* \@param heatmaps:: s_partNum planes of width * height #the background plane is not read#
+		* \@param pafs:: s_pairNum * 2 planes of width * height in the OpenPose channel order
+		* \@param scaleX/scaleY:: source image pixels per map pixel
+		* \@param keypoints:: resized to people * s_partNum * 3
+		* \@return number of people
+		*/
+		size_t parse(const float* heatmaps, const float* pafs, const int width, const int height,
+			const float scaleX, const float scaleY, std::vector<float>& keypoints);
+
+		/**
+		* \@brief Draw the skeletons in the OpenPose colours
+		*/
+		static void render(cv::Mat& image, const float* keypoints, const size_t peopleNum, const float threshold = 0.05f);
+
+	private:
+		struct SPeak
+		{
+			float x, y;										//refined position in map pixels
+			float score;
+		};
+
+		struct SConnection
+		{
+			int peakA, peakB;								//index into the part's peak list
+			float score;
+		};
+
+		using PeakRowFunc = int(*)(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns);
+		using LimbScoreFunc = float(*)(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count);
+
+		void reserve();
+		void findPeaks(const float* heatmap, const int width, const int height, std::vector<SPeak>& peaks);
+		void connect(const float* pafX, const float* pafY, const int width, const int height,
+			const std::vector<SPeak>& peaksA, const std::vector<SPeak>& peaksB, std::vector<SConnection>& connections);
+		void assemble();
+
+	private:
+		SParams m_params;
+		simd::EIsa m_isa;
+		PeakRowFunc m_peakRow;
+		LimbScoreFunc m_limbScore;
+
+		std::vector<std::vector<SPeak>> m_peaks;			//!< per part
+		std::vector<SConnection> m_candidates;				//!< scratch for one limb
+		std::vector<std::vector<SConnection>> m_connections;//!< per limb
+		std::vector<int> m_subsets;							//!< per person s_partNum peak indices, -1 if missing
+		std::vector<float> m_subsetScores;
+		std::vector<int> m_subsetCounts;
+		std::vector<int> m_people;							//!< subsets passing the person thresholds
+		std::vector<int> m_owners;							//!< [part][peak] lowest person holding the peak, -1 if none
+		std::vector<unsigned char> m_usedA, m_usedB;
+		std::vector<int> m_columns;							//!< peak columns of one heatmap row
+		std::vector<float> m_lowRow;						//!< stands in for the rows above the first / below the last
+		std::vector<float> m_steps;							//!< sample positions along a limb, padded to a full vector
+	};
+}///namespace Ghost
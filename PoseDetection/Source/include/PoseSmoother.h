@@ -0,0 +1,109 @@
+/**
+* \@brief Author			Ghost Chen
+* \@brief Email				cxx2020@outlook.com
+* \@brief Date				2026/10/19
+* \@brief File				PoseSmoother.h
+* \@brief Desc:				Per person One-Euro filtering of BODY_25 keypoints with motion prediction
+* \@brief prerequisite::	C++17
+*/
+#pragma once
+
+#include <vector>
+
+#include "PoseParser.h"
+
+namespace Ghost
+{
+	/**
+	* \@brief Follows people from frame to frame and smooths every keypoint with a One-Euro filter
+	* \@desc a person keeps its id while it is matched, the filtered velocity extrapolates the skeletons on frames the network skips
+	* \@desc keypoints are float[people][25][3] = x, y, score as written by PoseParser
+	* \@warning not thread safe
+	*/
+	class POSEDETECTOR_API PoseSmoother final
+	{
+	public:
+		/**
+		* \@brief Filter and tracking parameters, positions in pixels and times in seconds
+		*/
+		struct SParams
+		{
+			float minCutoff;								//cutoff at rest in Hz, lower is smoother
+			float beta;										//cutoff added per pixel/s of speed, higher lags less
+			float derivativeCutoff;							//cutoff of the velocity estimate in Hz
+			float pointThreshold;							//score a keypoint needs to feed the filter
+			float matchDistance;							//mean keypoint distance, in person heights, still taken as the same person
+			int maxMissed;									//updates a person may go unmatched before its id is dropped
+			float maxPrediction;							//longest extrapolation, older tracks are held still
+
+			SParams()
+				:
+				minCutoff(1.f), beta(0.05f), derivativeCutoff(1.f), pointThreshold(0.05f),
+				matchDistance(0.5f), maxMissed(5), maxPrediction(0.5f)
+			{}
+		};
+
+	public:
+		PoseSmoother();
+
+		void setParams(const SParams& params) noexcept(true) { m_params = params; }
+		const SParams& getParams() const noexcept(true) { return m_params; }
+
+		/**
+		* \@brief Forget every person
+		*/
+		void reset() noexcept(true);
+
+		/**
+		* \@brief Match the detected people to the tracked ones and filter their keypoints
+		* \@param keypoints:: detections of the frame
+		* \@param time:: capture time of the frame in seconds
+		* \@param smoothed:: resized to peopleNum * 25 * 3, in the order of keypoints
+		* \@return number of people, always peopleNum
+		*/
+		size_t update(const float* keypoints, const size_t peopleNum, const double time, std::vector<float>& smoothed);
+
+		/**
+		* \@brief Extrapolate the people seen by the last update to time
+		* \@param predicted:: resized to people * 25 * 3, in the order of that update
+		* \@return number of people
+		*/
+		size_t predict(const double time, std::vector<float>& predicted) const;
+
+		/**
+		* \@brief Id of each person written by the last update, predict keeps the same order
+		*/
+		const std::vector<int>& ids() const noexcept(true) { return m_ids; }
+
+	private:
+		struct STrack
+		{
+			int id;
+			int missed;										//updates since it was last matched
+			double time;									//time of the last update
+			float x[PoseParser::s_partNum], y[PoseParser::s_partNum];
+			float dx[PoseParser::s_partNum], dy[PoseParser::s_partNum];
+			float score[PoseParser::s_partNum];				//0 if the part is not tracked
+		};
+
+		struct SMatch
+		{
+			float cost;
+			int person, track;
+		};
+
+		float matchCost(const float* person, const STrack& track, const double time) const;
+		void filter(STrack& track, const float* person, const double time, float* smoothed) const;
+
+	private:
+		SParams m_params;
+		int m_nextId;
+
+		std::vector<STrack> m_tracks;
+		std::vector<SMatch> m_matches;						//!< candidate pairs of one update
+		std::vector<int> m_trackOf;							//!< per person the track index, -1 if new
+		std::vector<unsigned char> m_trackUsed;
+		std::vector<int> m_order;							//!< tracks in the output order of the last update
+		std::vector<int> m_ids;
+	};
+}///namespace Ghost
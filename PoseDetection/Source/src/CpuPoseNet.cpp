@@ -0,0 +1,1084 @@
+#include "CpuPoseNet.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "GThreadPool.hpp"
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		enum struct ELayerType : uint8_t
+		{
+			Convolution = 0,
+			Pooling,
+			Activation,
+			Concat
+		};
+
+		enum struct EActivation : uint8_t
+		{
+			Linear = 0,
+			Relu,
+			PRelu
+		};
+
+		//output columns handled by one im2col + GEMM tile
+		const int s_tileColumns = 2048;
+
+		/**
+		* \@brief One message of the prototxt text format
+		*/
+		struct SProtoNode
+		{
+			vector<pair<string, string>> values;
+			vector<pair<string, SProtoNode>> children;
+
+			string get(const string& key, const string& defaultValue) const
+			{
+				for (const auto& value : values)
+				{
+					if (value.first == key)
+						return value.second;
+				}
+				return defaultValue;
+			}
+
+			int getInt(const string& key, const int defaultValue) const
+			{
+				const string value = get(key, "");
+				return value.empty() ? defaultValue : std::atoi(value.c_str());
+			}
+
+			float getFloat(const string& key, const float defaultValue) const
+			{
+				const string value = get(key, "");
+				return value.empty() ? defaultValue : static_cast<float>(std::atof(value.c_str()));
+			}
+
+			vector<string> getAll(const string& key) const
+			{
+				vector<string> result;
+				for (const auto& value : values)
+				{
+					if (value.first == key)
+						result.push_back(value.second);
+				}
+				return result;
+			}
+
+			const SProtoNode* child(const string& name) const
+			{
+				for (const auto& node : children)
+				{
+					if (node.first == name)
+						return &node.second;
+				}
+				return nullptr;
+			}
+		};
+
+		/**
+		* \@brief Tokenizer + recursive parser for the protobuf text format
+		*/
+		class ProtoTextParser
+		{
+		public:
+			explicit ProtoTextParser(const string& text) : m_text(text), m_pos(0) {}
+
+			bool parse(SProtoNode& root)
+			{
+				return parseMessage(root, false);
+			}
+
+		private:
+			bool parseMessage(SProtoNode& node, const bool nested)
+			{
+				for (;;)
+				{
+					string name;
+					if (!nextToken(name))
+						return !nested;
+					if (name == "}")
+						return nested;
+
+					string token;
+					if (!nextToken(token))
+						return false;
+					if (token == ":")
+					{
+						if (!nextToken(token))
+							return false;
+					}
+
+					if (token == "{")
+					{
+						node.children.emplace_back(name, SProtoNode());
+						if (!parseMessage(node.children.back().second, true))
+							return false;
+					}
+					else
+						node.values.emplace_back(name, token);
+				}
+			}
+
+			bool nextToken(string& token)
+			{
+				token.clear();
+				while (m_pos < m_text.size())
+				{
+					const char c = m_text[m_pos];
+					if (c == '#')
+					{
+						while (m_pos < m_text.size() && m_text[m_pos] != '\n')
+							m_pos++;
+					}
+					else if (std::isspace(static_cast<unsigned char>(c)))
+						m_pos++;
+					else
+						break;
+				}
+				if (m_pos >= m_text.size())
+					return false;
+
+				const char c = m_text[m_pos];
+				if (c == '{' || c == '}' || c == ':')
+				{
+					token = c;
+					m_pos++;
+					return true;
+				}
+
+				if (c == '"' || c == '\'')
+				{
+					m_pos++;
+					while (m_pos < m_text.size() && m_text[m_pos] != c)
+					{
+						if (m_text[m_pos] == '\\' && m_pos + 1 < m_text.size())
+							m_pos++;
+						token += m_text[m_pos++];
+					}
+					m_pos++;
+					return true;
+				}
+
+				while (m_pos < m_text.size())
+				{
+					const char d = m_text[m_pos];
+					if (std::isspace(static_cast<unsigned char>(d)) || d == '{' || d == '}' || d == ':' || d == '#')
+						break;
+					token += d;
+					m_pos++;
+				}
+				return true;
+			}
+
+		private:
+			const string& m_text;
+			size_t m_pos;
+		};
+
+		/**
+		* \@brief One BlobProto of the caffemodel
+		*/
+		struct SWeightBlob
+		{
+			vector<int64_t> shape;
+			vector<float> data;
+		};
+
+		/**
+		* \@brief Protobuf wire format reader, enough for NetParameter/LayerParameter/BlobProto
+		*/
+		class WireReader
+		{
+		public:
+			WireReader(const uint8_t* data, const size_t size) : m_pos(data), m_end(data + size) {}
+
+			bool done() const noexcept(true) { return m_pos >= m_end; }
+
+			bool varint(uint64_t& value)
+			{
+				value = 0;
+				for (int shift = 0; shift < 64 && m_pos < m_end; shift += 7)
+				{
+					const uint8_t byte = *m_pos++;
+					value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0)
+						return true;
+				}
+				return false;
+			}
+
+			bool key(uint32_t& field, uint32_t& wire)
+			{
+				uint64_t value = 0;
+				if (!varint(value))
+					return false;
+				field = static_cast<uint32_t>(value >> 3);
+				wire = static_cast<uint32_t>(value & 7);
+				return true;
+			}
+
+			bool bytes(const uint8_t*& data, size_t& size)
+			{
+				uint64_t length = 0;
+				if (!varint(length) || length > static_cast<uint64_t>(m_end - m_pos))
+					return false;
+				data = m_pos;
+				size = static_cast<size_t>(length);
+				m_pos += size;
+				return true;
+			}
+
+			bool fixed32(uint32_t& value)
+			{
+				if (m_end - m_pos < 4)
+					return false;
+				std::memcpy(&value, m_pos, 4);
+				m_pos += 4;
+				return true;
+			}
+
+			bool skip(const uint32_t wire)
+			{
+				uint64_t value = 0;
+				const uint8_t* data = nullptr;
+				size_t size = 0;
+				switch (wire)
+				{
+				case 0: return varint(value);
+				case 1: if (m_end - m_pos < 8) return false; m_pos += 8; return true;
+				case 2: return bytes(data, size);
+				case 5: if (m_end - m_pos < 4) return false; m_pos += 4; return true;
+				default: return false;
+				}
+			}
+
+		private:
+			const uint8_t* m_pos;
+			const uint8_t* m_end;
+		};
+
+		bool parseBlobShape(const uint8_t* data, const size_t size, vector<int64_t>& shape)
+		{
+			WireReader reader(data, size);
+			uint32_t field = 0, wire = 0;
+			while (!reader.done())
+			{
+				if (!reader.key(field, wire))
+					return false;
+
+				if (field == 1 && wire == 2)
+				{
+					const uint8_t* packed = nullptr;
+					size_t packedSize = 0;
+					if (!reader.bytes(packed, packedSize))
+						return false;
+					WireReader dims(packed, packedSize);
+					uint64_t dim = 0;
+					while (!dims.done() && dims.varint(dim))
+						shape.push_back(static_cast<int64_t>(dim));
+				}
+				else if (field == 1 && wire == 0)
+				{
+					uint64_t dim = 0;
+					if (!reader.varint(dim))
+						return false;
+					shape.push_back(static_cast<int64_t>(dim));
+				}
+				else if (!reader.skip(wire))
+					return false;
+			}
+			return true;
+		}
+
+		bool parseBlob(const uint8_t* data, const size_t size, SWeightBlob& blob)
+		{
+			WireReader reader(data, size);
+			int64_t legacy[4] = { 0, 0, 0, 0 };
+			uint32_t field = 0, wire = 0;
+			while (!reader.done())
+			{
+				if (!reader.key(field, wire))
+					return false;
+
+				if (field == 5 && wire == 2)
+				{
+					const uint8_t* packed = nullptr;
+					size_t packedSize = 0;
+					if (!reader.bytes(packed, packedSize))
+						return false;
+					const size_t offset = blob.data.size();
+					blob.data.resize(offset + packedSize / 4);
+					std::memcpy(blob.data.data() + offset, packed, packedSize / 4 * 4);
+				}
+				else if (field == 5 && wire == 5)
+				{
+					uint32_t bits = 0;
+					if (!reader.fixed32(bits))
+						return false;
+					float value = 0.f;
+					std::memcpy(&value, &bits, 4);
+					blob.data.push_back(value);
+				}
+				else if (field == 7 && wire == 2)
+				{
+					const uint8_t* shape = nullptr;
+					size_t shapeSize = 0;
+					if (!reader.bytes(shape, shapeSize) || !parseBlobShape(shape, shapeSize, blob.shape))
+						return false;
+				}
+				else if (field >= 1 && field <= 4 && wire == 0)
+				{
+					uint64_t value = 0;
+					if (!reader.varint(value))
+						return false;
+					legacy[field - 1] = static_cast<int64_t>(value);
+				}
+				else if (!reader.skip(wire))
+					return false;
+			}
+
+			if (blob.shape.empty() && legacy[0] + legacy[1] + legacy[2] + legacy[3] > 0)
+				blob.shape.assign(legacy, legacy + 4);
+			return true;
+		}
+
+		/**
+		* \@brief LayerParameter (name 1, blobs 7) or the V1 layout (name 4, blobs 6)
+		*/
+		bool parseLayer(const uint8_t* data, const size_t size, const bool v1, map<string, vector<SWeightBlob>>& weights)
+		{
+			const uint32_t nameField = v1 ? 4 : 1;
+			const uint32_t blobField = v1 ? 6 : 7;
+
+			WireReader reader(data, size);
+			string name;
+			vector<SWeightBlob> blobs;
+			uint32_t field = 0, wire = 0;
+			while (!reader.done())
+			{
+				if (!reader.key(field, wire))
+					return false;
+
+				const uint8_t* bytes = nullptr;
+				size_t bytesSize = 0;
+				if (field == nameField && wire == 2)
+				{
+					if (!reader.bytes(bytes, bytesSize))
+						return false;
+					name.assign(reinterpret_cast<const char*>(bytes), bytesSize);
+				}
+				else if (field == blobField && wire == 2)
+				{
+					if (!reader.bytes(bytes, bytesSize))
+						return false;
+					blobs.emplace_back();
+					if (!parseBlob(bytes, bytesSize, blobs.back()))
+						return false;
+				}
+				else if (!reader.skip(wire))
+					return false;
+			}
+
+			if (!name.empty() && !blobs.empty())
+				weights[name] = std::move(blobs);
+			return true;
+		}
+
+		bool parseCaffeModel(const string& path, map<string, vector<SWeightBlob>>& weights)
+		{
+			ifstream file(path, ios::binary);
+			if (!file.is_open())
+				return false;
+			const vector<uint8_t> content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+			WireReader reader(content.data(), content.size());
+			uint32_t field = 0, wire = 0;
+			while (!reader.done())
+			{
+				if (!reader.key(field, wire))
+					return false;
+
+				if ((field == 100 || field == 2) && wire == 2)
+				{
+					const uint8_t* bytes = nullptr;
+					size_t bytesSize = 0;
+					if (!reader.bytes(bytes, bytesSize) || !parseLayer(bytes, bytesSize, field == 2, weights))
+						return false;
+				}
+				else if (!reader.skip(wire))
+					return false;
+			}
+			return true;
+		}
+	}
+
+	struct CpuPoseNet::SLayer
+	{
+		ELayerType type;
+		string name;
+		vector<int> bottoms;
+		int top;
+
+		//convolution
+		int inChannels, outChannels, kernel, stride, pad;
+		simd::AlignedVector<float> weights;					//[outChannels][inChannels * kernel * kernel]
+		vector<float> biases;
+
+		//activation, standalone or fused into the convolution
+		EActivation activation;
+		float negativeSlope;
+		vector<float> slopes;								//PReLU, one per channel
+
+		//pooling
+		bool maxFlag;
+
+		SLayer()
+			:
+			type(ELayerType::Convolution), top(-1),
+			inChannels(0), outChannels(0), kernel(1), stride(1), pad(0),
+			activation(EActivation::Linear), negativeSlope(0.f), maxFlag(true)
+		{}
+	};
+
+	struct CpuPoseNet::SBlob
+	{
+		string name;
+		int channels, height, width;
+		int buffer;											//index into m_buffers
+
+		SBlob() : channels(0), height(0), width(0), buffer(-1) {}
+
+		size_t count() const noexcept(true) { return static_cast<size_t>(channels) * height * width; }
+	};
+
+	CpuPoseNet::CpuPoseNet()
+		:
+		m_pPool(nullptr),
+		m_isa(simd::bestIsa()),
+		m_netHeight(368),
+		m_inputBlob(-1), m_outputBlob(-1),
+		m_plannedWidth(0), m_plannedHeight(0)
+	{
+		setThreadNum(0);
+	}
+
+	CpuPoseNet::~CpuPoseNet()
+	{
+		m_pPool.reset();
+	}
+
+	void CpuPoseNet::setThreadNum(const size_t threadNum)
+	{
+		size_t num = (threadNum == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : threadNum;
+
+		//the calling thread takes part in parallelFor
+		m_pPool = (num > 1) ? std::make_unique<ThreadPool>(num - 1) : nullptr;
+	}
+
+	void CpuPoseNet::parallelFor(const size_t begin, const size_t end, const std::function<void(size_t, size_t)>& func, const size_t grain)
+	{
+		if (m_pPool == nullptr)
+			func(begin, end);
+		else
+			m_pPool->parallelFor(begin, end, func, grain);
+	}
+
+	EResult CpuPoseNet::load(const string& prototxtPath, const string& caffeModelPath)
+	{
+		m_layers.clear();
+		m_blobs.clear();
+		m_plannedWidth = m_plannedHeight = 0;
+		m_inputBlob = m_outputBlob = -1;
+
+		ifstream prototxt(prototxtPath);
+		if (!prototxt.is_open())
+			return EResult::SR_Prototxt_Path_Not_Exist;
+		stringstream text;
+		text << prototxt.rdbuf();
+
+		const string content = text.str();
+		SProtoNode root;
+		if (!ProtoTextParser(content).parse(root))
+			return EResult::SR_NG;
+
+		map<string, vector<SWeightBlob>> weights;
+		{
+			ifstream check(caffeModelPath, ios::binary);
+			if (!check.is_open())
+				return EResult::SR_Caffe_Model_Path_Not_Exist;
+		}
+		if (!parseCaffeModel(caffeModelPath, weights))
+			return EResult::SR_NG;
+
+		auto blobIndex = [this](const string& name) -> int
+		{
+			for (size_t i = 0; i < m_blobs.size(); i++)
+			{
+				if (m_blobs[i].name == name)
+					return static_cast<int>(i);
+			}
+			m_blobs.emplace_back();
+			m_blobs.back().name = name;
+			return static_cast<int>(m_blobs.size() - 1);
+		};
+
+		const string inputName = root.get("input", "");
+		if (!inputName.empty())
+			m_inputBlob = blobIndex(inputName);
+
+		for (const auto& node : root.children)
+		{
+			if (node.first != "layer")
+				continue;
+
+			const SProtoNode& layerNode = node.second;
+			const string type = layerNode.get("type", "");
+			const string name = layerNode.get("name", "");
+			const vector<string> bottoms = layerNode.getAll("bottom");
+			const vector<string> tops = layerNode.getAll("top");
+			if (tops.size() != 1)
+				return EResult::SR_NG;
+
+			if (type == "Input")
+			{
+				m_inputBlob = blobIndex(tops[0]);
+				continue;
+			}
+			if (bottoms.empty())
+				return EResult::SR_NG;
+
+			auto pLayer = std::make_unique<SLayer>();
+			pLayer->name = name;
+			for (const auto& bottom : bottoms)
+				pLayer->bottoms.push_back(blobIndex(bottom));
+			pLayer->top = blobIndex(tops[0]);
+
+			const auto iterWeights = weights.find(name);
+			const vector<SWeightBlob>* pBlobs = (iterWeights == weights.end()) ? nullptr : &iterWeights->second;
+
+			if (type == "Convolution")
+			{
+				const SProtoNode* param = layerNode.child("convolution_param");
+				if (param == nullptr || pBlobs == nullptr)
+					return EResult::SR_NG;
+				if (param->getInt("group", 1) != 1 || param->getInt("dilation", 1) != 1)
+					return EResult::SR_NG;
+
+				pLayer->type = ELayerType::Convolution;
+				pLayer->outChannels = param->getInt("num_output", 0);
+				pLayer->kernel = param->getInt("kernel_size", param->getInt("kernel_h", 1));
+				pLayer->stride = param->getInt("stride", param->getInt("stride_h", 1));
+				pLayer->pad = param->getInt("pad", param->getInt("pad_h", 0));
+
+				const size_t perFilter = static_cast<size_t>(pLayer->kernel) * pLayer->kernel;
+				const SWeightBlob& filters = pBlobs->at(0);
+				if (pLayer->outChannels <= 0 || filters.data.size() % (perFilter * pLayer->outChannels) != 0)
+					return EResult::SR_NG;
+				pLayer->inChannels = static_cast<int>(filters.data.size() / (perFilter * pLayer->outChannels));
+				pLayer->weights.assign(filters.data.begin(), filters.data.end());
+
+				pLayer->biases.assign(pLayer->outChannels, 0.f);
+				if (param->get("bias_term", "true") != "false" && pBlobs->size() > 1)
+				{
+					if (pBlobs->at(1).data.size() != static_cast<size_t>(pLayer->outChannels))
+						return EResult::SR_NG;
+					pLayer->biases = pBlobs->at(1).data;
+				}
+			}
+			else if (type == "ReLU" || type == "PReLU")
+			{
+				pLayer->type = ELayerType::Activation;
+				if (type == "ReLU")
+				{
+					const SProtoNode* param = layerNode.child("relu_param");
+					pLayer->activation = EActivation::Relu;
+					pLayer->negativeSlope = (param == nullptr) ? 0.f : param->getFloat("negative_slope", 0.f);
+				}
+				else
+				{
+					if (pBlobs == nullptr || pBlobs->at(0).data.empty())
+						return EResult::SR_NG;
+					pLayer->activation = EActivation::PRelu;
+					pLayer->slopes = pBlobs->at(0).data;
+				}
+
+				//in place right after the convolution that produced it:: fold into the GEMM tile
+				if (!m_layers.empty() && pLayer->top == pLayer->bottoms[0])
+				{
+					SLayer& previous = *m_layers.back();
+					if (previous.type == ELayerType::Convolution && previous.top == pLayer->top && previous.activation == EActivation::Linear)
+					{
+						previous.activation = pLayer->activation;
+						previous.negativeSlope = pLayer->negativeSlope;
+						previous.slopes = pLayer->slopes;
+						continue;
+					}
+				}
+			}
+			else if (type == "Pooling")
+			{
+				const SProtoNode* param = layerNode.child("pooling_param");
+				if (param == nullptr || param->get("global_pooling", "false") == "true")
+					return EResult::SR_NG;
+
+				pLayer->type = ELayerType::Pooling;
+				const string pool = param->get("pool", "MAX");
+				if (pool != "MAX" && pool != "AVE")
+					return EResult::SR_NG;
+				pLayer->maxFlag = (pool == "MAX");
+				pLayer->kernel = param->getInt("kernel_size", param->getInt("kernel_h", 1));
+				pLayer->stride = param->getInt("stride", param->getInt("stride_h", 1));
+				pLayer->pad = param->getInt("pad", param->getInt("pad_h", 0));
+			}
+			else if (type == "Concat")
+			{
+				const SProtoNode* param = layerNode.child("concat_param");
+				const int axis = (param == nullptr) ? 1 : param->getInt("axis", param->getInt("concat_dim", 1));
+				if (axis != 1)
+					return EResult::SR_NG;
+				pLayer->type = ELayerType::Concat;
+			}
+			else
+				return EResult::SR_NG;
+
+			m_layers.push_back(std::move(pLayer));
+		}
+
+		if (m_layers.empty() || m_inputBlob < 0)
+		{
+			m_layers.clear();
+			return EResult::SR_NG;
+		}
+		m_outputBlob = m_layers.back()->top;
+
+		return EResult::SR_OK;
+	}
+
+	void CpuPoseNet::planBlobs(const int netWidth, const int netHeight)
+	{
+		SBlob& input = m_blobs[m_inputBlob];
+		input.channels = 3;
+		input.height = netHeight;
+		input.width = netWidth;
+
+		//shapes
+		vector<int> lastUse(m_blobs.size(), -1);
+		for (size_t i = 0; i < m_layers.size(); i++)
+		{
+			const SLayer& layer = *m_layers[i];
+			const SBlob& bottom = m_blobs[layer.bottoms[0]];
+			SBlob& top = m_blobs[layer.top];
+			for (const int b : layer.bottoms)
+				lastUse[b] = static_cast<int>(i);
+
+			switch (layer.type)
+			{
+			case ELayerType::Convolution:
+				top.channels = layer.outChannels;
+				top.height = (bottom.height + 2 * layer.pad - layer.kernel) / layer.stride + 1;
+				top.width = (bottom.width + 2 * layer.pad - layer.kernel) / layer.stride + 1;
+				break;
+			case ELayerType::Pooling:
+			{
+				//caffe rounds the pooled size up and drops a window that starts in the padding
+				auto pooled = [&](const int size)
+				{
+					int out = static_cast<int>(std::ceil(static_cast<float>(size + 2 * layer.pad - layer.kernel) / layer.stride)) + 1;
+					if (layer.pad > 0 && (out - 1) * layer.stride >= size + layer.pad)
+						out--;
+					return out;
+				};
+				top.channels = bottom.channels;
+				top.height = pooled(bottom.height);
+				top.width = pooled(bottom.width);
+				break;
+			}
+			case ELayerType::Activation:
+				top.channels = bottom.channels;
+				top.height = bottom.height;
+				top.width = bottom.width;
+				break;
+			case ELayerType::Concat:
+				top.channels = 0;
+				for (const int b : layer.bottoms)
+					top.channels += m_blobs[b].channels;
+				top.height = bottom.height;
+				top.width = bottom.width;
+				break;
+			}
+		}
+
+		//storage:: a dead blob gives its buffer to the next blob that needs one
+		for (auto& blob : m_blobs)
+			blob.buffer = -1;
+		vector<size_t> bufferSizes;
+		vector<int> freeBuffers;
+		auto acquire = [&](SBlob& blob)
+		{
+			if (freeBuffers.empty())
+			{
+				freeBuffers.push_back(static_cast<int>(bufferSizes.size()));
+				bufferSizes.push_back(0);
+			}
+			blob.buffer = freeBuffers.back();
+			freeBuffers.pop_back();
+			bufferSizes[blob.buffer] = std::max(bufferSizes[blob.buffer], blob.count());
+		};
+
+		acquire(input);
+		for (size_t i = 0; i < m_layers.size(); i++)
+		{
+			const SLayer& layer = *m_layers[i];
+			SBlob& top = m_blobs[layer.top];
+			if (top.buffer < 0)
+				acquire(top);
+
+			for (const int b : layer.bottoms)
+			{
+				if (lastUse[b] == static_cast<int>(i) && b != layer.top && b != m_outputBlob && m_blobs[b].buffer >= 0)
+				{
+					if (std::find(freeBuffers.begin(), freeBuffers.end(), m_blobs[b].buffer) == freeBuffers.end())
+						freeBuffers.push_back(m_blobs[b].buffer);
+				}
+			}
+		}
+
+		m_buffers.resize(bufferSizes.size());
+		for (size_t i = 0; i < bufferSizes.size(); i++)
+		{
+			if (m_buffers[i].size() < bufferSizes[i])
+				m_buffers[i].resize(bufferSizes[i]);
+		}
+
+		m_plannedWidth = netWidth;
+		m_plannedHeight = netHeight;
+	}
+
+	void CpuPoseNet::preprocess(const cv::Mat& frame, SInput& input) const
+	{
+		cv::Mat bgr = frame;
+		if (frame.channels() == 1)
+			cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
+		else if (frame.channels() == 4)
+			cv::cvtColor(frame, bgr, cv::COLOR_BGRA2BGR);
+
+		const int netHeight = m_netHeight;
+		const double scale = static_cast<double>(netHeight) / bgr.rows;
+		const int netWidth = std::max(16, static_cast<int>(std::lround(bgr.cols * scale / 16.0)) * 16);
+
+		cv::Mat resized;
+		cv::resize(bgr, resized, cv::Size(netWidth, netHeight), 0, 0, cv::INTER_LINEAR);
+
+		input.netWidth = netWidth;
+		input.netHeight = netHeight;
+		input.imageWidth = frame.cols;
+		input.imageHeight = frame.rows;
+
+		const size_t plane = static_cast<size_t>(netWidth) * netHeight;
+		input.data.resize(plane * 3);
+		float* dst = input.data.data();
+		for (int y = 0; y < netHeight; y++)
+		{
+			const uint8_t* src = resized.ptr<uint8_t>(y);
+			float* b = dst + static_cast<size_t>(y) * netWidth;
+			float* g = b + plane;
+			float* r = g + plane;
+			for (int x = 0; x < netWidth; x++)
+			{
+				b[x] = src[x * 3 + 0] * (1.f / 256.f) - 0.5f;
+				g[x] = src[x * 3 + 1] * (1.f / 256.f) - 0.5f;
+				r[x] = src[x * 3 + 2] * (1.f / 256.f) - 0.5f;
+			}
+		}
+	}
+
+	void CpuPoseNet::infer(const SInput& input, SOutput& output)
+	{
+		if (!isLoaded() || input.data.empty())
+			return;
+
+		if (input.netWidth != m_plannedWidth || input.netHeight != m_plannedHeight)
+			planBlobs(input.netWidth, input.netHeight);
+
+		std::memcpy(m_buffers[m_blobs[m_inputBlob].buffer].data(), input.data.data(), input.data.size() * sizeof(float));
+
+		for (const auto& pLayer : m_layers)
+		{
+			const SLayer& layer = *pLayer;
+			const SBlob& bottom = m_blobs[layer.bottoms[0]];
+			const SBlob& top = m_blobs[layer.top];
+			float* dst = m_buffers[top.buffer].data();
+
+			switch (layer.type)
+			{
+			case ELayerType::Convolution:
+				forwardConvolution(layer, m_buffers[bottom.buffer].data(), dst);
+				break;
+			case ELayerType::Pooling:
+				forwardPooling(layer, m_buffers[bottom.buffer].data(), dst);
+				break;
+			case ELayerType::Activation:
+				if (bottom.buffer != top.buffer)
+					std::memcpy(dst, m_buffers[bottom.buffer].data(), bottom.count() * sizeof(float));
+				forwardActivation(layer, dst, static_cast<size_t>(top.height) * top.width);
+				break;
+			case ELayerType::Concat:
+			{
+				size_t offset = 0;
+				for (const int b : layer.bottoms)
+				{
+					const SBlob& part = m_blobs[b];
+					std::memcpy(dst + offset, m_buffers[part.buffer].data(), part.count() * sizeof(float));
+					offset += part.count();
+				}
+				break;
+			}
+			}
+		}
+
+		//heatmaps (parts + background) and PAFs, located by their channel count when the output is a concat
+		const SBlob& result = m_blobs[m_outputBlob];
+		output.channels = result.channels;
+		output.width = result.width;
+		output.height = result.height;
+		output.imageWidth = input.imageWidth;
+		output.imageHeight = input.imageHeight;
+		output.heatmapOffset = 0;
+		output.pafOffset = PoseParser::s_partNum + 1;
+
+		const SLayer& last = *m_layers.back();
+		if (last.type == ELayerType::Concat)
+		{
+			int offset = 0;
+			for (const int b : last.bottoms)
+			{
+				if (m_blobs[b].channels == PoseParser::s_partNum + 1)
+					output.heatmapOffset = offset;
+				else if (m_blobs[b].channels == PoseParser::s_pairNum * 2)
+					output.pafOffset = offset;
+				offset += m_blobs[b].channels;
+			}
+		}
+
+		output.data.resize(result.count());
+		std::memcpy(output.data.data(), m_buffers[result.buffer].data(), result.count() * sizeof(float));
+	}
+
+	void CpuPoseNet::forwardConvolution(const SLayer& layer, const float* input, float* output)
+	{
+		const SBlob& bottom = m_blobs[layer.bottoms[0]];
+		const SBlob& top = m_blobs[layer.top];
+
+		const int M = layer.outChannels;
+		const int K = layer.inChannels * layer.kernel * layer.kernel;
+		const int N = top.height * top.width;
+		const bool pointwise = (layer.kernel == 1 && layer.stride == 1 && layer.pad == 0);
+
+		const int rowsPerTile = std::max(1, s_tileColumns / top.width);
+		const size_t tiles = static_cast<size_t>((top.height + rowsPerTile - 1) / rowsPerTile);
+		const simd::EIsa isa = m_isa;
+
+		parallelFor(0, tiles, [&](size_t tileBegin, size_t tileEnd)
+		{
+			thread_local simd::AlignedVector<float> col;
+
+			for (size_t tile = tileBegin; tile < tileEnd; tile++)
+			{
+				const int yBegin = static_cast<int>(tile) * rowsPerTile;
+				const int yEnd = std::min(top.height, yBegin + rowsPerTile);
+				const int n0 = yBegin * top.width;
+				const int n = (yEnd - yBegin) * top.width;
+
+				if (pointwise)
+					simd::sgemm(M, n, K, layer.weights.data(), K, input + n0, N, output + n0, N, false, isa);
+				else
+				{
+					//caffe im2col restricted to the output rows of this tile:: [inChannels * kernel * kernel][n]
+					col.resize(static_cast<size_t>(K) * n);
+					for (int k = 0; k < K; k++)
+					{
+						const int kx = k % layer.kernel;
+						const int ky = (k / layer.kernel) % layer.kernel;
+						const int channel = k / layer.kernel / layer.kernel;
+						const float* src = input + static_cast<size_t>(channel) * bottom.height * bottom.width;
+						float* dst = col.data() + static_cast<size_t>(k) * n;
+
+						for (int y = yBegin; y < yEnd; y++)
+						{
+							const int row = y * layer.stride - layer.pad + ky;
+							float* line = dst + static_cast<size_t>(y - yBegin) * top.width;
+							if (row < 0 || row >= bottom.height)
+							{
+								std::fill(line, line + top.width, 0.f);
+								continue;
+							}
+
+							const float* srcRow = src + static_cast<size_t>(row) * bottom.width;
+							for (int x = 0; x < top.width; x++)
+							{
+								const int column = x * layer.stride - layer.pad + kx;
+								line[x] = (column < 0 || column >= bottom.width) ? 0.f : srcRow[column];
+							}
+						}
+					}
+					simd::sgemm(M, n, K, layer.weights.data(), K, col.data(), n, output + n0, N, false, isa);
+				}
+
+				//bias and the fused activation while the tile is still in cache
+				for (int m = 0; m < M; m++)
+				{
+					float* out = output + static_cast<size_t>(m) * N + n0;
+					const float bias = layer.biases[m];
+					const float slope = (layer.activation == EActivation::PRelu) ? layer.slopes[layer.slopes.size() == 1 ? 0 : m] : layer.negativeSlope;
+					if (layer.activation == EActivation::Linear)
+					{
+						for (int i = 0; i < n; i++)
+							out[i] += bias;
+					}
+					else
+					{
+						for (int i = 0; i < n; i++)
+						{
+							const float value = out[i] + bias;
+							out[i] = (value > 0.f) ? value : value * slope;
+						}
+					}
+				}
+			}
+		});
+	}
+
+	void CpuPoseNet::forwardPooling(const SLayer& layer, const float* input, float* output)
+	{
+		const SBlob& bottom = m_blobs[layer.bottoms[0]];
+		const SBlob& top = m_blobs[layer.top];
+
+		parallelFor(0, top.channels, [&](size_t cBegin, size_t cEnd)
+		{
+			for (size_t c = cBegin; c < cEnd; c++)
+			{
+				const float* src = input + c * bottom.height * bottom.width;
+				float* dst = output + c * top.height * top.width;
+				for (int y = 0; y < top.height; y++)
+				{
+					const int yStart = y * layer.stride - layer.pad;
+					const int yStop = std::min(yStart + layer.kernel, bottom.height + layer.pad);
+					const int y0 = std::max(0, yStart), y1 = std::min(yStop, bottom.height);
+					for (int x = 0; x < top.width; x++)
+					{
+						const int xStart = x * layer.stride - layer.pad;
+						const int xStop = std::min(xStart + layer.kernel, bottom.width + layer.pad);
+						const int x0 = std::max(0, xStart), x1 = std::min(xStop, bottom.width);
+
+						if (layer.maxFlag)
+						{
+							float value = -FLT_MAX;
+							for (int yy = y0; yy < y1; yy++)
+							{
+								for (int xx = x0; xx < x1; xx++)
+									value = std::max(value, src[yy * bottom.width + xx]);
+							}
+							dst[y * top.width + x] = value;
+						}
+						else
+						{
+							float sum = 0.f;
+							for (int yy = y0; yy < y1; yy++)
+							{
+								for (int xx = x0; xx < x1; xx++)
+									sum += src[yy * bottom.width + xx];
+							}
+							dst[y * top.width + x] = sum / ((yStop - yStart) * (xStop - xStart));
+						}
+					}
+				}
+			}
+		}, 4);
+	}
+
+	void CpuPoseNet::forwardActivation(const SLayer& layer, float* data, const size_t plane)
+	{
+		const size_t channels = m_blobs[layer.top].channels;
+		parallelFor(0, channels, [&](size_t cBegin, size_t cEnd)
+		{
+			for (size_t c = cBegin; c < cEnd; c++)
+			{
+				const float slope = (layer.activation == EActivation::PRelu) ? layer.slopes[layer.slopes.size() == 1 ? 0 : c] : layer.negativeSlope;
+				float* values = data + c * plane;
+				for (size_t i = 0; i < plane; i++)
+					values[i] = (values[i] > 0.f) ? values[i] : values[i] * slope;
+			}
+		}, 8);
+	}
+
+	size_t CpuPoseNet::postprocess(const SOutput& output, std::vector<float>& keypoints)
+	{
+		keypoints.clear();
+		if (output.data.empty() || output.width <= 0 || output.height <= 0)
+			return 0;
+
+		const size_t plane = static_cast<size_t>(output.width) * output.height;
+		const float scaleX = static_cast<float>(output.imageWidth) / output.width;
+		const float scaleY = static_cast<float>(output.imageHeight) / output.height;
+		return m_parser.parse(output.data.data() + output.heatmapOffset * plane, output.data.data() + output.pafOffset * plane,
+			output.width, output.height, scaleX, scaleY, keypoints);
+	}
+
+	size_t CpuPoseNet::detect(const cv::Mat& frame, std::vector<float>& keypoints)
+	{
+		keypoints.clear();
+		if (frame.empty() || !isLoaded())
+			return 0;
+
+		preprocess(frame, m_input);
+		infer(m_input, m_output);
+		return postprocess(m_output, keypoints);
+	}
+
+	void CpuPoseNet::detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<float>>& keypoints)
+	{
+		keypoints.resize(frames.size());
+		if (!isLoaded())
+		{
+			for (auto& points : keypoints)
+				points.clear();
+			return;
+		}
+
+		if (m_batchInputs.size() < frames.size())
+			m_batchInputs.resize(frames.size());
+
+		parallelFor(0, frames.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				if (!frames[i].empty())
+					preprocess(frames[i], m_batchInputs[i]);
+			}
+		});
+
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			keypoints[i].clear();
+			if (frames[i].empty())
+				continue;
+
+			infer(m_batchInputs[i], m_output);
+			postprocess(m_output, keypoints[i]);
+		}
+	}
+}///namespace Ghost
@@ -1,9 +1,18 @@
 #include "PoseDetector.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cfloat>
+#include <chrono>
 #include <filesystem>
 #include <mutex>
 
+#include "CpuPoseNet.h"
+#include "PoseSmoother.h"
+#include "GThreadPool.hpp"
+
+#ifdef USE_OPENPOSE
 #define OPENPOSE_FLAGS_DISABLE_PRODUCER
 #define OPENPOSE_FLAGS_DISABLE_DISPLAY
 
@@ -11,12 +20,15 @@
 #include <openpose/headers.hpp>
 
 using namespace op;
+#endif
 namespace fs = std::filesystem;
 using namespace std;
 using namespace Ghost::signalslot;
 
+#ifdef USE_OPENPOSE
 // Display
 DEFINE_bool(no_display, false, "Enable to disable the visual display.");
+#endif
 
 namespace Ghost
 {
@@ -25,8 +37,15 @@ namespace Ghost
 	public:
 		Impl()
 			:
-			m_pDetector(nullptr)
-		{}
+#ifdef USE_OPENPOSE
+			m_pDetector(nullptr),
+#endif
+			m_pCpuNet(nullptr)
+		{
+			m_keypoints.reserve(s_reservedPeople * PoseParser::s_partNum * 3);
+			m_points.reserve(s_reservedPeople * PoseParser::s_partNum);
+			m_smooth.keypoints.reserve(s_reservedPeople * PoseParser::s_partNum * 3);
+		}
 
 		~Impl()
 		{
@@ -45,13 +64,10 @@ namespace Ghost
 			if (m_flags.initFlag.load())
 				return EResult::SR_Detector_Already_Exist;
 
-			m_pDetector = std::make_unique<op::Wrapper>(op::ThreadManagerMode::Asynchronous);	//!!!!!!!!!!!
-			if (m_pDetector == nullptr)
-				return EResult::SR_Detector_Memory_Allocation_Failed;
-
-			this->configure();
-
-			m_pDetector->start();
+			//CPUģʽֻ openpose
+			const EResult result = m_flags.cpuFlag.load() ? loadCpuNet() : startWrapper();
+			if (result != EResult::SR_OK)
+				return result;
 
 			m_flags.initFlag.store(true);
 
@@ -69,17 +85,26 @@ namespace Ghost
 			if ((!m_flags.initFlag.load()))
 				return EResult::SR_Detector_Not_Exist;
 
+#ifdef USE_OPENPOSE
 			if (m_pDetector)
 			{
 				m_pDetector.reset();
 				m_pDetector = nullptr;
 			}
+#endif
+			m_pCpuNet.reset();
 
+			m_async = SAsyncState();
+			m_roi.frameCounter = 0;
+			m_roi.boxes.clear();
+			m_smooth.frameCounter = 0;
+			m_smooth.smoother.reset();
 			m_flags.initFlag.store(false);
 
 			return EResult::SR_OK;
 		}
 
+#ifdef USE_OPENPOSE
 		/**
 		* \@brief
 		* \@return Returns the result of execution
@@ -96,7 +121,7 @@ namespace Ghost
 			// outputSize
 			const auto outputSize = op::flagsToPoint(FLAGS_output_resolution, "-1x-1");
 			// netInputSize
-			const auto netInputSize = op::flagsToPoint(FLAGS_net_resolution, "-1x368");
+			const op::Point<int> netInputSize{ m_config.netWidth, m_config.netHeight };
 			// faceNetInputSize
 			const auto faceNetInputSize = op::flagsToPoint(FLAGS_face_net_resolution, "368x368 (multiples of 16)");
 			// handNetInputSize
@@ -117,28 +142,31 @@ namespace Ghost
 			// >1 camera view?
 			const auto multipleView = (FLAGS_3d || FLAGS_3d_views > 1);
 			// Face and hand detectors
-			const auto faceDetector = op::flagsToDetector(FLAGS_face_detector);
-			const auto handDetector = op::flagsToDetector(FLAGS_hand_detector);
+			// ǰһ֡ؼ ûоε֡face/hand粻
+			const auto faceDetector = op::Detector::Provided;
+			const auto handDetector = op::Detector::Provided;
 			// Enabling Google Logging
 			const bool enableGoogleLogging = false;
+			// رջʱȾ׶ cvOutputDataҲ
+			const int renderPose = m_flags.showFlag.load() ? FLAGS_render_pose : 0;
 
 			// Pose configuration (use WrapperStructPose{} for default and recommended configuration)
 			const op::WrapperStructPose wrapperStructPose
 			{
-				poseMode, netInputSize, outputSize, keypointScaleMode, FLAGS_num_gpu, FLAGS_num_gpu_start,
-				FLAGS_scale_number, (float)FLAGS_scale_gap, op::flagsToRenderMode(FLAGS_render_pose, multipleView),
+				poseMode, netInputSize, outputSize, keypointScaleMode, m_config.numGpu, m_config.numGpuStart,
+				m_config.scaleNumber, m_config.scaleGap, op::flagsToRenderMode(renderPose, multipleView),
 				poseModel, !FLAGS_disable_blending, (float)FLAGS_alpha_pose, (float)FLAGS_alpha_heatmap,
-				FLAGS_part_to_show, PoseDetector::Impl::s_modelPath, heatMapTypes, heatMapScaleMode, FLAGS_part_candidates,
-				(float)FLAGS_render_threshold, FLAGS_number_people_max, FLAGS_maximize_positives, FLAGS_fps_max,
-				PoseDetector::Impl::s_prototxtName, PoseDetector::Impl::s_caffeModelName, (float)FLAGS_upsampling_ratio, enableGoogleLogging
+				FLAGS_part_to_show, modelsFolderPath(), heatMapTypes, heatMapScaleMode, FLAGS_part_candidates,
+				(float)FLAGS_render_threshold, m_config.numberPeopleMax, FLAGS_maximize_positives, FLAGS_fps_max,
+				prototxtName(), caffeModelName(), (float)FLAGS_upsampling_ratio, enableGoogleLogging
 			};
 			m_pDetector->configure(wrapperStructPose);
 
 			// Face configuration (use op::WrapperStructFace{} to disable it)
 			const op::WrapperStructFace wrapperStructFace
 			{
-				false, faceDetector, faceNetInputSize,
-				op::flagsToRenderMode(FLAGS_face_render, multipleView, FLAGS_render_pose),
+				m_subnet.faceLoaded, faceDetector, faceNetInputSize,
+				op::flagsToRenderMode(m_flags.showFlag.load() ? FLAGS_face_render : 0, multipleView, renderPose),
 				(float)FLAGS_face_alpha_pose, (float)FLAGS_face_alpha_heatmap, (float)FLAGS_face_render_threshold
 			};
 			m_pDetector->configure(wrapperStructFace);
@@ -146,8 +174,8 @@ namespace Ghost
 			// Hand configuration (use op::WrapperStructHand{} to disable it)
 			const op::WrapperStructHand wrapperStructHand
 			{
-				false, handDetector, handNetInputSize, FLAGS_hand_scale_number, (float)FLAGS_hand_scale_range,
-				op::flagsToRenderMode(FLAGS_hand_render, multipleView, FLAGS_render_pose), (float)FLAGS_hand_alpha_pose,
+				m_subnet.handLoaded, handDetector, handNetInputSize, FLAGS_hand_scale_number, (float)FLAGS_hand_scale_range,
+				op::flagsToRenderMode(m_flags.showFlag.load() ? FLAGS_hand_render : 0, multipleView, renderPose), (float)FLAGS_hand_alpha_pose,
 				(float)FLAGS_hand_alpha_heatmap, (float)FLAGS_hand_render_threshold
 			};
 			m_pDetector->configure(wrapperStructHand);
@@ -182,6 +210,7 @@ namespace Ghost
 
 			return EResult::SR_OK;
 		}
+#endif
 
 		/**
 		* \@brief Detect the Object  #warning if frameShow is tempty Explains that the detected object does not need to be drawn#
@@ -193,130 +222,1389 @@ namespace Ghost
 			std::lock_guard<std::mutex> lock(m_mutex);
 
 			if (!m_flags.initFlag.load())
-				EResult::SR_Detector_Not_Exist;
+				return EResult::SR_Detector_Not_Exist;
 
-			auto datumProcessed = m_pDetector->emplaceAndPop(frameIn);
+			//֡ģʽ ÿinterval֡һ ֡˲
+			if (m_smooth.interval > 1 && !m_flags.asyncFlag.load())
+			{
+				const bool inferFlag = (m_smooth.frameCounter % m_smooth.interval) == 0;
+				m_smooth.frameCounter++;
+				if (!inferFlag)
+					return detectPredicted(frameIn, frameOut);
+			}
 
-			frameOut = datumProcessed->at(0)->cvOutputData;
+			//ROIģʽ ÿinterval֡ȫͼһ ֻ֡һ֡ڵ
+			if (m_roi.interval > 0 && !m_flags.asyncFlag.load())
+				return detectTracked(frameIn, frameOut);
 
-			return EResult::SR_OK;
+			if (m_flags.cpuFlag.load())
+				return detectCpu(frameIn, frameOut);
+
+			//ģʽ ύǰ֡ ɵһ֡
+			if (m_flags.asyncFlag.load())
+			{
+				//ʱ֡ ɵһ֡ SR_Pipeline_Full֪÷
+				const EResult result = submit(frameIn, m_async.frameCounter++);
+				collect();
+
+				if (!m_async.latestFrame.empty())
+					frameOut = m_async.latestFrame;
+
+				return result;
+			}
+
+			return detectOpenPose(frameIn, frameOut);
 		}
 
-	public:
-		//pose
-		std::unique_ptr<op::Wrapper> m_pDetector;
+		/**
+		* \@brief ֻڸڼ ÿüź̬ ؼӳԭͼ
+		*/
+		EResult detectRois(const cv::Mat& frameIn, const std::vector<cv::Rect>& personBoxes, cv::Mat& frameOut)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-		struct SFlags
+			if (!m_flags.initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			const EResult result = detectRoi(frameIn, personBoxes, frameOut);
+			if (result == EResult::SR_OK)
+				trackBoxes();
+
+			return result;
+		}
+
+		/**
+		* \@brief ύ openposeԼ߳ϴ ͨgetLatestResultȡ
+		*/
+		EResult detectAsync(const cv::Mat& frameIn, const size_t frameIndex)
 		{
-			std::atomic_bool initFlag;				//ʼ־
-			std::atomic_bool poseFlag;				//pose ־
-			std::atomic_bool faceFlag;				//face ־
-			std::atomic_bool handFlag;				//hand ־
-			std::atomic_bool extraFlag;				//extra ־
-			std::atomic_bool outputFlag;			//output ־
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-			SFlags() :
-				initFlag(false), poseFlag(true), faceFlag(false),
-				handFlag(false), extraFlag(false), outputFlag(false)
-			{}
-		};
-		SFlags m_flags;
+			if (!m_flags.initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
 
-		//źŲ
-		Ghost::signalslot::Signal<void(const std::vector<Ghost::SPoint2D>&)> m_SIGNAL_void_points2D;
-		Ghost::signalslot::Slot m_SLOT_void_points2D;
+			//CPUûԼ߳ ͵
+			if (m_flags.cpuFlag.load())
+			{
+				cv::Mat frameShow = m_flags.showFlag.load() ? frameIn.clone() : cv::Mat();
+				const EResult result = detectCpu(frameIn, frameShow);
+				if (result == EResult::SR_OK)
+				{
+					m_async.latestFlag = true;
+					m_async.latestIndex = frameIndex;
+					m_async.latestFrame = frameShow;
+				}
+				return result;
+			}
 
-		//
-		std::mutex m_mutex;
+			const EResult result = submit(frameIn, frameIndex);
+			collect();
 
-		//modelļ
-		static string s_modelPath;
-		static string s_prototxtName;
-		static string s_caffeModelName;
+			return result;
+		}
 
-		//汾
-		const static string s_version;
-	};
+		/**
+		* \@brief ɵһ֡֡ ȴ
+		*/
+		bool getLatestResult(size_t& frameIndex, cv::Mat& frameShow)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-	string PoseDetector::Impl::s_modelPath = "";
-	string PoseDetector::Impl::s_prototxtName = "";
-	string PoseDetector::Impl::s_caffeModelName = "";
+			if (m_flags.initFlag.load() && !m_flags.cpuFlag.load())
+				collect();
 
-#if( _MSC_TOOLSET_VER_ == 140 )
-#ifdef NDEBUG
-	const string PoseDetector::Impl::s_version = "vc140-r.0";
-#else
-	const string PoseDetector::Impl::s_version = "vc140-d.0";
-#endif
-#elif(_MSC_TOOLSET_VER_ == 141)
-#ifdef NDEBUG
-	const string PoseDetector::Impl::s_version = "vc141-r.0";
-#else
-	const string PoseDetector::Impl::s_version = "vc141-d.0";
-#endif
-#elif(_MSC_TOOLSET_VER_ == 142)
-#ifdef NDEBUG
-	const string PoseDetector::Impl::s_version = "vc142-r.0";
+			if (!m_async.latestFlag)
+				return false;
+
+			frameIndex = m_async.latestIndex;
+			frameShow = m_async.latestFrame;
+			return true;
+		}
+
+		/**
+		* \@brief  ֡ͬʱopenpose첽 ڲ׶߳ͬʱ ٰ֡ȡ
+		*/
+		EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+		{
+			if (!framesOut.empty() && framesOut.size() != framesIn.size())
+				return EResult::SR_NG;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_flags.initFlag.load())
+				return EResult::SR_Detector_Not_Exist;
+
+			//CPUڲѾ߳ ִ֡
+			if (m_flags.cpuFlag.load())
+			{
+				results.assign(framesIn.size(), EResult::SR_OK);
+				for (size_t i = 0; i < framesIn.size(); i++)
+				{
+					cv::Mat frameEmpty;
+					results[i] = detectCpu(framesIn[i], framesOut.empty() ? frameEmpty : framesOut[i]);
+				}
+				return EResult::SR_OK;
+			}
+
+#ifdef USE_OPENPOSE
+			//ȡģʽ;֡ ǻᱻɱ֡ȡ
+			drainAsync();
+
+			results.assign(framesIn.size(), EResult::SR_Detector_Not_Exist);
+
+			//ȡһ֡ ֡ŷŻԭλ
+			auto popOne = [&]() -> bool
+			{
+				std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> datumProcessed;
+				if (!m_pDetector->waitAndPop(datumProcessed))
+					return false;
+
+				if (datumProcessed != nullptr && !datumProcessed->empty())
+				{
+					const auto& datum = datumProcessed->at(0);
+					const size_t index = static_cast<size_t>(datum->frameNumber);
+					if (index < framesIn.size())
+					{
+						publish(*datum);
+						if (!framesOut.empty() && m_flags.showFlag.load())
+							framesOut[index] = datum->cvOutputData;
+						results[index] = EResult::SR_OK;
+					}
+				}
+				return true;
+			};
+
+			size_t pending = 0;
+			for (size_t i = 0; i < framesIn.size(); i++)
+			{
+				if (framesIn[i].empty())
+				{
+					results[i] = EResult::SR_Image_Empty;
+					continue;
+				}
+
+				//;֡ д˻һֱ
+				if (pending >= s_batchInFlight)
+				{
+					if (!popOne())
+						return EResult::SR_NG;
+					pending--;
+				}
+
+				auto datumsPtr = makeDatums(framesIn[i], i);
+
+				if (m_pDetector->waitAndEmplace(datumsPtr))
+					pending++;
+			}
+
+			for (; pending > 0; pending--)
+			{
+				if (!popOne())
+					break;
+			}
+
+			return EResult::SR_OK;
 #else
-	const string PoseDetector::Impl::s_version = "vc142-d.0";
-#endif
+			return EResult::SR_Detector_Not_Exist;
 #endif
+		}
 
-	PoseDetector::PoseDetector()
-		:
-		m_pImpl(std::make_unique<Impl>())
-	{
-		if (m_pImpl == nullptr)
+		/**
+		* \@brief лopenpose/CPU ѳʼʱĿ
+		*/
+		EResult setCpu(const bool cpuFlag)
 		{
-			throw std::exception("PoseDetector::PoseDetector::make_unique::failured!!!");
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!cpuFlag && !s_openPoseFlag)
+				return EResult::SR_Detector_Not_Exist;
+
+			if (m_flags.initFlag.load())
+			{
+				const EResult result = cpuFlag ? loadCpuNet() : startWrapper();
+				if (result != EResult::SR_OK)
+					return result;
+			}
+
+			m_flags.cpuFlag.store(cpuFlag);
+
+			return EResult::SR_OK;
 		}
-	}
 
-	PoseDetector::~PoseDetector()
-	{
-		antiModual();
-	}
+		/**
+		* \@brief /رջ openposeȾģʽconfigureʱȷ ʱwrapper
+		*/
+		EResult setShow(const bool showFlag)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-	EResult PoseDetector::loadModualParam(const string& modualLoadPath)
-	{
-		return EResult::SR_OK;
-	}
+			if (m_flags.showFlag.load() == showFlag)
+				return EResult::SR_OK;
 
-	EResult  PoseDetector::saveModelParam()
-	{
-		return EResult::SR_OK;
-	}
+			m_flags.showFlag.store(showFlag);
+			m_async.latestFrame.release();
 
-	EResult PoseDetector::initModual()
-	{
-		return m_pImpl->initModual();
-	}
+			if (!m_flags.initFlag.load())
+				return EResult::SR_OK;
 
-	EResult PoseDetector::antiModual()
-	{
-		this->saveModelParam();
+			return restartWrapper();
+		}
 
-		return m_pImpl->antiModual();
-	}
+		/**
+		* \@brief /رfacehand ֻڵһδʱһ ֮лֻһ֡Ƿ
+		*/
+		EResult setSubnet(const bool faceFlag, const bool enableFlag)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-	EResult PoseDetector::setModualParam(const EModualParamType type, const float value)
-	{
-		return EResult::SR_OK;
-	}
+			(faceFlag ? m_flags.faceFlag : m_flags.handFlag).store(enableFlag);
+			if (!enableFlag)
+				return EResult::SR_OK;
 
-	EResult PoseDetector::detect(const cv::Mat& frameIn, cv::Mat& frameOut)
-	{
-		return m_pImpl->detect(frameIn, frameOut);
-	}
+			bool& loaded = faceFlag ? m_subnet.faceLoaded : m_subnet.handLoaded;
+			if (loaded)
+				return EResult::SR_OK;
 
-	EDetectModual PoseDetector::getModualType() noexcept(true)
-	{
-		return EDetectModual::Pose_Detection_Modual;
-	}
+			loaded = true;
+			if (!m_flags.initFlag.load())
+				return EResult::SR_OK;
 
-	void PoseDetector::bindSlotPoseFind(const std::function<void(const std::vector<Ghost::SPoint2D>&)>& func)
-	{
-		m_pImpl->m_SLOT_void_points2D = m_pImpl->m_SIGNAL_void_points2D.connect(func);
+			//еһδ һΰؽ
+			return restartWrapper();
+		}
+
+		void setSubnetFilter(const std::function<bool(const float*)>& filter)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_subnet.filter = filter;
+		}
+
+		/**
+		* \@brief ROIģʽ interval֡ȫͼһ 0::ر
+		*/
+		EResult setRoiInterval(const size_t interval)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_roi.interval = interval;
+			m_roi.frameCounter = 0;
+			m_roi.boxes.clear();
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief /رչؼʱ˲
+		*/
+		EResult setSmooth(const bool smoothFlag)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_smooth.enableFlag = smoothFlag;
+			m_smooth.smoother.reset();
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ÿinterval֡һ 0/1::ÿ֡
+		*/
+		EResult setSkipInterval(const size_t interval)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_smooth.interval = interval;
+			m_smooth.frameCounter = 0;
+
+			return EResult::SR_OK;
+		}
+
+		void setSmoothParams(const PoseSmoother::SParams& params)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_smooth.smoother.setParams(params);
+		}
+
+		EResult setThreadNum(const size_t threadNum)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_config.threadNum = threadNum;
+			if (m_pCpuNet != nullptr)
+				m_pCpuNet->setThreadNum(threadNum);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ʵ 水ؽ
+		*/
+		EResult setConfig(const SPoseConfig& config)
+		{
+			//Ϊ16ı -1ʾ
+			if (config.netHeight <= 0 || config.netHeight % 16 != 0 || (config.netWidth != -1 && (config.netWidth <= 0 || config.netWidth % 16 != 0)))
+				return EResult::SR_NG;
+			if (config.scaleNumber < 1 || config.scaleGap <= 0.f)
+				return EResult::SR_NG;
+
+			if (!config.modelsFolderPath.empty())
+			{
+				if (!fs::exists(config.modelsFolderPath))
+					return EResult::SR_Model_Path_Not_Exist;
+				if (!fs::exists(config.modelsFolderPath + config.prototxtName))
+					return EResult::SR_Prototxt_Path_Not_Exist;
+				if (!fs::exists(config.modelsFolderPath + config.caffeModelName))
+					return EResult::SR_Caffe_Model_Path_Not_Exist;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			const SPoseConfig previous = m_config;
+			m_config = config;
+			if (!m_flags.initFlag.load())
+				return EResult::SR_OK;
+
+			//µCPUسɹ滻 ʧʱ;ñֲ
+			if (m_pCpuNet != nullptr)
+			{
+				std::unique_ptr<CpuPoseNet> pCpuNet;
+				const EResult result = createCpuNet(pCpuNet);
+				if (result != EResult::SR_OK)
+				{
+					m_config = previous;
+					return result;
+				}
+				m_pCpuNet = std::move(pCpuNet);
+			}
+
+			return restartWrapper();
+		}
+
+		SPoseConfig getConfig()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			return m_config;
+		}
+
+	private:
+#ifdef USE_OPENPOSE
+		/**
+		* \@brief openpose #÷#
+		*/
+		EResult startWrapper()
+		{
+			if (m_pDetector != nullptr)
+				return EResult::SR_OK;
+
+			m_pDetector = std::make_unique<op::Wrapper>(op::ThreadManagerMode::Asynchronous);	//!!!!!!!!!!!
+			if (m_pDetector == nullptr)
+				return EResult::SR_Detector_Memory_Allocation_Failed;
+
+			this->configure();
+
+			m_pDetector->start();
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief openposeǰؽ δʱκ #÷#
+		*/
+		EResult restartWrapper()
+		{
+			if (m_pDetector == nullptr)
+				return EResult::SR_OK;
+
+			drainAsync();
+			m_pDetector.reset();
+			return startWrapper();
+		}
+#else
+		EResult startWrapper()
+		{
+			return EResult::SR_Detector_Not_Exist;
+		}
+
+		EResult restartWrapper()
+		{
+			return EResult::SR_OK;
+		}
+#endif
+
+		/**
+		* \@brief еprototxt/caffemodelCPU #÷#
+		*/
+		EResult loadCpuNet()
+		{
+			if (m_pCpuNet != nullptr)
+				return EResult::SR_OK;
+
+			return createCpuNet(m_pCpuNet);
+		}
+
+		/**
+		* \@brief ǰ½CPU ֻڳɹʱдpCpuNet #÷#
+		*/
+		EResult createCpuNet(std::unique_ptr<CpuPoseNet>& pCpuNet) const
+		{
+			if (modelsFolderPath().empty())
+				return EResult::SR_Data_Path_Not_Set;
+
+			auto pNet = std::make_unique<CpuPoseNet>();
+			const EResult result = pNet->load(modelsFolderPath() + prototxtName(), modelsFolderPath() + caffeModelName());
+			if (result != EResult::SR_OK)
+				return result;
+
+			//CPUǰ
+			pNet->setThreadNum(m_config.threadNum);
+			pNet->setNetHeight(m_config.netHeight);
+			pCpuNet = std::move(pNet);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ģ· δʱʹsetPathõĽĬֵ
+		*/
+		const string& modelsFolderPath() const { return m_config.modelsFolderPath.empty() ? s_modelPath : m_config.modelsFolderPath; }
+		const string& prototxtName() const { return m_config.modelsFolderPath.empty() ? s_prototxtName : m_config.prototxtName; }
+		const string& caffeModelName() const { return m_config.modelsFolderPath.empty() ? s_caffeModelName : m_config.caffeModelName; }
+
+		/**
+		* \@brief CPUһ֡ ƹǼܲؼź #÷#
+		*/
+		EResult detectCpu(const cv::Mat& frameIn, cv::Mat& frameOut)
+		{
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			const size_t peopleNum = m_pCpuNet->detect(frameIn, m_keypoints);
+
+			emitKeypoints(peopleNum);
+			render(frameOut);
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ֡ģʽ֡ ˲һεĽƵǰʱ #÷#
+		*/
+		EResult detectPredicted(const cv::Mat& frameIn, cv::Mat& frameOut)
+		{
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			const size_t peopleNum = m_smooth.smoother.predict(elapsedSeconds(), m_smooth.keypoints);
+
+			emitPeople(m_smooth.keypoints, peopleNum);
+			render(frameOut);
+
+			return EResult::SR_OK;
+		}
+
+#ifdef USE_OPENPOSE
+		/**
+		* \@brief ģʽopenposeһ֡ #÷#
+		*/
+		EResult detectOpenPose(const cv::Mat& frameIn, cv::Mat& frameOut)
+		{
+			//лģʽʱ ȡ;֡ emplaceAndPopõ֡
+			drainAsync();
+
+			auto datumsPtr = makeDatums(frameIn, 0);
+			std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> datumProcessed;
+			if (!m_pDetector->waitAndEmplace(datumsPtr) || !m_pDetector->waitAndPop(datumProcessed))
+				return EResult::SR_NG;
+			if (datumProcessed == nullptr || datumProcessed->empty())
+				return EResult::SR_NG;
+
+			const auto& datum = datumProcessed->at(0);
+			publish(*datum);
+			if (m_flags.showFlag.load())
+				frameOut = datum->cvOutputData;
+
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief ȡзģʽ֡ #÷#
+		*/
+		void drainAsync()
+		{
+			std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> datumPending;
+			for (; m_async.inFlight > 0; m_async.inFlight--)
+				m_pDetector->waitAndPop(datumPending);
+		}
+#else
+		EResult detectOpenPose(const cv::Mat& frameIn, cv::Mat& frameOut)
+		{
+			return EResult::SR_Detector_Not_Exist;
+		}
+
+		void drainAsync()
+		{
+		}
+#endif
+
+		/**
+		* \@brief ROIģʽһ֡ ûпɸٵ˻򵽴ʱȫͼ #÷#
+		*/
+		EResult detectTracked(const cv::Mat& frameIn, cv::Mat& frameOut)
+		{
+			const bool fullFlag = m_roi.boxes.empty() || (m_roi.frameCounter % m_roi.interval) == 0;
+			m_roi.frameCounter++;
+
+			EResult result = EResult::SR_OK;
+			if (!fullFlag)
+				result = detectRoi(frameIn, m_roi.boxes, frameOut);
+			else
+				result = m_flags.cpuFlag.load() ? detectCpu(frameIn, frameOut) : detectOpenPose(frameIn, frameOut);
+
+			if (result == EResult::SR_OK)
+				trackBoxes();
+
+			return result;
+		}
+
+		/**
+		* \@brief üROI ̬ ÿROIȡܷߵһӳԭͼ #÷#
+		*/
+		EResult detectRoi(const cv::Mat& frameIn, const std::vector<cv::Rect>& personBoxes, cv::Mat& frameOut)
+		{
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			m_roi.rois.clear();
+			for (const auto& box : personBoxes)
+			{
+				const cv::Rect roi = paddedRoi(box);
+				if ((roi & cv::Rect(0, 0, frameIn.cols, frameIn.rows)).area() > 0)
+					m_roi.rois.push_back(roi);
+			}
+
+			//ROIŵͬһߴ ֻ谴һߴ滮
+			const size_t roiNum = m_roi.rois.size();
+			m_roi.crops.resize(roiNum);
+			Ghost::sharedThreadPool().parallelFor(0, roiNum, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					cropRoi(frameIn, m_roi.rois[i], m_roi.crops[i]);
+			});
+
+			if (m_flags.cpuFlag.load())
+				m_pCpuNet->detectBatch(m_roi.crops, m_roi.keypoints);
+			else if (!detectCropsOpenPose())
+				return EResult::SR_NG;
+
+			const size_t stride = PoseParser::s_partNum * 3;
+			m_keypoints.assign(roiNum * stride, 0.f);
+			size_t peopleNum = 0;
+			for (size_t i = 0; i < roiNum; i++)
+			{
+				const std::vector<float>& points = m_roi.keypoints[i];
+				const float* best = nullptr;
+				float bestScore = 0.f;
+				for (size_t p = 0; p < points.size() / stride; p++)
+				{
+					float score = 0.f;
+					for (int part = 0; part < PoseParser::s_partNum; part++)
+						score += points[p * stride + part * 3 + 2];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = &points[p * stride];
+					}
+				}
+				if (best == nullptr)
+					continue;
+
+				const cv::Rect& roi = m_roi.rois[i];
+				const float scaleX = static_cast<float>(roi.width) / s_roiSize.width;
+				const float scaleY = static_cast<float>(roi.height) / s_roiSize.height;
+				float* person = &m_keypoints[peopleNum * stride];
+				for (int part = 0; part < PoseParser::s_partNum; part++)
+				{
+					if (best[part * 3 + 2] <= 0.f)
+						continue;
+					person[part * 3 + 0] = roi.x + (best[part * 3 + 0] + 0.5f) * scaleX - 0.5f;
+					person[part * 3 + 1] = roi.y + (best[part * 3 + 1] + 0.5f) * scaleY - 0.5f;
+					person[part * 3 + 2] = best[part * 3 + 2];
+				}
+				peopleNum++;
+			}
+			m_keypoints.resize(peopleNum * stride);
+
+			emitKeypoints(peopleNum);
+			render(frameOut);
+
+			return EResult::SR_OK;
+		}
+
+#ifdef USE_OPENPOSE
+		/**
+		* \@brief üROIopenpose ŷŻm_roi.keypoints #÷#
+		*/
+		bool detectCropsOpenPose()
+		{
+			drainAsync();
+
+			const size_t roiNum = m_roi.crops.size();
+			m_roi.keypoints.resize(roiNum);
+			for (auto& points : m_roi.keypoints)
+				points.clear();
+
+			auto popOne = [&]() -> bool
+			{
+				std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> datumProcessed;
+				if (!m_pDetector->waitAndPop(datumProcessed))
+					return false;
+
+				if (datumProcessed != nullptr && !datumProcessed->empty())
+				{
+					const auto& datum = datumProcessed->at(0);
+					const size_t index = static_cast<size_t>(datum->frameNumber);
+					if (index < roiNum)
+						copyPoseKeypoints(*datum, m_roi.keypoints[index]);
+				}
+				return true;
+			};
+
+			size_t pending = 0;
+			for (size_t i = 0; i < roiNum; i++)
+			{
+				if (pending >= s_batchInFlight)
+				{
+					if (!popOne())
+						return false;
+					pending--;
+				}
+
+				auto datumsPtr = std::make_shared<std::vector<std::shared_ptr<op::Datum>>>();
+				datumsPtr->emplace_back(std::make_shared<op::Datum>());
+				datumsPtr->at(0)->cvInputData = m_roi.crops[i];
+				datumsPtr->at(0)->frameNumber = i;
+
+				if (m_pDetector->waitAndEmplace(datumsPtr))
+					pending++;
+			}
+
+			for (; pending > 0; pending--)
+			{
+				if (!popOne())
+					return false;
+			}
+			return true;
+		}
+#else
+		bool detectCropsOpenPose()
+		{
+			return false;
+		}
+#endif
+
+		/**
+		* \@brief s_roiMargin ٲs_roiSizeĿ߱
+		*/
+		static cv::Rect paddedRoi(const cv::Rect& box)
+		{
+			const float aspect = static_cast<float>(s_roiSize.width) / s_roiSize.height;
+			float width = box.width * s_roiMargin;
+			float height = box.height * s_roiMargin;
+			if (width < height * aspect)
+				width = height * aspect;
+			else
+				height = width / aspect;
+
+			const float centerX = box.x + box.width * 0.5f;
+			const float centerY = box.y + box.height * 0.5f;
+			return cv::Rect(static_cast<int>(std::lround(centerX - width * 0.5f)), static_cast<int>(std::lround(centerY - height * 0.5f)),
+				std::max(1, static_cast<int>(std::lround(width))), std::max(1, static_cast<int>(std::lround(height))));
+		}
+
+		/**
+		* \@brief üroiŵs_roiSize ͼĲֲڱ
+		*/
+		static void cropRoi(const cv::Mat& frame, const cv::Rect& roi, cv::Mat& crop)
+		{
+			const cv::Rect inside = roi & cv::Rect(0, 0, frame.cols, frame.rows);
+			if (inside == roi)
+			{
+				cv::resize(frame(roi), crop, s_roiSize, 0, 0, cv::INTER_LINEAR);
+				return;
+			}
+
+			cv::Mat padded;
+			cv::copyMakeBorder(frame(inside), padded, inside.y - roi.y, roi.br().y - inside.br().y,
+				inside.x - roi.x, roi.br().x - inside.br().x, cv::BORDER_CONSTANT, cv::Scalar::all(0));
+			cv::resize(padded, crop, s_roiSize, 0, 0, cv::INTER_LINEAR);
+		}
+
+		/**
+		* \@brief m_keypointsõһ֡ п󲿷صΪͬһ #÷#
+		*/
+		void trackBoxes()
+		{
+			m_roi.boxes.clear();
+
+			const size_t stride = PoseParser::s_partNum * 3;
+			for (size_t p = 0; p < m_keypoints.size() / stride; p++)
+			{
+				const float* person = &m_keypoints[p * stride];
+				float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+				int count = 0;
+				for (int part = 0; part < PoseParser::s_partNum; part++)
+				{
+					if (person[part * 3 + 2] <= s_roiPointThreshold)
+						continue;
+					minX = std::min(minX, person[part * 3 + 0]);
+					minY = std::min(minY, person[part * 3 + 1]);
+					maxX = std::max(maxX, person[part * 3 + 0]);
+					maxY = std::max(maxY, person[part * 3 + 1]);
+					count++;
+				}
+				if (count < s_roiMinParts)
+					continue;
+
+				const cv::Rect box(cvFloor(minX), cvFloor(minY), cvCeil(maxX - minX) + 1, cvCeil(maxY - minY) + 1);
+				bool duplicateFlag = false;
+				for (const auto& other : m_roi.boxes)
+				{
+					if ((box & other).area() > s_roiOverlap * std::min(box.area(), other.area()))
+					{
+						duplicateFlag = true;
+						break;
+					}
+				}
+				if (!duplicateFlag)
+					m_roi.boxes.push_back(box);
+			}
+		}
+
+#ifdef USE_OPENPOSE
+		/**
+		* \@brief openposeposeKeypointsfloat[people][25][3]дkeypoints #BODY_25ģֻǰĵ scoreΪ0#
+		* \@return 
+		*/
+		static size_t copyPoseKeypoints(const op::Datum& datum, std::vector<float>& keypoints)
+		{
+			const auto& poseKeypoints = datum.poseKeypoints;
+			const size_t peopleNum = poseKeypoints.empty() ? 0 : static_cast<size_t>(poseKeypoints.getSize(0));
+			const int srcPartNum = poseKeypoints.empty() ? 0 : poseKeypoints.getSize(1);
+			const int partNum = std::min(srcPartNum, PoseParser::s_partNum);
+
+			keypoints.assign(peopleNum * PoseParser::s_partNum * 3, 0.f);
+			const float* src = poseKeypoints.getConstPtr();
+			for (size_t p = 0; p < peopleNum; p++)
+				std::copy(src + p * srcPartNum * 3, src + (p * srcPartNum + partNum) * 3, keypoints.data() + p * PoseParser::s_partNum * 3);
+
+			return peopleNum;
+		}
+
+		/**
+		* \@brief openposeposeKeypointsԤm_keypointsź #÷#
+		*/
+		void publish(const op::Datum& datum)
+		{
+			emitKeypoints(copyPoseKeypoints(datum, m_keypoints));
+
+			if (m_subnet.faceLoaded && !datum.faceRectangles.empty())
+			{
+				const size_t faceNum = copyKeypoints(datum.faceKeypoints, s_facePartNum, m_subnet.faceKeypoints);
+				m_SIGNAL_void_faceKeypoints(m_subnet.faceKeypoints.data(), faceNum);
+			}
+
+			if (m_subnet.handLoaded && !datum.handRectangles.empty())
+			{
+				//ÿֺ
+				const size_t handNum = datum.handRectangles.size();
+				const size_t stride = s_handPartNum * 3;
+				copyKeypoints(datum.handKeypoints[0], s_handPartNum, m_subnet.handScratch[0]);
+				copyKeypoints(datum.handKeypoints[1], s_handPartNum, m_subnet.handScratch[1]);
+				m_subnet.handKeypoints.assign(handNum * 2 * stride, 0.f);
+				for (size_t p = 0; p < handNum; p++)
+				{
+					for (size_t side = 0; side < 2; side++)
+					{
+						if ((p + 1) * stride <= m_subnet.handScratch[side].size())
+							std::copy_n(m_subnet.handScratch[side].data() + p * stride, stride, m_subnet.handKeypoints.data() + (p * 2 + side) * stride);
+					}
+				}
+				m_SIGNAL_void_handKeypoints(m_subnet.handKeypoints.data(), handNum);
+			}
+		}
+
+		/**
+		* \@brief ½һ֡datum һ֡ؼface/hand #÷#
+		*/
+		std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> makeDatums(const cv::Mat& frame, const size_t frameNumber)
+		{
+			auto datumsPtr = std::make_shared<std::vector<std::shared_ptr<op::Datum>>>();
+			datumsPtr->emplace_back(std::make_shared<op::Datum>());
+			auto& datum = *datumsPtr->at(0);
+			datum.cvInputData = frame;
+			datum.frameNumber = frameNumber;
+
+			const bool faceFlag = m_subnet.faceLoaded && m_flags.faceFlag.load();
+			const bool handFlag = m_subnet.handLoaded && m_flags.handFlag.load();
+			if (!faceFlag && !handFlag)
+				return datumsPtr;
+
+			const size_t stride = PoseParser::s_partNum * 3;
+			for (size_t p = 0; p < m_keypoints.size() / stride; p++)
+			{
+				const float* person = &m_keypoints[p * stride];
+				if (m_subnet.filter && !m_subnet.filter(person))
+					continue;
+
+				if (faceFlag)
+					datum.faceRectangles.push_back(faceRectangle(person));
+				if (handFlag)
+					datum.handRectangles.push_back(handRectangles(person));
+			}
+			return datumsPtr;
+		}
+
+		/**
+		* \@brief ɱ ۾  ӹ #openposeķͬ˼·# 㲻ʱؿվ
+		*/
+		static op::Rectangle<float> faceRectangle(const float* person)
+		{
+			auto valid = [person](const int part) { return person[part * 3 + 2] > s_subnetPointThreshold; };
+			auto distance = [person](const int a, const int b) { return std::hypot(person[a * 3] - person[b * 3], person[a * 3 + 1] - person[b * 3 + 1]); };
+
+			// ۾ 
+			const int headParts[] = { 0, 15, 16, 17, 18 };
+			float centerX = 0.f, centerY = 0.f;
+			int count = 0;
+			for (const int part : headParts)
+			{
+				if (!valid(part))
+					continue;
+				centerX += person[part * 3];
+				centerY += person[part * 3 + 1];
+				count++;
+			}
+			if (count == 0)
+				return op::Rectangle<float>();
+			centerX /= count;
+			centerY /= count;
+
+			float size = 0.f;
+			if (valid(17) && valid(18))
+				size = std::max(size, 1.6f * distance(17, 18));
+			if (valid(15) && valid(16))
+				size = std::max(size, 3.f * distance(15, 16));
+			if (valid(1))
+				size = std::max(size, 1.5f * std::hypot(person[3] - centerX, person[4] - centerY));
+			if (size <= 0.f)
+				return op::Rectangle<float>();
+
+			return op::Rectangle<float>(centerX - size * 0.5f, centerY - size * 0.5f, size, size);
+		}
+
+		/**
+		* \@brief С۷1/3 СȡСϱ۳ȵ1.5 #openposeֲķ# ˳Ϊ 
+		*/
+		static std::array<op::Rectangle<float>, 2> handRectangles(const float* person)
+		{
+			auto valid = [person](const int part) { return person[part * 3 + 2] > s_subnetPointThreshold; };
+			auto distance = [person](const int a, const int b) { return std::hypot(person[a * 3] - person[b * 3], person[a * 3 + 1] - person[b * 3 + 1]); };
+
+			//BODY_25    = 5 6 7 Ҳ = 2 3 4
+			const int arms[2][3] = { { 5, 6, 7 }, { 2, 3, 4 } };
+			std::array<op::Rectangle<float>, 2> rectangles;
+			for (size_t side = 0; side < 2; side++)
+			{
+				const int shoulder = arms[side][0], elbow = arms[side][1], wrist = arms[side][2];
+				if (!valid(elbow) || !valid(wrist))
+					continue;
+
+				const float centerX = person[wrist * 3] + (person[wrist * 3] - person[elbow * 3]) / 3.f;
+				const float centerY = person[wrist * 3 + 1] + (person[wrist * 3 + 1] - person[elbow * 3 + 1]) / 3.f;
+				float size = distance(wrist, elbow);
+				if (valid(shoulder))
+					size = std::max(size, 0.9f * distance(elbow, shoulder));
+				size *= 1.5f;
+
+				rectangles[side] = op::Rectangle<float>(centerX - size * 0.5f, centerY - size * 0.5f, size, size);
+			}
+			return rectangles;
+		}
+
+		/**
+		* \@brief op::Array [num][partNum][3] keypoints
+		* \@return 
+		*/
+		static size_t copyKeypoints(const op::Array<float>& src, const int partNum, std::vector<float>& keypoints)
+		{
+			if (src.empty() || src.getSize(1) != partNum)
+			{
+				keypoints.clear();
+				return 0;
+			}
+
+			const size_t num = static_cast<size_t>(src.getSize(0));
+			keypoints.assign(src.getConstPtr(), src.getConstPtr() + num * partNum * 3);
+			return num;
+		}
+#endif
+
+		/**
+		* \@brief m_keypointsеĹؼ ˲֡ʱȾ˲ #÷#
+		* \@desc m_keypointsԭʼ ROIٺface/handζΪ׼
+		*/
+		void emitKeypoints(const size_t peopleNum)
+		{
+			if (!smoothing())
+			{
+				emitPeople(m_keypoints, peopleNum);
+				return;
+			}
+
+			m_smooth.smoother.update(m_keypoints.data(), peopleNum, elapsedSeconds(), m_smooth.keypoints);
+			emitPeople(m_smooth.keypoints, peopleNum);
+		}
+
+		/**
+		* \@brief float[people][25][3]ؼ #÷#
+		*/
+		void emitPeople(const std::vector<float>& keypoints, const size_t peopleNum)
+		{
+			m_SIGNAL_void_keypoints(keypoints.data(), peopleNum);
+			if (smoothing())
+				m_SIGNAL_void_tracks(keypoints.data(), m_smooth.smoother.ids().data(), peopleNum);
+
+			//ÿPoseParser::s_partNum δ⵽ĵscoreΪ0
+			m_points.resize(keypoints.size() / 3);
+			for (size_t i = 0; i < m_points.size(); i++)
+				m_points[i] = Ghost::SPoint2D(keypoints[i * 3], keypoints[i * 3 + 1], keypoints[i * 3 + 2]);
+			m_SIGNAL_void_points2D(m_points);
+		}
+
+		/**
+		* \@brief frameOutϻһηĹǼ #÷#
+		*/
+		void render(cv::Mat& frameOut) const
+		{
+			if (!m_flags.showFlag.load() || frameOut.empty())
+				return;
+
+			const std::vector<float>& keypoints = smoothing() ? m_smooth.keypoints : m_keypoints;
+			PoseParser::render(frameOut, keypoints.data(), keypoints.size() / (PoseParser::s_partNum * 3));
+		}
+
+		/**
+		* \@brief ֡Ҫ˲ Գ֡ʱ˲Ǵ
+		*/
+		bool smoothing() const noexcept(true)
+		{
+			return m_smooth.enableFlag || m_smooth.interval > 1;
+		}
+
+		/**
+		* \@brief ˲ʹõʱ
+		*/
+		double elapsedSeconds() const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_smooth.start).count();
+		}
+
+#ifdef USE_OPENPOSE
+		/**
+		* \@brief tryEmplaceһ֡ ;֡ﵽʱ #÷#
+		*/
+		EResult submit(const cv::Mat& frameIn, const size_t frameIndex)
+		{
+			if (frameIn.empty())
+				return EResult::SR_Image_Empty;
+
+			if (m_async.inFlight >= s_asyncInFlight)
+				return EResult::SR_Pipeline_Full;
+
+			auto datumsPtr = makeDatums(frameIn.clone(), frameIndex);
+
+			if (!m_pDetector->tryEmplace(datumsPtr))
+				return EResult::SR_Pipeline_Full;
+
+			m_async.inFlight++;
+			return EResult::SR_OK;
+		}
+
+		/**
+		* \@brief tryPopȡɵ֡ ֻ֡µһ֡ #÷#
+		*/
+		void collect()
+		{
+			std::shared_ptr<std::vector<std::shared_ptr<op::Datum>>> datumProcessed;
+			while (m_async.inFlight > 0 && m_pDetector->tryPop(datumProcessed))
+			{
+				m_async.inFlight--;
+				if (datumProcessed == nullptr || datumProcessed->empty())
+					continue;
+
+				const auto& datum = datumProcessed->at(0);
+				const size_t frameIndex = static_cast<size_t>(datum->frameNumber);
+				if (m_async.latestFlag && frameIndex < m_async.latestIndex)
+					continue;
+
+				m_async.latestFlag = true;
+				m_async.latestIndex = frameIndex;
+				if (m_flags.showFlag.load())
+					m_async.latestFrame = datum->cvOutputData;
+				publish(*datum);
+			}
+		}
+#else
+		EResult submit(const cv::Mat& frameIn, const size_t frameIndex)
+		{
+			return EResult::SR_Detector_Not_Exist;
+		}
+
+		void collect()
+		{
+		}
+#endif
+
+	public:
+#ifdef USE_OPENPOSE
+		//pose
+		std::unique_ptr<op::Wrapper> m_pDetector;
+#endif
+
+		//CPU
+		std::unique_ptr<CpuPoseNet> m_pCpuNet;
+
+		//ʵ
+		SPoseConfig m_config;
+
+		//ؼ float[people][25][3] Ԥs_reservedPeople Ӧź
+		std::vector<float> m_keypoints;
+		std::vector<Ghost::SPoint2D> m_points;
+
+		struct SFlags
+		{
+			std::atomic_bool initFlag;				//ʼ־
+			std::atomic_bool poseFlag;				//pose ־
+			std::atomic_bool faceFlag;				//face ־
+			std::atomic_bool handFlag;				//hand ־
+			std::atomic_bool extraFlag;				//extra ־
+			std::atomic_bool outputFlag;			//output ־
+			std::atomic_bool asyncFlag;				//־
+			std::atomic_bool cpuFlag;				//CPU־
+			std::atomic_bool showFlag;				//Ʊ־ رʱֻؼ
+
+			SFlags() :
+				initFlag(false), poseFlag(true), faceFlag(false),
+				handFlag(false), extraFlag(false), outputFlag(false), asyncFlag(false), cpuFlag(!s_openPoseFlag), showFlag(true)
+			{}
+		};
+		SFlags m_flags;
+
+		//״̬ m_mutex
+		struct SAsyncState
+		{
+			size_t frameCounter;					//detectģʽԶ֡
+			size_t inFlight;						//δȡص֡
+			bool latestFlag;						//Ƿɵ֡
+			size_t latestIndex;						//֡֡
+			cv::Mat latestFrame;					//֡Ļƽ
+
+			SAsyncState() :
+				frameCounter(0), inFlight(0), latestFlag(false), latestIndex(0)
+			{}
+		};
+		SAsyncState m_async;
+
+		//ROI״̬ m_mutex
+		struct SRoiState
+		{
+			size_t interval;						//ȫͼ֡ 0::ر
+			size_t frameCounter;					//ROIģʽѼ֡
+			std::vector<cv::Rect> boxes;			//һ֡ һ֡м
+			std::vector<cv::Rect> rois;				//Ĳü
+			std::vector<cv::Mat> crops;				//ŵs_roiSizeĲüͼ
+			std::vector<std::vector<float>> keypoints;	//ÿüͼļ
+
+			SRoiState() :
+				interval(0), frameCounter(0)
+			{}
+		};
+		SRoiState m_roi;
+
+		//face/hand״̬ m_mutex
+		struct SSubnetState
+		{
+			bool faceLoaded;						//openposeѼface
+			bool handLoaded;						//openposeѼhand
+			std::function<bool(const float*)> filter;	//ѡǷface/hand ::
+			std::vector<float> faceKeypoints;		//float[faces][70][3]
+			std::vector<float> handKeypoints;		//float[people][2][21][3]
+			std::vector<float> handScratch[2];
+
+			SSubnetState() :
+				faceLoaded(false), handLoaded(false)
+			{}
+		};
+		SSubnetState m_subnet;
+
+		//ʱ˲֡״̬ m_mutex
+		struct SSmoothState
+		{
+			bool enableFlag;						//˲־
+			size_t interval;						//м֡ 0/1::ÿ֡
+			size_t frameCounter;					//֡ģʽѴ֡
+			PoseSmoother smoother;
+			std::vector<float> keypoints;			//˲ƺĹؼ float[people][25][3]
+			std::chrono::steady_clock::time_point start;
+
+			SSmoothState() :
+				enableFlag(false), interval(0), frameCounter(0), start(std::chrono::steady_clock::now())
+			{}
+		};
+		SSmoothState m_smooth;
+
+		//źŲ
+		Ghost::signalslot::Signal<void(const std::vector<Ghost::SPoint2D>&)> m_SIGNAL_void_points2D;
+		Ghost::signalslot::Slot m_SLOT_void_points2D;
+		Ghost::signalslot::Signal<void(const float*, const size_t)> m_SIGNAL_void_keypoints;
+		Ghost::signalslot::Slot m_SLOT_void_keypoints;
+		Ghost::signalslot::Signal<void(const float*, const int*, const size_t)> m_SIGNAL_void_tracks;
+		Ghost::signalslot::Slot m_SLOT_void_tracks;
+		Ghost::signalslot::Signal<void(const float*, const size_t)> m_SIGNAL_void_faceKeypoints;
+		Ghost::signalslot::Slot m_SLOT_void_faceKeypoints;
+		Ghost::signalslot::Signal<void(const float*, const size_t)> m_SIGNAL_void_handKeypoints;
+		Ghost::signalslot::Slot m_SLOT_void_handKeypoints;
+
+		//
+		std::mutex m_mutex;
+
+		//Ƿopenpose δUSE_OPENPOSEʱֻCPU
+		static constexpr bool s_openPoseFlag =
+#ifdef USE_OPENPOSE
+			true;
+#else
+			false;
+#endif
+		//ʱͬʱopenpose֡
+		const static size_t s_batchInFlight;
+		//ģʽͬʱopenpose֡ ʱ֡Աֵӳ
+		const static size_t s_asyncInFlight;
+		//ؼ㻺Ԥ ʱ·
+		const static size_t s_reservedPeople;
+		//ROIüͼߴ  ٵŶ жΪͬһ˵ص
+		const static cv::Size s_roiSize;
+		const static float s_roiMargin;
+		const static int s_roiMinParts;
+		const static float s_roiPointThreshold;
+		const static float s_roiOverlap;
+		//face/handؼ ƾŶ
+		const static int s_facePartNum;
+		const static int s_handPartNum;
+		const static float s_subnetPointThreshold;
+
+		//modelļ
+		static string s_modelPath;
+		static string s_prototxtName;
+		static string s_caffeModelName;
+
+		//汾
+		const static string s_version;
+	};
+
+	string PoseDetector::Impl::s_modelPath = "";
+	string PoseDetector::Impl::s_prototxtName = "";
+	string PoseDetector::Impl::s_caffeModelName = "";
+	const size_t PoseDetector::Impl::s_batchInFlight = 8;
+	const size_t PoseDetector::Impl::s_asyncInFlight = 2;
+	const size_t PoseDetector::Impl::s_reservedPeople = 64;
+	const cv::Size PoseDetector::Impl::s_roiSize = cv::Size(192, 368);
+	const float PoseDetector::Impl::s_roiMargin = 1.3f;
+	const int PoseDetector::Impl::s_roiMinParts = 4;
+	const float PoseDetector::Impl::s_roiPointThreshold = 0.1f;
+	const float PoseDetector::Impl::s_roiOverlap = 0.7f;
+	const int PoseDetector::Impl::s_facePartNum = 70;
+	const int PoseDetector::Impl::s_handPartNum = 21;
+	const float PoseDetector::Impl::s_subnetPointThreshold = 0.1f;
+
+#if( _MSC_TOOLSET_VER_ == 140 )
+#ifdef NDEBUG
+	const string PoseDetector::Impl::s_version = "vc140-r.0";
+#else
+	const string PoseDetector::Impl::s_version = "vc140-d.0";
+#endif
+#elif(_MSC_TOOLSET_VER_ == 141)
+#ifdef NDEBUG
+	const string PoseDetector::Impl::s_version = "vc141-r.0";
+#else
+	const string PoseDetector::Impl::s_version = "vc141-d.0";
+#endif
+#elif(_MSC_TOOLSET_VER_ == 142)
+#ifdef NDEBUG
+	const string PoseDetector::Impl::s_version = "vc142-r.0";
+#else
+	const string PoseDetector::Impl::s_version = "vc142-d.0";
+#endif
+#endif
+
+	PoseDetector::PoseDetector()
+		:
+		m_pImpl(std::make_unique<Impl>())
+	{
+		if (m_pImpl == nullptr)
+		{
+			throw std::exception("PoseDetector::PoseDetector::make_unique::failured!!!");
+		}
+	}
+
+	PoseDetector::PoseDetector(const SPoseConfig& config)
+		:
+		PoseDetector()
+	{
+		if (m_pImpl->setConfig(config) != EResult::SR_OK)
+		{
+			throw std::exception("PoseDetector::PoseDetector::setConfig::failured!!!");
+		}
+	}
+
+	PoseDetector::~PoseDetector()
+	{
+		antiModual();
+	}
+
+	EResult PoseDetector::loadModualParam(const string& modualLoadPath)
+	{
+		return EResult::SR_OK;
+	}
+
+	EResult  PoseDetector::saveModelParam()
+	{
+		return EResult::SR_OK;
+	}
+
+	EResult PoseDetector::initModual()
+	{
+		return m_pImpl->initModual();
+	}
+
+	EResult PoseDetector::antiModual()
+	{
+		this->saveModelParam();
+
+		return m_pImpl->antiModual();
+	}
+
+	EResult PoseDetector::setModualParam(const EModualParamType type, const float value)
+	{
+		switch (type)
+		{
+		case EModualParamType::TYPE_POSE_Detection_Async:
+		{
+			m_pImpl->m_flags.asyncFlag.store(value > 0.5f);
+			break;
+		}
+		case EModualParamType::TYPE_POSE_Dtection_Face:
+			return m_pImpl->setSubnet(true, value > 0.5f);
+		case EModualParamType::TYPE_POSE_Dtection_Hand:
+			return m_pImpl->setSubnet(false, value > 0.5f);
+		case EModualParamType::TYPE_POSE_Dtection_Gui:
+			return m_pImpl->setShow(value > 0.5f);
+		case EModualParamType::TYPE_POSE_Detection_Cpu:
+			return m_pImpl->setCpu(value > 0.5f);
+		case EModualParamType::TYPE_POSE_Detection_Threads:
+			return m_pImpl->setThreadNum(static_cast<size_t>(std::max(0.f, value)));
+		case EModualParamType::TYPE_POSE_Detection_Roi:
+			return m_pImpl->setRoiInterval(static_cast<size_t>(std::max(0.f, value)));
+		case EModualParamType::TYPE_POSE_Detection_Smooth:
+			return m_pImpl->setSmooth(value > 0.5f);
+		case EModualParamType::TYPE_POSE_Detection_Skip:
+			return m_pImpl->setSkipInterval(static_cast<size_t>(std::max(0.f, value)));
+		default:
+			break;
+		}
+
+		return EResult::SR_OK;
+	}
+
+	EResult PoseDetector::setConfig(const SPoseConfig& config)
+	{
+		return m_pImpl->setConfig(config);
+	}
+
+	SPoseConfig PoseDetector::getConfig()
+	{
+		return m_pImpl->getConfig();
+	}
+
+	EResult PoseDetector::detect(const cv::Mat& frameIn, cv::Mat& frameOut)
+	{
+		return m_pImpl->detect(frameIn, frameOut);
+	}
+
+	EResult PoseDetector::detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+	{
+		const EResult result = m_pImpl->detectBatch(framesIn, framesOut, results);
+		if (result != EResult::SR_OK)
+			return result;
+
+		return firstFailure(results);
+	}
+
+	void PoseDetector::setSmoothParams(const PoseSmoother::SParams& params)
+	{
+		m_pImpl->setSmoothParams(params);
+	}
+
+	void PoseDetector::setSubnetFilter(const std::function<bool(const float*)>& filter)
+	{
+		m_pImpl->setSubnetFilter(filter);
+	}
+
+	EResult PoseDetector::detectRois(const cv::Mat& frameIn, const std::vector<cv::Rect>& personBoxes, cv::Mat& frameOut)
+	{
+		return m_pImpl->detectRois(frameIn, personBoxes, frameOut);
+	}
+
+	EResult PoseDetector::detectAsync(const cv::Mat& frameIn, const size_t frameIndex)
+	{
+		return m_pImpl->detectAsync(frameIn, frameIndex);
+	}
+
+	bool PoseDetector::getLatestResult(size_t& frameIndex, cv::Mat& frameShow)
+	{
+		return m_pImpl->getLatestResult(frameIndex, frameShow);
+	}
+
+	EDetectModual PoseDetector::getModualType() noexcept(true)
+	{
+		return EDetectModual::Pose_Detection_Modual;
+	}
+
+	void PoseDetector::bindSlotPoseFind(const std::function<void(const std::vector<Ghost::SPoint2D>&)>& func)
+	{
+		m_pImpl->m_SLOT_void_points2D = m_pImpl->m_SIGNAL_void_points2D.connect(func);
+	}
+
+	void PoseDetector::bindSlotPoseKeypoints(const std::function<void(const float*, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_keypoints = m_pImpl->m_SIGNAL_void_keypoints.connect(func);
+	}
+
+	void PoseDetector::bindSlotPoseTracks(const std::function<void(const float*, const int*, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_tracks = m_pImpl->m_SIGNAL_void_tracks.connect(func);
+	}
+
+	void PoseDetector::bindSlotFaceKeypoints(const std::function<void(const float*, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_faceKeypoints = m_pImpl->m_SIGNAL_void_faceKeypoints.connect(func);
+	}
+
+	void PoseDetector::bindSlotHandKeypoints(const std::function<void(const float*, const size_t)>& func)
+	{
+		m_pImpl->m_SLOT_void_handKeypoints = m_pImpl->m_SIGNAL_void_handKeypoints.connect(func);
 	}
 
 	EResult PoseDetector::setPath(const string& modelsFolderPath, const string& prototxtName, const string& caffeModelName) noexcept(true)
@@ -0,0 +1,607 @@
+#include "PoseParser.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		//limbs in PAF order, BODY_25
+		const int s_pairs[PoseParser::s_pairNum * 2] =
+		{
+			1,8,	1,2,	1,5,	2,3,	3,4,	5,6,	6,7,	8,9,	9,10,	10,11,	8,12,	12,13,	13,14,
+			1,0,	0,15,	15,17,	0,16,	16,18,	2,17,	5,18,	14,19,	19,20,	14,21,	11,22,	22,23,	11,24
+		};
+
+		//PAF channel (x, y) of every limb, relative to the first PAF channel
+		const int s_mapIndex[PoseParser::s_pairNum * 2] =
+		{
+			0,1,	14,15,	22,23,	16,17,	18,19,	24,25,	26,27,	6,7,	2,3,	4,5,	8,9,	10,11,	12,13,
+			30,31,	32,33,	36,37,	34,35,	38,39,	20,21,	28,29,	40,41,	42,43,	44,45,	46,47,	48,49,	50,51
+		};
+
+		//limbs that are drawn, the two ear-shoulder links only help the assembly
+		const int s_renderPairs[] =
+		{
+			1,8,	1,2,	1,5,	2,3,	3,4,	5,6,	6,7,	8,9,	9,10,	10,11,	8,12,	12,13,	13,14,
+			1,0,	0,15,	15,17,	0,16,	16,18,	14,19,	19,20,	14,21,	11,22,	22,23,	11,24
+		};
+
+		//RGB per part
+		const unsigned char s_colors[PoseParser::s_partNum * 3] =
+		{
+			255,0,85,	255,0,0,	255,85,0,	255,170,0,	255,255,0,	170,255,0,	85,255,0,	0,255,0,
+			255,0,0,	0,255,85,	0,255,170,	0,255,255,	0,170,255,	0,85,255,	0,0,255,	255,0,170,
+			170,0,255,	255,0,255,	85,0,255,	0,0,255,	0,0,255,	0,0,255,	0,255,255,	0,255,255,
+			0,255,255
+		};
+
+		/**
+		* \@brief Lane operations, one struct per instruction set, the kernels below are written once against them
+		*/
+		struct OpsScalar
+		{
+			static const int lanes = 1;
+			using VI = int32_t;
+			using VF = float;
+			using M = bool;
+
+			static VF loadf(const float* p) { return *p; }
+			static VF setf(const float a) { return a; }
+			static VI seti(const int32_t a) { return a; }
+			static VF addf(const VF a, const VF b) { return a + b; }
+			static VF mulf(const VF a, const VF b) { return a * b; }
+			static M gtf(const VF a, const VF b) { return a > b; }
+			static M gef(const VF a, const VF b) { return a >= b; }
+			static M andm(const M a, const M b) { return a && b; }
+			static uint32_t bits(const M m) { return m ? 1u : 0u; }
+			static VI cvtt(const VF a) { return static_cast<int32_t>(a); }
+			static VI clampi(const VI a, const VI hi) { return std::min(hi, std::max(0, a)); }
+			static VI madd(const VI a, const VI b, const VI c) { return a * b + c; }
+			static VF gather(const float* base, const VI index) { return base[index]; }
+			static float sumMasked(const VF a, const uint32_t mask) { return (mask & 1u) ? a : 0.f; }
+		};
+
+		struct OpsSse41
+		{
+			static const int lanes = 4;
+			using VI = __m128i;
+			using VF = __m128;
+			using M = __m128;
+
+			GHOST_TARGET_SSE41 static VF loadf(const float* p) { return _mm_loadu_ps(p); }
+			GHOST_TARGET_SSE41 static VF setf(const float a) { return _mm_set1_ps(a); }
+			GHOST_TARGET_SSE41 static VI seti(const int32_t a) { return _mm_set1_epi32(a); }
+			GHOST_TARGET_SSE41 static VF addf(const VF a, const VF b) { return _mm_add_ps(a, b); }
+			GHOST_TARGET_SSE41 static VF mulf(const VF a, const VF b) { return _mm_mul_ps(a, b); }
+			GHOST_TARGET_SSE41 static M gtf(const VF a, const VF b) { return _mm_cmpgt_ps(a, b); }
+			GHOST_TARGET_SSE41 static M gef(const VF a, const VF b) { return _mm_cmpge_ps(a, b); }
+			GHOST_TARGET_SSE41 static M andm(const M a, const M b) { return _mm_and_ps(a, b); }
+			GHOST_TARGET_SSE41 static uint32_t bits(const M m) { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+			GHOST_TARGET_SSE41 static VI cvtt(const VF a) { return _mm_cvttps_epi32(a); }
+			GHOST_TARGET_SSE41 static VI clampi(const VI a, const VI hi) { return _mm_min_epi32(hi, _mm_max_epi32(_mm_setzero_si128(), a)); }
+			GHOST_TARGET_SSE41 static VI madd(const VI a, const VI b, const VI c) { return _mm_add_epi32(_mm_mullo_epi32(a, b), c); }
+			GHOST_TARGET_SSE41 static VF gather(const float* base, const VI index)
+			{
+				//no gather before AVX2
+				return _mm_setr_ps(base[_mm_cvtsi128_si32(index)], base[_mm_extract_epi32(index, 1)],
+					base[_mm_extract_epi32(index, 2)], base[_mm_extract_epi32(index, 3)]);
+			}
+			GHOST_TARGET_SSE41 static float sumMasked(const VF a, const uint32_t mask)
+			{
+				const __m128i lane = _mm_setr_epi32(1, 2, 4, 8);
+				const __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int32_t>(mask)), lane), lane);
+				__m128 sum = _mm_and_ps(a, _mm_castsi128_ps(keep));
+				sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+				sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x1));
+				return _mm_cvtss_f32(sum);
+			}
+		};
+
+		struct OpsAvx2
+		{
+			static const int lanes = 8;
+			using VI = __m256i;
+			using VF = __m256;
+			using M = __m256;
+
+			GHOST_TARGET_AVX2 static VF loadf(const float* p) { return _mm256_loadu_ps(p); }
+			GHOST_TARGET_AVX2 static VF setf(const float a) { return _mm256_set1_ps(a); }
+			GHOST_TARGET_AVX2 static VI seti(const int32_t a) { return _mm256_set1_epi32(a); }
+			GHOST_TARGET_AVX2 static VF addf(const VF a, const VF b) { return _mm256_add_ps(a, b); }
+			GHOST_TARGET_AVX2 static VF mulf(const VF a, const VF b) { return _mm256_mul_ps(a, b); }
+			GHOST_TARGET_AVX2 static M gtf(const VF a, const VF b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+			GHOST_TARGET_AVX2 static M gef(const VF a, const VF b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+			GHOST_TARGET_AVX2 static M andm(const M a, const M b) { return _mm256_and_ps(a, b); }
+			GHOST_TARGET_AVX2 static uint32_t bits(const M m) { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+			GHOST_TARGET_AVX2 static VI cvtt(const VF a) { return _mm256_cvttps_epi32(a); }
+			GHOST_TARGET_AVX2 static VI clampi(const VI a, const VI hi) { return _mm256_min_epi32(hi, _mm256_max_epi32(_mm256_setzero_si256(), a)); }
+			GHOST_TARGET_AVX2 static VI madd(const VI a, const VI b, const VI c) { return _mm256_add_epi32(_mm256_mullo_epi32(a, b), c); }
+			GHOST_TARGET_AVX2 static VF gather(const float* base, const VI index) { return _mm256_i32gather_ps(base, index, 4); }
+			GHOST_TARGET_AVX2 static float sumMasked(const VF a, const uint32_t mask)
+			{
+				const __m256i lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+				const __m256i keep = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int32_t>(mask)), lane), lane);
+				const __m256 masked = _mm256_and_ps(a, _mm256_castsi256_ps(keep));
+				__m128 sum = _mm_add_ps(_mm256_castps256_ps128(masked), _mm256_extractf128_ps(masked, 1));
+				sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+				sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x1));
+				return _mm_cvtss_f32(sum);
+			}
+		};
+
+		struct OpsAvx512
+		{
+			static const int lanes = 16;
+			using VI = __m512i;
+			using VF = __m512;
+			using M = __mmask16;
+
+			GHOST_TARGET_AVX512 static VF loadf(const float* p) { return _mm512_loadu_ps(p); }
+			GHOST_TARGET_AVX512 static VF setf(const float a) { return _mm512_set1_ps(a); }
+			GHOST_TARGET_AVX512 static VI seti(const int32_t a) { return _mm512_set1_epi32(a); }
+			GHOST_TARGET_AVX512 static VF addf(const VF a, const VF b) { return _mm512_add_ps(a, b); }
+			GHOST_TARGET_AVX512 static VF mulf(const VF a, const VF b) { return _mm512_mul_ps(a, b); }
+			GHOST_TARGET_AVX512 static M gtf(const VF a, const VF b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+			GHOST_TARGET_AVX512 static M gef(const VF a, const VF b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+			GHOST_TARGET_AVX512 static M andm(const M a, const M b) { return static_cast<M>(a & b); }
+			GHOST_TARGET_AVX512 static uint32_t bits(const M m) { return static_cast<uint32_t>(m); }
+			GHOST_TARGET_AVX512 static VI cvtt(const VF a) { return _mm512_cvttps_epi32(a); }
+			GHOST_TARGET_AVX512 static VI clampi(const VI a, const VI hi) { return _mm512_min_epi32(hi, _mm512_max_epi32(_mm512_setzero_si512(), a)); }
+			GHOST_TARGET_AVX512 static VI madd(const VI a, const VI b, const VI c) { return _mm512_add_epi32(_mm512_mullo_epi32(a, b), c); }
+			GHOST_TARGET_AVX512 static VF gather(const float* base, const VI index) { return _mm512_i32gather_ps(index, base, 4); }
+			GHOST_TARGET_AVX512 static float sumMasked(const VF a, const uint32_t mask)
+			{
+				return _mm512_reduce_add_ps(_mm512_maskz_mov_ps(static_cast<__mmask16>(mask), a));
+			}
+		};
+
+		/**
+		* \@brief 3x3 peak test of one pixel, strict against the already visited half so a plateau yields one peak
+		*/
+		inline bool isPeak(const float* up, const float* row, const float* down, const int x, const int width, const float threshold)
+		{
+			const float value = row[x];
+			if (!(value >= threshold))
+				return false;
+
+			for (int column = std::max(0, x - 1); column <= std::min(width - 1, x + 1); column++)
+			{
+				if (!(value > up[column]) || value < down[column])
+					return false;
+			}
+			return (x == 0 || value > row[x - 1]) && (x + 1 == width || value >= row[x + 1]);
+		}
+
+		/**
+		* \@brief Peak columns of one heatmap row, lanes neighbouring pixels are tested per instruction
+		* \@param up/down:: the neighbour rows, a row of -FLT_MAX at the map border
+		* \@return number of peaks written to columns #ascending#
+		*/
+		template<class Ops>
+		inline int peakRow(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns)
+		{
+			int peakNum = 0;
+			if (width > 0 && isPeak(up, row, down, 0, width, threshold))
+				columns[peakNum++] = 0;
+
+			const typename Ops::VF low = Ops::setf(threshold);
+			int x = 1;
+			for (; x + Ops::lanes < width; x += Ops::lanes)
+			{
+				const typename Ops::VF value = Ops::loadf(row + x);
+				typename Ops::M m = Ops::gef(value, low);
+				if (Ops::bits(m) == 0)
+					continue;
+
+				m = Ops::andm(m, Ops::gtf(value, Ops::loadf(row + x - 1)));
+				m = Ops::andm(m, Ops::gef(value, Ops::loadf(row + x + 1)));
+				m = Ops::andm(m, Ops::gtf(value, Ops::loadf(up + x - 1)));
+				m = Ops::andm(m, Ops::gtf(value, Ops::loadf(up + x)));
+				m = Ops::andm(m, Ops::gtf(value, Ops::loadf(up + x + 1)));
+				m = Ops::andm(m, Ops::gef(value, Ops::loadf(down + x - 1)));
+				m = Ops::andm(m, Ops::gef(value, Ops::loadf(down + x)));
+				m = Ops::andm(m, Ops::gef(value, Ops::loadf(down + x + 1)));
+
+				uint32_t mask = Ops::bits(m);
+				for (int i = 0; mask != 0; i++, mask >>= 1)
+				{
+					if (mask & 1u)
+						columns[peakNum++] = x + i;
+				}
+			}
+			for (; x < width; x++)
+			{
+				if (isPeak(up, row, down, x, width, threshold))
+					columns[peakNum++] = x;
+			}
+			return peakNum;
+		}
+
+		/**
+		* \@brief Line integral of one limb candidate over the PAF, lanes samples are gathered per instruction
+		* \@param limb:: start x, start y, dx, dy and the unit direction ux, uy in map pixels
+		* \@param steps:: sample positions 0..1, padded with zeros to a multiple of the lane count
+		* \@return sum of the projections above threshold, their number in count
+		*/
+		template<class Ops>
+		inline float limbScore(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count)
+		{
+			const typename Ops::VF startX = Ops::setf(limb[0]), startY = Ops::setf(limb[1]);
+			const typename Ops::VF dx = Ops::setf(limb[2]), dy = Ops::setf(limb[3]);
+			const typename Ops::VF ux = Ops::setf(limb[4]), uy = Ops::setf(limb[5]);
+			const typename Ops::VF half = Ops::setf(0.5f), low = Ops::setf(threshold);
+			const typename Ops::VI maxX = Ops::seti(width - 1), maxY = Ops::seti(height - 1), stride = Ops::seti(width);
+
+			float sum = 0.f;
+			count = 0;
+			for (int s = 0; s < samples; s += Ops::lanes)
+			{
+				const typename Ops::VF t = Ops::loadf(steps + s);
+				const typename Ops::VI x = Ops::clampi(Ops::cvtt(Ops::addf(Ops::addf(startX, Ops::mulf(t, dx)), half)), maxX);
+				const typename Ops::VI y = Ops::clampi(Ops::cvtt(Ops::addf(Ops::addf(startY, Ops::mulf(t, dy)), half)), maxY);
+				const typename Ops::VI index = Ops::madd(y, stride, x);
+				const typename Ops::VF projection = Ops::addf(Ops::mulf(Ops::gather(pafX, index), ux), Ops::mulf(Ops::gather(pafY, index), uy));
+
+				//padding lanes sample the limb start, they are masked out here
+				const int valid = std::min(Ops::lanes, samples - s);
+				uint32_t mask = Ops::bits(Ops::gtf(projection, low)) & ((valid >= 32) ? 0xffffffffu : ((1u << valid) - 1u));
+				sum += Ops::sumMasked(projection, mask);
+				for (; mask != 0; mask &= mask - 1u)
+					count++;
+			}
+			return sum;
+		}
+
+		inline int peakRowScalar(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns)
+		{
+			return peakRow<OpsScalar>(up, row, down, width, threshold, columns);
+		}
+
+		GHOST_TARGET_SSE41 GHOST_FLATTEN inline int peakRowSse41(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns)
+		{
+			return peakRow<OpsSse41>(up, row, down, width, threshold, columns);
+		}
+
+		GHOST_TARGET_AVX2 GHOST_FLATTEN inline int peakRowAvx2(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns)
+		{
+			return peakRow<OpsAvx2>(up, row, down, width, threshold, columns);
+		}
+
+		GHOST_TARGET_AVX512 GHOST_FLATTEN inline int peakRowAvx512(const float* up, const float* row, const float* down, const int width, const float threshold, int* columns)
+		{
+			return peakRow<OpsAvx512>(up, row, down, width, threshold, columns);
+		}
+
+		inline float limbScoreScalar(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count)
+		{
+			return limbScore<OpsScalar>(pafX, pafY, width, height, limb, steps, samples, threshold, count);
+		}
+
+		GHOST_TARGET_SSE41 GHOST_FLATTEN inline float limbScoreSse41(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count)
+		{
+			return limbScore<OpsSse41>(pafX, pafY, width, height, limb, steps, samples, threshold, count);
+		}
+
+		GHOST_TARGET_AVX2 GHOST_FLATTEN inline float limbScoreAvx2(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count)
+		{
+			return limbScore<OpsAvx2>(pafX, pafY, width, height, limb, steps, samples, threshold, count);
+		}
+
+		GHOST_TARGET_AVX512 GHOST_FLATTEN inline float limbScoreAvx512(const float* pafX, const float* pafY, const int width, const int height,
+			const float* limb, const float* steps, const int samples, const float threshold, int& count)
+		{
+			return limbScore<OpsAvx512>(pafX, pafY, width, height, limb, steps, samples, threshold, count);
+		}
+	}
+
+	PoseParser::PoseParser()
+		:
+		m_peaks(s_partNum),
+		m_connections(s_pairNum)
+	{
+		setIsa(simd::bestIsa());
+		reserve();
+	}
+
+	void PoseParser::setParams(const SParams& params)
+	{
+		m_params = params;
+		reserve();
+	}
+
+	void PoseParser::setIsa(const simd::EIsa isa) noexcept(true)
+	{
+		m_isa = simd::resolveIsa(isa);
+		switch (m_isa)
+		{
+		case simd::EIsa::AVX512:
+		case simd::EIsa::AVX512_VNNI:
+			m_peakRow = &peakRowAvx512;
+			m_limbScore = &limbScoreAvx512;
+			break;
+		case simd::EIsa::AVX2:
+			m_peakRow = &peakRowAvx2;
+			m_limbScore = &limbScoreAvx2;
+			break;
+		case simd::EIsa::SSE41:
+			m_peakRow = &peakRowSse41;
+			m_limbScore = &limbScoreSse41;
+			break;
+		default:
+			m_peakRow = &peakRowScalar;
+			m_limbScore = &limbScoreScalar;
+			break;
+		}
+	}
+
+	void PoseParser::reserve()
+	{
+		//everything a frame can need is sized here, parse() then only reuses it
+		const size_t maxPeaks = static_cast<size_t>(std::max(1, m_params.maxPeaks));
+		const size_t maxSubsets = maxPeaks * s_pairNum;
+
+		for (auto& peaks : m_peaks)
+			peaks.reserve(maxPeaks * 4);
+		for (auto& connections : m_connections)
+			connections.reserve(maxPeaks);
+		m_candidates.reserve(maxPeaks * maxPeaks);
+		m_usedA.reserve(maxPeaks);
+		m_usedB.reserve(maxPeaks);
+		m_subsets.reserve(maxSubsets * s_partNum);
+		m_subsetScores.reserve(maxSubsets);
+		m_subsetCounts.reserve(maxSubsets);
+		m_people.reserve(maxSubsets);
+		m_owners.reserve(maxPeaks * s_partNum);
+
+		const size_t samples = static_cast<size_t>(std::max(2, m_params.intermediatePoints));
+		const size_t padded = (samples + 15) / 16 * 16;
+		m_steps.assign(padded, 0.f);
+		for (size_t s = 0; s < samples; s++)
+			m_steps[s] = s * (1.f / (samples - 1));
+	}
+
+	size_t PoseParser::parse(const float* heatmaps, const float* pafs, const int width, const int height,
+		const float scaleX, const float scaleY, std::vector<float>& keypoints)
+	{
+		const size_t plane = static_cast<size_t>(width) * height;
+
+		if (m_lowRow.size() != static_cast<size_t>(width))
+		{
+			m_lowRow.assign(width, -FLT_MAX);
+			m_columns.resize(width);
+		}
+
+		for (int part = 0; part < s_partNum; part++)
+			findPeaks(heatmaps + part * plane, width, height, m_peaks[part]);
+
+		for (int pair = 0; pair < s_pairNum; pair++)
+		{
+			const float* pafX = pafs + s_mapIndex[pair * 2] * plane;
+			const float* pafY = pafs + s_mapIndex[pair * 2 + 1] * plane;
+			connect(pafX, pafY, width, height, m_peaks[s_pairs[pair * 2]], m_peaks[s_pairs[pair * 2 + 1]], m_connections[pair]);
+		}
+
+		assemble();
+
+		m_people.clear();
+		for (size_t s = 0; s < m_subsetCounts.size(); s++)
+		{
+			if (m_subsetCounts[s] >= m_params.minSubsetCount && m_subsetScores[s] / m_subsetCounts[s] >= m_params.minSubsetScore)
+				m_people.push_back(static_cast<int>(s));
+		}
+
+		const size_t peopleNum = m_people.size();
+		keypoints.assign(peopleNum * s_partNum * 3, 0.f);
+		for (size_t p = 0; p < peopleNum; p++)
+		{
+			const int* subset = &m_subsets[m_people[p] * s_partNum];
+			float* person = &keypoints[p * s_partNum * 3];
+			for (int part = 0; part < s_partNum; part++)
+			{
+				if (subset[part] < 0)
+					continue;
+
+				const SPeak& peak = m_peaks[part][subset[part]];
+				person[part * 3 + 0] = (peak.x + 0.5f) * scaleX - 0.5f;
+				person[part * 3 + 1] = (peak.y + 0.5f) * scaleY - 0.5f;
+				person[part * 3 + 2] = peak.score;
+			}
+		}
+
+		return peopleNum;
+	}
+
+	void PoseParser::findPeaks(const float* heatmap, const int width, const int height, std::vector<SPeak>& peaks)
+	{
+		peaks.clear();
+		const float threshold = m_params.peakThreshold;
+
+		for (int y = 0; y < height; y++)
+		{
+			const float* row = heatmap + static_cast<size_t>(y) * width;
+			const float* up = (y > 0) ? row - width : m_lowRow.data();
+			const float* down = (y + 1 < height) ? row + width : m_lowRow.data();
+
+			const int peakNum = m_peakRow(up, row, down, width, threshold, m_columns.data());
+			for (int i = 0; i < peakNum; i++)
+			{
+				const int x = m_columns[i];
+
+				//sub-pixel position:: 3x3 weighted centroid
+				float sum = 0.f, sumX = 0.f, sumY = 0.f;
+				for (int yy = std::max(0, y - 1); yy <= std::min(height - 1, y + 1); yy++)
+				{
+					for (int xx = std::max(0, x - 1); xx <= std::min(width - 1, x + 1); xx++)
+					{
+						const float weight = std::max(0.f, heatmap[static_cast<size_t>(yy) * width + xx]);
+						sum += weight;
+						sumX += weight * xx;
+						sumY += weight * yy;
+					}
+				}
+
+				SPeak peak;
+				peak.x = sumX / sum;
+				peak.y = sumY / sum;
+				peak.score = row[x];
+				peaks.push_back(peak);
+			}
+		}
+
+		if (static_cast<int>(peaks.size()) > m_params.maxPeaks)
+		{
+			std::partial_sort(peaks.begin(), peaks.begin() + m_params.maxPeaks, peaks.end(),
+				[](const SPeak& a, const SPeak& b) { return a.score > b.score; });
+			peaks.resize(m_params.maxPeaks);
+		}
+	}
+
+	void PoseParser::connect(const float* pafX, const float* pafY, const int width, const int height,
+		const std::vector<SPeak>& peaksA, const std::vector<SPeak>& peaksB, std::vector<SConnection>& connections)
+	{
+		connections.clear();
+		m_candidates.clear();
+		if (peaksA.empty() || peaksB.empty())
+			return;
+
+		const int samples = std::max(2, m_params.intermediatePoints);
+		const float minAbove = m_params.interMinAboveThreshold * samples;
+
+		for (int a = 0; a < static_cast<int>(peaksA.size()); a++)
+		{
+			for (int b = 0; b < static_cast<int>(peaksB.size()); b++)
+			{
+				const float dx = peaksB[b].x - peaksA[a].x;
+				const float dy = peaksB[b].y - peaksA[a].y;
+				const float norm = std::sqrt(dx * dx + dy * dy);
+				if (norm < 1e-6f)
+					continue;
+
+				const float limb[6] = { peaksA[a].x, peaksA[a].y, dx, dy, dx / norm, dy / norm };
+				int count = 0;
+				const float sum = m_limbScore(pafX, pafY, width, height, limb, m_steps.data(), samples, m_params.interThreshold, count);
+				if (count == 0 || count < minAbove)
+					continue;
+
+				//long limbs relative to the map are penalised
+				const float score = sum / count + std::min(0.f, 0.5f * height / norm - 1.f);
+				if (score > 0.f)
+					m_candidates.push_back({ a, b, score });
+			}
+		}
+
+		std::sort(m_candidates.begin(), m_candidates.end(), [](const SConnection& x, const SConnection& y) { return x.score > y.score; });
+
+		m_usedA.assign(peaksA.size(), 0);
+		m_usedB.assign(peaksB.size(), 0);
+		const size_t maxConnections = std::min(peaksA.size(), peaksB.size());
+		for (const auto& candidate : m_candidates)
+		{
+			if (m_usedA[candidate.peakA] || m_usedB[candidate.peakB])
+				continue;
+
+			m_usedA[candidate.peakA] = m_usedB[candidate.peakB] = 1;
+			connections.push_back(candidate);
+			if (connections.size() >= maxConnections)
+				break;
+		}
+	}
+
+	void PoseParser::assemble()
+	{
+		m_subsets.clear();
+		m_subsetScores.clear();
+		m_subsetCounts.clear();
+
+		const int maxPeaks = std::max(1, m_params.maxPeaks);
+		m_owners.assign(static_cast<size_t>(maxPeaks) * s_partNum, -1);
+		auto own = [this, maxPeaks](const int part, const int peak, const int subset)
+		{
+			int& owner = m_owners[part * maxPeaks + peak];
+			if (owner < 0 || subset < owner)
+				owner = subset;
+		};
+
+		//greedy:: a limb extends the lowest person that already owns one of its ends
+		for (int pair = 0; pair < s_pairNum; pair++)
+		{
+			const int partA = s_pairs[pair * 2];
+			const int partB = s_pairs[pair * 2 + 1];
+			for (const auto& connection : m_connections[pair])
+			{
+				const int ownerA = m_owners[partA * maxPeaks + connection.peakA];
+				const int ownerB = m_owners[partB * maxPeaks + connection.peakB];
+				const int owner = (ownerA < 0) ? ownerB : ((ownerB < 0) ? ownerA : std::min(ownerA, ownerB));
+
+				if (owner >= 0)
+				{
+					int* subset = &m_subsets[owner * s_partNum];
+					if (subset[partB] < 0)
+					{
+						subset[partB] = connection.peakB;
+						own(partB, connection.peakB, owner);
+						m_subsetCounts[owner]++;
+						m_subsetScores[owner] += m_peaks[partB][connection.peakB].score + connection.score;
+					}
+					else if (subset[partA] < 0)
+					{
+						subset[partA] = connection.peakA;
+						own(partA, connection.peakA, owner);
+						m_subsetCounts[owner]++;
+						m_subsetScores[owner] += m_peaks[partA][connection.peakA].score + connection.score;
+					}
+					continue;
+				}
+
+				const int subsetNum = static_cast<int>(m_subsetCounts.size());
+				m_subsets.insert(m_subsets.end(), s_partNum, -1);
+				m_subsets[subsetNum * s_partNum + partA] = connection.peakA;
+				m_subsets[subsetNum * s_partNum + partB] = connection.peakB;
+				own(partA, connection.peakA, subsetNum);
+				own(partB, connection.peakB, subsetNum);
+				m_subsetCounts.push_back(2);
+				m_subsetScores.push_back(m_peaks[partA][connection.peakA].score + m_peaks[partB][connection.peakB].score + connection.score);
+			}
+		}
+	}
+
+	void PoseParser::render(cv::Mat& image, const float* keypoints, const size_t peopleNum, const float threshold)
+	{
+		if (image.empty() || keypoints == nullptr)
+			return;
+
+		const int thickness = std::max(1, static_cast<int>(std::lround(std::min(image.cols, image.rows) / 240.0)));
+		auto color = [](const int part) { return cv::Scalar(s_colors[part * 3 + 2], s_colors[part * 3 + 1], s_colors[part * 3 + 0]); };
+
+		for (size_t p = 0; p < peopleNum; p++)
+		{
+			const float* person = keypoints + p * s_partNum * 3;
+			for (size_t l = 0; l < sizeof(s_renderPairs) / sizeof(s_renderPairs[0]); l += 2)
+			{
+				const float* a = person + s_renderPairs[l] * 3;
+				const float* b = person + s_renderPairs[l + 1] * 3;
+				if (a[2] <= threshold || b[2] <= threshold)
+					continue;
+
+				cv::line(image, cv::Point(cvRound(a[0]), cvRound(a[1])), cv::Point(cvRound(b[0]), cvRound(b[1])),
+					color(s_renderPairs[l + 1]), thickness * 2, cv::LINE_AA);
+			}
+
+			for (int part = 0; part < s_partNum; part++)
+			{
+				const float* point = person + part * 3;
+				if (point[2] > threshold)
+					cv::circle(image, cv::Point(cvRound(point[0]), cvRound(point[1])), thickness * 2, color(part), -1, cv::LINE_AA);
+			}
+		}
+	}
+}///namespace Ghost
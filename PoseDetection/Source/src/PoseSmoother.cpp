@@ -0,0 +1,205 @@
+#include "PoseSmoother.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+namespace Ghost
+{
+	namespace
+	{
+		constexpr int s_partNum = PoseParser::s_partNum;
+		constexpr double s_defaultInterval = 1.0 / 30.0;	//时间戳不递增时按30fps计
+
+		/**
+		* \@brief 一阶低通在截止频率cutoff下的平滑系数
+		*/
+		inline float smoothingFactor(const float cutoff, const float interval)
+		{
+			const float tau = 1.f / (2.f * 3.14159265f * cutoff);
+			return 1.f / (1.f + tau / interval);
+		}
+	}
+
+	PoseSmoother::PoseSmoother()
+		:
+		m_nextId(0)
+	{
+	}
+
+	void PoseSmoother::reset() noexcept(true)
+	{
+		m_tracks.clear();
+		m_order.clear();
+		m_ids.clear();
+	}
+
+	size_t PoseSmoother::update(const float* keypoints, const size_t peopleNum, const double time, std::vector<float>& smoothed)
+	{
+		const size_t stride = s_partNum * 3;
+
+		//上一次更新后已丢失过久的人不再参与匹配 #先删除 m_order中的序号在本次更新结束前不会失效#
+		m_tracks.erase(std::remove_if(m_tracks.begin(), m_tracks.end(),
+			[this](const STrack& track) { return track.missed > m_params.maxMissed; }), m_tracks.end());
+
+		//所有人与已有轨迹两两打分 由小到大贪心配对
+		m_matches.clear();
+		for (size_t p = 0; p < peopleNum; p++)
+		{
+			for (size_t t = 0; t < m_tracks.size(); t++)
+			{
+				const float cost = matchCost(keypoints + p * stride, m_tracks[t], time);
+				if (cost <= m_params.matchDistance)
+					m_matches.push_back({ cost, static_cast<int>(p), static_cast<int>(t) });
+			}
+		}
+		std::sort(m_matches.begin(), m_matches.end(), [](const SMatch& a, const SMatch& b) { return a.cost < b.cost; });
+
+		m_trackOf.assign(peopleNum, -1);
+		m_trackUsed.assign(m_tracks.size(), 0);
+		for (const SMatch& match : m_matches)
+		{
+			if (m_trackOf[match.person] >= 0 || m_trackUsed[match.track])
+				continue;
+			m_trackOf[match.person] = match.track;
+			m_trackUsed[match.track] = 1;
+		}
+
+		for (auto& track : m_tracks)
+			track.missed++;
+
+		//没有配对的人开新轨迹
+		smoothed.resize(peopleNum * stride);
+		m_order.resize(peopleNum);
+		m_ids.resize(peopleNum);
+		for (size_t p = 0; p < peopleNum; p++)
+		{
+			if (m_trackOf[p] < 0)
+			{
+				STrack track;
+				track.id = m_nextId++;
+				track.missed = 0;
+				track.time = time;
+				std::fill_n(track.score, s_partNum, 0.f);
+				m_tracks.push_back(track);
+				m_trackOf[p] = static_cast<int>(m_tracks.size() - 1);
+			}
+
+			STrack& track = m_tracks[m_trackOf[p]];
+			filter(track, keypoints + p * stride, time, smoothed.data() + p * stride);
+			track.missed = 0;
+			track.time = time;
+			m_order[p] = m_trackOf[p];
+			m_ids[p] = track.id;
+		}
+
+		return peopleNum;
+	}
+
+	size_t PoseSmoother::predict(const double time, std::vector<float>& predicted) const
+	{
+		const size_t stride = s_partNum * 3;
+
+		predicted.resize(m_order.size() * stride);
+		for (size_t p = 0; p < m_order.size(); p++)
+		{
+			const STrack& track = m_tracks[m_order[p]];
+			const float elapsed = static_cast<float>(std::min(std::max(time - track.time, 0.0), static_cast<double>(m_params.maxPrediction)));
+
+			float* person = predicted.data() + p * stride;
+			for (int part = 0; part < s_partNum; part++)
+			{
+				if (track.score[part] <= 0.f)
+				{
+					person[part * 3 + 0] = person[part * 3 + 1] = person[part * 3 + 2] = 0.f;
+					continue;
+				}
+				person[part * 3 + 0] = track.x[part] + track.dx[part] * elapsed;
+				person[part * 3 + 1] = track.y[part] + track.dy[part] * elapsed;
+				person[part * 3 + 2] = track.score[part];
+			}
+		}
+
+		return m_order.size();
+	}
+
+	float PoseSmoother::matchCost(const float* person, const STrack& track, const double time) const
+	{
+		//轨迹先外推到本帧 再比较两者都有的点 距离按轨迹的身高归一
+		const float elapsed = static_cast<float>(std::min(std::max(time - track.time, 0.0), static_cast<double>(m_params.maxPrediction)));
+
+		float minY = FLT_MAX, maxY = -FLT_MAX, minX = FLT_MAX, maxX = -FLT_MAX;
+		float distance = 0.f;
+		int count = 0;
+		for (int part = 0; part < s_partNum; part++)
+		{
+			if (track.score[part] <= 0.f)
+				continue;
+
+			const float x = track.x[part] + track.dx[part] * elapsed;
+			const float y = track.y[part] + track.dy[part] * elapsed;
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+
+			if (person[part * 3 + 2] <= m_params.pointThreshold)
+				continue;
+			distance += std::hypot(person[part * 3 + 0] - x, person[part * 3 + 1] - y);
+			count++;
+		}
+		if (count == 0)
+			return FLT_MAX;
+
+		const float size = std::max({ maxY - minY, maxX - minX, 1.f });
+		return distance / count / size;
+	}
+
+	void PoseSmoother::filter(STrack& track, const float* person, const double time, float* smoothed) const
+	{
+		const double interval = time - track.time;
+		const float dt = static_cast<float>(interval > 0.0 ? interval : s_defaultInterval);
+		const float derivativeFactor = smoothingFactor(m_params.derivativeCutoff, dt);
+
+		for (int part = 0; part < s_partNum; part++)
+		{
+			const float rawX = person[part * 3 + 0];
+			const float rawY = person[part * 3 + 1];
+			const float score = person[part * 3 + 2];
+
+			//置信度不够的点原样输出 不进入滤波器
+			if (score <= m_params.pointThreshold)
+			{
+				track.score[part] = 0.f;
+				smoothed[part * 3 + 0] = rawX;
+				smoothed[part * 3 + 1] = rawY;
+				smoothed[part * 3 + 2] = score;
+				continue;
+			}
+
+			if (track.score[part] <= 0.f)
+			{
+				track.x[part] = rawX;
+				track.y[part] = rawY;
+				track.dx[part] = track.dy[part] = 0.f;
+			}
+			else
+			{
+				//One-Euro:: 速度越快截止频率越高 静止时去抖 运动时不拖尾
+				track.dx[part] += derivativeFactor * ((rawX - track.x[part]) / dt - track.dx[part]);
+				track.dy[part] += derivativeFactor * ((rawY - track.y[part]) / dt - track.dy[part]);
+				const float cutoff = m_params.minCutoff + m_params.beta * std::hypot(track.dx[part], track.dy[part]);
+				const float factor = smoothingFactor(cutoff, dt);
+				track.x[part] += factor * (rawX - track.x[part]);
+				track.y[part] += factor * (rawY - track.y[part]);
+			}
+			track.score[part] = score;
+
+			smoothed[part * 3 + 0] = track.x[part];
+			smoothed[part * 3 + 1] = track.y[part];
+			smoothed[part * 3 + 2] = score;
+		}
+	}
+}///namespace Ghost
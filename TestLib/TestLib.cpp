@@ -22,6 +22,28 @@
 #define FACE_LANDMARK 0
 #define EMOTION_DETECTION 1
 
+//OBJECT_DETECTION:: 1::INT8 校准并输出 FP32/INT8 精度-速度报告 argv[1]::校准图片文件夹 argv[2]::评估图片文件夹
+#define OBJECT_DETECTION_INT8_REPORT 0
+
+//1::合成 1/10/50 人的 BODY_25 热图与 PAF, 输出各指令集下姿态后处理的耗时
+#define POSE_PARSER_BENCHMARK 0
+
+//1::随机的 68 点 4 级 SDM 模型, 输出各指令集/精度下单张脸的回归耗时; argv[1]::ldmarkmodel 模型文件夹 argv[2]::测试图片 时再与 ldmarkmodel 对比
+//argv[3]::FACE_LANDMARK_TRAIN 训练的 .gsdm 时用它代替随机模型
+#define FACE_LANDMARK_BENCHMARK 0
+
+//1::1万/10万人 128/256 维 (256 为 ArcFace 特征去掉头后的维度) 的 FaceGallery, 输出各指令集下 top-1 检索耗时与 fp32 暴力检索的一致率, 及增删耗时
+#define FACE_GALLERY_BENCHMARK 0
+
+//1::由 300-W 格式的标注 (图片与同名的 68 点 .pts) 训练 SdmLandmarker, 写出 FaceLandmark::setEnginePath 使用的 GSDM 模型
+//argv[1]::标注文件夹 argv[2]::运行时人脸检测使用的级联 .xml argv[3]::输出的 .gsdm
+#define FACE_LANDMARK_TRAIN 0
+
+//1::由按类别分文件夹的人脸裁剪 (FER2013 的图片格式 neutral/happy/surprise/sad/angry/fear/disgust) 训练 EmotionClassifier,
+//写出 EmotionDetector::setClassifierPath 使用的 GEMO 模型; 每张图片都有同名的 68 点 .pts 时训练按两眼对齐的模型
+//argv[1]::数据集文件夹 argv[2]::输出的 .gemo
+#define EMOTION_TRAIN 0
+
 #if(FACE_RECOGNITION == 1)
 	#include "FaceRecognition.h"
 #elif(FACE_LANDMARK == 1)
@@ -30,12 +52,549 @@
 	#include "EmotionDetection.h"
 #elif(FACE_DETECTION == 1)
 #include "FaceDetection.h"
+#elif(OBJECT_DETECTION == 1)
+#include "ObjectDetection.h"
+#endif
+
+#if(POSE_PARSER_BENCHMARK == 1)
+#include <chrono>
+#include "PoseParser.h"
+#endif
+
+#if(FACE_LANDMARK_BENCHMARK == 1)
+#include <chrono>
+#include <random>
+#include "FaceLandmark.h"
+#include "SdmLandmarker.h"
+#endif
+
+#if(FACE_GALLERY_BENCHMARK == 1)
+#include <chrono>
+#include <random>
+#include "FaceGallery.h"
+#endif
+
+#if(FACE_LANDMARK_TRAIN == 1)
+#include <chrono>
+#include <fstream>
+#include "GCascadeDetector.hpp"
+#include "SdmLandmarker.h"
+#endif
+
+#if(EMOTION_TRAIN == 1)
+#include <chrono>
+#include <fstream>
+#include "EmotionClassifier.h"
 #endif
 
 using namespace std;
 using namespace Ghost;
 using namespace cv;
 
+#if(POSE_PARSER_BENCHMARK == 1)
+// 合成 peopleNum 个人的网络输出, 人按网格排列
+static void synthesizePose(const int peopleNum, const int width, const int height, vector<float>& heatmaps, vector<float>& pafs)
+{
+	//BODY_25 骨架模板 单位:: 身高的一半
+	static const float skeleton[PoseParser::s_partNum][2] =
+	{
+		{0.f,-1.6f},	{0.f,-1.2f},	{-0.3f,-1.2f},	{-0.45f,-0.7f},	{-0.5f,-0.25f},	{0.3f,-1.2f},	{0.45f,-0.7f},
+		{0.5f,-0.25f},	{0.f,-0.2f},	{-0.15f,-0.2f},	{-0.17f,0.4f},	{-0.18f,0.95f},	{0.15f,-0.2f},	{0.17f,0.4f},
+		{0.18f,0.95f},	{-0.06f,-1.68f},{0.06f,-1.68f},	{-0.14f,-1.62f},{0.14f,-1.62f},	{0.25f,1.05f},	{0.3f,1.02f},
+		{0.16f,1.f},	{-0.25f,1.05f},	{-0.3f,1.02f},	{-0.16f,1.f}
+	};
+	//与 PoseParser 相同的肢体与 PAF 通道顺序
+	static const int pairs[PoseParser::s_pairNum * 2] =
+	{
+		1,8,	1,2,	1,5,	2,3,	3,4,	5,6,	6,7,	8,9,	9,10,	10,11,	8,12,	12,13,	13,14,
+		1,0,	0,15,	15,17,	0,16,	16,18,	2,17,	5,18,	14,19,	19,20,	14,21,	11,22,	22,23,	11,24
+	};
+	static const int mapIndex[PoseParser::s_pairNum * 2] =
+	{
+		0,1,	14,15,	22,23,	16,17,	18,19,	24,25,	26,27,	6,7,	2,3,	4,5,	8,9,	10,11,	12,13,
+		30,31,	32,33,	36,37,	34,35,	38,39,	20,21,	28,29,	40,41,	42,43,	44,45,	46,47,	48,49,	50,51
+	};
+
+	const size_t plane = static_cast<size_t>(width) * height;
+	heatmaps.assign(plane * PoseParser::s_partNum, 0.f);
+	pafs.assign(plane * PoseParser::s_pairNum * 2, 0.f);
+
+	const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(peopleNum * 2.0))));
+	const int rows = (peopleNum + columns - 1) / columns;
+	const float cellWidth = static_cast<float>(width) / columns;
+	const float cellHeight = static_cast<float>(height) / std::max(1, rows);
+	const float scale = std::min(cellWidth * 0.8f, cellHeight / 3.6f);
+
+	for (int p = 0; p < peopleNum; p++)
+	{
+		float points[PoseParser::s_partNum][2];
+		for (int part = 0; part < PoseParser::s_partNum; part++)
+		{
+			points[part][0] = (p % columns + 0.5f) * cellWidth + skeleton[part][0] * scale;
+			points[part][1] = (p / columns + 0.5f) * cellHeight + skeleton[part][1] * scale;
+		}
+
+		for (int part = 0; part < PoseParser::s_partNum; part++)
+		{
+			float* heatmap = &heatmaps[part * plane];
+			for (int y = std::max(0, static_cast<int>(points[part][1]) - 3); y < std::min(height, static_cast<int>(points[part][1]) + 4); y++)
+			{
+				for (int x = std::max(0, static_cast<int>(points[part][0]) - 3); x < std::min(width, static_cast<int>(points[part][0]) + 4); x++)
+				{
+					const float dx = x - points[part][0], dy = y - points[part][1];
+					float& value = heatmap[y * width + x];
+					value = std::max(value, std::exp(-(dx * dx + dy * dy) / 1.6f));
+				}
+			}
+		}
+
+		for (int pair = 0; pair < PoseParser::s_pairNum; pair++)
+		{
+			const float* a = points[pairs[pair * 2]];
+			const float* b = points[pairs[pair * 2 + 1]];
+			const float length = std::max(1e-3f, std::hypot(b[0] - a[0], b[1] - a[1]));
+			const float ux = (b[0] - a[0]) / length, uy = (b[1] - a[1]) / length;
+			for (int y = std::max(0, static_cast<int>(std::min(a[1], b[1])) - 1); y < std::min(height, static_cast<int>(std::max(a[1], b[1])) + 2); y++)
+			{
+				for (int x = std::max(0, static_cast<int>(std::min(a[0], b[0])) - 1); x < std::min(width, static_cast<int>(std::max(a[0], b[0])) + 2); x++)
+				{
+					const float px = x - a[0], py = y - a[1];
+					const float along = px * ux + py * uy;
+					if (along < -1.f || along > length + 1.f || std::fabs(px * uy - py * ux) > 1.f)
+						continue;
+					pafs[mapIndex[pair * 2] * plane + y * width + x] = ux;
+					pafs[mapIndex[pair * 2 + 1] * plane + y * width + x] = uy;
+				}
+			}
+		}
+	}
+}
+
+// 1/10/50 人下各指令集的后处理耗时
+static void benchmarkPoseParser()
+{
+	//1920x1080 输入, 网络输出为其 1/8
+	const int width = 240, height = 135;
+	const int repeat = 100;
+	const simd::EIsa isas[] = { simd::EIsa::Scalar, simd::EIsa::SSE41, simd::EIsa::AVX2, simd::EIsa::AVX512 };
+
+	PoseParser parser;
+	vector<float> heatmaps, pafs, keypoints;
+	for (const int peopleNum : { 1, 10, 50 })
+	{
+		synthesizePose(peopleNum, width, height, heatmaps, pafs);
+		for (const simd::EIsa isa : isas)
+		{
+			if (simd::resolveIsa(isa) != isa)
+				continue;
+
+			parser.setIsa(isa);
+			size_t found = parser.parse(heatmaps.data(), pafs.data(), width, height, 8.f, 8.f, keypoints);
+
+			const auto start = std::chrono::steady_clock::now();
+			for (int r = 0; r < repeat; r++)
+				found = parser.parse(heatmaps.data(), pafs.data(), width, height, 8.f, 8.f, keypoints);
+			const auto ends = std::chrono::steady_clock::now();
+
+			cout << "people " << peopleNum << " found " << found << " " << simd::isaName(isa) << " "
+				<< std::chrono::duration<double, std::milli>(ends - start).count() / repeat << ":ms" << endl;
+		}
+	}
+}
+#endif
+
+#if(FACE_LANDMARK_BENCHMARK == 1)
+// 每张脸的平均耗时 单位:: ms
+static double timeLandmark(FaceLandmark& landmark, const Mat& frame, const vector<Rect>& faces, const int repeat)
+{
+	Mat frameOut;
+	landmark.detectFaces(frame, faces, frameOut);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeat; r++)
+		landmark.detectFaces(frame, faces, frameOut);
+	const auto ends = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(ends - start).count() / repeat / faces.size();
+}
+
+// 各指令集与精度下 SdmLandmarker 的耗时, 给出 ldmarkmodel 时在同一张图同样的人脸框上对比
+static void benchmarkLandmark(int argc, char* argv[])
+{
+	const int landmarkNum = 68, stageNum = 4, repeat = 100;
+	const simd::EIsa isas[] = { simd::EIsa::Scalar, simd::EIsa::SSE41, simd::EIsa::AVX2, simd::EIsa::AVX512 };
+	const char* precisions[] = { "fp32", "fp16", "int8" };
+
+	//随机模型 只用于计时 与训练好的模型规模相同
+	std::mt19937 random(7);
+	std::normal_distribution<float> normal(0.f, 2e-4f);
+	std::uniform_real_distribution<float> uniform(0.1f, 0.9f);
+	vector<Point2f> meanShape(landmarkNum);
+	for (auto& point : meanShape)
+		point = Point2f(uniform(random), uniform(random));
+	vector<SdmLandmarker::SStage> stages(stageNum);
+	for (int s = 0; s < stageNum; s++)
+	{
+		stages[s].patchScale = 0.3f - 0.05f * s;
+		stages[s].regressor.create(landmarkNum * 2, landmarkNum * SdmLandmarker::s_descriptorSize + 1, CV_32F);
+		for (int r = 0; r < stages[s].regressor.rows; r++)
+		{
+			for (int c = 0; c < stages[s].regressor.cols; c++)
+				stages[s].regressor.at<float>(r, c) = normal(random);
+		}
+	}
+
+	Mat frame = (argc > 2) ? imread(argv[2]) : Mat();
+	if (frame.empty())
+	{
+		frame.create(720, 1280, CV_8UC3);
+		randu(frame, Scalar::all(0), Scalar::all(255));
+		GaussianBlur(frame, frame, Size(9, 9), 3.0);
+	}
+	Mat gray;
+	cvtColor(frame, gray, COLOR_BGR2GRAY);
+	const Rect box(frame.cols / 2 - 100, frame.rows / 2 - 110, 200, 220);
+
+	SdmLandmarker engine;
+	if ((argc > 3) ? engine.load(argv[3]) != EResult::SR_OK : engine.create(meanShape, stages) != EResult::SR_OK)
+	{
+		cout << "Failured to Load Model" << endl;
+		return;
+	}
+	SdmLandmarker::SWorkspace workspace;
+	vector<Point2f> shape;
+	for (int p = 0; p < 3; p++)
+	{
+		engine.setPrecision(static_cast<SdmLandmarker::EPrecision>(p));
+		for (const simd::EIsa isa : isas)
+		{
+			if (simd::resolveIsa(isa) != isa)
+				continue;
+
+			engine.setIsa(isa);
+			engine.fit(gray, box, shape, workspace);
+
+			const auto start = std::chrono::steady_clock::now();
+			for (int r = 0; r < repeat; r++)
+				engine.track(gray, shape, workspace);
+			const auto ends = std::chrono::steady_clock::now();
+
+			cout << "SDM " << precisions[p] << " " << simd::isaName(isa) << " " << engine.regressorBytes() / 1024 << ":KB "
+				<< std::chrono::duration<double, std::milli>(ends - start).count() / repeat << ":ms" << endl;
+		}
+	}
+
+	if (argc < 2)
+		return;
+
+	//同样的人脸框 单线程 每帧只做跟踪
+	const string folder = argv[1];
+	const string enginePath = folder + "\\benchmark.gsdm";
+	engine.setPrecision(SdmLandmarker::EPrecision::FP32);
+	if (FaceLandmark::setPath(folder + "\\roboman-landmark-model.bin", folder + "\\haar_roboman_ff_alt2.xml") != EResult::SR_OK
+		|| engine.save(enginePath) != EResult::SR_OK || FaceLandmark::setEnginePath(enginePath) != EResult::SR_OK)
+	{
+		cout << "Failured to Set Path" << endl;
+		return;
+	}
+
+	const vector<Rect> faces = { box };
+	for (const int engineType : { 0, 1 })
+	{
+		FaceLandmark landmark;
+		landmark.setModualParam(EModualParamType::TYPE_Face_Landmark_Engine, static_cast<float>(engineType));
+		landmark.setModualParam(EModualParamType::TYPE_Face_Landmark_Threads, 1.f);
+		if (landmark.initModual() != EResult::SR_OK)
+			continue;
+
+		cout << (engineType == 0 ? "ldmarkmodel " : "SDM ") << timeLandmark(landmark, frame, faces, repeat) << ":ms" << endl;
+	}
+}
+#endif
+
+#if(FACE_GALLERY_BENCHMARK == 1)
+// 同一人的查询为库中特征加噪声 与 fp32 暴力检索的 top-1 比较
+static void benchmarkGallery()
+{
+	const int queryNum = 200, changeNum = 1000;
+	const simd::EIsa isas[] = { simd::EIsa::Scalar, simd::EIsa::AVX2, simd::EIsa::AVX512, simd::EIsa::AVX512_VNNI };
+
+	std::mt19937 random(7);
+	std::normal_distribution<float> normal;
+	for (const int dimension : { 128, 256 })
+	{
+		for (const size_t identityNum : { static_cast<size_t>(10000), static_cast<size_t>(100000) })
+		{
+			vector<float> embeddings(identityNum * dimension);
+			for (auto& value : embeddings)
+				value = normal(random);
+
+			FaceGallery gallery;
+			gallery.create(dimension);
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < identityNum; i++)
+				gallery.insert(i, embeddings.data() + i * dimension);
+			auto ends = std::chrono::steady_clock::now();
+			cout << "dimension " << dimension << " identities " << identityNum << " insert " << std::chrono::duration<double, std::micro>(ends - start).count() / identityNum << ":us" << endl;
+
+			vector<float> queries(static_cast<size_t>(queryNum) * dimension);
+			vector<size_t> truths(queryNum);
+			for (int q = 0; q < queryNum; q++)
+			{
+				const size_t ID = (static_cast<size_t>(q) * 7919) % identityNum;
+				for (int d = 0; d < dimension; d++)
+					queries[q * dimension + d] = embeddings[ID * dimension + d] + 0.5f * normal(random);
+
+				//暴力检索
+				double best = -2.0;
+				for (size_t i = 0; i < identityNum; i++)
+				{
+					double dot = 0.0, norm = 0.0;
+					for (int d = 0; d < dimension; d++)
+					{
+						dot += queries[q * dimension + d] * embeddings[i * dimension + d];
+						norm += embeddings[i * dimension + d] * embeddings[i * dimension + d];
+					}
+					if (dot / std::sqrt(norm) > best)
+					{
+						best = dot / std::sqrt(norm);
+						truths[q] = i;
+					}
+				}
+			}
+
+			FaceGallery::SWorkspace workspace;
+			FaceGallery::SMatch match;
+			for (const simd::EIsa isa : isas)
+			{
+				if (simd::resolveIsa(isa) != isa)
+					continue;
+
+				gallery.setIsa(isa);
+				int agree = 0;
+				start = std::chrono::steady_clock::now();
+				for (int q = 0; q < queryNum; q++)
+				{
+					if (gallery.search(queries.data() + q * dimension, 1, &match, workspace) == 1 && match.ID == truths[q])
+						agree++;
+				}
+				ends = std::chrono::steady_clock::now();
+
+				cout << "dimension " << dimension << " identities " << identityNum << " " << simd::isaName(isa) << " search " << std::chrono::duration<double, std::milli>(ends - start).count() / queryNum
+					<< ":ms top-1 agrees with brute force " << agree << "/" << queryNum << endl;
+			}
+
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < changeNum; i++)
+				gallery.erase(static_cast<size_t>(i) * 13 % identityNum);
+			ends = std::chrono::steady_clock::now();
+			cout << "dimension " << dimension << " identities " << identityNum << " erase " << std::chrono::duration<double, std::micro>(ends - start).count() / changeNum << ":us" << endl;
+		}
+	}
+}
+#endif
+
+#if(FACE_LANDMARK_TRAIN == 1 || EMOTION_TRAIN == 1)
+// 300-W 的 .pts:: version: 1 / n_points: 68 / { x y ... }, 坐标从 1 开始
+static bool readPts(const string& path, vector<Point2f>& shape)
+{
+	ifstream file(path);
+	string token;
+	int count = 0;
+	while (file >> token && token != "{")
+	{
+		if (token == "n_points:")
+			file >> count;
+	}
+
+	shape.clear();
+	float x = 0.f, y = 0.f;
+	while (static_cast<int>(shape.size()) < count && file >> x >> y)
+		shape.emplace_back(x - 1.f, y - 1.f);
+
+	return count > 0 && static_cast<int>(shape.size()) == count;
+}
+#endif
+
+#if(FACE_LANDMARK_TRAIN == 1)
+// 人脸框取运行时检测器的输出 与 fit 的起点一致
+static void trainLandmark(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		cout << "TestLib <300-W folder> <face cascade .xml> <output .gsdm>" << endl;
+		return;
+	}
+
+	CascadeDetector cascade;
+	if (cascade.load(argv[2]) != EResult::SR_OK)
+	{
+		cout << "Failured to Load Cascade" << endl;
+		return;
+	}
+
+	vector<Mat> grays;
+	vector<vector<Point2f>> shapes;
+	vector<Rect> boxes;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[1]))
+	{
+		vector<Point2f> shape;
+		if (entry.path().extension() != ".pts" || !readPts(entry.path().string(), shape) || shape.size() != 68)
+			continue;
+
+		Mat gray;
+		for (const char* extension : { ".jpg", ".png" })
+		{
+			std::filesystem::path imagePath = entry.path();
+			imagePath.replace_extension(extension);
+			if (std::filesystem::exists(imagePath))
+			{
+				gray = imread(imagePath.string(), IMREAD_GRAYSCALE);
+				break;
+			}
+		}
+		if (gray.empty())
+			continue;
+
+		//与 FaceDetection 默认参数相同 取与标注重叠最多的框 检测不到的脸运行时也不会回归
+		const Rect truth = boundingRect(shape);
+		Rect best;
+		int bestArea = 0;
+		for (const auto& object : cascade.detect(gray, Size(60, 60), Size(), 1.25, 2))
+		{
+			const int area = (object.rect & truth).area();
+			if (area > bestArea)
+			{
+				bestArea = area;
+				best = object.rect;
+			}
+		}
+		if (bestArea * 2 < truth.area())
+			continue;
+
+		grays.push_back(gray);
+		shapes.push_back(shape);
+		boxes.push_back(best);
+	}
+	cout << "faces " << grays.size() << endl;
+
+	SdmLandmarker engine;
+	const auto start = std::chrono::steady_clock::now();
+	if (engine.train(grays, shapes, boxes, SdmLandmarker::STrainParam()) != EResult::SR_OK || engine.save(argv[3]) != EResult::SR_OK)
+	{
+		cout << "Failured to Train" << endl;
+		return;
+	}
+	const auto ends = std::chrono::steady_clock::now();
+
+	//训练集上的平均误差 以两眼外角距离归一化
+	SdmLandmarker::SWorkspace workspace;
+	vector<Point2f> shape;
+	double error = 0.0;
+	for (size_t f = 0; f < grays.size(); f++)
+	{
+		engine.fit(grays[f], boxes[f], shape, workspace);
+		const double ocular = std::max(1.0, cv::norm(shapes[f][36] - shapes[f][45]));
+		for (size_t i = 0; i < shape.size(); i++)
+			error += cv::norm(shape[i] - shapes[f][i]) / ocular / shape.size();
+	}
+
+	cout << "trained " << std::chrono::duration<double>(ends - start).count() << ":s error " << error / std::max<size_t>(grays.size(), 1) << endl;
+}
+#endif
+
+#if(EMOTION_TRAIN == 1)
+// 每10张留1张验证 文件夹名即类别
+static void trainEmotion(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		cout << "TestLib <emotion folder> <output .gemo>" << endl;
+		return;
+	}
+
+	const vector<vector<string>> classNames = { { "neutral" }, { "smile", "happy" }, { "surprise" }, { "sad" }, { "angry" }, { "fear" }, { "disgust" } };
+	vector<Mat> grays[2];
+	vector<Rect> faces[2];
+	vector<Vec4f> eyes[2];
+	vector<int> labels[2];
+	bool aligned = true;
+	size_t count = 0;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[1]))
+	{
+		const string extension = entry.path().extension().string();
+		if (extension != ".jpg" && extension != ".png")
+			continue;
+
+		string folder = entry.path().parent_path().filename().string();
+		std::transform(folder.begin(), folder.end(), folder.begin(), [](const char c) { return static_cast<char>(::tolower(c)); });
+		int label = -1;
+		for (size_t c = 0; c < classNames.size() && label < 0; c++)
+		{
+			if (std::find(classNames[c].begin(), classNames[c].end(), folder) != classNames[c].end())
+				label = static_cast<int>(c);
+		}
+		const Mat gray = (label < 0) ? Mat() : imread(entry.path().string(), IMREAD_GRAYSCALE);
+		if (gray.empty())
+			continue;
+
+		//图片本身就是人脸裁剪 取放大10%后正好是整张图的框
+		const Size size(cvRound(gray.cols / 1.2), cvRound(gray.rows / 1.2));
+		const Rect face((gray.cols - size.width) / 2, (gray.rows - size.height) / 2, size.width, size.height);
+
+		vector<Point2f> shape;
+		std::filesystem::path ptsPath = entry.path();
+		ptsPath.replace_extension(".pts");
+		Vec4f eye;
+		if (readPts(ptsPath.string(), shape) && shape.size() == 68)
+		{
+			Point2f centers[2];
+			for (int e = 0; e < 2; e++)
+			{
+				for (int i = 36 + e * 6; i < 42 + e * 6; i++)
+					centers[e] += shape[i] / 6.f;
+			}
+			eye = Vec4f(centers[0].x, centers[0].y, centers[1].x, centers[1].y);
+		}
+		else
+			aligned = false;
+
+		const int split = (count++ % 10 == 9) ? 1 : 0;
+		grays[split].push_back(gray);
+		faces[split].push_back(face);
+		eyes[split].push_back(eye);
+		labels[split].push_back(label);
+	}
+	cout << "faces " << grays[0].size() << " validation " << grays[1].size() << (aligned ? " aligned" : " box") << endl;
+
+	EmotionClassifier classifier;
+	const auto start = std::chrono::steady_clock::now();
+	if (classifier.train(grays[0], faces[0], aligned ? eyes[0] : vector<Vec4f>(), labels[0], EmotionClassifier::STrainParam()) != EResult::SR_OK
+		|| classifier.save(argv[2]) != EResult::SR_OK)
+	{
+		cout << "Failured to Train" << endl;
+		return;
+	}
+	const auto ends = std::chrono::steady_clock::now();
+
+	//训练集与验证集的准确率
+	EmotionClassifier::SWorkspace workspace;
+	float probabilities[EmotionClassifier::s_classNum];
+	for (int split = 0; split < 2; split++)
+	{
+		size_t correct = 0;
+		for (size_t f = 0; f < grays[split].size(); f++)
+		{
+			classifier.classify(grays[split][f], { faces[split][f] }, aligned ? vector<Vec4f>{ eyes[split][f] } : vector<Vec4f>(), probabilities, workspace);
+			if (std::max_element(probabilities, probabilities + EmotionClassifier::s_classNum) - probabilities == labels[split][f])
+				correct++;
+		}
+		cout << (split == 0 ? "train" : "validation") << " accuracy " << static_cast<double>(correct) / std::max<size_t>(grays[split].size(), 1) << endl;
+	}
+	cout << "trained " << std::chrono::duration<double>(ends - start).count() << ":s" << endl;
+}
+#endif
+
 // 使用互斥体保证单体运行
 BOOL IsAlreadyRun()
 {
@@ -57,6 +616,36 @@ int main(int argc, char* argv[])
 	if (IsAlreadyRun())
 		return -1;
 
+#if(POSE_PARSER_BENCHMARK == 1)
+	benchmarkPoseParser();
+	system("pause");
+	return 0;
+#endif
+
+#if(FACE_LANDMARK_BENCHMARK == 1)
+	benchmarkLandmark(argc, argv);
+	system("pause");
+	return 0;
+#endif
+
+#if(FACE_GALLERY_BENCHMARK == 1)
+	benchmarkGallery();
+	system("pause");
+	return 0;
+#endif
+
+#if(FACE_LANDMARK_TRAIN == 1)
+	trainLandmark(argc, argv);
+	system("pause");
+	return 0;
+#endif
+
+#if(EMOTION_TRAIN == 1)
+	trainEmotion(argc, argv);
+	system("pause");
+	return 0;
+#endif
+
 	EResult result = EResult::SR_OK;
 
 #if( FACE_RECOGNITION == 1)
@@ -95,6 +684,20 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
+#if( OBJECT_DETECTION == 1 && OBJECT_DETECTION_INT8_REPORT == 1)
+	const string calibrationFolder = argv[1];
+	const string evaluationFolder = argv[2];
+	result = ObjectDetector::setCalibrationPath(calibrationFolder + "\\yolov3.int8.table");
+	if (result == EResult::SR_OK)
+		result = detector.calibrateInt8(calibrationFolder);
+	if (result == EResult::SR_OK)
+		result = detector.reportInt8(evaluationFolder, evaluationFolder + "\\int8_report.txt");
+
+	cout << ((result == EResult::SR_OK) ? "INT8 report written" : "Failured to write INT8 report") << endl;
+	system("pause");
+	return 0;
+#endif
+
 	result = detector.initModual();
 	if (result != EResult::SR_OK)
 	{
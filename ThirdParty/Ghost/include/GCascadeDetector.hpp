@@ -0,0 +1,1066 @@
+/*
+
++	Description:            Boosted cascade detector (Haar / LBP) with SIMD window evaluation
++	FileName:               GCascadeDetector.hpp
++	Author:                 Ghost Chen
++   Date:                   2026/10/19
+
++	Copyright(C)            Quantum Dynamics Lab.
++
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "GSimd.hpp"
+#include "GThreadPool.hpp"
+#include "GUtilities.hpp"
+
+namespace Ghost
+{
+	namespace cascade
+	{
+		namespace detail
+		{
+			const int kMaxTreeNodes = 16;				//!< deepest weak classifier accepted by load()
+
+			struct SStage
+			{
+				int32_t firstTree;
+				int32_t treeNum;
+				float threshold;
+			};
+
+			struct STree
+			{
+				int32_t firstNode;
+				int32_t nodeNum;
+				int32_t firstLeaf;
+			};
+
+			/**
+			* \@brief left/right > 0 is a node of the same tree, <= 0 is the leaf -left/-right
+			*/
+			struct SNode
+			{
+				int32_t feature;
+				int32_t left;
+				int32_t right;
+				float threshold;							//!< Haar only
+				int32_t subset[8];							//!< LBP only, bit set -> left
+			};
+
+			/**
+			* \@brief Cascade as seen by the kernels on one pyramid level
+			* \@desc offsets are element offsets into the integral image of that level
+			* \@desc Haar:: 3 rects x 4 corners per feature, LBP:: 4 x 4 grid corners per feature
+			*/
+			struct SModel
+			{
+				bool lbpFlag;
+				const SStage* stages;
+				int32_t stageNum;
+				const STree* trees;
+				const SNode* nodes;
+				const float* leaves;
+				const int32_t* offsets;
+				const float* weights;						//!< Haar rect weights, 3 per feature
+				int32_t normOffsets[4];						//!< Haar variance window corners
+				float normArea;
+			};
+
+			/**
+			* \@brief Lane operations, one struct per instruction set, the kernels below are written once against them
+			*/
+			struct OpsScalar
+			{
+				static const int lanes = 1;
+				using VI = int32_t;
+				using VF = float;
+				using M = bool;
+
+				static VI load(const int32_t* p, const int) { return *p; }
+				static VF loadf(const float* p) { return *p; }
+				static VI rectSum(const int32_t* p, const int32_t* o, const int) { return p[o[0]] - p[o[1]] - p[o[2]] + p[o[3]]; }
+				static VI addi(const VI a, const VI b) { return a + b; }
+				static VI subi(const VI a, const VI b) { return a - b; }
+				static VF cvt(const VI a) { return static_cast<float>(a); }
+				static VF setf(const float a) { return a; }
+				static VF addf(const VF a, const VF b) { return a + b; }
+				static VF mulf(const VF a, const VF b) { return a * b; }
+				static M ltf(const VF a, const VF b) { return a < b; }
+				static M gef(const VF a, const VF b) { return a >= b; }
+				static VF select(const M m, const VF a, const VF b) { return m ? a : b; }
+				static M andm(const M a, const M b) { return a && b; }
+				static M fromBits(const uint32_t bits) { return (bits & 1) != 0; }
+				static uint32_t bits(const M m) { return m ? 1u : 0u; }
+				static VI zeroi() { return 0; }
+				static VI orBitGe(const VI code, const VI a, const VI center, const int32_t bit) { return (a >= center) ? (code | bit) : code; }
+				static M subsetTest(const VI code, const int32_t* subset) { return (subset[code >> 5] & (1 << (code & 31))) != 0; }
+				static M varianceNorm(const VI sum, const VI sqsum, const float area, VF& invNorm)
+				{
+					const double norm = static_cast<double>(area) * sqsum - static_cast<double>(sum) * sum;
+					if (norm > 0.)
+					{
+						invNorm = static_cast<float>(1. / std::sqrt(norm));
+						return static_cast<float>(area * invNorm) < 1e-1;
+					}
+					invNorm = 1.f;
+					return false;
+				}
+			};
+
+			struct OpsSse41
+			{
+				static const int lanes = 4;
+				using VI = __m128i;
+				using VF = __m128;
+				using M = __m128;
+
+				GHOST_TARGET_SSE41 static VI load(const int32_t* p, const int step)
+				{
+					if (step == 1)
+						return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+					const __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+					const __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4)));
+					return _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+				}
+				GHOST_TARGET_SSE41 static VF loadf(const float* p) { return _mm_loadu_ps(p); }
+				GHOST_TARGET_SSE41 static VI rectSum(const int32_t* p, const int32_t* o, const int step)
+				{
+					return _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(load(p + o[0], step), load(p + o[1], step)), load(p + o[2], step)), load(p + o[3], step));
+				}
+				GHOST_TARGET_SSE41 static VI addi(const VI a, const VI b) { return _mm_add_epi32(a, b); }
+				GHOST_TARGET_SSE41 static VI subi(const VI a, const VI b) { return _mm_sub_epi32(a, b); }
+				GHOST_TARGET_SSE41 static VF cvt(const VI a) { return _mm_cvtepi32_ps(a); }
+				GHOST_TARGET_SSE41 static VF setf(const float a) { return _mm_set1_ps(a); }
+				GHOST_TARGET_SSE41 static VF addf(const VF a, const VF b) { return _mm_add_ps(a, b); }
+				GHOST_TARGET_SSE41 static VF mulf(const VF a, const VF b) { return _mm_mul_ps(a, b); }
+				GHOST_TARGET_SSE41 static M ltf(const VF a, const VF b) { return _mm_cmplt_ps(a, b); }
+				GHOST_TARGET_SSE41 static M gef(const VF a, const VF b) { return _mm_cmpge_ps(a, b); }
+				GHOST_TARGET_SSE41 static VF select(const M m, const VF a, const VF b) { return _mm_blendv_ps(b, a, m); }
+				GHOST_TARGET_SSE41 static M andm(const M a, const M b) { return _mm_and_ps(a, b); }
+				GHOST_TARGET_SSE41 static M fromBits(const uint32_t bits)
+				{
+					const __m128i lane = _mm_setr_epi32(1, 2, 4, 8);
+					return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int32_t>(bits)), lane), lane));
+				}
+				GHOST_TARGET_SSE41 static uint32_t bits(const M m) { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+				GHOST_TARGET_SSE41 static VI zeroi() { return _mm_setzero_si128(); }
+				GHOST_TARGET_SSE41 static VI orBitGe(const VI code, const VI a, const VI center, const int32_t bit)
+				{
+					return _mm_or_si128(code, _mm_andnot_si128(_mm_cmpgt_epi32(center, a), _mm_set1_epi32(bit)));
+				}
+				//SSE4.1 没有 gather 和按元素移位
+				GHOST_TARGET_SSE41 static M subsetTest(const VI code, const int32_t* subset)
+				{
+					alignas(16) int32_t c[4];
+					_mm_store_si128(reinterpret_cast<__m128i*>(c), code);
+					uint32_t mask = 0;
+					for (int i = 0; i < 4; i++)
+						mask |= ((subset[c[i] >> 5] & (1 << (c[i] & 31))) != 0) ? (1u << i) : 0u;
+					return fromBits(mask);
+				}
+				GHOST_TARGET_SSE41 static M varianceNorm(const VI sum, const VI sqsum, const float area, VF& invNorm)
+				{
+					const __m128d a = _mm_set1_pd(area);
+					const __m128d one = _mm_set1_pd(1.);
+					__m128 inv[2];
+					uint32_t mask = 0;
+					for (int h = 0; h < 2; h++)
+					{
+						const __m128d s = _mm_cvtepi32_pd(h ? _mm_unpackhi_epi64(sum, sum) : sum);
+						const __m128d q = _mm_cvtepi32_pd(h ? _mm_unpackhi_epi64(sqsum, sqsum) : sqsum);
+						const __m128d norm = _mm_sub_pd(_mm_mul_pd(a, q), _mm_mul_pd(s, s));
+						const __m128d positive = _mm_cmpgt_pd(norm, _mm_setzero_pd());
+						inv[h] = _mm_cvtpd_ps(_mm_blendv_pd(one, _mm_div_pd(one, _mm_sqrt_pd(norm)), positive));
+						const __m128d small = _mm_cmplt_pd(_mm_cvtps_pd(_mm_mul_ps(_mm_set1_ps(area), inv[h])), _mm_set1_pd(1e-1));
+						mask |= static_cast<uint32_t>(_mm_movemask_pd(_mm_and_pd(positive, small))) << (2 * h);
+					}
+					invNorm = _mm_movelh_ps(inv[0], inv[1]);
+					return fromBits(mask);
+				}
+			};
+
+			struct OpsAvx2
+			{
+				static const int lanes = 8;
+				using VI = __m256i;
+				using VF = __m256;
+				using M = __m256;
+
+				GHOST_TARGET_AVX2 static VI load(const int32_t* p, const int step)
+				{
+					if (step == 1)
+						return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+					const __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+					const __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8)));
+					const __m256 even = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+					return _mm256_castpd_si256(_mm256_permute4x64_pd(_mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+				}
+				GHOST_TARGET_AVX2 static VF loadf(const float* p) { return _mm256_loadu_ps(p); }
+				GHOST_TARGET_AVX2 static VI rectSum(const int32_t* p, const int32_t* o, const int step)
+				{
+					return _mm256_add_epi32(_mm256_sub_epi32(_mm256_sub_epi32(load(p + o[0], step), load(p + o[1], step)), load(p + o[2], step)), load(p + o[3], step));
+				}
+				GHOST_TARGET_AVX2 static VI addi(const VI a, const VI b) { return _mm256_add_epi32(a, b); }
+				GHOST_TARGET_AVX2 static VI subi(const VI a, const VI b) { return _mm256_sub_epi32(a, b); }
+				GHOST_TARGET_AVX2 static VF cvt(const VI a) { return _mm256_cvtepi32_ps(a); }
+				GHOST_TARGET_AVX2 static VF setf(const float a) { return _mm256_set1_ps(a); }
+				GHOST_TARGET_AVX2 static VF addf(const VF a, const VF b) { return _mm256_add_ps(a, b); }
+				GHOST_TARGET_AVX2 static VF mulf(const VF a, const VF b) { return _mm256_mul_ps(a, b); }
+				GHOST_TARGET_AVX2 static M ltf(const VF a, const VF b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+				GHOST_TARGET_AVX2 static M gef(const VF a, const VF b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+				GHOST_TARGET_AVX2 static VF select(const M m, const VF a, const VF b) { return _mm256_blendv_ps(b, a, m); }
+				GHOST_TARGET_AVX2 static M andm(const M a, const M b) { return _mm256_and_ps(a, b); }
+				GHOST_TARGET_AVX2 static M fromBits(const uint32_t bits)
+				{
+					const __m256i lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+					return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int32_t>(bits)), lane), lane));
+				}
+				GHOST_TARGET_AVX2 static uint32_t bits(const M m) { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+				GHOST_TARGET_AVX2 static VI zeroi() { return _mm256_setzero_si256(); }
+				GHOST_TARGET_AVX2 static VI orBitGe(const VI code, const VI a, const VI center, const int32_t bit)
+				{
+					return _mm256_or_si256(code, _mm256_andnot_si256(_mm256_cmpgt_epi32(center, a), _mm256_set1_epi32(bit)));
+				}
+				GHOST_TARGET_AVX2 static M subsetTest(const VI code, const int32_t* subset)
+				{
+					const __m256i word = _mm256_i32gather_epi32(subset, _mm256_srli_epi32(code, 5), 4);
+					const __m256i bit = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_and_si256(code, _mm256_set1_epi32(31)));
+					const __m256i zero = _mm256_cmpeq_epi32(_mm256_and_si256(word, bit), _mm256_setzero_si256());
+					return _mm256_castsi256_ps(_mm256_xor_si256(zero, _mm256_set1_epi32(-1)));
+				}
+				GHOST_TARGET_AVX2 static M varianceNorm(const VI sum, const VI sqsum, const float area, VF& invNorm)
+				{
+					const __m256d a = _mm256_set1_pd(area);
+					const __m256d one = _mm256_set1_pd(1.);
+					__m128 inv[2];
+					uint32_t mask = 0;
+					for (int h = 0; h < 2; h++)
+					{
+						const __m256d s = _mm256_cvtepi32_pd(h ? _mm256_extracti128_si256(sum, 1) : _mm256_castsi256_si128(sum));
+						const __m256d q = _mm256_cvtepi32_pd(h ? _mm256_extracti128_si256(sqsum, 1) : _mm256_castsi256_si128(sqsum));
+						const __m256d norm = _mm256_sub_pd(_mm256_mul_pd(a, q), _mm256_mul_pd(s, s));
+						const __m256d positive = _mm256_cmp_pd(norm, _mm256_setzero_pd(), _CMP_GT_OQ);
+						inv[h] = _mm256_cvtpd_ps(_mm256_blendv_pd(one, _mm256_div_pd(one, _mm256_sqrt_pd(norm)), positive));
+						const __m256d small = _mm256_cmp_pd(_mm256_cvtps_pd(_mm_mul_ps(_mm_set1_ps(area), inv[h])), _mm256_set1_pd(1e-1), _CMP_LT_OQ);
+						mask |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_and_pd(positive, small))) << (4 * h);
+					}
+					invNorm = _mm256_set_m128(inv[1], inv[0]);
+					return fromBits(mask);
+				}
+			};
+
+			struct OpsAvx512
+			{
+				static const int lanes = 16;
+				using VI = __m512i;
+				using VF = __m512;
+				using M = __mmask16;
+
+				GHOST_TARGET_AVX512 static VI load(const int32_t* p, const int step)
+				{
+					if (step == 1)
+						return _mm512_loadu_si512(p);
+
+					const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+					return _mm512_permutex2var_epi32(_mm512_loadu_si512(p), even, _mm512_loadu_si512(p + 16));
+				}
+				GHOST_TARGET_AVX512 static VF loadf(const float* p) { return _mm512_loadu_ps(p); }
+				GHOST_TARGET_AVX512 static VI rectSum(const int32_t* p, const int32_t* o, const int step)
+				{
+					return _mm512_add_epi32(_mm512_sub_epi32(_mm512_sub_epi32(load(p + o[0], step), load(p + o[1], step)), load(p + o[2], step)), load(p + o[3], step));
+				}
+				GHOST_TARGET_AVX512 static VI addi(const VI a, const VI b) { return _mm512_add_epi32(a, b); }
+				GHOST_TARGET_AVX512 static VI subi(const VI a, const VI b) { return _mm512_sub_epi32(a, b); }
+				GHOST_TARGET_AVX512 static VF cvt(const VI a) { return _mm512_cvtepi32_ps(a); }
+				GHOST_TARGET_AVX512 static VF setf(const float a) { return _mm512_set1_ps(a); }
+				GHOST_TARGET_AVX512 static VF addf(const VF a, const VF b) { return _mm512_add_ps(a, b); }
+				GHOST_TARGET_AVX512 static VF mulf(const VF a, const VF b) { return _mm512_mul_ps(a, b); }
+				GHOST_TARGET_AVX512 static M ltf(const VF a, const VF b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+				GHOST_TARGET_AVX512 static M gef(const VF a, const VF b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+				GHOST_TARGET_AVX512 static VF select(const M m, const VF a, const VF b) { return _mm512_mask_blend_ps(m, b, a); }
+				GHOST_TARGET_AVX512 static M andm(const M a, const M b) { return static_cast<M>(a & b); }
+				GHOST_TARGET_AVX512 static M fromBits(const uint32_t bits) { return static_cast<M>(bits); }
+				GHOST_TARGET_AVX512 static uint32_t bits(const M m) { return static_cast<uint32_t>(m); }
+				GHOST_TARGET_AVX512 static VI zeroi() { return _mm512_setzero_si512(); }
+				GHOST_TARGET_AVX512 static VI orBitGe(const VI code, const VI a, const VI center, const int32_t bit)
+				{
+					return _mm512_mask_or_epi32(code, _mm512_cmpge_epi32_mask(a, center), code, _mm512_set1_epi32(bit));
+				}
+				GHOST_TARGET_AVX512 static M subsetTest(const VI code, const int32_t* subset)
+				{
+					const __m512i word = _mm512_i32gather_epi32(_mm512_srli_epi32(code, 5), subset, 4);
+					const __m512i bit = _mm512_sllv_epi32(_mm512_set1_epi32(1), _mm512_and_si512(code, _mm512_set1_epi32(31)));
+					return _mm512_test_epi32_mask(word, bit);
+				}
+				GHOST_TARGET_AVX512 static M varianceNorm(const VI sum, const VI sqsum, const float area, VF& invNorm)
+				{
+					const __m512d a = _mm512_set1_pd(area);
+					const __m512d one = _mm512_set1_pd(1.);
+					__m256 inv[2];
+					uint32_t mask = 0;
+					for (int h = 0; h < 2; h++)
+					{
+						const __m512d s = _mm512_cvtepi32_pd(h ? _mm512_extracti64x4_epi64(sum, 1) : _mm512_castsi512_si256(sum));
+						const __m512d q = _mm512_cvtepi32_pd(h ? _mm512_extracti64x4_epi64(sqsum, 1) : _mm512_castsi512_si256(sqsum));
+						const __m512d norm = _mm512_sub_pd(_mm512_mul_pd(a, q), _mm512_mul_pd(s, s));
+						const __mmask8 positive = _mm512_cmp_pd_mask(norm, _mm512_setzero_pd(), _CMP_GT_OQ);
+						inv[h] = _mm512_cvtpd_ps(_mm512_mask_blend_pd(positive, one, _mm512_div_pd(one, _mm512_sqrt_pd(norm))));
+						const __mmask8 small = _mm512_cmp_pd_mask(_mm512_cvtps_pd(_mm256_mul_ps(_mm256_set1_ps(area), inv[h])), _mm512_set1_pd(1e-1), _CMP_LT_OQ);
+						mask |= static_cast<uint32_t>(positive & small) << (8 * h);
+					}
+					invNorm = _mm512_insertf32x8(_mm512_castps256_ps512(inv[0]), inv[1], 1);
+					return fromBits(mask);
+				}
+			};
+
+			template<class Ops>
+			inline typename Ops::VF haarFeature(const SModel& m, const int32_t feature, const int32_t* p, const int step)
+			{
+				const int32_t* o = m.offsets + feature * 12;
+				const float* w = m.weights + feature * 3;
+
+				typename Ops::VF value = Ops::addf
+				(
+					Ops::mulf(Ops::setf(w[0]), Ops::cvt(Ops::rectSum(p, o, step))),
+					Ops::mulf(Ops::setf(w[1]), Ops::cvt(Ops::rectSum(p, o + 4, step)))
+				);
+				if (w[2] != 0.f)
+					value = Ops::addf(value, Ops::mulf(Ops::setf(w[2]), Ops::cvt(Ops::rectSum(p, o + 8, step))));
+
+				return value;
+			}
+
+			/**
+			* \@brief Every node of the tree is evaluated, children always follow their parent so the tree resolves bottom-up
+			*/
+			template<class Ops>
+			inline typename Ops::VF haarTree(const SModel& m, const STree& tree, const int32_t* p, const int step, const typename Ops::VF invNorm)
+			{
+				const SNode* nodes = m.nodes + tree.firstNode;
+				const float* leaves = m.leaves + tree.firstLeaf;
+
+				typename Ops::VF values[kMaxTreeNodes];
+				for (int32_t n = tree.nodeNum - 1; n >= 0; n--)
+				{
+					const SNode& node = nodes[n];
+					const typename Ops::VF value = Ops::mulf(haarFeature<Ops>(m, node.feature, p, step), invNorm);
+					const typename Ops::VF left = (node.left > 0) ? values[node.left] : Ops::setf(leaves[-node.left]);
+					const typename Ops::VF right = (node.right > 0) ? values[node.right] : Ops::setf(leaves[-node.right]);
+					values[n] = Ops::select(Ops::ltf(value, Ops::setf(node.threshold)), left, right);
+				}
+				return values[0];
+			}
+
+			/**
+			* \@brief 8 bit LBP code of the 3 x 3 cell block, bit order as in OpenCV (top-left = 128, clockwise, left = 1)
+			*/
+			template<class Ops>
+			inline typename Ops::VI lbpCode(const SModel& m, const int32_t feature, const int32_t* p, const int step)
+			{
+				const int32_t* o = m.offsets + feature * 16;
+
+				typename Ops::VI corner[16];
+				for (int i = 0; i < 16; i++)
+					corner[i] = Ops::load(p + o[i], step);
+
+				typename Ops::VI cell[9];
+				for (int r = 0; r < 3; r++)
+				{
+					for (int c = 0; c < 3; c++)
+					{
+						const int i = r * 4 + c;
+						cell[r * 3 + c] = Ops::addi(Ops::subi(Ops::subi(corner[i], corner[i + 1]), corner[i + 4]), corner[i + 5]);
+					}
+				}
+
+				const typename Ops::VI center = cell[4];
+				typename Ops::VI code = Ops::zeroi();
+				code = Ops::orBitGe(code, cell[0], center, 128);
+				code = Ops::orBitGe(code, cell[1], center, 64);
+				code = Ops::orBitGe(code, cell[2], center, 32);
+				code = Ops::orBitGe(code, cell[5], center, 16);
+				code = Ops::orBitGe(code, cell[8], center, 8);
+				code = Ops::orBitGe(code, cell[7], center, 4);
+				code = Ops::orBitGe(code, cell[6], center, 2);
+				code = Ops::orBitGe(code, cell[3], center, 1);
+				return code;
+			}
+
+			template<class Ops>
+			inline typename Ops::VF lbpTree(const SModel& m, const STree& tree, const int32_t* p, const int step)
+			{
+				const SNode* nodes = m.nodes + tree.firstNode;
+				const float* leaves = m.leaves + tree.firstLeaf;
+
+				typename Ops::VF values[kMaxTreeNodes];
+				for (int32_t n = tree.nodeNum - 1; n >= 0; n--)
+				{
+					const SNode& node = nodes[n];
+					const typename Ops::VF left = (node.left > 0) ? values[node.left] : Ops::setf(leaves[-node.left]);
+					const typename Ops::VF right = (node.right > 0) ? values[node.right] : Ops::setf(leaves[-node.right]);
+					values[n] = Ops::select(Ops::subsetTest(lbpCode<Ops>(m, node.feature, p, step), node.subset), left, right);
+				}
+				return values[0];
+			}
+
+			/**
+			* \@brief Run the cascade on Ops::lanes windows starting at p, p + step, ...
+			* \@return bit i set::window i passed every stage
+			*/
+			template<class Ops>
+			inline uint32_t evalWindows(const SModel& m, const int32_t* p, const uint32_t* q, const int step)
+			{
+				//Haar:: 方差归一化 方差过小的窗口直接拒绝 #窗口平方和不超过 int32 由 load() 保证#
+				typename Ops::VF norm = Ops::setf(1.f);
+				typename Ops::M aliveMask = Ops::fromBits((1u << Ops::lanes) - 1u);
+				if (!m.lbpFlag)
+				{
+					aliveMask = Ops::varianceNorm(Ops::rectSum(p, m.normOffsets, step), Ops::rectSum(reinterpret_cast<const int32_t*>(q), m.normOffsets, step), m.normArea, norm);
+					if (Ops::bits(aliveMask) == 0)
+						return 0;
+				}
+
+				for (int32_t s = 0; s < m.stageNum; s++)
+				{
+					const SStage& stage = m.stages[s];
+					typename Ops::VF sum = Ops::setf(0.f);
+					for (int32_t t = 0; t < stage.treeNum; t++)
+					{
+						const STree& tree = m.trees[stage.firstTree + t];
+						sum = Ops::addf(sum, m.lbpFlag ? lbpTree<Ops>(m, tree, p, step) : haarTree<Ops>(m, tree, p, step, norm));
+					}
+
+					aliveMask = Ops::andm(aliveMask, Ops::gef(sum, Ops::setf(stage.threshold)));
+					if (Ops::bits(aliveMask) == 0)
+						return 0;
+				}
+
+				return Ops::bits(aliveMask);
+			}
+
+			/**
+			* \@brief Scan one row of windows x = 0, step, ... <= xEnd, positions of the hits are written to hits
+			* \@return number of hits
+			*/
+			template<class Ops>
+			inline int scanRow(const SModel& m, const int32_t* sumRow, const uint32_t* sqsumRow, const int xEnd, const int step, int* hits)
+			{
+				int hitNum = 0;
+				int x = 0;
+				for (; x + (Ops::lanes - 1) * step <= xEnd; x += Ops::lanes * step)
+				{
+					uint32_t mask = evalWindows<Ops>(m, sumRow + x, sqsumRow + x, step);
+					for (int i = 0; mask != 0; i++, mask >>= 1)
+					{
+						if (mask & 1u)
+							hits[hitNum++] = x + i * step;
+					}
+				}
+				for (; x <= xEnd; x += step)
+				{
+					if (evalWindows<OpsScalar>(m, sumRow + x, sqsumRow + x, step) != 0)
+						hits[hitNum++] = x;
+				}
+				return hitNum;
+			}
+
+			inline int scanRowScalar(const SModel& m, const int32_t* sumRow, const uint32_t* sqsumRow, const int xEnd, const int step, int* hits)
+			{
+				return scanRow<OpsScalar>(m, sumRow, sqsumRow, xEnd, step, hits);
+			}
+
+			GHOST_TARGET_SSE41 GHOST_FLATTEN inline int scanRowSse41(const SModel& m, const int32_t* sumRow, const uint32_t* sqsumRow, const int xEnd, const int step, int* hits)
+			{
+				return scanRow<OpsSse41>(m, sumRow, sqsumRow, xEnd, step, hits);
+			}
+
+			GHOST_TARGET_AVX2 GHOST_FLATTEN inline int scanRowAvx2(const SModel& m, const int32_t* sumRow, const uint32_t* sqsumRow, const int xEnd, const int step, int* hits)
+			{
+				return scanRow<OpsAvx2>(m, sumRow, sqsumRow, xEnd, step, hits);
+			}
+
+			GHOST_TARGET_AVX512 GHOST_FLATTEN inline int scanRowAvx512(const SModel& m, const int32_t* sumRow, const uint32_t* sqsumRow, const int xEnd, const int step, int* hits)
+			{
+				return scanRow<OpsAvx512>(m, sumRow, sqsumRow, xEnd, step, hits);
+			}
+
+			using ScanRowFunc = int(*)(const SModel&, const int32_t*, const uint32_t*, const int, const int, int*);
+
+			inline ScanRowFunc scanRowFunc(const simd::EIsa isa)
+			{
+				switch (simd::resolveIsa(isa))
+				{
+				case simd::EIsa::AVX512:
+				case simd::EIsa::AVX512_VNNI:	return &scanRowAvx512;
+				case simd::EIsa::AVX2:			return &scanRowAvx2;
+				case simd::EIsa::SSE41:			return &scanRowSse41;
+				default:						return &scanRowScalar;
+				}
+			}
+
+			/**
+			* \@brief Integral and squared integral with one zero row/column in front, stride = width + 1
+			* \@desc the squared integral wraps around in 32 bit, window differences stay exact
+			*/
+			inline void integral(const uint8_t* src, const size_t srcStep, const int width, const int height, int32_t* sum, uint32_t* sqsum)
+			{
+				const int stride = width + 1;
+				std::memset(sum, 0, sizeof(int32_t) * stride);
+				std::memset(sqsum, 0, sizeof(uint32_t) * stride);
+
+				for (int y = 0; y < height; y++)
+				{
+					const uint8_t* row = src + y * srcStep;
+					const int32_t* sumUp = sum + y * stride;
+					const uint32_t* sqsumUp = sqsum + y * stride;
+					int32_t* sumRow = sum + (y + 1) * stride;
+					uint32_t* sqsumRow = sqsum + (y + 1) * stride;
+
+					int32_t rowSum = 0;
+					uint32_t rowSqsum = 0;
+					sumRow[0] = 0;
+					sqsumRow[0] = 0;
+					for (int x = 0; x < width; x++)
+					{
+						rowSum += row[x];
+						rowSqsum += static_cast<uint32_t>(row[x]) * row[x];
+						sumRow[x + 1] = sumUp[x + 1] + rowSum;
+						sqsumRow[x + 1] = sqsumUp[x + 1] + rowSqsum;
+					}
+				}
+			}
+		}///namespace detail
+	}///namespace cascade
+
+	/**
+	* \@brief Boosted cascade detector reading OpenCV cascade xml files (Haar or LBP, new format)
+	* \@desc the image pyramid is scanned with the same rules as cv::CascadeClassifier::detectMultiScale,
+	* \@desc 4 / 8 / 16 neighbouring windows are evaluated per instruction with SSE4.1 / AVX2 / AVX-512,
+	* \@desc the pyramid levels and row strips are spread over a thread pool
+	* \@warning detect and detectBatch may be called from several threads at once, load / setIsa / setThreadNum may not
+	*/
+	class CascadeDetector final
+	{
+	public:
+		struct SObject
+		{
+			cv::Rect rect;
+			int32_t neighbors;									//!< number of raw windows merged into rect
+		};
+
+		/**
+		* \@param threadNum:: 0::all cores 1::calling thread only
+		*/
+		explicit CascadeDetector(const size_t threadNum = 0)
+			:
+			m_lbpFlag(false),
+			m_isa(simd::bestIsa())
+		{
+			setThreadNum(threadNum);
+		}
+
+		CascadeDetector(const CascadeDetector&) = delete;
+		CascadeDetector& operator=(const CascadeDetector&) = delete;
+
+	public:
+		/**
+		* \@brief True if the path names a cascade xml rather than a seeta model
+		*/
+		static bool isCascadeFile(const std::string& path)
+		{
+			if (path.size() < 4)
+				return false;
+
+			std::string extension = path.substr(path.size() - 4);
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return static_cast<char>(::tolower(c)); });
+			return extension == ".xml";
+		}
+
+		/**
+		* \@brief Load a cascade trained by opencv_traincascade (BOOST stages, HAAR or LBP features)
+		* \@return SR_NG if the file uses the old format, tilted Haar features or trees deeper than kMaxTreeNodes
+		*/
+		EResult load(const std::string& xmlPath)
+		{
+			clear();
+
+			cv::FileStorage fs;
+			try
+			{
+				if (!fs.open(xmlPath, cv::FileStorage::READ))
+					return EResult::SR_Model_Path_Not_Exist;
+			}
+			catch (cv::Exception&)
+			{
+				return EResult::SR_Model_Path_Not_Exist;
+			}
+
+			const cv::FileNode root = fs.getFirstTopLevelNode();
+			if (root.empty() || static_cast<std::string>(root["stageType"]) != "BOOST")
+				return EResult::SR_NG;
+
+			const std::string featureType = static_cast<std::string>(root["featureType"]);
+			if (featureType != "HAAR" && featureType != "LBP")
+				return EResult::SR_NG;
+			m_lbpFlag = (featureType == "LBP");
+
+			//方差窗口的平方和要放进 int32
+			m_window = cv::Size(static_cast<int>(root["width"]), static_cast<int>(root["height"]));
+			if (m_window.width <= 2 || m_window.height <= 2 || (m_window.width - 2) * (m_window.height - 2) * 255.0 * 255.0 >= 2147483647.0)
+				return EResult::SR_NG;
+
+			if (!readStages(root["stages"]) || !readFeatures(root["features"]))
+			{
+				clear();
+				return EResult::SR_NG;
+			}
+
+			return EResult::SR_OK;
+		}
+
+		bool empty() const noexcept(true) { return m_stages.empty(); }
+
+		cv::Size getWindowSize() const noexcept(true) { return m_window; }
+
+		/**
+		* \@brief Force an instruction set #clamped to what the CPU supports#
+		*/
+		void setIsa(const simd::EIsa isa) { m_isa = simd::resolveIsa(isa); }
+
+		simd::EIsa getIsa() const noexcept(true) { return m_isa; }
+
+		/**
+		* \@param threadNum:: 0::all cores 1::calling thread only
+		*/
+		void setThreadNum(const size_t threadNum)
+		{
+			const size_t num = (threadNum == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : threadNum;
+
+			//调用线程也参与计算
+			m_pPool.reset();
+			if (num > 1)
+				m_pPool = std::make_unique<ThreadPool>(num - 1);
+		}
+
+		size_t getThreadNum() const noexcept(true) { return (m_pPool == nullptr) ? 1 : m_pPool->size() + 1; }
+
+		/**
+		* \@brief Detect objects in a gray (or BGR) image
+		* \@param minSize / maxSize:: object size range #empty maxSize::no limit#
+		* \@param scaleFactor:: pyramid step, > 1
+		* \@param minNeighbors:: raw windows needed to keep a group #0::return the raw windows#
+		*/
+		std::vector<SObject> detect(const cv::Mat& image, const cv::Size minSize, const cv::Size maxSize, const double scaleFactor = 1.1, const int32_t minNeighbors = 3) const
+		{
+			return detectImpl(image, minSize, maxSize, scaleFactor, minNeighbors, true);
+		}
+
+		/**
+		* \@brief Detect in several images, the images are spread over the pool and each one is scanned by a single thread
+		*/
+		std::vector<std::vector<SObject>> detectBatch(const std::vector<cv::Mat>& images, const cv::Size minSize, const cv::Size maxSize, const double scaleFactor = 1.1, const int32_t minNeighbors = 3) const
+		{
+			std::vector<std::vector<SObject>> objects(images.size());
+			if (images.size() == 1)
+			{
+				objects[0] = detect(images[0], minSize, maxSize, scaleFactor, minNeighbors);
+				return objects;
+			}
+
+			parallelFor(images.size(), true, [&](size_t index)
+			{
+				objects[index] = detectImpl(images[index], minSize, maxSize, scaleFactor, minNeighbors, false);
+			});
+
+			return objects;
+		}
+
+	private:
+		/**
+		* \@brief One pyramid level:: resized image, integral images and the feature offsets for its stride
+		*/
+		struct SLevel
+		{
+			double factor;
+			float scale;										//!< factor rounded like cv::CascadeClassifier, used to map hits back
+			cv::Size window;									//!< window size in the original image
+			cv::Size size;										//!< size of the resized image
+			int32_t stride;
+			int32_t step;										//!< window step, 1 above factor 2 else 2
+			int32_t xEnd;
+			int32_t yEnd;
+			simd::AlignedVector<int32_t> sum;
+			simd::AlignedVector<uint32_t> sqsum;
+			std::vector<int32_t> offsets;
+			cascade::detail::SModel model;
+		};
+
+		/**
+		* \@param parallel:: false::scan on the calling thread only #detectBatch already runs one image per thread#
+		*/
+		std::vector<SObject> detectImpl(const cv::Mat& image, const cv::Size minSize, const cv::Size maxSize, const double scaleFactor, const int32_t minNeighbors, const bool parallel) const
+		{
+			std::vector<SObject> objects;
+			if (empty() || image.empty())
+				return objects;
+
+			cv::Mat gray = image;
+			if (image.channels() == 3)
+				cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+			else if (image.channels() == 4)
+				cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+
+			std::vector<SLevel> levels = planLevels(gray.size(), minSize, maxSize, scaleFactor);
+			if (levels.empty())
+				return objects;
+
+			//每层一个积分图 再按行条带分成任务
+			parallelFor(levels.size(), parallel, [&](size_t index) { buildLevel(gray, levels[index]); });
+
+			std::vector<cv::Rect> rects = scanLevels(levels, gray.size(), parallel);
+
+			if (minNeighbors <= 0)
+			{
+				for (const auto& rect : rects)
+					objects.push_back({ rect, 1 });
+				return objects;
+			}
+
+			std::vector<int> weights;
+			cv::groupRectangles(rects, weights, minNeighbors, 0.2);
+			for (size_t i = 0; i < rects.size(); i++)
+				objects.push_back({ rects[i], weights[i] });
+
+			return objects;
+		}
+
+		void clear()
+		{
+			m_stages.clear();
+			m_trees.clear();
+			m_nodes.clear();
+			m_leaves.clear();
+			m_rects.clear();
+			m_weights.clear();
+			m_window = cv::Size();
+		}
+
+		static std::vector<double> readNumbers(const cv::FileNode& node)
+		{
+			std::vector<double> values;
+			for (auto it = node.begin(); it != node.end(); ++it)
+				values.push_back(static_cast<double>(*it));
+			return values;
+		}
+
+		bool readStages(const cv::FileNode& stages)
+		{
+			if (stages.empty() || !stages.isSeq())
+				return false;
+
+			const size_t nodeSize = m_lbpFlag ? 11 : 4;
+			for (auto stageIt = stages.begin(); stageIt != stages.end(); ++stageIt)
+			{
+				const cv::FileNode weaks = (*stageIt)["weakClassifiers"];
+				if (weaks.empty() || !weaks.isSeq())
+					return false;
+
+				cascade::detail::SStage stage;
+				stage.firstTree = static_cast<int32_t>(m_trees.size());
+				stage.treeNum = static_cast<int32_t>(weaks.size());
+				stage.threshold = static_cast<float>((*stageIt)["stageThreshold"]) - 1e-5f;
+
+				for (auto weakIt = weaks.begin(); weakIt != weaks.end(); ++weakIt)
+				{
+					const std::vector<double> internal = readNumbers((*weakIt)["internalNodes"]);
+					const std::vector<double> leaves = readNumbers((*weakIt)["leafValues"]);
+					const size_t nodeNum = internal.size() / nodeSize;
+					if (nodeNum == 0 || nodeNum > static_cast<size_t>(cascade::detail::kMaxTreeNodes) || internal.size() % nodeSize != 0)
+						return false;
+
+					cascade::detail::STree tree;
+					tree.firstNode = static_cast<int32_t>(m_nodes.size());
+					tree.nodeNum = static_cast<int32_t>(nodeNum);
+					tree.firstLeaf = static_cast<int32_t>(m_leaves.size());
+
+					for (size_t n = 0; n < nodeNum; n++)
+					{
+						const double* value = internal.data() + n * nodeSize;
+
+						cascade::detail::SNode node;
+						std::memset(&node, 0, sizeof(node));
+						node.left = static_cast<int32_t>(value[0]);
+						node.right = static_cast<int32_t>(value[1]);
+						node.feature = static_cast<int32_t>(value[2]);
+						if (m_lbpFlag)
+						{
+							for (int i = 0; i < 8; i++)
+								node.subset[i] = static_cast<int32_t>(value[3 + i]);
+						}
+						else
+						{
+							node.threshold = static_cast<float>(value[3]);
+						}
+
+						//子节点必须在父节点之后 叶子下标不能越界
+						for (const int32_t child : { node.left, node.right })
+						{
+							if ((child > 0 && (child <= static_cast<int32_t>(n) || child >= static_cast<int32_t>(nodeNum))) ||
+								(child <= 0 && -child >= static_cast<int32_t>(leaves.size())))
+								return false;
+						}
+						m_nodes.push_back(node);
+					}
+
+					for (const double leaf : leaves)
+						m_leaves.push_back(static_cast<float>(leaf));
+					m_trees.push_back(tree);
+				}
+
+				m_stages.push_back(stage);
+			}
+
+			return !m_stages.empty();
+		}
+
+		bool readFeatures(const cv::FileNode& features)
+		{
+			if (features.empty() || !features.isSeq())
+				return false;
+
+			for (auto it = features.begin(); it != features.end(); ++it)
+			{
+				if (m_lbpFlag)
+				{
+					const std::vector<double> rect = readNumbers((*it)["rect"]);
+					if (rect.size() != 4)
+						return false;
+
+					const cv::Rect cell(static_cast<int>(rect[0]), static_cast<int>(rect[1]), static_cast<int>(rect[2]), static_cast<int>(rect[3]));
+					if (cell.x < 0 || cell.y < 0 || cell.x + 3 * cell.width > m_window.width || cell.y + 3 * cell.height > m_window.height)
+						return false;
+					m_rects.push_back(cell);
+					continue;
+				}
+
+				const cv::FileNode tilted = (*it)["tilted"];
+				if (!tilted.empty() && static_cast<int>(tilted) != 0)
+					return false;
+
+				const cv::FileNode rects = (*it)["rects"];
+				if (rects.empty() || rects.size() < 2 || rects.size() > 3)
+					return false;
+
+				size_t index = 0;
+				for (auto rectIt = rects.begin(); rectIt != rects.end(); ++rectIt, index++)
+				{
+					const std::vector<double> rect = readNumbers(*rectIt);
+					if (rect.size() != 5)
+						return false;
+
+					m_rects.push_back(cv::Rect(static_cast<int>(rect[0]), static_cast<int>(rect[1]), static_cast<int>(rect[2]), static_cast<int>(rect[3])));
+					m_weights.push_back(static_cast<float>(rect[4]));
+				}
+				for (; index < 3; index++)
+				{
+					m_rects.push_back(cv::Rect());
+					m_weights.push_back(0.f);
+				}
+			}
+
+			//节点引用的特征必须存在
+			const size_t featureNum = m_lbpFlag ? m_rects.size() : m_rects.size() / 3;
+			for (const auto& node : m_nodes)
+			{
+				if (node.feature < 0 || static_cast<size_t>(node.feature) >= featureNum)
+					return false;
+			}
+
+			return true;
+		}
+
+		/**
+		* \@brief Pyramid levels with the skip / stop rules of detectMultiScale
+		*/
+		std::vector<SLevel> planLevels(const cv::Size imageSize, const cv::Size minSize, const cv::Size maxSize, const double scaleFactor) const
+		{
+			const cv::Size maxObject = (maxSize.width <= 0 || maxSize.height <= 0) ? imageSize : maxSize;
+			const double step = std::max(1.0001, scaleFactor);
+
+			std::vector<SLevel> levels;
+			for (double factor = 1.0; ; factor *= step)
+			{
+				const cv::Size window(cvRound(m_window.width * factor), cvRound(m_window.height * factor));
+				const cv::Size size(cvRound(imageSize.width / factor), cvRound(imageSize.height / factor));
+
+				if (size.width <= m_window.width || size.height <= m_window.height)
+					break;
+				if (window.width > maxObject.width || window.height > maxObject.height)
+					break;
+				if (window.width < minSize.width || window.height < minSize.height)
+					continue;
+
+				SLevel level;
+				level.factor = factor;
+				level.scale = static_cast<float>(factor);
+				level.window = window;
+				level.size = size;
+				level.stride = size.width + 1;
+				level.step = (factor > 2.0) ? 1 : 2;
+				level.xEnd = size.width - m_window.width;
+				level.yEnd = size.height - m_window.height;
+				levels.push_back(std::move(level));
+			}
+
+			return levels;
+		}
+
+		void buildLevel(const cv::Mat& gray, SLevel& level) const
+		{
+			cv::Mat resized = gray;
+			if (level.size != gray.size())
+				cv::resize(gray, resized, level.size, 0, 0, cv::INTER_LINEAR);
+
+			//两个步长的载入会多读一个元素 加上余量
+			const size_t elements = static_cast<size_t>(level.stride) * (level.size.height + 1) + 64;
+			level.sum.assign(elements, 0);
+			level.sqsum.assign(elements, 0);
+			cascade::detail::integral(resized.data, resized.step, resized.cols, resized.rows, level.sum.data(), level.sqsum.data());
+
+			const int32_t stride = level.stride;
+			if (m_lbpFlag)
+			{
+				level.offsets.resize(m_rects.size() * 16);
+				for (size_t f = 0; f < m_rects.size(); f++)
+				{
+					const cv::Rect& r = m_rects[f];
+					for (int32_t row = 0; row < 4; row++)
+					{
+						for (int32_t col = 0; col < 4; col++)
+							level.offsets[f * 16 + row * 4 + col] = (r.y + row * r.height) * stride + r.x + col * r.width;
+					}
+				}
+			}
+			else
+			{
+				level.offsets.resize(m_rects.size() * 4);
+				for (size_t i = 0; i < m_rects.size(); i++)
+				{
+					const cv::Rect& r = m_rects[i];
+					level.offsets[i * 4 + 0] = r.y * stride + r.x;
+					level.offsets[i * 4 + 1] = r.y * stride + r.x + r.width;
+					level.offsets[i * 4 + 2] = (r.y + r.height) * stride + r.x;
+					level.offsets[i * 4 + 3] = (r.y + r.height) * stride + r.x + r.width;
+				}
+			}
+
+			cascade::detail::SModel& model = level.model;
+			model.lbpFlag = m_lbpFlag;
+			model.stages = m_stages.data();
+			model.stageNum = static_cast<int32_t>(m_stages.size());
+			model.trees = m_trees.data();
+			model.nodes = m_nodes.data();
+			model.leaves = m_leaves.data();
+			model.offsets = level.offsets.data();
+			model.weights = m_weights.data();
+
+			//方差窗口去掉一圈边框
+			const cv::Rect norm(1, 1, m_window.width - 2, m_window.height - 2);
+			model.normOffsets[0] = norm.y * stride + norm.x;
+			model.normOffsets[1] = norm.y * stride + norm.x + norm.width;
+			model.normOffsets[2] = (norm.y + norm.height) * stride + norm.x;
+			model.normOffsets[3] = (norm.y + norm.height) * stride + norm.x + norm.width;
+			model.normArea = static_cast<float>(norm.area());
+		}
+
+		/**
+		* \@brief Scan every level, rows are cut into strips of 8 window rows
+		* \@return raw windows in original image coordinates, clipped to the image
+		*/
+		std::vector<cv::Rect> scanLevels(const std::vector<SLevel>& levels, const cv::Size imageSize, const bool parallel) const
+		{
+			const cv::Rect bound(0, 0, imageSize.width, imageSize.height);
+
+			struct STask
+			{
+				size_t level;
+				int32_t yBegin;
+				int32_t yEnd;
+			};
+			std::vector<STask> tasks;
+			for (size_t i = 0; i < levels.size(); i++)
+			{
+				const int32_t band = levels[i].step * 8;
+				for (int32_t y = 0; y <= levels[i].yEnd; y += band)
+					tasks.push_back({ i, y, std::min(levels[i].yEnd, y + band - 1) });
+			}
+
+			const cascade::detail::ScanRowFunc scan = cascade::detail::scanRowFunc(m_isa);
+			std::vector<std::vector<cv::Rect>> found(tasks.size());
+			parallelFor(tasks.size(), parallel, [&](size_t index)
+			{
+				const STask& task = tasks[index];
+				const SLevel& level = levels[task.level];
+
+				std::vector<int> hits(level.xEnd + 1);
+				for (int32_t y = task.yBegin; y <= task.yEnd; y += level.step)
+				{
+					const int hitNum = scan(level.model, level.sum.data() + y * level.stride, level.sqsum.data() + y * level.stride, level.xEnd, level.step, hits.data());
+					for (int i = 0; i < hitNum; i++)
+						found[index].push_back(cv::Rect(cvRound(hits[i] * level.scale), cvRound(y * level.scale), level.window.width, level.window.height) & bound);
+				}
+			});
+
+			std::vector<cv::Rect> rects;
+			for (const auto& result : found)
+				rects.insert(rects.end(), result.begin(), result.end());
+
+			return rects;
+		}
+
+		void parallelFor(const size_t count, const bool parallel, const std::function<void(size_t)>& func) const
+		{
+			if (!parallel || m_pPool == nullptr || count <= 1)
+			{
+				for (size_t i = 0; i < count; i++)
+					func(i);
+				return;
+			}
+
+			m_pPool->parallelFor(0, count, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					func(i);
+			});
+		}
+
+	private:
+		bool m_lbpFlag;											//!< LBP features, else Haar
+		cv::Size m_window;										//!< training window size
+		std::vector<cascade::detail::SStage> m_stages;
+		std::vector<cascade::detail::STree> m_trees;
+		std::vector<cascade::detail::SNode> m_nodes;
+		std::vector<float> m_leaves;
+		std::vector<cv::Rect> m_rects;							//!< Haar:: 3 rects per feature, LBP:: cell rect per feature
+		std::vector<float> m_weights;							//!< Haar rect weights
+
+		simd::EIsa m_isa;										//!< instruction set used by the scan
+		std::unique_ptr<ThreadPool> m_pPool;					//!< nullptr::single thread
+	};
+}///namespace Ghost
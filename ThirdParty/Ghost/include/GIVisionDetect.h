@@ -11,6 +11,8 @@
 #include "GUtilities.hpp"
 #include "opencv2/opencv.hpp"
 
+#include <vector>
+
 using namespace Ghost;
 
 class IVisionDetecter
@@ -64,9 +66,46 @@ public:
 	*/
 	virtual EResult detect(const cv::Mat& frameIn, cv::Mat& frameOut) = 0;
 
+	/**
+	* \@brief Detect a batch of frames for offline throughput, moduals that can batch override it
+	* \@desc the default implementation calls detect on one frame after another, it is no faster than a detect loop
+	* \@param framesIn::Images for detection
+	* \@param framesOut::Empty if nothing needs to be drawn, else one image per frame
+	* \@param results::Result of each frame
+	* \@return SR_OK if every frame succeeded, else the first failure
+	*/
+	virtual EResult detectBatch(const std::vector<cv::Mat>& framesIn, std::vector<cv::Mat>& framesOut, std::vector<EResult>& results)
+	{
+		if (!framesOut.empty() && framesOut.size() != framesIn.size())
+			return EResult::SR_NG;
+
+		results.assign(framesIn.size(), EResult::SR_OK);
+		for (size_t i = 0; i < framesIn.size(); i++)
+		{
+			cv::Mat frameEmpty;
+			results[i] = detect(framesIn[i], framesOut.empty() ? frameEmpty : framesOut[i]);
+		}
+
+		return firstFailure(results);
+	}
+
 	/**
 	* \@brief Get the module type
 	* \@return module type
 	*/
 	virtual EDetectModual getModualType() noexcept(true) = 0;
+
+protected:
+	/**
+	* \@brief Result of a batch #SR_OK or the first failed frame#
+	*/
+	static EResult firstFailure(const std::vector<EResult>& results) noexcept(true)
+	{
+		for (const auto result : results)
+		{
+			if (result != EResult::SR_OK)
+				return result;
+		}
+		return EResult::SR_OK;
+	}
 };
\ No newline at end of file
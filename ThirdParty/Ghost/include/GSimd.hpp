@@ -0,0 +1,553 @@
+/*
+
++	Description:            Runtime CPU dispatch, aligned storage and shared SIMD kernels
++	FileName:               GSimd.hpp
++	Author:                 Ghost Chen
++   Date:                   2026/10/19
+
++	Copyright(C)            Quantum Dynamics Lab.
++
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+
+/**
+* \@brief MSVC accepts every intrinsic in any function, GCC/Clang need the target attribute per kernel
+* \@brief GHOST_FLATTEN inlines a generic kernel template into its ISA specific entry point
+*/
+#if defined(_MSC_VER)
+#define GHOST_TARGET_SSE41
+#define GHOST_TARGET_AVX2
+#define GHOST_TARGET_AVX512
+#define GHOST_TARGET_AVX512VNNI
+#define GHOST_FLATTEN
+#else
+#define GHOST_TARGET_SSE41		__attribute__((target("sse4.1")))
+#define GHOST_TARGET_AVX2		__attribute__((target("avx2,fma,f16c")))
+#define GHOST_TARGET_AVX512		__attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx2,fma,f16c")))
+#define GHOST_TARGET_AVX512VNNI	__attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx512vnni,avx2,fma,f16c")))
+#define GHOST_FLATTEN			__attribute__((flatten))
+#endif
+
+namespace Ghost
+{
+	namespace simd
+	{
+		/**
+		* \@brief Instruction set levels used by the dispatchers, ordered from slowest to fastest
+		*/
+		enum struct EIsa : uint8_t
+		{
+			Scalar = 0,
+			SSE41,
+			AVX2,
+			AVX512,
+			AVX512_VNNI
+		};
+
+		/**
+		* \@brief Features of the running CPU (and enabled by the OS)
+		*/
+		struct SCpuFeature
+		{
+			bool sse41;
+			bool avx2;
+			bool fma;
+			bool f16c;
+			bool avx512f;
+			bool avx512bw;
+			bool avx512vl;
+			bool avx512dq;
+			bool avx512vnni;
+
+			SCpuFeature()
+				:
+				sse41(false), avx2(false), fma(false), f16c(false), avx512f(false),
+				avx512bw(false), avx512vl(false), avx512dq(false), avx512vnni(false)
+			{}
+		};
+
+		namespace detail
+		{
+			inline void cpuid(int out[4], int leaf, int subLeaf)
+			{
+#if defined(_MSC_VER)
+				__cpuidex(out, leaf, subLeaf);
+#else
+				unsigned int a = 0, b = 0, c = 0, d = 0;
+				__cpuid_count(leaf, subLeaf, a, b, c, d);
+				out[0] = static_cast<int>(a); out[1] = static_cast<int>(b);
+				out[2] = static_cast<int>(c); out[3] = static_cast<int>(d);
+#endif
+			}
+
+			inline uint64_t xgetbv0()
+			{
+#if defined(_MSC_VER)
+				return _xgetbv(0);
+#else
+				uint32_t lo = 0, hi = 0;
+				__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+				return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+			}
+
+			inline SCpuFeature detectCpuFeature()
+			{
+				SCpuFeature feature;
+
+				int regs[4] = { 0 };
+				cpuid(regs, 0, 0);
+				const int maxLeaf = regs[0];
+				if (maxLeaf < 1)
+					return feature;
+
+				cpuid(regs, 1, 0);
+				feature.sse41 = (regs[2] & (1 << 19)) != 0;
+				const bool osxsave = (regs[2] & (1 << 27)) != 0;
+				const bool avx = (regs[2] & (1 << 28)) != 0;
+				const bool fma = (regs[2] & (1 << 12)) != 0;
+				const bool f16c = (regs[2] & (1 << 29)) != 0;
+				if (!osxsave || !avx)
+					return feature;
+
+				//YMM/ZMM state must be enabled by the OS
+				const uint64_t xcr0 = xgetbv0();
+				const bool ymmState = (xcr0 & 0x6) == 0x6;
+				const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+				if (!ymmState || maxLeaf < 7)
+					return feature;
+
+				cpuid(regs, 7, 0);
+				feature.avx2 = (regs[1] & (1 << 5)) != 0;
+				feature.fma = fma;
+				feature.f16c = f16c;
+				if (zmmState)
+				{
+					feature.avx512f = (regs[1] & (1 << 16)) != 0;
+					feature.avx512dq = (regs[1] & (1 << 17)) != 0;
+					feature.avx512bw = (regs[1] & (1 << 30)) != 0;
+					feature.avx512vl = (regs[1] & (1 << 31)) != 0;
+					feature.avx512vnni = (regs[2] & (1 << 11)) != 0;
+				}
+
+				return feature;
+			}
+		}///namespace detail
+
+		/**
+		* \@brief Cached CPU features
+		*/
+		inline const SCpuFeature& cpuFeature()
+		{
+			static const SCpuFeature s_feature = detail::detectCpuFeature();
+			return s_feature;
+		}
+
+		/**
+		* \@brief Best instruction set supported by the running CPU
+		*/
+		inline EIsa bestIsa()
+		{
+			const SCpuFeature& f = cpuFeature();
+			//every AVX2 part also has FMA and F16C, the AVX2 kernels may use all three
+			const bool avx2 = f.avx2 && f.fma && f.f16c;
+			if (avx2 && f.avx512f && f.avx512bw && f.avx512vl && f.avx512dq && f.avx512vnni)
+				return EIsa::AVX512_VNNI;
+			if (avx2 && f.avx512f && f.avx512bw && f.avx512vl && f.avx512dq)
+				return EIsa::AVX512;
+			if (avx2)
+				return EIsa::AVX2;
+			if (f.sse41)
+				return EIsa::SSE41;
+			return EIsa::Scalar;
+		}
+
+		/**
+		* \@brief Clamp the requested level to what the CPU supports #used to force a slower path for comparison#
+		*/
+		inline EIsa resolveIsa(const EIsa requested)
+		{
+			const EIsa best = bestIsa();
+			return (static_cast<uint8_t>(requested) < static_cast<uint8_t>(best)) ? requested : best;
+		}
+
+		inline const char* isaName(const EIsa isa)
+		{
+			switch (isa)
+			{
+			case EIsa::SSE41:		return "SSE4.1";
+			case EIsa::AVX2:		return "AVX2";
+			case EIsa::AVX512:		return "AVX-512";
+			case EIsa::AVX512_VNNI:	return "AVX-512-VNNI";
+			default:				return "Scalar";
+			}
+		}
+
+		/**
+		* \@brief Allocator returning 64-byte aligned blocks (one cache line, one zmm register)
+		*/
+		template<class T, size_t Alignment = 64>
+		struct AlignedAllocator
+		{
+			using value_type = T;
+
+			template<class U>
+			struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+			AlignedAllocator() noexcept {}
+
+			template<class U>
+			AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+			T* allocate(const size_t n)
+			{
+				if (n == 0)
+					return nullptr;
+
+				const size_t bytes = ((n * sizeof(T) + Alignment - 1) / Alignment) * Alignment;
+#if defined(_MSC_VER)
+				void* p = _aligned_malloc(bytes, Alignment);
+#else
+				void* p = std::aligned_alloc(Alignment, bytes);
+#endif
+				if (p == nullptr)
+					throw std::bad_alloc();
+
+				return static_cast<T*>(p);
+			}
+
+			void deallocate(T* p, const size_t) noexcept
+			{
+#if defined(_MSC_VER)
+				_aligned_free(p);
+#else
+				std::free(p);
+#endif
+			}
+
+			template<class U>
+			bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+			template<class U>
+			bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+		};
+
+		template<class T>
+		using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+		/**
+		* \@brief Round up to the next multiple of align
+		*/
+		inline size_t alignUp(const size_t value, const size_t align)
+		{
+			return ((value + align - 1) / align) * align;
+		}
+
+		/*------------------------------------------ dot product ------------------------------------------*/
+
+		namespace detail
+		{
+			inline float dotScalar(const float* a, const float* b, const size_t n)
+			{
+				float sum = 0.f;
+				for (size_t i = 0; i < n; i++)
+					sum += a[i] * b[i];
+				return sum;
+			}
+
+			GHOST_TARGET_AVX2 inline float dotAvx2(const float* a, const float* b, const size_t n)
+			{
+				__m256 acc0 = _mm256_setzero_ps();
+				__m256 acc1 = _mm256_setzero_ps();
+				size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+					acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+				}
+				for (; i + 8 <= n; i += 8)
+					acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+
+				acc0 = _mm256_add_ps(acc0, acc1);
+				__m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+				lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+				lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x1));
+				float sum = _mm_cvtss_f32(lo);
+
+				for (; i < n; i++)
+					sum += a[i] * b[i];
+				return sum;
+			}
+
+			GHOST_TARGET_AVX512 inline float dotAvx512(const float* a, const float* b, const size_t n)
+			{
+				__m512 acc0 = _mm512_setzero_ps();
+				__m512 acc1 = _mm512_setzero_ps();
+				size_t i = 0;
+				for (; i + 32 <= n; i += 32)
+				{
+					acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+					acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+				}
+				for (; i + 16 <= n; i += 16)
+					acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+				if (i < n)
+				{
+					const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1u);
+					acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc1);
+				}
+
+				return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+			}
+		}///namespace detail
+
+		/**
+		* \@brief Dot product of two float arrays
+		*/
+		inline float dot(const float* a, const float* b, const size_t n)
+		{
+			static const EIsa s_isa = bestIsa();
+			if (s_isa >= EIsa::AVX512)
+				return detail::dotAvx512(a, b, n);
+			if (s_isa >= EIsa::AVX2)
+				return detail::dotAvx2(a, b, n);
+			return detail::dotScalar(a, b, n);
+		}
+
+		/*------------------------------------------ SGEMM ------------------------------------------*/
+
+		namespace detail
+		{
+			/**
+			* \@brief C[M x N] = A[M x K] * B[K x N] (+ C when accumulate), all row-major
+			*/
+			inline void sgemmScalar(const int M, const int N, const int K, const float* A, const int lda,
+				const float* B, const int ldb, float* C, const int ldc, const bool accumulate)
+			{
+				for (int i = 0; i < M; i++)
+				{
+					float* c = C + static_cast<size_t>(i) * ldc;
+					if (!accumulate)
+						std::fill(c, c + N, 0.f);
+
+					for (int k = 0; k < K; k++)
+					{
+						const float a = A[static_cast<size_t>(i) * lda + k];
+						if (a == 0.f)
+							continue;
+
+						const float* b = B + static_cast<size_t>(k) * ldb;
+						for (int j = 0; j < N; j++)
+							c[j] += a * b[j];
+					}
+				}
+			}
+
+			/**
+			* \@brief 4 x 16 register tile #rows beyond M point to the last valid row and are not stored#
+			*/
+			GHOST_TARGET_AVX2 inline void sgemmTileAvx2(const int rows, const int kBegin, const int kEnd,
+				const float* A, const int lda, const float* B, const int ldb, float* C, const int ldc, const bool load)
+			{
+				const float* a0 = A;
+				const float* a1 = A + static_cast<size_t>(std::min(1, rows - 1)) * lda;
+				const float* a2 = A + static_cast<size_t>(std::min(2, rows - 1)) * lda;
+				const float* a3 = A + static_cast<size_t>(std::min(3, rows - 1)) * lda;
+
+				__m256 c00, c01, c10, c11, c20, c21, c30, c31;
+				if (load)
+				{
+					c00 = _mm256_loadu_ps(C);									c01 = _mm256_loadu_ps(C + 8);
+					c10 = rows > 1 ? _mm256_loadu_ps(C + ldc) : _mm256_setzero_ps();
+					c11 = rows > 1 ? _mm256_loadu_ps(C + ldc + 8) : _mm256_setzero_ps();
+					c20 = rows > 2 ? _mm256_loadu_ps(C + 2 * ldc) : _mm256_setzero_ps();
+					c21 = rows > 2 ? _mm256_loadu_ps(C + 2 * ldc + 8) : _mm256_setzero_ps();
+					c30 = rows > 3 ? _mm256_loadu_ps(C + 3 * ldc) : _mm256_setzero_ps();
+					c31 = rows > 3 ? _mm256_loadu_ps(C + 3 * ldc + 8) : _mm256_setzero_ps();
+				}
+				else
+				{
+					c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm256_setzero_ps();
+				}
+
+				for (int k = kBegin; k < kEnd; k++)
+				{
+					const float* b = B + static_cast<size_t>(k) * ldb;
+					const __m256 b0 = _mm256_loadu_ps(b);
+					const __m256 b1 = _mm256_loadu_ps(b + 8);
+
+					__m256 a = _mm256_broadcast_ss(a0 + k);
+					c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+					a = _mm256_broadcast_ss(a1 + k);
+					c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+					a = _mm256_broadcast_ss(a2 + k);
+					c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+					a = _mm256_broadcast_ss(a3 + k);
+					c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+				}
+
+				_mm256_storeu_ps(C, c00); _mm256_storeu_ps(C + 8, c01);
+				if (rows > 1) { _mm256_storeu_ps(C + ldc, c10); _mm256_storeu_ps(C + ldc + 8, c11); }
+				if (rows > 2) { _mm256_storeu_ps(C + 2 * ldc, c20); _mm256_storeu_ps(C + 2 * ldc + 8, c21); }
+				if (rows > 3) { _mm256_storeu_ps(C + 3 * ldc, c30); _mm256_storeu_ps(C + 3 * ldc + 8, c31); }
+			}
+
+			GHOST_TARGET_AVX2 inline void sgemmAvx2(const int M, const int N, const int K, const float* A, const int lda,
+				const float* B, const int ldb, float* C, const int ldc, const bool accumulate)
+			{
+				const int KC = 256;
+				const int N16 = N - N % 16;
+
+				for (int kBegin = 0; kBegin < K || (K == 0 && kBegin == 0); kBegin += KC)
+				{
+					const int kEnd = std::min(K, kBegin + KC);
+					const bool load = accumulate || kBegin > 0;
+
+					for (int i = 0; i < M; i += 4)
+					{
+						const int rows = std::min(4, M - i);
+						const float* a = A + static_cast<size_t>(i) * lda;
+						float* c = C + static_cast<size_t>(i) * ldc;
+
+						for (int j = 0; j < N16; j += 16)
+							sgemmTileAvx2(rows, kBegin, kEnd, a, lda, B + j, ldb, c + j, ldc, load);
+
+						//column tail
+						for (int r = 0; r < rows; r++)
+						{
+							float* cr = c + static_cast<size_t>(r) * ldc;
+							const float* ar = a + static_cast<size_t>(r) * lda;
+							for (int j = N16; j < N; j++)
+							{
+								float sum = load ? cr[j] : 0.f;
+								for (int k = kBegin; k < kEnd; k++)
+									sum += ar[k] * B[static_cast<size_t>(k) * ldb + j];
+								cr[j] = sum;
+							}
+						}
+					}
+
+					if (K == 0)
+						break;
+				}
+			}
+
+			GHOST_TARGET_AVX512 inline void sgemmTileAvx512(const int rows, const int kBegin, const int kEnd,
+				const float* A, const int lda, const float* B, const int ldb, float* C, const int ldc, const bool load)
+			{
+				const float* a0 = A;
+				const float* a1 = A + static_cast<size_t>(std::min(1, rows - 1)) * lda;
+				const float* a2 = A + static_cast<size_t>(std::min(2, rows - 1)) * lda;
+				const float* a3 = A + static_cast<size_t>(std::min(3, rows - 1)) * lda;
+
+				__m512 c00, c01, c10, c11, c20, c21, c30, c31;
+				c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm512_setzero_ps();
+				if (load)
+				{
+					c00 = _mm512_loadu_ps(C); c01 = _mm512_loadu_ps(C + 16);
+					if (rows > 1) { c10 = _mm512_loadu_ps(C + ldc); c11 = _mm512_loadu_ps(C + ldc + 16); }
+					if (rows > 2) { c20 = _mm512_loadu_ps(C + 2 * ldc); c21 = _mm512_loadu_ps(C + 2 * ldc + 16); }
+					if (rows > 3) { c30 = _mm512_loadu_ps(C + 3 * ldc); c31 = _mm512_loadu_ps(C + 3 * ldc + 16); }
+				}
+
+				for (int k = kBegin; k < kEnd; k++)
+				{
+					const float* b = B + static_cast<size_t>(k) * ldb;
+					const __m512 b0 = _mm512_loadu_ps(b);
+					const __m512 b1 = _mm512_loadu_ps(b + 16);
+
+					__m512 a = _mm512_set1_ps(a0[k]);
+					c00 = _mm512_fmadd_ps(a, b0, c00); c01 = _mm512_fmadd_ps(a, b1, c01);
+					a = _mm512_set1_ps(a1[k]);
+					c10 = _mm512_fmadd_ps(a, b0, c10); c11 = _mm512_fmadd_ps(a, b1, c11);
+					a = _mm512_set1_ps(a2[k]);
+					c20 = _mm512_fmadd_ps(a, b0, c20); c21 = _mm512_fmadd_ps(a, b1, c21);
+					a = _mm512_set1_ps(a3[k]);
+					c30 = _mm512_fmadd_ps(a, b0, c30); c31 = _mm512_fmadd_ps(a, b1, c31);
+				}
+
+				_mm512_storeu_ps(C, c00); _mm512_storeu_ps(C + 16, c01);
+				if (rows > 1) { _mm512_storeu_ps(C + ldc, c10); _mm512_storeu_ps(C + ldc + 16, c11); }
+				if (rows > 2) { _mm512_storeu_ps(C + 2 * ldc, c20); _mm512_storeu_ps(C + 2 * ldc + 16, c21); }
+				if (rows > 3) { _mm512_storeu_ps(C + 3 * ldc, c30); _mm512_storeu_ps(C + 3 * ldc + 16, c31); }
+			}
+
+			GHOST_TARGET_AVX512 inline void sgemmAvx512(const int M, const int N, const int K, const float* A, const int lda,
+				const float* B, const int ldb, float* C, const int ldc, const bool accumulate)
+			{
+				const int KC = 256;
+				const int N32 = N - N % 32;
+
+				for (int kBegin = 0; kBegin < K || (K == 0 && kBegin == 0); kBegin += KC)
+				{
+					const int kEnd = std::min(K, kBegin + KC);
+					const bool load = accumulate || kBegin > 0;
+
+					for (int i = 0; i < M; i += 4)
+					{
+						const int rows = std::min(4, M - i);
+						const float* a = A + static_cast<size_t>(i) * lda;
+						float* c = C + static_cast<size_t>(i) * ldc;
+
+						for (int j = 0; j < N32; j += 32)
+							sgemmTileAvx512(rows, kBegin, kEnd, a, lda, B + j, ldb, c + j, ldc, load);
+
+						//column tail, 16 lanes masked
+						for (int j = N32; j < N; j += 16)
+						{
+							const int cols = std::min(16, N - j);
+							const __mmask16 mask = static_cast<__mmask16>((1u << cols) - 1u);
+							for (int r = 0; r < rows; r++)
+							{
+								float* cr = c + static_cast<size_t>(r) * ldc + j;
+								const float* ar = a + static_cast<size_t>(r) * lda;
+								__m512 acc = load ? _mm512_maskz_loadu_ps(mask, cr) : _mm512_setzero_ps();
+								for (int k = kBegin; k < kEnd; k++)
+									acc = _mm512_fmadd_ps(_mm512_set1_ps(ar[k]), _mm512_maskz_loadu_ps(mask, B + static_cast<size_t>(k) * ldb + j), acc);
+								_mm512_mask_storeu_ps(cr, mask, acc);
+							}
+						}
+					}
+
+					if (K == 0)
+						break;
+				}
+			}
+		}///namespace detail
+
+		/**
+		* \@brief Single precision matrix multiply C = A * B (+ C), row-major, dispatched on the running CPU
+		* \@param isa:: upper bound of the instruction set to use
+		*/
+		inline void sgemm(const int M, const int N, const int K, const float* A, const int lda,
+			const float* B, const int ldb, float* C, const int ldc, const bool accumulate = false, const EIsa isa = EIsa::AVX512_VNNI)
+		{
+			if (M <= 0 || N <= 0)
+				return;
+
+			const EIsa level = resolveIsa(isa);
+			if (level >= EIsa::AVX512)
+				detail::sgemmAvx512(M, N, K, A, lda, B, ldb, C, ldc, accumulate);
+			else if (level >= EIsa::AVX2)
+				detail::sgemmAvx2(M, N, K, A, lda, B, ldb, C, ldc, accumulate);
+			else
+				detail::sgemmScalar(M, N, K, A, lda, B, ldb, C, ldc, accumulate);
+		}
+	}///namespace simd
+}///namespace Ghost
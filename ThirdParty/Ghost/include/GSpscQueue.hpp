@@ -0,0 +1,128 @@
+/*
+
++	Description:            Bounded single-producer/single-consumer queue for detection pipelines
++	FileName:               GSpscQueue.hpp
++	Author:                 Ghost Chen
++   Date:                   2026/10/19
+
++	Copyright(C)            Quantum Dynamics Lab.
++
+
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Ghost
+{
+	/**
+	* \@brief Lock-free ring buffer, exactly one thread pushes and exactly one thread pops
+	* \@warning one slot is kept empty, capacity is the number of items that fit
+	*/
+	template<class T>
+	class SpscQueue final
+	{
+	public:
+		explicit SpscQueue(const size_t capacity)
+			:
+			m_buffer(capacity + 1),
+			m_head(0),
+			m_tail(0)
+		{}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+	public:
+		/**
+		* \@brief Producer side
+		* \@return false if the queue is full, item is left untouched
+		*/
+		bool tryPush(T& item)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			const size_t next = increment(tail);
+			if (next == m_head.load(std::memory_order_acquire))
+				return false;
+
+			m_buffer[tail] = std::move(item);
+			m_tail.store(next, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* \@brief Consumer side
+		* \@return false if the queue is empty
+		*/
+		bool tryPop(T& item)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire))
+				return false;
+
+			item = std::move(m_buffer[head]);
+			m_head.store(increment(head), std::memory_order_release);
+			return true;
+		}
+
+		/**
+		* \@brief Consumer side, spins then backs off until an item arrives or stopFlag is set
+		* \@return false if stopped
+		*/
+		bool waitPop(T& item, const std::atomic<bool>& stopFlag)
+		{
+			for (size_t spin = 0; !stopFlag.load(std::memory_order_relaxed); spin++)
+			{
+				if (tryPop(item))
+					return true;
+
+				if (spin < 64)
+					std::this_thread::yield();
+				else
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+			return false;
+		}
+
+		/**
+		* \@brief Producer side, waits for a free slot until stopFlag is set
+		* \@return false if stopped
+		*/
+		bool waitPush(T& item, const std::atomic<bool>& stopFlag)
+		{
+			for (size_t spin = 0; !stopFlag.load(std::memory_order_relaxed); spin++)
+			{
+				if (tryPush(item))
+					return true;
+
+				if (spin < 64)
+					std::this_thread::yield();
+				else
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+			return false;
+		}
+
+		bool empty() const noexcept(true)
+		{
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+
+		size_t capacity() const noexcept(true) { return m_buffer.size() - 1; }
+
+	private:
+		size_t increment(const size_t index) const noexcept(true)
+		{
+			return (index + 1 == m_buffer.size()) ? 0 : index + 1;
+		}
+
+	private:
+		std::vector<T> m_buffer;
+		alignas(64) std::atomic<size_t> m_head;			//!< next slot to pop, written by the consumer
+		alignas(64) std::atomic<size_t> m_tail;			//!< next slot to push, written by the producer
+	};
+}///namespace Ghost
@@ -0,0 +1,192 @@
+/*
+
++	Description:            Fixed size worker pool shared by the detection moduals
++	FileName:               GThreadPool.hpp
++	Author:                 Ghost Chen
++   Date:                   2026/10/19
+
++	Copyright(C)            Quantum Dynamics Lab.
++
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Ghost
+{
+	/**
+	* \@brief Worker pool with a FIFO task queue
+	* \@warning parallelFor may be nested, the calling thread always takes part in the work so it never waits on queued tasks
+	*/
+	class ThreadPool final
+	{
+	public:
+		explicit ThreadPool(const size_t threadNum = 0)
+			:
+			m_stopFlag(false)
+		{
+			size_t num = threadNum;
+			if (num == 0)
+				num = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+			m_workers.reserve(num);
+			for (size_t i = 0; i < num; i++)
+				m_workers.emplace_back([this]() { this->workLoop(); });
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stopFlag = true;
+			}
+			m_condition.notify_all();
+
+			for (auto& worker : m_workers)
+			{
+				if (worker.joinable())
+					worker.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+	public:
+		/**
+		* \@brief Number of worker threads
+		*/
+		size_t size() const noexcept(true) { return m_workers.size(); }
+
+		/**
+		* \@brief Queue a task
+		* \@return future of the task result
+		*/
+		template<class Func, class... Args>
+		auto commit(Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>
+		{
+			using ReturnType = std::invoke_result_t<Func, Args...>;
+
+			auto task = std::make_shared<std::packaged_task<ReturnType()>>
+			(
+				std::bind(std::forward<Func>(func), std::forward<Args>(args)...)
+			);
+			std::future<ReturnType> result = task->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.emplace([task]() { (*task)(); });
+			}
+			m_condition.notify_one();
+
+			return result;
+		}
+
+		/**
+		* \@brief Split [begin, end) into chunks and run func(chunkBegin, chunkEnd) across the pool, returns when all chunks finished
+		* \@param grain:: minimum number of items in one chunk
+		*/
+		void parallelFor(const size_t begin, const size_t end, const std::function<void(size_t, size_t)>& func, const size_t grain = 1)
+		{
+			if (end <= begin)
+				return;
+
+			const size_t total = end - begin;
+			const size_t maxChunks = (total + std::max<size_t>(1, grain) - 1) / std::max<size_t>(1, grain);
+			const size_t chunks = std::min(maxChunks, (m_workers.size() + 1) * 4);
+			if (chunks <= 1 || m_workers.empty())
+			{
+				func(begin, end);
+				return;
+			}
+
+			struct SShared
+			{
+				std::atomic<size_t> next;
+				std::atomic<size_t> done;
+				std::mutex mutex;
+				std::condition_variable condition;
+				SShared() : next(0), done(0) {}
+			};
+			auto shared = std::make_shared<SShared>();
+			const size_t step = (total + chunks - 1) / chunks;
+			const size_t chunkNum = (total + step - 1) / step;
+
+			auto runChunks = [shared, begin, end, step, chunkNum, &func]()
+			{
+				for (size_t index = shared->next.fetch_add(1); index < chunkNum; index = shared->next.fetch_add(1))
+				{
+					const size_t chunkBegin = begin + index * step;
+					func(chunkBegin, std::min(end, chunkBegin + step));
+
+					if (shared->done.fetch_add(1) + 1 == chunkNum)
+					{
+						std::lock_guard<std::mutex> lock(shared->mutex);
+						shared->condition.notify_all();
+					}
+				}
+			};
+
+			const size_t helpers = std::min(m_workers.size(), chunkNum - 1);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (size_t i = 0; i < helpers; i++)
+					m_tasks.emplace(runChunks);
+			}
+			m_condition.notify_all();
+
+			runChunks();
+
+			//only chunks that are already running on a worker can be outstanding here
+			std::unique_lock<std::mutex> lock(shared->mutex);
+			shared->condition.wait(lock, [&]() { return shared->done.load() >= chunkNum; });
+		}
+
+	private:
+		void workLoop()
+		{
+			for (;;)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_condition.wait(lock, [this]() { return m_stopFlag || !m_tasks.empty(); });
+					if (m_stopFlag && m_tasks.empty())
+						return;
+
+					task = std::move(m_tasks.front());
+					m_tasks.pop();
+				}
+				task();
+			}
+		}
+
+	private:
+		std::vector<std::thread> m_workers;					//!< worker threads
+		std::queue<std::function<void()>> m_tasks;			//!< pending tasks
+		std::mutex m_mutex;									//!< guards m_tasks
+		std::condition_variable m_condition;
+		bool m_stopFlag;
+	};
+
+	/**
+	* \@brief Process wide pool for batch work, one worker per core, created on first use
+	* \@warning never destroyed, joining workers while a dll is unloaded would dead lock
+	*/
+	inline ThreadPool& sharedThreadPool()
+	{
+		static ThreadPool* s_pPool = new ThreadPool();
+		return *s_pPool;
+	}
+}///namespace Ghost
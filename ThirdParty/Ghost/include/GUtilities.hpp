@@ -61,6 +61,11 @@ namespace Ghost
 		SR_ASF_IdCard_Feature_Extraction_Failed,
 		SR_ASF_Face_IdCard_Compare_Failed,
 
+		SR_Calibration_File_Not_Exist,
+		SR_Calibration_Image_Not_Exist,
+		SR_Pipeline_Full,
+		SR_Pipeline_Thread_Call,
+
 		SR_UNDEFINE = 100
 	};
 
@@ -150,6 +155,30 @@ namespace Ghost
 		TYPE_POSE_Dtection_Output,					//
 		TYPE_POSE_Dtection_Gui,						//ʾ
 
+		TYPE_Object_Detection_Int8,					//INT8 CPU 0::FP32 1::INT8
+		TYPE_Object_Detection_Threads,				//CPU߳ 0::к
+		TYPE_Face_Detection_TrackInterval,			//ģʽȫͼ֡ 0::رո
+		TYPE_Face_Detection_Threads,				//߳ Ĭ1 0::к ʼǰ󶼿
+		TYPE_Face_Detection_AutoScale,				//Զż 0::ر 1::
+		TYPE_POSE_Detection_Async,					//pose 0::ر 1::
+		TYPE_POSE_Detection_Cpu,					//CPU 0::OpenPose 1::CPU
+		TYPE_POSE_Detection_Threads,				//CPU߳ 0::к
+		TYPE_POSE_Detection_Roi,					//ROI ȫͼ֡ 0::ر
+		TYPE_POSE_Detection_Smooth,					//ؼʱ˲ 0::ر 1::
+		TYPE_POSE_Detection_Skip,					//ÿN֡һ ֡˲ 0/1::ÿ֡
+		TYPE_Face_Landmark_Threads,					//лع߳ Ĭ1 0::к
+		TYPE_Face_Landmark_Engine,					//ع 0::ldmarkmodel 1::SDM
+		TYPE_Face_Landmark_Precision,				//SDMĻع󾫶 0::fp32 1::fp16 2::int8
+		TYPE_Face_Landmark_HeadPose,				//68landmarkͷ̬ 0::ر 1::
+		TYPE_Face_Landmark_Blendshape,				//landmarkblendshapeȨ 0::ر 1::ģ 2::нС
+		TYPE_Face_Landmark_Blendshape_Neutral,		//ѸidΪvalueǰıΪԱ ȡһ
+		TYPE_Emotion_FlagInterval,					//ɰSmileFlagļд  0::رվ
+		TYPE_Emotion_Classifier,					//ʶ 0::Haar΢Ц 1::ö 2::landmarkļιϵ
+		TYPE_Emotion_Interval,						//ÿʶļ֡ ֡ý 0/1::ÿ֡
+		TYPE_Emotion_ChangeThreshold,				//۱仯ʱǰʶ 0::ر
+		TYPE_FACE_RECONGNITION_Compare,				//뱾ȶ
+		TYPE_FACE_RECONGNITION_Threshold,			//ȶֵ ƶ Ĭ0.8
+
 		TYPE_UNDEFINE = 100
 	};
 
@@ -169,7 +198,14 @@ namespace Ghost
 
 	enum struct EEmotion : uint8_t
 	{
-		
+		Neutral = 0,								//ƽ
+		Smile,										//΢Ц
+		Surprise,									//
+		Sad,										//
+		Angry,										//
+		Fear,										//
+		Disgust,									//
+		Max,
 	};
 
 	/**
@@ -218,10 +254,33 @@ namespace Ghost
 			ID(0), name(""), gender(0), age(0), post(127)
 		{}
 	};
+	using SPersonInfor = SPersonalInformation;
 
+	/**
+	* \@brief Rectangle in image pixels
+	*/
 	struct SRect
 	{
+		int x;
+		int y;
+		int width;
+		int height;
+
+		SRect() : x(0), y(0), width(0), height(0) {}
+		SRect(const int _x, const int _y, const int _width, const int _height) : x(_x), y(_y), width(_width), height(_height) {}
+	};
+
+	/**
+	* \@brief 2D keypoint in image pixels
+	*/
+	struct SPoint2D
+	{
+		float x;
+		float y;
+		float score;								//Ŷ 0::δ⵽
 
+		SPoint2D() : x(0.f), y(0.f), score(0.f) {}
+		SPoint2D(const float _x, const float _y, const float _score) : x(_x), y(_y), score(_score) {}
 	};
 
 	